@@ -0,0 +1,321 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Immutable double-array trie with the same lookup semantics as Trie<T>.
+
+#ifndef MOZC_BASE_CONTAINER_DOUBLE_ARRAY_TRIE_H_
+#define MOZC_BASE_CONTAINER_DOUBLE_ARRAY_TRIE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "base/util.h"
+
+namespace mozc {
+
+// DoubleArrayTrie is a frozen version of Trie<T>. All the nodes are stored in
+// one flat array and a transition is an array access instead of a hash map
+// lookup and a pointer chase, so it is faster and smaller than Trie<T>.
+// The keys are split into characters in the same way as Trie<T>, so
+// LookUp(), LookUpPrefix(), LookUpPredictiveAll() and HasSubTrie() return
+// the same results as Trie<T> built from the same entries. Only the order of
+// the results of LookUpPredictiveAll() may differ.
+template <typename T>
+class DoubleArrayTrie final {
+ public:
+  DoubleArrayTrie() = default;
+
+  // Builds the trie from the pairs of a key and its data. If a key appears
+  // more than once, the last data is used.
+  explicit DoubleArrayTrie(std::vector<std::pair<std::string, T>> entries) {
+    Build(std::move(entries));
+  }
+
+  DoubleArrayTrie(const DoubleArrayTrie &) = default;
+  DoubleArrayTrie &operator=(const DoubleArrayTrie &) = default;
+  DoubleArrayTrie(DoubleArrayTrie &&) = default;
+  DoubleArrayTrie &operator=(DoubleArrayTrie &&) = default;
+
+  bool LookUp(absl::string_view key, T *data) const {
+    const int32_t node = Traverse(key);
+    if (node < 0 || units_[node].value < 0) {
+      return false;
+    }
+    *data = values_[units_[node].value];
+    return true;
+  }
+
+  // Same as Trie<T>::LookUpPrefix. Follows `key` as far as possible and
+  // returns the data of the deepest node. `fixed` is set to true if the node
+  // has no children.
+  bool LookUpPrefix(absl::string_view key, T *data, size_t *key_length,
+                    bool *fixed) const {
+    *key_length = 0;
+    if (units_.empty()) {
+      *fixed = true;
+      return false;
+    }
+    int32_t node = 0;
+    absl::string_view rest = key;
+    while (!rest.empty()) {
+      absl::string_view next_rest;
+      const int32_t next = NextChar(node, rest, &next_rest);
+      if (next < 0) {
+        break;
+      }
+      *key_length += rest.size() - next_rest.size();
+      node = next;
+      rest = next_rest;
+    }
+    const Unit &unit = units_[node];
+    if (unit.value >= 0) {
+      *data = values_[unit.value];
+      *fixed = unit.child == 0;
+      return true;
+    }
+    *fixed = true;
+    return false;
+  }
+
+  // Appends all the data whose keys start with `key`.
+  void LookUpPredictiveAll(absl::string_view key,
+                           std::vector<T> *data_list) const {
+    DCHECK(data_list);
+    const int32_t node = Traverse(key);
+    if (node >= 0) {
+      CollectValues(node, data_list);
+    }
+  }
+
+  bool HasSubTrie(absl::string_view key) const {
+    return !key.empty() && Traverse(key) >= 0;
+  }
+
+  bool empty() const { return values_.empty(); }
+
+  // Returns the number of bytes used by the trie, excluding the memory owned
+  // by the data themselves.
+  size_t GetMemoryUsage() const {
+    return units_.capacity() * sizeof(Unit) + values_.capacity() * sizeof(T);
+  }
+
+ private:
+  // Labels are bytes shifted by one so that 0 can mean "no label".
+  struct Unit {
+    // The children of this node are at `base + label`.
+    int32_t base = 0;
+    // The index of the parent node, or -1 if the unit is not used.
+    int32_t check = -1;
+    // The index in `values_`, or -1 if the node has no data.
+    int32_t value = -1;
+    // The smallest label of the children, or 0 if the node has no children.
+    uint16_t child = 0;
+    // The next larger label among the siblings, or 0 if there is none.
+    uint16_t sibling = 0;
+  };
+
+  // Returns the bytes of the first character of `key` as Trie<T> splits it,
+  // and sets the rest to `rest`. An invalid UTF-8 sequence is treated as
+  // U+0000 followed by nothing, as Util::SplitFirstChar32 does.
+  static absl::string_view SplitFirstChar(absl::string_view key,
+                                          absl::string_view *rest) {
+    if (!Util::SplitFirstChar32(key, nullptr, rest)) {
+      *rest = absl::string_view();
+      return absl::string_view("\0", 1);
+    }
+    return key.substr(0, key.size() - rest->size());
+  }
+
+  int32_t Next(int32_t node, uint8_t byte) const {
+    const size_t index = static_cast<size_t>(units_[node].base) + byte + 1;
+    if (index >= units_.size() || units_[index].check != node) {
+      return -1;
+    }
+    return static_cast<int32_t>(index);
+  }
+
+  // Follows the first character of `key` from `node`. Returns -1 if there is
+  // no such transition.
+  int32_t NextChar(int32_t node, absl::string_view key,
+                   absl::string_view *rest) const {
+    for (const char c : SplitFirstChar(key, rest)) {
+      node = Next(node, static_cast<uint8_t>(c));
+      if (node < 0) {
+        return -1;
+      }
+    }
+    return node;
+  }
+
+  // Returns the node for `key`, or -1 if it does not exist.
+  int32_t Traverse(absl::string_view key) const {
+    if (units_.empty()) {
+      return -1;
+    }
+    int32_t node = 0;
+    while (!key.empty()) {
+      node = NextChar(node, key, &key);
+      if (node < 0) {
+        return -1;
+      }
+    }
+    return node;
+  }
+
+  void CollectValues(int32_t node, std::vector<T> *data_list) const {
+    const Unit &unit = units_[node];
+    if (unit.value >= 0) {
+      data_list->push_back(values_[unit.value]);
+    }
+    for (uint16_t label = unit.child; label != 0;) {
+      const int32_t child = unit.base + label;
+      CollectValues(child, data_list);
+      label = units_[child].sibling;
+    }
+  }
+
+  void Build(std::vector<std::pair<std::string, T>> entries) {
+    // Split the keys into characters in the same way as lookups, and
+    // re-encode them so that the trie is built from the byte sequences that
+    // lookups follow.
+    std::vector<std::pair<std::string, size_t>> keys;
+    keys.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+      std::string bytes;
+      absl::string_view rest = entries[i].first;
+      while (!rest.empty()) {
+        absl::string_view next_rest;
+        const absl::string_view c = SplitFirstChar(rest, &next_rest);
+        bytes.append(c.data(), c.size());
+        rest = next_rest;
+      }
+      keys.emplace_back(std::move(bytes), i);
+    }
+    // Stable sort keeps the later one of duplicated keys at the end.
+    absl::c_stable_sort(keys, [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+
+    units_.assign(1, Unit());
+    units_[0].check = 0;
+    values_.clear();
+    values_.reserve(entries.size());
+    first_free_ = 1;
+    BuildNode(keys, 0, keys.size(), 0, 0, entries);
+    units_.shrink_to_fit();
+    values_.shrink_to_fit();
+  }
+
+  // Builds the subtree of `node` from keys[begin, end), which share the first
+  // `depth` bytes.
+  void BuildNode(const std::vector<std::pair<std::string, size_t>> &keys,
+                 size_t begin, size_t end, size_t depth, int32_t node,
+                 std::vector<std::pair<std::string, T>> &entries) {
+    // The keys ending at this node come first as the keys are sorted. Use the
+    // last one of them.
+    size_t children_begin = begin;
+    while (children_begin < end &&
+           keys[children_begin].first.size() == depth) {
+      ++children_begin;
+    }
+    if (children_begin > begin) {
+      units_[node].value = static_cast<int32_t>(values_.size());
+      const size_t last = keys[children_begin - 1].second;
+      values_.push_back(std::move(entries[last].second));
+    }
+
+    // Collect the labels of the children and the ranges of their keys.
+    std::vector<std::pair<uint16_t, size_t>> children;
+    for (size_t i = children_begin; i < end; ++i) {
+      const uint16_t label = static_cast<uint8_t>(keys[i].first[depth]) + 1;
+      if (children.empty() || children.back().first != label) {
+        children.emplace_back(label, i);
+      }
+    }
+    if (children.empty()) {
+      return;
+    }
+
+    const int32_t base = FindBase(children);
+    units_[node].base = base;
+    units_[node].child = children.front().first;
+    for (size_t i = 0; i < children.size(); ++i) {
+      Unit &unit = units_[base + children[i].first];
+      unit.check = node;
+      unit.sibling = i + 1 < children.size() ? children[i + 1].first : 0;
+    }
+    for (size_t i = 0; i < children.size(); ++i) {
+      const size_t child_end =
+          i + 1 < children.size() ? children[i + 1].second : end;
+      BuildNode(keys, children[i].second, child_end, depth + 1,
+                base + children[i].first, entries);
+    }
+  }
+
+  // Returns the smallest base whose slots for all `children` are free, and
+  // extends `units_` to cover them.
+  int32_t FindBase(const std::vector<std::pair<uint16_t, size_t>> &children) {
+    const uint16_t first_label = children.front().first;
+    // Start from the first free unit to skip the dense part quickly.
+    size_t first_free = first_free_;
+    while (first_free < units_.size() && units_[first_free].check >= 0) {
+      ++first_free;
+    }
+    first_free_ = first_free;
+    for (size_t base = first_free > first_label ? first_free - first_label : 0;
+         ; ++base) {
+      const bool fits = absl::c_all_of(children, [&](const auto &child) {
+        const size_t index = base + child.first;
+        return index >= units_.size() || units_[index].check < 0;
+      });
+      if (fits) {
+        const size_t required = base + children.back().first + 1;
+        if (units_.size() < required) {
+          units_.resize(required);
+        }
+        return static_cast<int32_t>(base);
+      }
+    }
+  }
+
+  std::vector<Unit> units_;
+  std::vector<T> values_;
+  // Used only while building. Every unit before it is used.
+  size_t first_free_ = 0;
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_BASE_CONTAINER_DOUBLE_ARRAY_TRIE_H_
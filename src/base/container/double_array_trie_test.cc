@@ -0,0 +1,226 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "base/container/double_array_trie.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/random/random.h"
+#include "absl/strings/string_view.h"
+#include "base/container/trie.h"
+#include "testing/gmock.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+DoubleArrayTrie<std::string> BuildTrie(
+    std::vector<std::pair<std::string, std::string>> entries) {
+  return DoubleArrayTrie<std::string>(std::move(entries));
+}
+
+TEST(DoubleArrayTrieTest, LookUp) {
+  const DoubleArrayTrie<std::string> trie = BuildTrie({
+      {"abc", "data_abc"},
+      {"abd", "data_abd"},
+      {"abcd", "data_abcd"},
+      {"abc", "data_abc2"},
+      {"bcd", "data_bcd"},
+  });
+
+  std::string data;
+  EXPECT_TRUE(trie.LookUp("abc", &data));
+  EXPECT_EQ(data, "data_abc2");
+  EXPECT_TRUE(trie.LookUp("abd", &data));
+  EXPECT_EQ(data, "data_abd");
+  EXPECT_TRUE(trie.LookUp("abcd", &data));
+  EXPECT_EQ(data, "data_abcd");
+  EXPECT_TRUE(trie.LookUp("bcd", &data));
+  EXPECT_EQ(data, "data_bcd");
+  EXPECT_FALSE(trie.LookUp("ab", &data));
+  EXPECT_FALSE(trie.LookUp("xyz", &data));
+  EXPECT_FALSE(trie.LookUp("abcde", &data));
+  EXPECT_FALSE(trie.LookUp("", &data));
+}
+
+TEST(DoubleArrayTrieTest, LookUpPrefix) {
+  const DoubleArrayTrie<std::string> trie = BuildTrie({
+      {"abc", "[ABC]"},
+      {"abd", "[ABD]"},
+      {"a", "[A]"},
+  });
+
+  std::string value;
+  size_t key_length = 0;
+  bool fixed = false;
+  EXPECT_TRUE(trie.LookUpPrefix("abc", &value, &key_length, &fixed));
+  EXPECT_EQ(value, "[ABC]");
+  EXPECT_EQ(key_length, 3);
+  EXPECT_TRUE(fixed);
+
+  EXPECT_TRUE(trie.LookUpPrefix("abcd", &value, &key_length, &fixed));
+  EXPECT_EQ(value, "[ABC]");
+  EXPECT_EQ(key_length, 3);
+
+  EXPECT_FALSE(trie.LookUpPrefix("abe", &value, &key_length, &fixed));
+  EXPECT_EQ(key_length, 2);
+  EXPECT_TRUE(fixed);
+
+  EXPECT_TRUE(trie.LookUpPrefix("ac", &value, &key_length, &fixed));
+  EXPECT_EQ(value, "[A]");
+  EXPECT_EQ(key_length, 1);
+  EXPECT_FALSE(fixed);
+
+  EXPECT_FALSE(trie.LookUpPrefix("xyz", &value, &key_length, &fixed));
+  EXPECT_EQ(key_length, 0);
+}
+
+TEST(DoubleArrayTrieTest, Empty) {
+  const DoubleArrayTrie<std::string> trie;
+  EXPECT_TRUE(trie.empty());
+
+  std::vector<std::string> values;
+  trie.LookUpPredictiveAll("a", &values);
+  EXPECT_THAT(values, IsEmpty());
+
+  std::string value;
+  size_t key_length = 0;
+  bool fixed = false;
+  EXPECT_FALSE(trie.LookUpPrefix("a", &value, &key_length, &fixed));
+  EXPECT_EQ(key_length, 0);
+  EXPECT_FALSE(trie.HasSubTrie("a"));
+}
+
+TEST(DoubleArrayTrieTest, LookUpPredictiveAll) {
+  const DoubleArrayTrie<std::string> trie = BuildTrie({
+      {"abc", "[ABC]"},
+      {"abd", "[ABD]"},
+      {"a", "[A]"},
+      {"きゃ", "[KYA]"},
+  });
+
+  std::vector<std::string> values;
+  trie.LookUpPredictiveAll("a", &values);
+  EXPECT_THAT(values, ElementsAre("[A]", "[ABC]", "[ABD]"));
+
+  values.clear();
+  trie.LookUpPredictiveAll("ab", &values);
+  EXPECT_THAT(values, ElementsAre("[ABC]", "[ABD]"));
+
+  values.clear();
+  trie.LookUpPredictiveAll("き", &values);
+  EXPECT_THAT(values, ElementsAre("[KYA]"));
+
+  values.clear();
+  trie.LookUpPredictiveAll("", &values);
+  EXPECT_THAT(values, UnorderedElementsAre("[A]", "[ABC]", "[ABD]", "[KYA]"));
+
+  values.clear();
+  trie.LookUpPredictiveAll("b", &values);
+  EXPECT_THAT(values, IsEmpty());
+}
+
+TEST(DoubleArrayTrieTest, HasSubTrie) {
+  const DoubleArrayTrie<std::string> trie = BuildTrie({
+      {"abc", "[ABC]"},
+      {"きゃ", "[KYA]"},
+  });
+  EXPECT_TRUE(trie.HasSubTrie("a"));
+  EXPECT_TRUE(trie.HasSubTrie("ab"));
+  EXPECT_TRUE(trie.HasSubTrie("abc"));
+  EXPECT_TRUE(trie.HasSubTrie("き"));
+  EXPECT_FALSE(trie.HasSubTrie(""));
+  EXPECT_FALSE(trie.HasSubTrie("abcd"));
+  EXPECT_FALSE(trie.HasSubTrie("b"));
+  // The first byte of "き" is not a character.
+  EXPECT_FALSE(trie.HasSubTrie(absl::string_view("き", 1)));
+}
+
+// Checks that DoubleArrayTrie returns the same results as Trie for random
+// keys, including multibyte characters and invalid UTF-8 sequences.
+TEST(DoubleArrayTrieTest, SameAsTrie) {
+  constexpr absl::string_view kChars[] = {
+      "a", "b", "k", "n", "あ", "か", "ん", "\xEF\xBF\xBF", "\xFF", "\x80",
+  };
+  absl::BitGen gen;
+  auto random_key = [&](size_t max_length) {
+    std::string key;
+    const size_t length = absl::Uniform<size_t>(gen, 0, max_length + 1);
+    for (size_t i = 0; i < length; ++i) {
+      key.append(kChars[absl::Uniform<size_t>(gen, 0, std::size(kChars))]);
+    }
+    return key;
+  };
+
+  Trie<int> trie;
+  std::vector<std::pair<std::string, int>> entries;
+  for (int i = 0; i < 300; ++i) {
+    std::string key = random_key(4);
+    trie.AddEntry(key, i);
+    entries.emplace_back(std::move(key), i);
+  }
+  const DoubleArrayTrie<int> double_array(std::move(entries));
+
+  for (int i = 0; i < 1000; ++i) {
+    const std::string key = random_key(5);
+    SCOPED_TRACE(key);
+
+    int expected = -1, actual = -1;
+    EXPECT_EQ(double_array.LookUp(key, &actual), trie.LookUp(key, &expected));
+    EXPECT_EQ(actual, expected);
+
+    size_t expected_length = 0, actual_length = 0;
+    bool expected_fixed = false, actual_fixed = false;
+    expected = actual = -1;
+    EXPECT_EQ(
+        double_array.LookUpPrefix(key, &actual, &actual_length, &actual_fixed),
+        trie.LookUpPrefix(key, &expected, &expected_length, &expected_fixed));
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(actual_length, expected_length);
+    EXPECT_EQ(actual_fixed, expected_fixed);
+
+    std::vector<int> expected_values, actual_values;
+    trie.LookUpPredictiveAll(key, &expected_values);
+    double_array.LookUpPredictiveAll(key, &actual_values);
+    EXPECT_THAT(actual_values, UnorderedElementsAreArray(expected_values));
+
+    EXPECT_EQ(double_array.HasSubTrie(key), trie.HasSubTrie(key));
+  }
+}
+
+}  // namespace
+}  // namespace mozc
@@ -107,6 +107,10 @@ class FlatConcurrentCache {
     }
   }
 
+  // Returns the bytes allocated for the buckets. The memory owned by the keys
+  // and the values themselves, e.g. the contents of strings, is not included.
+  size_t GetMemoryUsage() const { return num_buckets_ * sizeof(Bucket); }
+
   template <typename Functor>
   void ForEach(const Functor& functor) const {
     for (size_t i = 0; i < num_buckets_; ++i) {
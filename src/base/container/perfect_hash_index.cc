@@ -0,0 +1,242 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/container/perfect_hash_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "base/bits.h"
+#include "base/file_util.h"
+
+namespace mozc {
+namespace {
+
+static_assert(std::endian::native == std::endian::little,
+              "Little endian is assumed");
+
+constexpr size_t kHeaderSize = 3;  // In uint32_t.
+
+// The average number of keys per bucket.  Larger buckets make the index
+// smaller but the construction slower.
+constexpr uint32_t kKeysPerBucket = 4;
+
+// Limits of the search.  The construction with a new seed is tried when no
+// displacement is found for a bucket.
+constexpr uint32_t kMaxSeed = 256;
+constexpr uint32_t kMinMaxDisplacement = 1 << 16;
+
+struct Group {
+  absl::string_view key;
+  uint32_t begin;
+  uint32_t end;
+};
+
+// Tries to find the displacement of every bucket for |seed|.  On success,
+// fills |displacements| and |slot_to_group| and returns true.
+bool TryBuild(absl::Span<const Group> groups, const uint32_t num_buckets,
+              const uint32_t seed, std::vector<uint32_t> *displacements,
+              std::vector<uint32_t> *slot_to_group) {
+  const uint32_t num_keys = groups.size();
+  std::vector<uint32_t> hashes(num_keys);
+  std::vector<std::vector<uint32_t>> buckets(num_buckets);
+  for (uint32_t i = 0; i < num_keys; ++i) {
+    const uint64_t h = PerfectHashIndex::Hash(groups[i].key, seed);
+    hashes[i] = static_cast<uint32_t>(h);
+    buckets[static_cast<uint32_t>(h >> 32) % num_buckets].push_back(i);
+  }
+
+  // Place larger buckets first as they are harder to place.
+  std::vector<uint32_t> order(num_buckets);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  constexpr uint32_t kEmpty = UINT32_MAX;
+  displacements->assign(num_buckets, 0);
+  slot_to_group->assign(num_keys, kEmpty);
+  const uint32_t max_displacement =
+      std::max(kMinMaxDisplacement, 64 * num_keys);
+  std::vector<uint32_t> slots;
+  for (const uint32_t b : order) {
+    const std::vector<uint32_t> &bucket = buckets[b];
+    if (bucket.empty()) {
+      break;
+    }
+    bool placed = false;
+    for (uint32_t d = 0; d < max_displacement && !placed; ++d) {
+      slots.clear();
+      for (const uint32_t i : bucket) {
+        const uint32_t slot =
+            PerfectHashIndex::Mix32(hashes[i] ^ d) % num_keys;
+        if ((*slot_to_group)[slot] != kEmpty ||
+            absl::c_linear_search(slots, slot)) {
+          break;
+        }
+        slots.push_back(slot);
+      }
+      if (slots.size() == bucket.size()) {
+        for (size_t j = 0; j < bucket.size(); ++j) {
+          (*slot_to_group)[slots[j]] = bucket[j];
+        }
+        (*displacements)[b] = d;
+        placed = true;
+      }
+    }
+    if (!placed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool PerfectHashIndex::Init(absl::string_view data_aligned_at_4byte_boundary,
+                            const uint32_t num_entries) {
+  clear();
+  if (!VerifyData(data_aligned_at_4byte_boundary)) {
+    return false;
+  }
+  const absl::Span<const uint32_t> array =
+      MakeAlignedConstSpan<uint32_t>(data_aligned_at_4byte_boundary);
+  if (array.empty()) {
+    return false;
+  }
+  const uint32_t num_keys = array[0];
+  const uint32_t num_buckets = array[1];
+  const absl::Span<const uint32_t> ranges =
+      array.subspan(kHeaderSize + num_buckets);
+  for (uint32_t i = 0; i < num_keys; ++i) {
+    const uint32_t begin = ranges[2 * i];
+    const uint32_t end = ranges[2 * i + 1];
+    if (begin >= end || end > num_entries) {
+      LOG(ERROR) << "Invalid range for slot " << i << ": [" << begin << ", "
+                 << end << "), num_entries = " << num_entries;
+      return false;
+    }
+  }
+  seed_ = array[2];
+  displacements_ = array.subspan(kHeaderSize, num_buckets);
+  ranges_ = ranges;
+  return true;
+}
+
+void PerfectHashIndex::clear() {
+  seed_ = 0;
+  displacements_ = {};
+  ranges_ = {};
+}
+
+bool PerfectHashIndex::VerifyData(absl::string_view data) {
+  if (data.size() < kHeaderSize * 4 || data.size() % 4 != 0) {
+    LOG(ERROR) << "Header is missing";
+    return false;
+  }
+  const uint32_t num_keys = LoadUnaligned<uint32_t>(data.data());
+  const uint32_t num_buckets = LoadUnaligned<uint32_t>(data.data() + 4);
+  if ((num_keys == 0) != (num_buckets == 0)) {
+    LOG(ERROR) << "Invalid number of buckets: " << num_buckets;
+    return false;
+  }
+  const uint64_t expected_size =
+      4 * (kHeaderSize + static_cast<uint64_t>(num_buckets) +
+           2 * static_cast<uint64_t>(num_keys));
+  if (data.size() != expected_size) {
+    LOG(ERROR) << "Invalid data size: " << data.size()
+               << ", expected = " << expected_size;
+    return false;
+  }
+  return true;
+}
+
+absl::string_view PerfectHashIndex::BuildToBuffer(
+    const absl::Span<const absl::string_view> keys,
+    std::unique_ptr<uint32_t[]> *buffer) {
+  // Group contiguous entries having the same key.
+  std::vector<Group> groups;
+  absl::flat_hash_set<absl::string_view> seen;
+  for (uint32_t i = 0; i < keys.size(); ++i) {
+    if (!groups.empty() && groups.back().key == keys[i]) {
+      groups.back().end = i + 1;
+      continue;
+    }
+    CHECK(seen.insert(keys[i]).second)
+        << "Entries of the same key must be contiguous: " << keys[i];
+    groups.push_back({keys[i], i, i + 1});
+  }
+
+  const uint32_t num_keys = groups.size();
+  const uint32_t num_buckets =
+      (num_keys + kKeysPerBucket - 1) / kKeysPerBucket;
+  std::vector<uint32_t> displacements, slot_to_group;
+  uint32_t seed = 0;
+  while (!TryBuild(groups, num_buckets, seed, &displacements,
+                   &slot_to_group)) {
+    ++seed;
+    CHECK_LT(seed, kMaxSeed) << "Failed to build a perfect hash index";
+  }
+
+  const size_t size = kHeaderSize + num_buckets + 2 * num_keys;
+  *buffer = std::make_unique<uint32_t[]>(size);
+  uint32_t *ptr = buffer->get();
+  *ptr++ = num_keys;
+  *ptr++ = num_buckets;
+  *ptr++ = seed;
+  ptr = std::copy(displacements.begin(), displacements.end(), ptr);
+  for (const uint32_t g : slot_to_group) {
+    *ptr++ = groups[g].begin;
+    *ptr++ = groups[g].end;
+  }
+  return absl::string_view(reinterpret_cast<const char *>(buffer->get()),
+                           size * 4);
+}
+
+void PerfectHashIndex::BuildToFile(
+    const absl::Span<const absl::string_view> keys,
+    const std::string &filepath) {
+  std::unique_ptr<uint32_t[]> buffer;
+  const absl::string_view data = BuildToBuffer(keys, &buffer);
+  CHECK_OK(FileUtil::SetContents(filepath, data));
+}
+
+}  // namespace mozc
@@ -0,0 +1,167 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_BASE_CONTAINER_PERFECT_HASH_INDEX_H_
+#define MOZC_BASE_CONTAINER_PERFECT_HASH_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace mozc {
+
+// Minimal perfect hash index over a sorted array of keyed entries, such as the
+// token arrays of SerializedDictionary, EmojiRewriter and ZeroQueryDict.  The
+// index is generated at build time and stored as a separate section next to
+// the array.  At runtime, it maps a key to the range [begin, end) of entries
+// having that key with one hash computation and two memory reads, instead of
+// about log2(N) string comparisons of std::equal_range().
+//
+// Since a perfect hash function maps any string to some slot, a lookup always
+// verifies the key of the found entry, so keys not in the array are rejected.
+//
+// * Prerequisite
+// Little endian is assumed.  Entries having the same key must be contiguous in
+// the indexed array, which holds for any array sorted by key.
+//
+// * Serialized data creation
+// Use PerfectHashIndex::BuildToBuffer(), PerfectHashIndex::BuildToFile() or
+// build_tools/perfect_hash_index_builder.py.  Both builders use the same hash
+// function, so either output can be read by this class.
+//
+// * Binary format
+// The index is an array of uint32_t, where N is the number of distinct keys and
+// B is the number of buckets:
+//
+// +=====================================================================+
+// | Number of distinct keys N  (4 byte)                                 |
+// + - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - +
+// | Number of buckets B  (4 byte)                                       |
+// + - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - +
+// | Hash seed  (4 byte)                                                 |
+// +=====================================================================+
+// | Displacement of bucket[0 .. B - 1]  (4 * B byte)                    |
+// +=====================================================================+
+// | Begin and end entry index of slot[0 .. N - 1]  (8 * N byte)         |
+// +=====================================================================+
+//
+// A key is hashed to a 64-bit value h with Hash().  Its bucket is
+// (h >> 32) % B and its slot is Mix32(uint32_t(h) ^ displacement) % N.  The
+// builder chooses the displacement of each bucket so that no two keys share a
+// slot (the "hash and displace" construction).
+class PerfectHashIndex {
+ public:
+  using Range = std::pair<uint32_t, uint32_t>;
+
+  // Initializes the index from the given memory block, which must be aligned
+  // at 4 byte boundary.  |num_entries| is the size of the indexed array and
+  // is used to validate the ranges.  Returns false and leaves the index empty
+  // when the data is invalid.
+  bool Init(absl::string_view data_aligned_at_4byte_boundary,
+            uint32_t num_entries);
+
+  // Returns true if no index is loaded.  Callers should fall back to binary
+  // search in that case.
+  bool empty() const { return ranges_.empty(); }
+  void clear();
+
+  // Returns the range [begin, end) of entries whose key is |key|, or an empty
+  // range if |key| is not found.  |key_at| is a callable that takes an entry
+  // index and returns the key of the entry as absl::string_view.
+  template <typename KeyAt>
+  Range Find(absl::string_view key, KeyAt &&key_at) const {
+    if (ranges_.empty()) {
+      return Range(0, 0);
+    }
+    const uint64_t hash = Hash(key, seed_);
+    const uint32_t bucket =
+        static_cast<uint32_t>(hash >> 32) % displacements_.size();
+    const uint32_t slot =
+        Mix32(static_cast<uint32_t>(hash) ^ displacements_[bucket]) %
+        (ranges_.size() / 2);
+    const Range range(ranges_[2 * slot], ranges_[2 * slot + 1]);
+    if (key_at(range.first) != key) {
+      return Range(0, 0);
+    }
+    return range;
+  }
+
+  // Checks if the data has a valid header and size.  Ranges are validated by
+  // Init() as the size of the indexed array is required.
+  static bool VerifyData(absl::string_view data);
+
+  // Builds an index for |keys|, where keys[i] is the key of the i-th entry of
+  // the indexed array, into |buffer| and returns the memory block pointing to
+  // the image.
+  static absl::string_view BuildToBuffer(
+      absl::Span<const absl::string_view> keys,
+      std::unique_ptr<uint32_t[]> *buffer);
+  static void BuildToFile(absl::Span<const absl::string_view> keys,
+                          const std::string &filepath);
+
+  // Hash functions shared with build_tools/perfect_hash_index_builder.py.
+  // Hash() is 64-bit FNV-1a followed by the MurmurHash3 finalizer, and Mix32()
+  // is the 32-bit MurmurHash3 finalizer.
+  static constexpr uint64_t Hash(absl::string_view key, uint32_t seed) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (const char c : key) {
+      h ^= static_cast<uint8_t>(c);
+      h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static constexpr uint32_t Mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+  }
+
+ private:
+  uint32_t seed_ = 0;
+  absl::Span<const uint32_t> displacements_;
+  absl::Span<const uint32_t> ranges_;
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_BASE_CONTAINER_PERFECT_HASH_INDEX_H_
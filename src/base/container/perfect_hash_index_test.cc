@@ -0,0 +1,121 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/container/perfect_hash_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace {
+
+using Range = PerfectHashIndex::Range;
+
+TEST(PerfectHashIndexTest, DefaultConstructor) {
+  PerfectHashIndex index;
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(index.Find("a", [](uint32_t) { return "a"; }), Range(0, 0));
+}
+
+TEST(PerfectHashIndexTest, EmptyKeys) {
+  std::unique_ptr<uint32_t[]> buf;
+  const absl::string_view data = PerfectHashIndex::BuildToBuffer({}, &buf);
+  ASSERT_TRUE(PerfectHashIndex::VerifyData(data));
+  PerfectHashIndex index;
+  EXPECT_TRUE(index.Init(data, 0));
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(PerfectHashIndexTest, Find) {
+  const std::vector<absl::string_view> keys = {
+      "", "あ", "あ", "い", "う", "う", "う", "えもじ", "google",
+  };
+  std::unique_ptr<uint32_t[]> buf;
+  const absl::string_view data = PerfectHashIndex::BuildToBuffer(keys, &buf);
+  ASSERT_TRUE(PerfectHashIndex::VerifyData(data));
+
+  PerfectHashIndex index;
+  ASSERT_TRUE(index.Init(data, keys.size()));
+  EXPECT_FALSE(index.empty());
+  auto key_at = [&](uint32_t i) { return keys[i]; };
+  EXPECT_EQ(index.Find("", key_at), Range(0, 1));
+  EXPECT_EQ(index.Find("あ", key_at), Range(1, 3));
+  EXPECT_EQ(index.Find("い", key_at), Range(3, 4));
+  EXPECT_EQ(index.Find("う", key_at), Range(4, 7));
+  EXPECT_EQ(index.Find("えもじ", key_at), Range(7, 8));
+  EXPECT_EQ(index.Find("google", key_at), Range(8, 9));
+
+  // Keys not in the array are rejected.
+  for (absl::string_view key : {"え", "ああ", "mozc", "googl"}) {
+    const Range range = index.Find(key, key_at);
+    EXPECT_EQ(range.first, range.second) << key;
+  }
+}
+
+TEST(PerfectHashIndexTest, ManyKeys) {
+  std::vector<std::string> strings;
+  for (int i = 0; i < 10000; ++i) {
+    strings.push_back(absl::StrCat("key", i));
+  }
+  const std::vector<absl::string_view> keys(strings.begin(), strings.end());
+  std::unique_ptr<uint32_t[]> buf;
+  const absl::string_view data = PerfectHashIndex::BuildToBuffer(keys, &buf);
+
+  PerfectHashIndex index;
+  ASSERT_TRUE(index.Init(data, keys.size()));
+  auto key_at = [&](uint32_t i) { return keys[i]; };
+  for (uint32_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(index.Find(keys[i], key_at), Range(i, i + 1));
+  }
+  EXPECT_EQ(index.Find("key10000", key_at), Range(0, 0));
+}
+
+TEST(PerfectHashIndexTest, InvalidData) {
+  const std::vector<absl::string_view> keys = {"a", "b", "c"};
+  std::unique_ptr<uint32_t[]> buf;
+  const absl::string_view data = PerfectHashIndex::BuildToBuffer(keys, &buf);
+
+  PerfectHashIndex index;
+  // Truncated.
+  EXPECT_FALSE(PerfectHashIndex::VerifyData(data.substr(0, 8)));
+  EXPECT_FALSE(index.Init(data.substr(0, data.size() - 4), keys.size()));
+  // Ranges exceed the size of the indexed array.
+  EXPECT_FALSE(index.Init(data, keys.size() - 1));
+  EXPECT_TRUE(index.empty());
+}
+
+}  // namespace
+}  // namespace mozc
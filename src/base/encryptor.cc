@@ -256,6 +256,101 @@ bool Encryptor::DecryptArray(const Encryptor::Key& key, char* buf,
   return true;
 }
 
+Encryptor::EncryptionStream::EncryptionStream(const Encryptor::Key& key)
+    : cbc_(key.key_, key.iv_) {
+  DCHECK(key.IsAvailable());
+}
+
+void Encryptor::EncryptionStream::Update(const absl::string_view input,
+                                         std::string* output) {
+  DCHECK(output);
+  const size_t total_size = pending_.size() + input.size();
+  const size_t size = total_size - total_size % kBlockSize;
+  if (size == 0) {
+    pending_.append(input);
+    return;
+  }
+  // |pending_| is always shorter than a block, so it is consumed here.
+  const size_t offset = output->size();
+  const size_t consumed = size - pending_.size();
+  output->append(pending_);
+  output->append(input.substr(0, consumed));
+  cbc_.Transform(reinterpret_cast<uint8_t*>(output->data() + offset),
+                 size / kBlockSize);
+  pending_.assign(input.substr(consumed));
+}
+
+void Encryptor::EncryptionStream::Finish(std::string* output) {
+  DCHECK(output);
+  DCHECK_LT(pending_.size(), kBlockSize);
+  // perform PKCS#5 padding
+  const size_t padding_size = kBlockSize - pending_.size();
+  pending_.append(padding_size, static_cast<char>(padding_size));
+  const size_t offset = output->size();
+  output->append(pending_);
+  cbc_.Transform(reinterpret_cast<uint8_t*>(output->data() + offset), 1);
+  pending_.clear();
+}
+
+Encryptor::DecryptionStream::DecryptionStream(const Encryptor::Key& key)
+    : cbc_(key.key_, key.iv_) {
+  DCHECK(key.IsAvailable());
+}
+
+void Encryptor::DecryptionStream::Update(const absl::string_view input,
+                                         std::string* output) {
+  DCHECK(output);
+  const size_t total_size = pending_.size() + input.size();
+  // Holds back the last complete block, which contains the padding.
+  const size_t rest = total_size % kBlockSize == 0
+                          ? std::min(kBlockSize, total_size)
+                          : total_size % kBlockSize;
+  const size_t size = total_size - rest;
+  if (size == 0) {
+    pending_.append(input);
+    return;
+  }
+  const size_t offset = output->size();
+  const size_t consumed = size - pending_.size();
+  output->append(pending_);
+  output->append(input.substr(0, consumed));
+  cbc_.InverseTransform(reinterpret_cast<uint8_t*>(output->data() + offset),
+                        size / kBlockSize);
+  pending_.assign(input.substr(consumed));
+  decrypted_size_ += size;
+}
+
+bool Encryptor::DecryptionStream::Finish(std::string* output) {
+  DCHECK(output);
+  if (pending_.size() != kBlockSize) {
+    LOG(ERROR) << "data size is not multiples of " << kBlockSize;
+    return false;
+  }
+  uint8_t* block = reinterpret_cast<uint8_t*>(pending_.data());
+  cbc_.InverseTransform(block, 1);
+
+  // perform PKCS#5 un-padding
+  const uint8_t padding_value = block[kBlockSize - 1];
+  const size_t padding_size = static_cast<size_t>(padding_value);
+  if (padding_value == 0x00 || padding_value > kBlockSize) {
+    LOG(ERROR) << "Cannot find PKCS#5 padding values: ";
+    return false;
+  }
+  if (decrypted_size_ + kBlockSize <= padding_size) {
+    LOG(ERROR) << "padding size is no smaller than original message";
+    return false;
+  }
+  for (size_t i = kBlockSize - padding_size; i < kBlockSize; ++i) {
+    if (block[i] != padding_value) {
+      LOG(ERROR) << "invalid padding value. message is broken";
+      return false;
+    }
+  }
+  output->append(pending_, 0, kBlockSize - padding_size);
+  pending_.clear();
+  return true;
+}
+
 // Protect|Unprotect Data
 #ifdef _WIN32
 // See. http://msdn.microsoft.com/en-us/library/aa380261.aspx
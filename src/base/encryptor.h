@@ -35,6 +35,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "base/unverified_aes256.h"
 
 namespace mozc {
 
@@ -43,6 +44,9 @@ class Encryptor {
   static constexpr size_t kBlockSize = 16;  // 128 bit
   static constexpr size_t kKeySize = 32;    // 256 bit key length
 
+  class EncryptionStream;
+  class DecryptionStream;
+
   // Internal class for representing a key
   class Key {
    public:
@@ -87,6 +91,8 @@ class Encryptor {
 
    private:
     friend class Encryptor;  // TODO(yuryu): access via accessors
+    friend class Encryptor::EncryptionStream;
+    friend class Encryptor::DecryptionStream;
 
     uint8_t key_[kKeySize] = {};
     uint8_t iv_[kBlockSize] = {};
@@ -114,6 +120,49 @@ class Encryptor {
   // Encrypt string with key.
   static bool DecryptString(const Key& key, std::string* data);
 
+  // Encrypts data given in chunks, so that neither the whole plain text nor the
+  // whole cipher text has to be in memory at once. The concatenation of the
+  // outputs is the same as EncryptString() of the concatenated inputs.
+  class EncryptionStream {
+   public:
+    explicit EncryptionStream(const Key& key);
+    EncryptionStream(const EncryptionStream&) = delete;
+    EncryptionStream& operator=(const EncryptionStream&) = delete;
+
+    // Appends the encrypted blocks of |input| to |output|. The trailing bytes
+    // not filling a block are kept until the next call.
+    void Update(absl::string_view input, std::string* output);
+
+    // Appends the last block with the PKCS#5 padding to |output|.
+    void Finish(std::string* output);
+
+   private:
+    internal::UnverifiedAES256::CBC cbc_;
+    std::string pending_;
+  };
+
+  // Decrypts data given in chunks. The concatenation of the outputs is the
+  // same as DecryptString() of the concatenated inputs.
+  class DecryptionStream {
+   public:
+    explicit DecryptionStream(const Key& key);
+    DecryptionStream(const DecryptionStream&) = delete;
+    DecryptionStream& operator=(const DecryptionStream&) = delete;
+
+    // Appends the decrypted blocks of |input| to |output|. The last block is
+    // kept until Finish() as it contains the padding.
+    void Update(absl::string_view input, std::string* output);
+
+    // Appends the last block without the padding to |output|. Returns false
+    // if the data is not a valid cipher text.
+    bool Finish(std::string* output);
+
+   private:
+    internal::UnverifiedAES256::CBC cbc_;
+    std::string pending_;
+    size_t decrypted_size_ = 0;
+  };
+
   // Encrypt string to protect plain_text which may contain
   // sensitive data, like auth_token, password ..etc.
   // It uses CryptProtectData API to encrypt data on Windows.
@@ -34,6 +34,7 @@
 #include <iterator>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "base/random.h"
 #include "testing/gunit.h"
 #include "testing/mozctest.h"
@@ -223,6 +224,71 @@ TEST_F(EncryptorTest, EncryptBatch) {
   }
 }
 
+TEST_F(EncryptorTest, Stream) {
+  constexpr size_t kSizeTable[] = {1, 15, 16, 17, 32, 100, 1000, 10000};
+  constexpr size_t kChunkSizeTable[] = {1, 7, 16, 33, 4096};
+
+  Encryptor::Key key;
+  EXPECT_TRUE(key.DeriveFromPassword("test", "salt"));
+
+  Random random;
+  for (const size_t size : kSizeTable) {
+    const std::string original = random.ByteString(size);
+    std::string expected = original;
+    EXPECT_TRUE(Encryptor::EncryptString(key, &expected));
+
+    for (const size_t chunk_size : kChunkSizeTable) {
+      Encryptor::EncryptionStream encryption(key);
+      std::string encrypted;
+      for (size_t i = 0; i < original.size(); i += chunk_size) {
+        encryption.Update(absl::string_view(original).substr(i, chunk_size),
+                          &encrypted);
+      }
+      encryption.Finish(&encrypted);
+      EXPECT_EQ(encrypted, expected);
+
+      Encryptor::DecryptionStream decryption(key);
+      std::string decrypted;
+      for (size_t i = 0; i < encrypted.size(); i += chunk_size) {
+        decryption.Update(absl::string_view(encrypted).substr(i, chunk_size),
+                          &decrypted);
+      }
+      EXPECT_TRUE(decryption.Finish(&decrypted));
+      EXPECT_EQ(decrypted, original);
+    }
+  }
+}
+
+TEST_F(EncryptorTest, StreamWithBrokenData) {
+  Encryptor::Key key1, key2;
+  EXPECT_TRUE(key1.DeriveFromPassword("test", "salt"));
+  EXPECT_TRUE(key2.DeriveFromPassword("test2", "salt"));
+
+  std::string encrypted = "foo";
+  EXPECT_TRUE(Encryptor::EncryptString(key1, &encrypted));
+
+  {
+    // wrong key
+    Encryptor::DecryptionStream decryption(key2);
+    std::string decrypted;
+    decryption.Update(encrypted, &decrypted);
+    EXPECT_FALSE(decryption.Finish(&decrypted));
+  }
+  {
+    // truncated data
+    Encryptor::DecryptionStream decryption(key1);
+    std::string decrypted;
+    decryption.Update(absl::string_view(encrypted).substr(1), &decrypted);
+    EXPECT_FALSE(decryption.Finish(&decrypted));
+  }
+  {
+    // empty data
+    Encryptor::DecryptionStream decryption(key1);
+    std::string decrypted;
+    EXPECT_FALSE(decryption.Finish(&decrypted));
+  }
+}
+
 TEST_F(EncryptorTest, ProtectData) {
   constexpr size_t kSizeTable[] = {1, 10, 100, 1000, 10000, 100000};
 
@@ -0,0 +1,67 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "base/memory_usage.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "base/mmap.h"
+
+namespace mozc {
+
+void MemoryUsageCollector::AddHeap(const absl::string_view name,
+                                   const size_t bytes) {
+  MemoryUsage& usage = usages_.emplace_back();
+  usage.name = std::string(name);
+  usage.heap_bytes = bytes;
+}
+
+void MemoryUsageCollector::AddMapped(const absl::string_view name,
+                                     const absl::string_view region) {
+  MemoryUsage& usage = usages_.emplace_back();
+  usage.name = std::string(name);
+  usage.mapped_bytes = region.size();
+  absl::StatusOr<std::vector<std::pair<size_t, size_t>>> ranges =
+      Mmap::GetResidentRanges(region.data(), region.size());
+  if (!ranges.ok()) {
+    return;
+  }
+  size_t resident_bytes = 0;
+  for (const auto& [offset, size] : *ranges) {
+    resident_bytes += size;
+  }
+  usage.resident_bytes = resident_bytes;
+}
+
+}  // namespace mozc
@@ -0,0 +1,91 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_BASE_MEMORY_USAGE_H_
+#define MOZC_BASE_MEMORY_USAGE_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace mozc {
+
+// The memory footprint of a component.
+struct MemoryUsage {
+  // Dot-separated name of the component, e.g. "dictionary.user.tokens".
+  std::string name;
+  // Bytes allocated on the heap. This is an estimate from the sizes and
+  // capacities of the containers, not a measurement of the allocator.
+  size_t heap_bytes = 0;
+  // Bytes of memory-mapped data, and how many of them are resident in
+  // physical memory. `resident_bytes` is not set if the platform doesn't
+  // support the measurement.
+  size_t mapped_bytes = 0;
+  std::optional<size_t> resident_bytes;
+};
+
+// Collects the memory usage reported by the components. Each component
+// reports its own footprint in CollectMemoryUsage() and forwards the collector
+// to the components it owns.
+class MemoryUsageCollector {
+ public:
+  MemoryUsageCollector() = default;
+  MemoryUsageCollector(const MemoryUsageCollector&) = delete;
+  MemoryUsageCollector& operator=(const MemoryUsageCollector&) = delete;
+
+  void AddHeap(absl::string_view name, size_t bytes);
+
+  // Adds the memory-mapped `region` and measures its resident bytes.
+  void AddMapped(absl::string_view name, absl::string_view region);
+
+  absl::Span<const MemoryUsage> usages() const { return usages_; }
+
+ private:
+  std::vector<MemoryUsage> usages_;
+};
+
+// Helpers to estimate the heap bytes of standard containers. The memory owned
+// by the elements themselves is not included.
+template <typename T>
+size_t GetHeapBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+inline size_t GetHeapBytes(const std::string& s) {
+  // Short strings are stored in the object itself.
+  return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+}
+
+}  // namespace mozc
+
+#endif  // MOZC_BASE_MEMORY_USAGE_H_
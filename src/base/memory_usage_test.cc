@@ -0,0 +1,82 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "base/memory_usage.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace {
+
+TEST(MemoryUsageTest, AddHeap) {
+  MemoryUsageCollector collector;
+  collector.AddHeap("foo", 100);
+  collector.AddHeap("bar.baz", 0);
+
+  ASSERT_EQ(collector.usages().size(), 2);
+  EXPECT_EQ(collector.usages()[0].name, "foo");
+  EXPECT_EQ(collector.usages()[0].heap_bytes, 100);
+  EXPECT_EQ(collector.usages()[0].mapped_bytes, 0);
+  EXPECT_EQ(collector.usages()[1].name, "bar.baz");
+}
+
+TEST(MemoryUsageTest, AddMapped) {
+  // Touch the data so that it is resident.
+  const std::string data(1 << 16, 'x');
+  MemoryUsageCollector collector;
+  collector.AddMapped("data", data);
+
+  ASSERT_EQ(collector.usages().size(), 1);
+  const MemoryUsage& usage = collector.usages()[0];
+  EXPECT_EQ(usage.name, "data");
+  EXPECT_EQ(usage.heap_bytes, 0);
+  EXPECT_EQ(usage.mapped_bytes, data.size());
+#ifdef __linux__
+  ASSERT_TRUE(usage.resident_bytes.has_value());
+  EXPECT_EQ(*usage.resident_bytes, data.size());
+#endif  // __linux__
+}
+
+TEST(MemoryUsageTest, GetHeapBytes) {
+  std::vector<int> v;
+  EXPECT_EQ(GetHeapBytes(v), 0);
+  v.reserve(10);
+  EXPECT_EQ(GetHeapBytes(v), v.capacity() * sizeof(int));
+
+  EXPECT_EQ(GetHeapBytes(std::string("short")), 0);
+  const std::string long_string(100, 'x');
+  EXPECT_GE(GetHeapBytes(long_string), 101);
+}
+
+}  // namespace
+}  // namespace mozc
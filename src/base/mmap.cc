@@ -29,9 +29,12 @@
 
 #include "base/mmap.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -391,4 +394,81 @@ int Mmap::MaybeMUnlock(const void* addr, size_t len) { return -1; }
 
 #undef MOZC_HAVE_MLOCK
 
+int Mmap::MaybePrefetch(const void* addr, size_t len) {
+  if (len == 0) {
+    return 0;
+  }
+#if defined(_WIN32)
+  WIN32_MEMORY_RANGE_ENTRY range = {const_cast<void*>(addr), len};
+  return ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0) ? 0 : -1;
+#elif defined(__wasm__)
+  return -1;
+#else   // _WIN32
+  absl::StatusOr<size_t> page_size = GetPageSize();
+  if (!page_size.ok()) {
+    return -1;
+  }
+  // madvise() requires a page-aligned address.
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+  const uintptr_t aligned_begin = begin - begin % *page_size;
+  return madvise(reinterpret_cast<void*>(aligned_begin),
+                 begin + len - aligned_begin, MADV_WILLNEED);
+#endif  // _WIN32
+}
+
+absl::StatusOr<std::vector<std::pair<size_t, size_t>>> Mmap::GetResidentRanges(
+    const void* addr, size_t len) {
+  std::vector<std::pair<size_t, size_t>> ranges;
+  if (len == 0) {
+    return ranges;
+  }
+#if defined(__linux__)
+  absl::StatusOr<size_t> page_size = GetPageSize();
+  if (!page_size.ok()) {
+    return page_size.status();
+  }
+  // Each page has a 64-bit entry in /proc/self/pagemap, whose bit 63 is set if
+  // the page is present in memory. See the kernel's pagemap.rst.
+  constexpr uint64_t kPresentBit = uint64_t{1} << 63;
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+  const uintptr_t end = begin + len;
+  const uintptr_t first_page = begin / *page_size;
+  const uintptr_t num_pages = (end - 1) / *page_size - first_page + 1;
+
+  const int fd = open("/proc/self/pagemap", O_RDONLY);
+  if (fd == -1) {
+    return absl::ErrnoToStatus(errno, "open(/proc/self/pagemap) failed");
+  }
+  std::vector<uint64_t> entries(num_pages);
+  const size_t bytes = num_pages * sizeof(uint64_t);
+  const ssize_t read_bytes =
+      pread(fd, entries.data(), bytes, first_page * sizeof(uint64_t));
+  const int read_errno = errno;
+  close(fd);
+  if (read_bytes != static_cast<ssize_t>(bytes)) {
+    return absl::ErrnoToStatus(read_errno, "pread(/proc/self/pagemap) failed");
+  }
+
+  for (uintptr_t i = 0; i < num_pages; ++i) {
+    if ((entries[i] & kPresentBit) == 0) {
+      continue;
+    }
+    const uintptr_t page_begin =
+        std::max<uintptr_t>((first_page + i) * *page_size, begin);
+    const uintptr_t page_end =
+        std::min<uintptr_t>((first_page + i + 1) * *page_size, end);
+    if (!ranges.empty() &&
+        ranges.back().first + ranges.back().second == page_begin - begin) {
+      ranges.back().second += page_end - page_begin;
+    } else {
+      ranges.emplace_back(page_begin - begin, page_end - page_begin);
+    }
+  }
+  return ranges;
+#else   // __linux__
+  return absl::UnimplementedError(
+      "GetResidentRanges is not supported on this platform");
+#endif  // __linux__
+}
+
 }  // namespace mozc
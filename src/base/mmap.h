@@ -32,6 +32,8 @@
 
 #include <cstddef>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -87,6 +89,19 @@ class Mmap final {
   static int MaybeMLock(const void* addr, size_t len);
   static int MaybeMUnlock(const void* addr, size_t len);
 
+  // Asks the OS to read the pages of [addr, addr + len) ahead asynchronously,
+  // e.g., by madvise(MADV_WILLNEED). Unlike MaybeMLock(), the pages can still
+  // be paged out later. `addr` doesn't need to be page-aligned. Returns 0 on
+  // success, and -1 on failure or if the platform doesn't support it.
+  static int MaybePrefetch(const void* addr, size_t len);
+
+  // Returns the byte ranges of [addr, addr + len) that are mapped to physical
+  // memory in the current process, e.g., that have been accessed since mapped.
+  // Each range is {offset from `addr`, size}, clipped to [addr, addr + len) and
+  // page granular otherwise. Supported only on Linux and Android.
+  static absl::StatusOr<std::vector<std::pair<size_t, size_t>>>
+  GetResidentRanges(const void* addr, size_t len);
+
   constexpr char& operator[](size_t i) { return data_[i]; }
   constexpr char operator[](size_t i) const { return data_[i]; }
   constexpr char* begin() { return data_.begin(); }
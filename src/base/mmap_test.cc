@@ -148,6 +148,63 @@ TEST(MmapTest, MaybeMLockTest) {
   }
 }
 
+TEST(MmapTest, MaybePrefetch) {
+  const absl::StatusOr<TempFile> temp_file =
+      TempDirectory::Default().CreateTempFile();
+  ASSERT_OK(temp_file);
+  const std::vector<char> contents = GetRandomContents(3 * 4096 + 100);
+  ASSERT_OK(FileUtil::SetContents(
+      temp_file->path(), absl::string_view(contents.data(), contents.size())));
+  absl::StatusOr<Mmap> mmap = Mmap::Map(temp_file->path());
+  ASSERT_OK(mmap);
+
+  EXPECT_EQ(Mmap::MaybePrefetch(mmap->data(), 0), 0);
+#if defined(__linux__) || defined(__APPLE__)
+  // The address doesn't need to be aligned.
+  EXPECT_EQ(Mmap::MaybePrefetch(mmap->data() + 10, 5000), 0);
+#endif  // __linux__ || __APPLE__
+}
+
+TEST(MmapTest, GetResidentRanges) {
+  const absl::StatusOr<TempFile> temp_file =
+      TempDirectory::Default().CreateTempFile();
+  ASSERT_OK(temp_file);
+  const std::vector<char> contents = GetRandomContents(64 * 4096);
+  ASSERT_OK(FileUtil::SetContents(
+      temp_file->path(), absl::string_view(contents.data(), contents.size())));
+  absl::StatusOr<Mmap> mmap = Mmap::Map(temp_file->path());
+  ASSERT_OK(mmap);
+
+  // Touch a byte in the middle.
+  constexpr size_t kOffset = 40 * 4096 + 123;
+  EXPECT_EQ((*mmap)[kOffset], contents[kOffset]);
+
+  absl::StatusOr<std::vector<std::pair<size_t, size_t>>> ranges =
+      Mmap::GetResidentRanges(mmap->data(), mmap->size());
+#if defined(__linux__)
+  ASSERT_OK(ranges);
+  // The kernel may map neighboring pages as well, but the touched byte must be
+  // covered, and the ranges must be sorted and within the region.
+  bool covered = false;
+  size_t prev_end = 0;
+  for (const auto& [offset, size] : *ranges) {
+    EXPECT_LE(prev_end, offset);
+    EXPECT_GT(size, 0);
+    EXPECT_LE(offset + size, mmap->size());
+    covered |= (offset <= kOffset && kOffset < offset + size);
+    prev_end = offset + size;
+  }
+  EXPECT_TRUE(covered);
+
+  // The ranges are clipped to the given region.
+  ranges = Mmap::GetResidentRanges(mmap->data() + kOffset, 1);
+  ASSERT_OK(ranges);
+  EXPECT_THAT(*ranges, ::testing::ElementsAre(std::pair<size_t, size_t>(0, 1)));
+#else   // __linux__
+  EXPECT_FALSE(ranges.ok());
+#endif  // __linux__
+}
+
 class MmapEntireFileTest : public ::testing::TestWithParam<size_t> {};
 
 TEST_P(MmapEntireFileTest, Read) {
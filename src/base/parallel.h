@@ -0,0 +1,173 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Deterministic data-parallel helpers for offline build tools.
+//
+// The work is split into contiguous chunks whose boundaries depend only on the
+// input size and the number of threads, and each chunk writes only to its own
+// slots. As a result, the callers get the same output regardless of the number
+// of threads or the scheduling, which is required for reproducible builds.
+
+#ifndef MOZC_BASE_PARALLEL_H_
+#define MOZC_BASE_PARALLEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "base/thread.h"
+
+namespace mozc {
+
+// Returns the number of threads to use. Non-positive `num_threads` means the
+// number of hardware threads.
+inline int GetNumParallelThreads(int num_threads) {
+  if (num_threads > 0) {
+    return num_threads;
+  }
+  // hardware_concurrency() returns 0 when it is not computable.
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+namespace parallel_internal {
+
+// Inputs smaller than this are not split, as spawning a thread costs more.
+inline constexpr size_t kDefaultMinChunkSize = 256;
+
+inline size_t GetNumChunks(size_t size, int num_threads,
+                           size_t min_chunk_size) {
+  const size_t max_chunks = std::max<size_t>(1, size / min_chunk_size);
+  return std::min<size_t>(
+      max_chunks, static_cast<size_t>(GetNumParallelThreads(num_threads)));
+}
+
+// Returns the beginning of the `i`-th chunk of `num_chunks` chunks.
+inline size_t GetChunkBegin(size_t size, size_t num_chunks, size_t i) {
+  return size / num_chunks * i + std::min(i, size % num_chunks);
+}
+
+template <class F>
+void RunChunks(size_t size, size_t num_chunks, F& f) {
+  if (num_chunks <= 1) {
+    if (size > 0) {
+      f(size_t{0}, size);
+    }
+    return;
+  }
+  std::vector<Thread> threads;
+  threads.reserve(num_chunks - 1);
+  for (size_t i = 1; i < num_chunks; ++i) {
+    threads.emplace_back(std::ref(f), GetChunkBegin(size, num_chunks, i),
+                         GetChunkBegin(size, num_chunks, i + 1));
+  }
+  f(size_t{0}, GetChunkBegin(size, num_chunks, 1));
+  for (Thread& thread : threads) {
+    thread.Join();
+  }
+}
+
+}  // namespace parallel_internal
+
+// Calls `f(begin, end)` for contiguous chunks covering [0, `size`) from at most
+// `num_threads` threads, and blocks until all of them finish. The first chunk
+// runs on the calling thread. `f` must be safe to call concurrently for
+// disjoint ranges.
+template <class F>
+void ParallelForChunks(
+    size_t size, int num_threads, F f,
+    size_t min_chunk_size = parallel_internal::kDefaultMinChunkSize) {
+  parallel_internal::RunChunks(
+      size,
+      parallel_internal::GetNumChunks(size, num_threads, min_chunk_size), f);
+}
+
+// Calls `f(i)` for each i in [0, `size`) from at most `num_threads` threads.
+template <class F>
+void ParallelFor(size_t size, int num_threads, F f) {
+  ParallelForChunks(size, num_threads, [&f](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      f(i);
+    }
+  });
+}
+
+// Equivalent to `std::stable_sort(first, last, comp)`. Since a stable sort has
+// the unique result, the output is identical to the serial one.
+template <class RandomIt, class Compare>
+void ParallelStableSort(RandomIt first, RandomIt last, Compare comp,
+                        int num_threads) {
+  const size_t size = std::distance(first, last);
+  const size_t num_chunks = parallel_internal::GetNumChunks(
+      size, num_threads, parallel_internal::kDefaultMinChunkSize);
+  auto sort_chunk = [&](size_t begin, size_t end) {
+    std::stable_sort(first + begin, first + end, comp);
+  };
+  parallel_internal::RunChunks(size, num_chunks, sort_chunk);
+
+  std::vector<std::pair<size_t, size_t>> runs;
+  runs.reserve(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    runs.emplace_back(
+        parallel_internal::GetChunkBegin(size, num_chunks, i),
+        parallel_internal::GetChunkBegin(size, num_chunks, i + 1));
+  }
+
+  // Merge adjacent runs pairwise. The left run always precedes the right one,
+  // so the merge keeps the stability.
+  while (runs.size() > 1) {
+    const size_t num_merges = runs.size() / 2;
+    auto merge = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        std::inplace_merge(first + runs[2 * i].first,
+                           first + runs[2 * i + 1].first,
+                           first + runs[2 * i + 1].second, comp);
+      }
+    };
+    parallel_internal::RunChunks(num_merges, num_merges, merge);
+
+    std::vector<std::pair<size_t, size_t>> merged;
+    merged.reserve(num_merges + 1);
+    for (size_t i = 0; i + 1 < runs.size(); i += 2) {
+      merged.emplace_back(runs[i].first, runs[i + 1].second);
+    }
+    if (runs.size() % 2 == 1) {
+      merged.push_back(runs.back());
+    }
+    runs = std::move(merged);
+  }
+}
+
+}  // namespace mozc
+
+#endif  // MOZC_BASE_PARALLEL_H_
@@ -0,0 +1,99 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace {
+
+TEST(ParallelTest, ParallelForVisitsEachIndexOnce) {
+  for (const size_t size : {0, 1, 255, 256, 1000, 10007}) {
+    for (const int num_threads : {0, 1, 3, 8}) {
+      std::vector<std::atomic<int>> visited(size);
+      ParallelFor(size, num_threads, [&](size_t i) { ++visited[i]; });
+      for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(visited[i], 1) << i;
+      }
+    }
+  }
+}
+
+TEST(ParallelTest, ParallelForChunksIsContiguous) {
+  std::vector<int> chunk_ids(1000, -1);
+  std::atomic<int> next_id = 0;
+  ParallelForChunks(
+      chunk_ids.size(), 4,
+      [&](size_t begin, size_t end) {
+        const int id = next_id++;
+        std::fill(chunk_ids.begin() + begin, chunk_ids.begin() + end, id);
+      },
+      1);
+  EXPECT_EQ(next_id, 4);
+  EXPECT_EQ(std::count(chunk_ids.begin(), chunk_ids.end(), -1), 0);
+  // Each chunk covers a contiguous range, so the id changes only 3 times.
+  int num_changes = 0;
+  for (size_t i = 1; i < chunk_ids.size(); ++i) {
+    if (chunk_ids[i] != chunk_ids[i - 1]) {
+      ++num_changes;
+    }
+  }
+  EXPECT_EQ(num_changes, 3);
+}
+
+TEST(ParallelTest, ParallelStableSortMatchesStableSort) {
+  // Sort by the first element only, so the second element checks stability.
+  std::vector<std::pair<int, int>> data;
+  for (int i = 0; i < 10000; ++i) {
+    data.emplace_back((i * 7919) % 97, i);
+  }
+  auto comp = [](const std::pair<int, int>& lhs,
+                 const std::pair<int, int>& rhs) {
+    return lhs.first < rhs.first;
+  };
+
+  std::vector<std::pair<int, int>> expected = data;
+  std::stable_sort(expected.begin(), expected.end(), comp);
+  for (const int num_threads : {1, 2, 3, 7, 16}) {
+    std::vector<std::pair<int, int>> actual = data;
+    ParallelStableSort(actual.begin(), actual.end(), comp, num_threads);
+    EXPECT_EQ(actual, expected) << num_threads;
+  }
+}
+
+}  // namespace
+}  // namespace mozc
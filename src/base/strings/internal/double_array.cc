@@ -35,7 +35,6 @@
 #include <utility>
 #include <vector>
 
-#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "base/strings/internal/utf8_internal.h"
 #include "base/strings/unicode.h"
@@ -90,8 +89,17 @@ inline int AdvanceInputBy(const char *ctable, const LookupResult result,
 
 std::string ConvertUsingDoubleArray(const DoubleArray *da, const char *ctable,
                                     const absl::string_view input) {
-  int mblen = 0;
   std::string output;
+  ConvertUsingDoubleArray(da, ctable, input, &output);
+  return output;
+}
+
+void ConvertUsingDoubleArray(const DoubleArray *da, const char *ctable,
+                             const absl::string_view input,
+                             std::string *output) {
+  // Most conversions keep the byte length, so this avoids reallocations.
+  output->reserve(output->size() + input.size());
+  int mblen = 0;
   for (size_t i = 0; i < input.size(); i += mblen) {
     const LookupResult result = LookupDoubleArray(da, input.substr(i));
     if (result.seekto > 0) {
@@ -99,15 +107,15 @@ std::string ConvertUsingDoubleArray(const DoubleArray *da, const char *ctable,
       // - null-terminated string
       // - one byte offset to rewind the input
       const absl::string_view s(ctable + result.index);
-      absl::StrAppend(&output, s);
+      output->append(s.data(), s.size());
       mblen = AdvanceInputBy(ctable, result, s.size());
     } else {
       // Not found in the table. Copy from input.
       mblen = OneCharLen(input[i]);
-      absl::StrAppend(&output, input.substr(i, mblen));
+      const absl::string_view c = input.substr(i, mblen);
+      output->append(c.data(), c.size());
     }
   }
-  return output;
 }
 
 std::vector<std::pair<absl::string_view, absl::string_view>>
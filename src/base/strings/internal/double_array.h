@@ -47,6 +47,10 @@ struct DoubleArray {
 std::string ConvertUsingDoubleArray(const DoubleArray *da, const char *table,
                                     absl::string_view input);
 
+// Same as above, but appends the result to `output`.
+void ConvertUsingDoubleArray(const DoubleArray *da, const char *table,
+                             absl::string_view input, std::string *output);
+
 std::vector<std::pair<absl::string_view, absl::string_view>>
 AlignUsingDoubleArray(const DoubleArray *da, const char *ctable,
                       absl::string_view input);
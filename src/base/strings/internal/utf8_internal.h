@@ -32,6 +32,7 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
 
 namespace mozc::utf8_internal {
 
@@ -138,6 +139,25 @@ EncodeResult Encode(char32_t cp);
 // REQUIRES: [it, last) to be a valid range.
 DecodeResult Decode(const char* ptr, const char* last);
 
+// Returns the pointer to the first non-ASCII byte in [ptr, last), or `last` if
+// all the bytes are ASCII. It tests eight bytes at a time.
+// REQUIRES: [ptr, last) to be a valid range.
+inline const char* SkipAscii(const char* ptr, const char* const last) {
+  constexpr uint64_t kHighBits = 0x8080808080808080;
+  while (last - ptr >= 8) {
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+    if (word & kHighBits) {
+      break;
+    }
+    ptr += 8;
+  }
+  while (ptr != last && static_cast<unsigned char>(*ptr) < 0x80) {
+    ++ptr;
+  }
+  return ptr;
+}
+
 }  // namespace mozc::utf8_internal
 
 #endif  // MOZC_BASE_STRINGS_INTERNAL_UTF8_INTERNAL_H_
@@ -29,6 +29,9 @@
 
 #include "base/strings/japanese.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -36,80 +39,237 @@
 #include "absl/strings/string_view.h"
 #include "base/strings/internal/double_array.h"
 #include "base/strings/internal/japanese_rules.h"
+#include "base/strings/unicode.h"
 
 namespace mozc::japanese {
+namespace {
 
 using ::mozc::japanese::internal::ConvertUsingDoubleArray;
 
+// Hiragana [U+3041, U+3094] and katakana [U+30A1, U+30F4] correspond one to
+// one with the offset 0x60. This is all what hiragana-katakana.tsv and
+// katakana-hiragana.tsv define except for "う゛" -> "ヴ", so the conversions
+// between them are done arithmetically instead of looking up the double
+// arrays. All the characters in this range are encoded in three bytes
+// starting with 0xE3. japanese_test verifies that the results are the same as
+// the tables.
+constexpr char32_t kHiraganaFirst = 0x3041;
+constexpr char32_t kHiraganaLast = 0x3094;
+constexpr int kKanaOffset = 0x60;
+
+// Returns the code point of the three-byte sequence at `ptr` if it encodes a
+// character in [first, last]. Otherwise returns 0.
+char32_t DecodeKana(const char* ptr, const char* last, char32_t first,
+                    char32_t last_cp) {
+  if (last - ptr < 3 || static_cast<uint8_t>(ptr[0]) != 0xE3 ||
+      (ptr[1] & 0xC0) != 0x80 || (ptr[2] & 0xC0) != 0x80) {
+    return 0;
+  }
+  const char32_t cp = 0x3000 | ((ptr[1] & 0x3F) << 6) | (ptr[2] & 0x3F);
+  return (cp >= first && cp <= last_cp) ? cp : 0;
+}
+
+void AppendKana(char32_t cp, std::string* output) {
+  const char buf[3] = {
+      static_cast<char>(0xE0 | (cp >> 12)),
+      static_cast<char>(0x80 | ((cp >> 6) & 0x3F)),
+      static_cast<char>(0x80 | (cp & 0x3F)),
+  };
+  output->append(buf, sizeof(buf));
+}
+
+// Converts [first, last_cp] to [first + offset, last_cp + offset]. ASCII runs
+// are copied in bulk, and the other characters are copied as they are. If
+// `combine_vu` is true, "う゛" is converted to "ヴ".
+void ShiftKana(const absl::string_view input, const char32_t first,
+               const char32_t last_cp, const int offset, const bool combine_vu,
+               std::string* output) {
+  output->reserve(output->size() + input.size());
+  const char* const last = input.data() + input.size();
+  for (const char* ptr = input.data(); ptr != last;) {
+    const char* ascii_end = strings::SkipAscii(ptr, last);
+    output->append(ptr, ascii_end);
+    ptr = ascii_end;
+    if (ptr == last) {
+      break;
+    }
+    if (const char32_t cp = DecodeKana(ptr, last, first, last_cp); cp != 0) {
+      ptr += 3;
+      if (combine_vu && cp == U'う' && DecodeKana(ptr, last, U'゛', U'゛')) {
+        ptr += 3;
+        AppendKana(U'ヴ', output);
+      } else {
+        AppendKana(cp + offset, output);
+      }
+      continue;
+    }
+    // Not a kana. Copy it as the double array conversion does.
+    const char* next =
+        ptr + std::min<ptrdiff_t>(strings::OneCharLen(*ptr), last - ptr);
+    output->append(ptr, next);
+    ptr = next;
+  }
+}
+
+}  // namespace
+
 std::string HiraganaToKatakana(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::hiragana_to_katakana_da,
-                                 internal::hiragana_to_katakana_table, input);
+  std::string output;
+  HiraganaToKatakana(input, &output);
+  return output;
+}
+
+void HiraganaToKatakana(const absl::string_view input, std::string* output) {
+  ShiftKana(input, kHiraganaFirst, kHiraganaLast, kKanaOffset,
+            /*combine_vu=*/true, output);
 }
 
 std::string HiraganaToHalfwidthKatakana(const absl::string_view input) {
+  std::string output;
+  HiraganaToHalfwidthKatakana(input, &output);
+  return output;
+}
+
+void HiraganaToHalfwidthKatakana(const absl::string_view input,
+                                 std::string* output) {
   // combine two rules
-  return FullWidthKatakanaToHalfWidthKatakana(HiraganaToKatakana(input));
+  FullWidthKatakanaToHalfWidthKatakana(HiraganaToKatakana(input), output);
 }
 
 std::string HiraganaToRomanji(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::hiragana_to_romanji_da,
-                                 internal::hiragana_to_romanji_table, input);
+  std::string output;
+  HiraganaToRomanji(input, &output);
+  return output;
+}
+
+void HiraganaToRomanji(const absl::string_view input, std::string* output) {
+  ConvertUsingDoubleArray(internal::hiragana_to_romanji_da,
+                          internal::hiragana_to_romanji_table, input, output);
 }
 
 std::string HalfWidthAsciiToFullWidthAscii(const absl::string_view input) {
-  return ConvertUsingDoubleArray(
-      internal::halfwidthascii_to_fullwidthascii_da,
-      internal::halfwidthascii_to_fullwidthascii_table, input);
+  std::string output;
+  HalfWidthAsciiToFullWidthAscii(input, &output);
+  return output;
+}
+
+void HalfWidthAsciiToFullWidthAscii(const absl::string_view input,
+                                    std::string* output) {
+  ConvertUsingDoubleArray(internal::halfwidthascii_to_fullwidthascii_da,
+                          internal::halfwidthascii_to_fullwidthascii_table,
+                          input, output);
 }
 
 std::string FullWidthAsciiToHalfWidthAscii(const absl::string_view input) {
-  return ConvertUsingDoubleArray(
-      internal::fullwidthascii_to_halfwidthascii_da,
-      internal::fullwidthascii_to_halfwidthascii_table, input);
+  std::string output;
+  FullWidthAsciiToHalfWidthAscii(input, &output);
+  return output;
+}
+
+void FullWidthAsciiToHalfWidthAscii(const absl::string_view input,
+                                    std::string* output) {
+  ConvertUsingDoubleArray(internal::fullwidthascii_to_halfwidthascii_da,
+                          internal::fullwidthascii_to_halfwidthascii_table,
+                          input, output);
 }
 
 std::string HiraganaToFullwidthRomanji(const absl::string_view input) {
-  return HalfWidthAsciiToFullWidthAscii(HiraganaToRomanji(input));
+  std::string output;
+  HiraganaToFullwidthRomanji(input, &output);
+  return output;
+}
+
+void HiraganaToFullwidthRomanji(const absl::string_view input,
+                                std::string* output) {
+  HalfWidthAsciiToFullWidthAscii(HiraganaToRomanji(input), output);
 }
 
 std::string RomanjiToHiragana(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::romanji_to_hiragana_da,
-                                 internal::romanji_to_hiragana_table, input);
+  std::string output;
+  RomanjiToHiragana(input, &output);
+  return output;
+}
+
+void RomanjiToHiragana(const absl::string_view input, std::string* output) {
+  ConvertUsingDoubleArray(internal::romanji_to_hiragana_da,
+                          internal::romanji_to_hiragana_table, input, output);
+}
+
+std::string KatakanaToHiragana(const absl::string_view input) {
+  std::string output;
+  KatakanaToHiragana(input, &output);
+  return output;
+}
+
+void KatakanaToHiragana(const absl::string_view input, std::string* output) {
+  ShiftKana(input, kHiraganaFirst + kKanaOffset, kHiraganaLast + kKanaOffset,
+            -kKanaOffset, /*combine_vu=*/false, output);
 }
 
-std::string KatakanaToHiragana(absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::katakana_to_hiragana_da,
-                                 internal::katakana_to_hiragana_table, input);
+std::string HalfWidthKatakanaToFullWidthKatakana(
+    const absl::string_view input) {
+  std::string output;
+  HalfWidthKatakanaToFullWidthKatakana(input, &output);
+  return output;
 }
 
-std::string HalfWidthKatakanaToFullWidthKatakana(absl::string_view input) {
-  return ConvertUsingDoubleArray(
+void HalfWidthKatakanaToFullWidthKatakana(const absl::string_view input,
+                                          std::string* output) {
+  ConvertUsingDoubleArray(
       internal::halfwidthkatakana_to_fullwidthkatakana_da,
-      internal::halfwidthkatakana_to_fullwidthkatakana_table, input);
+      internal::halfwidthkatakana_to_fullwidthkatakana_table, input, output);
 }
 
-std::string FullWidthKatakanaToHalfWidthKatakana(absl::string_view input) {
-  return ConvertUsingDoubleArray(
+std::string FullWidthKatakanaToHalfWidthKatakana(
+    const absl::string_view input) {
+  std::string output;
+  FullWidthKatakanaToHalfWidthKatakana(input, &output);
+  return output;
+}
+
+void FullWidthKatakanaToHalfWidthKatakana(const absl::string_view input,
+                                          std::string* output) {
+  ConvertUsingDoubleArray(
       internal::fullwidthkatakana_to_halfwidthkatakana_da,
-      internal::fullwidthkatakana_to_halfwidthkatakana_table, input);
+      internal::fullwidthkatakana_to_halfwidthkatakana_table, input, output);
 }
 
 std::string FullWidthToHalfWidth(const absl::string_view input) {
-  return FullWidthKatakanaToHalfWidthKatakana(
-      FullWidthAsciiToHalfWidthAscii(input));
+  std::string output;
+  FullWidthToHalfWidth(input, &output);
+  return output;
+}
+
+void FullWidthToHalfWidth(const absl::string_view input, std::string* output) {
+  FullWidthKatakanaToHalfWidthKatakana(FullWidthAsciiToHalfWidthAscii(input),
+                                       output);
 }
 
 std::string HalfWidthToFullWidth(const absl::string_view input) {
-  return HalfWidthKatakanaToFullWidthKatakana(
-      HalfWidthAsciiToFullWidthAscii(input));
+  std::string output;
+  HalfWidthToFullWidth(input, &output);
+  return output;
+}
+
+void HalfWidthToFullWidth(const absl::string_view input, std::string* output) {
+  HalfWidthKatakanaToFullWidthKatakana(HalfWidthAsciiToFullWidthAscii(input),
+                                       output);
 }
 
 // TODO(tabata): Add another function to split voice mark
 // of some UNICODE only characters (required to display
 // and commit for old clients)
 std::string NormalizeVoicedSoundMark(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::normalize_voiced_sound_da,
-                                 internal::normalize_voiced_sound_table, input);
+  std::string output;
+  NormalizeVoicedSoundMark(input, &output);
+  return output;
+}
+
+void NormalizeVoicedSoundMark(const absl::string_view input,
+                              std::string* output) {
+  ConvertUsingDoubleArray(internal::normalize_voiced_sound_da,
+                          internal::normalize_voiced_sound_table, input,
+                          output);
 }
 
 std::vector<std::pair<absl::string_view, absl::string_view>>
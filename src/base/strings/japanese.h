@@ -39,31 +39,51 @@
 namespace mozc::japanese {
 
 // Japanese utilities for character form transliteration.
+//
+// Each function has an overload which appends the result to `output` instead
+// of returning a new string, so that callers can reuse their buffers.
 std::string HiraganaToKatakana(absl::string_view input);
+void HiraganaToKatakana(absl::string_view input, std::string* output);
 
 std::string HiraganaToHalfwidthKatakana(absl::string_view input);
+void HiraganaToHalfwidthKatakana(absl::string_view input, std::string* output);
 
 std::string HiraganaToRomanji(absl::string_view input);
+void HiraganaToRomanji(absl::string_view input, std::string* output);
 
 std::string HalfWidthAsciiToFullWidthAscii(absl::string_view input);
+void HalfWidthAsciiToFullWidthAscii(absl::string_view input,
+                                    std::string* output);
 
 std::string FullWidthAsciiToHalfWidthAscii(absl::string_view input);
+void FullWidthAsciiToHalfWidthAscii(absl::string_view input,
+                                    std::string* output);
 
 std::string HiraganaToFullwidthRomanji(absl::string_view input);
+void HiraganaToFullwidthRomanji(absl::string_view input, std::string* output);
 
 std::string RomanjiToHiragana(absl::string_view input);
+void RomanjiToHiragana(absl::string_view input, std::string* output);
 
 std::string KatakanaToHiragana(absl::string_view input);
+void KatakanaToHiragana(absl::string_view input, std::string* output);
 
 std::string HalfWidthKatakanaToFullWidthKatakana(absl::string_view input);
+void HalfWidthKatakanaToFullWidthKatakana(absl::string_view input,
+                                          std::string* output);
 
 std::string FullWidthKatakanaToHalfWidthKatakana(absl::string_view input);
+void FullWidthKatakanaToHalfWidthKatakana(absl::string_view input,
+                                          std::string* output);
 
 std::string FullWidthToHalfWidth(absl::string_view input);
+void FullWidthToHalfWidth(absl::string_view input, std::string* output);
 
 std::string HalfWidthToFullWidth(absl::string_view input);
+void HalfWidthToFullWidth(absl::string_view input, std::string* output);
 
 std::string NormalizeVoicedSoundMark(absl::string_view input);
+void NormalizeVoicedSoundMark(absl::string_view input, std::string* output);
 
 // Returns alignment.
 std::vector<std::pair<absl::string_view, absl::string_view>>
@@ -33,7 +33,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "base/strings/internal/double_array.h"
+#include "base/strings/internal/japanese_rules.h"
+#include "base/strings/unicode.h"
 #include "testing/gunit.h"
 
 namespace mozc::japanese {
@@ -89,6 +93,48 @@ TEST(JapaneseUtilTest, KatakanaToHiragana) {
   }
 }
 
+TEST(JapaneseUtilTest, KanaConversionsMatchRuleTables) {
+  using ::mozc::japanese::internal::ConvertUsingDoubleArray;
+  auto table_hiragana_to_katakana = [](absl::string_view input) {
+    return ConvertUsingDoubleArray(internal::hiragana_to_katakana_da,
+                                   internal::hiragana_to_katakana_table, input);
+  };
+  auto table_katakana_to_hiragana = [](absl::string_view input) {
+    return ConvertUsingDoubleArray(internal::katakana_to_hiragana_da,
+                                   internal::katakana_to_hiragana_table, input);
+  };
+
+  // Every character around the kana blocks, followed by "゛" and ASCII.
+  for (char32_t cp = 0x3000; cp < 0x3100; ++cp) {
+    const std::string input =
+        absl::StrCat(strings::Char32ToUtf8(cp), "゛", "abcdefghijk");
+    EXPECT_EQ(HiraganaToKatakana(input), table_hiragana_to_katakana(input))
+        << input;
+    EXPECT_EQ(KatakanaToHiragana(input), table_katakana_to_hiragana(input))
+        << input;
+  }
+
+  // Broken UTF-8 sequences are copied as the tables do.
+  for (const absl::string_view input :
+       {"\xE3", "\xE3\x81", "\xE3\xE3\x81\x82", "\x81\x82あ", "あ\xE3\x82",
+        "う\xE3\x82"}) {
+    EXPECT_EQ(HiraganaToKatakana(input), table_hiragana_to_katakana(input));
+    EXPECT_EQ(KatakanaToHiragana(input), table_katakana_to_hiragana(input));
+  }
+}
+
+TEST(JapaneseUtilTest, AppendToOutput) {
+  std::string output = "prefix:";
+  HiraganaToKatakana("ひらがな", &output);
+  EXPECT_EQ(output, "prefix:ヒラガナ");
+  KatakanaToHiragana("カタカナ", &output);
+  EXPECT_EQ(output, "prefix:ヒラガナかたかな");
+  FullWidthToHalfWidth("ＡＢＣアイウ", &output);
+  EXPECT_EQ(output, "prefix:ヒラガナかたかなABCｱｲｳ");
+  HiraganaToRomanji("もずく", &output);
+  EXPECT_EQ(output, "prefix:ヒラガナかたかなABCｱｲｳmozuku");
+}
+
 TEST(JapaneseUtilTest, RomanjiToHiragana) {
   struct {
     const char* input;
@@ -29,6 +29,7 @@
 
 #include "base/strings/unicode.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <string>
 #include <string_view>
@@ -42,6 +43,10 @@ namespace strings {
 bool IsValidUtf8(const absl::string_view sv) {
   const char* const last = sv.data() + sv.size();
   for (const char* ptr = sv.data(); ptr != last;) {
+    ptr = SkipAscii(ptr, last);
+    if (ptr == last) {
+      break;
+    }
     const utf8_internal::DecodeResult dr = utf8_internal::Decode(ptr, last);
     if (!dr.ok()) {
       return false;
@@ -51,6 +56,23 @@ bool IsValidUtf8(const absl::string_view sv) {
   return true;
 }
 
+size_t CharsLen(const absl::string_view sv) {
+  size_t result = 0;
+  const char* const last = sv.data() + sv.size();
+  for (const char* ptr = sv.data(); ptr != last;) {
+    // ASCII runs are counted in bulk.
+    const char* ascii_end = SkipAscii(ptr, last);
+    result += ascii_end - ptr;
+    ptr = ascii_end;
+    if (ptr == last) {
+      break;
+    }
+    ++result;
+    ptr += std::min<ptrdiff_t>(OneCharLen(*ptr), last - ptr);
+  }
+  return result;
+}
+
 std::u32string Utf8ToUtf32(const absl::string_view sv) {
   const Utf8AsChars32 c32s{sv};
   // Most strings in Mozc are fairly short, so it's faster to depend on
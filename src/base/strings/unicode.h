@@ -60,6 +60,10 @@ using ::mozc::utf8_internal::kReplacementCharacter;
 // REQUIRES: The UTF-8 character is valid.
 using ::mozc::utf8_internal::OneCharLen;
 
+// Returns the pointer to the first non-ASCII byte in [ptr, last), or `last` if
+// all the bytes are ASCII. It tests eight bytes at a time.
+using ::mozc::utf8_internal::SkipAscii;
+
 // Returns the byte length of a single UTF-8 character at the iterator. This
 // overload participates in resolution only if InputIterator is not convertible
 // to char.
@@ -88,9 +92,7 @@ bool IsValidUtf8(absl::string_view sv);
 template <typename InputIterator>
   requires std::input_iterator<InputIterator>
 size_t CharsLen(InputIterator first, InputIterator last);
-inline size_t CharsLen(const absl::string_view sv) {
-  return CharsLen(sv.begin(), sv.end());
-}
+size_t CharsLen(absl::string_view sv);
 
 // Returns the number of Unicode characters between [0, n]. It stops counting at
 // n. This is faster than CharsLen if you just want to check the length against
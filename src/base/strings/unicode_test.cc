@@ -60,6 +60,13 @@ TEST(UnicodeTest, CharsLen) {
   EXPECT_EQ(CharsLen(kText), 9);
   EXPECT_EQ(CharsLen(kText.begin(), kText.end()), 9);
   EXPECT_EQ(CharsLen(kText.end(), kText.end()), 0);
+
+  // Long ASCII runs are counted word by word.
+  EXPECT_EQ(CharsLen("abcdefghijklmnopqrstuvwxyz"), 26);
+  EXPECT_EQ(CharsLen("abcdefghあijklmnopいqrstuvwxyz"), 28);
+  EXPECT_EQ(CharsLen("0123456私の名前は中野です0123456789"), 26);
+  // A truncated trailing character is counted once.
+  EXPECT_EQ(CharsLen("abcdefghijklmnop\xE3\x81"), 17);
 }
 
 TEST(UnicodeTest, AtLeastCharsLen) {
@@ -165,6 +172,12 @@ TEST(UnicodeTest, IsValidUtf8) {
   EXPECT_FALSE(IsValidUtf8("\xED\xA0\x80"));
   EXPECT_FALSE(IsValidUtf8("\xED\xBF\xBF"));
   EXPECT_FALSE(IsValidUtf8("\xED\xAF\x41"));
+
+  // Invalid bytes after or between long ASCII runs.
+  EXPECT_TRUE(IsValidUtf8("abcdefghijklmnopあqrstuvwxyz0123456789"));
+  EXPECT_FALSE(IsValidUtf8("abcdefghijklmnop\xFF"));
+  EXPECT_FALSE(IsValidUtf8("abcdefg\x80hijklmnopqrstuvwxyz"));
+  EXPECT_FALSE(IsValidUtf8("abcdefghijklmnopあqrstuvwx\xE3\x81"));
 }
 
 TEST(UnicodeTest, Utf8Substring) {
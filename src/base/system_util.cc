@@ -63,6 +63,7 @@
 // clang-format off
 #include <windows.h>
 #include <lmcons.h>
+#include <psapi.h>
 #include <sddl.h>
 #include <shlobj.h>
 #include <versionhelpers.h>
@@ -75,6 +76,7 @@
 #else  // _WIN32
 #include <pwd.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #include "absl/container/fixed_array.h"
@@ -906,6 +908,31 @@ uint64_t SystemUtil::GetTotalPhysicalMemory() {
   // because of no return value.
 }
 
+uint64_t SystemUtil::GetPeakResidentMemorySize() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters = {sizeof(PROCESS_MEMORY_COUNTERS)};
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                              sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#elif defined(__wasm__)
+  return 0;
+#else   // _WIN32
+  struct rusage usage = {};
+  if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  // macOS reports ru_maxrss in bytes.
+  return static_cast<uint64_t>(usage.ru_maxrss);
+#else   // __APPLE__
+  // Linux reports ru_maxrss in kilobytes.
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif  // __APPLE__
+#endif  // _WIN32
+}
+
 void SystemUtil::SetProgramInvocationName(absl::string_view name) {
   ProgramInvocationNameHolder::GetInstance()->Set(name);
 }
@@ -136,6 +136,10 @@ class SystemUtil {
   // retrieve total physical memory. returns 0 if any error occurs.
   static uint64_t GetTotalPhysicalMemory();
 
+  // retrieve the peak resident memory size of the current process in bytes.
+  // returns 0 if any error occurs or the platform is not supported.
+  static uint64_t GetPeakResidentMemorySize();
+
   // Sets program invocation name to use it for runfiles directory.
   static void SetProgramInvocationName(absl::string_view name);
 
@@ -103,6 +103,12 @@ TEST_F(SystemUtilTest, GetTotalPhysicalMemoryTest) {
   EXPECT_GT(SystemUtil::GetTotalPhysicalMemory(), 0);
 }
 
+TEST_F(SystemUtilTest, GetPeakResidentMemorySizeTest) {
+#if !defined(__wasm__)
+  EXPECT_GT(SystemUtil::GetPeakResidentMemorySize(), 0);
+#endif  // !__wasm__
+}
+
 #ifdef __ANDROID__
 TEST_F(SystemUtilTest, GetOSVersionStringTestForAndroid) {
   std::string result = SystemUtil::GetOSVersionString();
@@ -0,0 +1,114 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "base/trace.h"
+
+#include <cstddef>
+#include <string>
+
+#include "absl/base/attributes.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/clock.h"
+
+namespace mozc {
+namespace {
+
+ABSL_CONST_INIT thread_local TraceRecorder* g_current_recorder = nullptr;
+
+void AppendJsonEscaped(absl::string_view str, std::string* output) {
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        output->append("\\\"");
+        break;
+      case '\\':
+        output->append("\\\\");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          // Control characters are not expected in span names.
+          output->push_back('?');
+        } else {
+          output->push_back(c);
+        }
+    }
+  }
+}
+
+}  // namespace
+
+TraceRecorder::ScopedActivation::ScopedActivation(TraceRecorder* recorder)
+    : previous_(g_current_recorder) {
+  g_current_recorder = recorder;
+}
+
+TraceRecorder::ScopedActivation::~ScopedActivation() {
+  g_current_recorder = previous_;
+}
+
+TraceRecorder* TraceRecorder::Current() { return g_current_recorder; }
+
+size_t TraceRecorder::BeginSpan(absl::string_view name) {
+  spans_.push_back(Span{
+      .name = name,
+      .begin = Clock::GetAbslTime(),
+      .depth = depth_++,
+  });
+  return spans_.size() - 1;
+}
+
+void TraceRecorder::EndSpan(size_t index) {
+  DCHECK_LT(index, spans_.size());
+  Span& span = spans_[index];
+  span.duration = Clock::GetAbslTime() - span.begin;
+  depth_ = span.depth;
+}
+
+void TraceRecorder::Clear() {
+  spans_.clear();
+  depth_ = 0;
+}
+
+void TraceRecorder::AppendChromeTraceEvents(int pid, int tid,
+                                            std::string* output) const {
+  DCHECK(output);
+  for (const Span& span : spans_) {
+    absl::StrAppend(output, R"({"name":")");
+    AppendJsonEscaped(span.name, output);
+    absl::StrAppend(output, R"(","cat":"mozc","ph":"X","ts":)",
+                    absl::ToUnixMicros(span.begin),
+                    R"(,"dur":)", absl::ToInt64Microseconds(span.duration),
+                    R"(,"pid":)", pid, R"(,"tid":)", tid, "},\n");
+  }
+}
+
+}  // namespace mozc
@@ -0,0 +1,153 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Lightweight per-request tracing.
+//
+// A TraceRecorder collects nested spans on the current thread while it is
+// activated with TraceRecorder::ScopedActivation. Code paths are annotated
+// with MOZC_TRACE_SPAN("name"), which records the wall time spent in the
+// enclosing scope. When the binary is built without MOZC_ENABLE_TRACING, the
+// macro expands to nothing so that annotated code has no overhead at all.
+//
+// Example:
+//   TraceRecorder recorder;
+//   {
+//     TraceRecorder::ScopedActivation activation(&recorder);
+//     MOZC_TRACE_SPAN("Outer");
+//     {
+//       MOZC_TRACE_SPAN("Inner");
+//       ...
+//     }
+//   }
+//   // recorder.spans() == {"Outer" (depth 0), "Inner" (depth 1)}
+
+#ifndef MOZC_BASE_TRACE_H_
+#define MOZC_BASE_TRACE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+namespace mozc {
+
+class TraceRecorder {
+ public:
+  struct Span {
+    // The name must outlive the recorder. Usually it is a string literal.
+    absl::string_view name;
+    absl::Time begin = absl::InfinitePast();
+    absl::Duration duration = absl::ZeroDuration();
+    // 0 for the outermost span.
+    int depth = 0;
+  };
+
+  // Makes `recorder` the active recorder of the current thread while this
+  // object is alive. Activations can be nested; the previous recorder is
+  // restored on destruction.
+  class ScopedActivation {
+   public:
+    explicit ScopedActivation(TraceRecorder* recorder);
+    ScopedActivation(const ScopedActivation&) = delete;
+    ScopedActivation& operator=(const ScopedActivation&) = delete;
+    ~ScopedActivation();
+
+   private:
+    TraceRecorder* previous_;
+  };
+
+  TraceRecorder() = default;
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  // Returns the recorder active on the current thread, or nullptr.
+  static TraceRecorder* Current();
+
+  // Opens a new span and returns its index to be passed to EndSpan().
+  size_t BeginSpan(absl::string_view name);
+  // Closes the span opened by BeginSpan().
+  void EndSpan(size_t index);
+
+  // Spans in the order they were opened.
+  absl::Span<const Span> spans() const { return spans_; }
+  bool empty() const { return spans_.empty(); }
+  void Clear();
+
+  // Appends the spans as complete events ("ph":"X") of the Chrome trace event
+  // format, which can be loaded by chrome://tracing and Perfetto UI. Events
+  // are separated by ",\n" and a trailing separator is appended so that the
+  // output of multiple requests can be concatenated into one JSON array.
+  void AppendChromeTraceEvents(int pid, int tid, std::string* output) const;
+
+ private:
+  std::vector<Span> spans_;
+  int depth_ = 0;
+};
+
+// Records a span for the lifetime of this object if a recorder is active.
+class ScopedTraceSpan {
+ public:
+  explicit ScopedTraceSpan(absl::string_view name)
+      : recorder_(TraceRecorder::Current()) {
+    if (recorder_ != nullptr) {
+      index_ = recorder_->BeginSpan(name);
+    }
+  }
+  ScopedTraceSpan(const ScopedTraceSpan&) = delete;
+  ScopedTraceSpan& operator=(const ScopedTraceSpan&) = delete;
+  ~ScopedTraceSpan() {
+    if (recorder_ != nullptr) {
+      recorder_->EndSpan(index_);
+    }
+  }
+
+ private:
+  TraceRecorder* recorder_;
+  size_t index_ = 0;
+};
+
+}  // namespace mozc
+
+#define MOZC_TRACE_INTERNAL_CONCAT2(a, b) a##b
+#define MOZC_TRACE_INTERNAL_CONCAT(a, b) MOZC_TRACE_INTERNAL_CONCAT2(a, b)
+
+#ifdef MOZC_ENABLE_TRACING
+#define MOZC_TRACE_SPAN(name)                               \
+  const ::mozc::ScopedTraceSpan MOZC_TRACE_INTERNAL_CONCAT( \
+      mozc_trace_span_, __LINE__)(name)
+#else  // MOZC_ENABLE_TRACING
+#define MOZC_TRACE_SPAN(name) \
+  do {                        \
+  } while (false)
+#endif  // MOZC_ENABLE_TRACING
+
+#endif  // MOZC_BASE_TRACE_H_
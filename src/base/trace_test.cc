@@ -0,0 +1,124 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "base/trace.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "base/clock.h"
+#include "base/clock_mock.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace {
+
+class TraceRecorderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    clock_mock_ = std::make_unique<ClockMock>(absl::FromUnixMicros(1000));
+    Clock::SetClockForUnitTest(clock_mock_.get());
+  }
+
+  void TearDown() override { Clock::SetClockForUnitTest(nullptr); }
+
+  void Advance(absl::Duration duration) { clock_mock_->Advance(duration); }
+
+  std::unique_ptr<ClockMock> clock_mock_;
+};
+
+TEST_F(TraceRecorderTest, NoActiveRecorder) {
+  EXPECT_EQ(TraceRecorder::Current(), nullptr);
+  // Must be a no-op.
+  ScopedTraceSpan span("NoRecorder");
+}
+
+TEST_F(TraceRecorderTest, NestedSpans) {
+  TraceRecorder recorder;
+  {
+    TraceRecorder::ScopedActivation activation(&recorder);
+    EXPECT_EQ(TraceRecorder::Current(), &recorder);
+    ScopedTraceSpan outer("Outer");
+    Advance(absl::Microseconds(10));
+    {
+      ScopedTraceSpan inner("Inner");
+      Advance(absl::Microseconds(20));
+    }
+    {
+      ScopedTraceSpan inner("Inner2");
+      Advance(absl::Microseconds(5));
+    }
+  }
+  EXPECT_EQ(TraceRecorder::Current(), nullptr);
+
+  ASSERT_EQ(recorder.spans().size(), 3);
+  EXPECT_EQ(recorder.spans()[0].name, "Outer");
+  EXPECT_EQ(recorder.spans()[0].depth, 0);
+  EXPECT_EQ(recorder.spans()[0].duration, absl::Microseconds(35));
+  EXPECT_EQ(recorder.spans()[1].name, "Inner");
+  EXPECT_EQ(recorder.spans()[1].depth, 1);
+  EXPECT_EQ(recorder.spans()[1].duration, absl::Microseconds(20));
+  EXPECT_EQ(recorder.spans()[2].name, "Inner2");
+  EXPECT_EQ(recorder.spans()[2].depth, 1);
+  EXPECT_EQ(recorder.spans()[2].begin, absl::FromUnixMicros(1030));
+
+  recorder.Clear();
+  EXPECT_TRUE(recorder.empty());
+}
+
+TEST_F(TraceRecorderTest, NestedActivation) {
+  TraceRecorder recorder1, recorder2;
+  TraceRecorder::ScopedActivation activation1(&recorder1);
+  {
+    TraceRecorder::ScopedActivation activation2(&recorder2);
+    ScopedTraceSpan span("Span2");
+  }
+  EXPECT_EQ(TraceRecorder::Current(), &recorder1);
+  EXPECT_TRUE(recorder1.empty());
+  EXPECT_EQ(recorder2.spans().size(), 1);
+}
+
+TEST_F(TraceRecorderTest, AppendChromeTraceEvents) {
+  TraceRecorder recorder;
+  {
+    TraceRecorder::ScopedActivation activation(&recorder);
+    ScopedTraceSpan span("Quote\"");
+    Advance(absl::Microseconds(7));
+  }
+  std::string output;
+  recorder.AppendChromeTraceEvents(1, 2, &output);
+  EXPECT_EQ(output,
+            R"({"name":"Quote\"","cat":"mozc","ph":"X","ts":1000,"dur":7,)"
+            R"("pid":1,"tid":2},)"
+            "\n");
+}
+
+}  // namespace
+}  // namespace mozc
@@ -35,6 +35,31 @@
 #include <utility>
 
 #include "absl/log/check.h"
+#include "absl/log/log.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define MOZC_AES256_USE_AESNI
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else  // _MSC_VER
+#include <cpuid.h>
+#endif  // _MSC_VER
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && \
+    (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+// The crypto extension is optional in ARMv8, so it is used only when the
+// compiler targets it.
+#define MOZC_AES256_USE_ARMV8_CRYPTO
+#include <arm_neon.h>
+#endif  // architectures
+
+#if defined(MOZC_AES256_USE_AESNI) && (defined(__GNUC__) || defined(__clang__))
+#define MOZC_AES256_TARGET_AESNI __attribute__((target("aes,sse2")))
+#else  // MOZC_AES256_USE_AESNI && (__GNUC__ || __clang__)
+#define MOZC_AES256_TARGET_AESNI
+#endif  // MOZC_AES256_USE_AESNI && (__GNUC__ || __clang__)
 
 namespace mozc {
 namespace internal {
@@ -138,46 +163,204 @@ void InvMixColumnsImpl(uint8_t column[4]) {
   column[3] = a11[0] ^ a13[1] ^ a9[2] ^ a14[3];
 }
 
+constexpr size_t kBlockBytes = UnverifiedAES256::kBlockBytes;
+
+// The hardware implementations below take the round keys in the same layout as
+// MakeKeySchedule(), and `dw` is the round keys for the equivalent inverse
+// cipher (FIPS-197 5.3.5) in the order of use.
+
+#if defined(MOZC_AES256_USE_AESNI)
+
+bool HasAESInstructions() {
+  // CPUID.01H:ECX.AESNI[bit 25]
+  constexpr uint32_t kAESNIBit = 1 << 25;
+#ifdef _MSC_VER
+  int info[4] = {};
+  __cpuid(info, 1);
+  return (static_cast<uint32_t>(info[2]) & kAESNIBit) != 0;
+#else   // _MSC_VER
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return (ecx & kAESNIBit) != 0;
+#endif  // _MSC_VER
+}
+
+MOZC_AES256_TARGET_AESNI void TransformCBCWithHardware(const uint8_t* w,
+                                                       uint8_t* vec,
+                                                       uint8_t* block,
+                                                       size_t block_count) {
+  __m128i rk[kNr + 1];
+  for (size_t i = 0; i <= kNr; ++i) {
+    rk[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i * 16));
+  }
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vec));
+  for (size_t i = 0; i < block_count; ++i) {
+    __m128i* p = reinterpret_cast<__m128i*>(block + i * kBlockBytes);
+    __m128i s = _mm_xor_si128(_mm_loadu_si128(p), v);
+    s = _mm_xor_si128(s, rk[0]);
+    for (size_t round = 1; round < kNr; ++round) {
+      s = _mm_aesenc_si128(s, rk[round]);
+    }
+    s = _mm_aesenclast_si128(s, rk[kNr]);
+    _mm_storeu_si128(p, s);
+    v = s;
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(vec), v);
+}
+
+MOZC_AES256_TARGET_AESNI void InverseTransformCBCWithHardware(
+    const uint8_t* dw, uint8_t* vec, uint8_t* block, size_t block_count) {
+  __m128i dk[kNr + 1];
+  for (size_t i = 0; i <= kNr; ++i) {
+    dk[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dw + i * 16));
+  }
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vec));
+  for (size_t i = 0; i < block_count; ++i) {
+    __m128i* p = reinterpret_cast<__m128i*>(block + i * kBlockBytes);
+    const __m128i c = _mm_loadu_si128(p);
+    __m128i s = _mm_xor_si128(c, dk[0]);
+    for (size_t round = 1; round < kNr; ++round) {
+      s = _mm_aesdec_si128(s, dk[round]);
+    }
+    s = _mm_aesdeclast_si128(s, dk[kNr]);
+    _mm_storeu_si128(p, _mm_xor_si128(s, v));
+    v = c;
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(vec), v);
+}
+
+#elif defined(MOZC_AES256_USE_ARMV8_CRYPTO)
+
+bool HasAESInstructions() { return true; }
+
+void TransformCBCWithHardware(const uint8_t* w, uint8_t* vec, uint8_t* block,
+                              size_t block_count) {
+  uint8x16_t rk[kNr + 1];
+  for (size_t i = 0; i <= kNr; ++i) {
+    rk[i] = vld1q_u8(w + i * 16);
+  }
+  uint8x16_t v = vld1q_u8(vec);
+  for (size_t i = 0; i < block_count; ++i) {
+    uint8_t* p = block + i * kBlockBytes;
+    // AESE does AddRoundKey, SubBytes and ShiftRows, and AESMC does
+    // MixColumns.
+    uint8x16_t s = veorq_u8(vld1q_u8(p), v);
+    for (size_t round = 0; round < kNr - 1; ++round) {
+      s = vaesmcq_u8(vaeseq_u8(s, rk[round]));
+    }
+    s = veorq_u8(vaeseq_u8(s, rk[kNr - 1]), rk[kNr]);
+    vst1q_u8(p, s);
+    v = s;
+  }
+  vst1q_u8(vec, v);
+}
+
+void InverseTransformCBCWithHardware(const uint8_t* dw, uint8_t* vec,
+                                     uint8_t* block, size_t block_count) {
+  uint8x16_t dk[kNr + 1];
+  for (size_t i = 0; i <= kNr; ++i) {
+    dk[i] = vld1q_u8(dw + i * 16);
+  }
+  uint8x16_t v = vld1q_u8(vec);
+  for (size_t i = 0; i < block_count; ++i) {
+    uint8_t* p = block + i * kBlockBytes;
+    const uint8x16_t c = vld1q_u8(p);
+    uint8x16_t s = c;
+    for (size_t round = 0; round < kNr - 1; ++round) {
+      s = vaesimcq_u8(vaesdq_u8(s, dk[round]));
+    }
+    s = veorq_u8(vaesdq_u8(s, dk[kNr - 1]), dk[kNr]);
+    vst1q_u8(p, veorq_u8(s, v));
+    v = c;
+  }
+  vst1q_u8(vec, v);
+}
+
+#else  // MOZC_AES256_USE_ARMV8_CRYPTO
+
+bool HasAESInstructions() { return false; }
+
+void TransformCBCWithHardware(const uint8_t* w, uint8_t* vec, uint8_t* block,
+                              size_t block_count) {
+  LOG(FATAL) << "AES instructions are not available";
+}
+
+void InverseTransformCBCWithHardware(const uint8_t* dw, uint8_t* vec,
+                                     uint8_t* block, size_t block_count) {
+  LOG(FATAL) << "AES instructions are not available";
+}
+
+#endif  // MOZC_AES256_USE_AESNI
+
 }  // namespace
 
-void UnverifiedAES256::TransformCBC(const uint8_t (&key)[kKeyBytes],
-                                    const uint8_t (&iv)[kBlockBytes],
-                                    uint8_t* block, size_t block_count) {
-  uint8_t w[kKeyScheduleBytes];
-  MakeKeySchedule(key, w);
+UnverifiedAES256::CBC::CBC(const uint8_t (&key)[kKeyBytes],
+                           const uint8_t (&iv)[kBlockBytes])
+    : use_hardware_(IsHardwareAvailable()) {
+  MakeKeySchedule(key, w_);
+  std::copy_n(iv, kBlockBytes, vec_);
 
-  uint8_t vec[kBlockBytes];
-  std::copy_n(iv, kBlockBytes, vec);
+  std::copy_n(&w_[kBlockBytes * kNr], kBlockBytes, &dw_[0]);
+  for (size_t round = 1; round < kNr; ++round) {
+    uint8_t* round_key = &dw_[kBlockBytes * round];
+    std::copy_n(&w_[kBlockBytes * (kNr - round)], kBlockBytes, round_key);
+    InvMixColumns(round_key);
+  }
+  std::copy_n(&w_[0], kBlockBytes, &dw_[kBlockBytes * kNr]);
+}
+
+bool UnverifiedAES256::CBC::IsHardwareAvailable() {
+  static const bool kAvailable = HasAESInstructions();
+  return kAvailable;
+}
+
+void UnverifiedAES256::CBC::Transform(uint8_t* block, size_t block_count) {
+  if (use_hardware_) {
+    TransformCBCWithHardware(w_, vec_, block, block_count);
+    return;
+  }
   for (size_t i = 0; i < block_count; ++i) {
     uint8_t* src = block + (i * kBlockBytes);
     for (size_t j = 0; j < kBlockBytes; ++j) {
-      src[j] ^= vec[j];
+      src[j] ^= vec_[j];
     }
-    TransformECB(w, src);
-    std::copy_n(src, kBlockBytes, vec);
+    TransformECB(w_, src);
+    std::copy_n(src, kBlockBytes, vec_);
   }
 }
 
-void UnverifiedAES256::InverseTransformCBC(const uint8_t (&key)[kKeyBytes],
-                                           const uint8_t (&iv)[kBlockBytes],
-                                           uint8_t* block, size_t block_count) {
-  uint8_t w[kKeyScheduleBytes];
-  MakeKeySchedule(key, w);
-
-  uint8_t prev_block[kBlockBytes];
-  std::copy_n(iv, kBlockBytes, prev_block);
+void UnverifiedAES256::CBC::InverseTransform(uint8_t* block,
+                                             size_t block_count) {
+  if (use_hardware_) {
+    InverseTransformCBCWithHardware(dw_, vec_, block, block_count);
+    return;
+  }
   for (size_t i = 0; i < block_count; ++i) {
     uint8_t original_current_block[kBlockBytes];
     uint8_t* current_block = block + (i * kBlockBytes);
     std::copy_n(current_block, kBlockBytes, original_current_block);
-    InverseTransformECB(w, current_block);
+    InverseTransformECB(w_, current_block);
     for (size_t j = 0; j < kBlockBytes; ++j) {
-      current_block[j] ^= prev_block[j];
+      current_block[j] ^= vec_[j];
     }
-    std::copy_n(original_current_block, kBlockBytes, prev_block);
+    std::copy_n(original_current_block, kBlockBytes, vec_);
   }
 }
 
+void UnverifiedAES256::TransformCBC(const uint8_t (&key)[kKeyBytes],
+                                    const uint8_t (&iv)[kBlockBytes],
+                                    uint8_t* block, size_t block_count) {
+  CBC(key, iv).Transform(block, block_count);
+}
+
+void UnverifiedAES256::InverseTransformCBC(const uint8_t (&key)[kKeyBytes],
+                                           const uint8_t (&iv)[kBlockBytes],
+                                           uint8_t* block, size_t block_count) {
+  CBC(key, iv).InverseTransform(block, block_count);
+}
+
 void UnverifiedAES256::MakeKeySchedule(const uint8_t (&key)[kKeyBytes],
                                        uint8_t w[kKeyScheduleBytes]) {
   std::copy_n(key, kKeyBytes, w);
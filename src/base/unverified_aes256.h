@@ -64,6 +64,35 @@ class UnverifiedAES256 {
                                   const uint8_t (&iv)[kBlockBytes],
                                   uint8_t* block, size_t block_count);
 
+  // Keeps the key schedule and the chaining vector of AES256 CBC so that data
+  // can be transformed in chunks. Transforming the chunks in order gives the
+  // same result as TransformCBC() or InverseTransformCBC() on the whole data.
+  // An instance should be used for only one direction.
+  //
+  // AES-NI or ARMv8 crypto extension is used when it is available.
+  class CBC {
+   public:
+    CBC(const uint8_t (&key)[kKeyBytes], const uint8_t (&iv)[kBlockBytes]);
+    CBC(const CBC&) = delete;
+    CBC& operator=(const CBC&) = delete;
+
+    void Transform(uint8_t* block, size_t block_count);
+    void InverseTransform(uint8_t* block, size_t block_count);
+
+    // Returns true if the CPU supports the AES instructions.
+    static bool IsHardwareAvailable();
+
+   private:
+    friend class UnverifiedAES256CBCTestPeer;
+
+    uint8_t w_[kKeyScheduleBytes];
+    // The round keys for the equivalent inverse cipher, used only with the
+    // AES instructions.
+    uint8_t dw_[kKeyScheduleBytes];
+    uint8_t vec_[kBlockBytes];
+    bool use_hardware_;
+  };
+
  protected:
   // Does AES256 ECB transformation.
   // CAVEATS: See the above comment.
@@ -29,13 +29,25 @@
 
 #include "base/unverified_aes256.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 
 #include "testing/gunit.h"
+#include "testing/test_peer.h"
 
 namespace mozc {
 namespace internal {
+
+class UnverifiedAES256CBCTestPeer
+    : public testing::TestPeer<UnverifiedAES256::CBC> {
+ public:
+  using testing::TestPeer<UnverifiedAES256::CBC>::TestPeer;
+
+  PEER_VARIABLE(use_hardware_);
+};
+
 namespace {
 
 using ::testing::AssertionFailure;
@@ -442,6 +454,76 @@ TEST(UnverifiedAES256Test, InverseTransformCBC_NonZero) {
   EXPECT_EQ_ARRAY(kExpected, block);
 }
 
+class UnverifiedAES256CBCTest : public ::testing::TestWithParam<bool> {
+ protected:
+  // Returns false if the hardware is requested but not available.
+  bool MaybeDisableHardware(UnverifiedAES256::CBC& cbc) {
+    const bool use_hardware = GetParam();
+    if (use_hardware && !UnverifiedAES256::CBC::IsHardwareAvailable()) {
+      return false;
+    }
+    UnverifiedAES256CBCTestPeer(cbc).use_hardware_() = use_hardware;
+    return true;
+  }
+};
+
+TEST_P(UnverifiedAES256CBCTest, TransformInChunks) {
+  uint8_t key[UnverifiedAES256::kKeyBytes];
+  for (size_t i = 0; i < std::size(key); ++i) {
+    key[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  uint8_t iv[UnverifiedAES256::kBlockBytes];
+  for (size_t i = 0; i < std::size(iv); ++i) {
+    iv[i] = static_cast<uint8_t>(0xf0 - i * 5);
+  }
+  constexpr size_t kNumBlocks = 37;
+  uint8_t original[UnverifiedAES256::kBlockBytes * kNumBlocks];
+  for (size_t i = 0; i < std::size(original); ++i) {
+    original[i] = static_cast<uint8_t>(i * 31 + (i >> 3));
+  }
+
+  // The result of the portable implementation in one call.
+  uint8_t expected[std::size(original)];
+  std::copy(std::begin(original), std::end(original), expected);
+  {
+    UnverifiedAES256::CBC cbc(key, iv);
+    UnverifiedAES256CBCTestPeer(cbc).use_hardware_() = false;
+    cbc.Transform(expected, kNumBlocks);
+  }
+
+  constexpr size_t kChunkBlocks[] = {1, 5, 0, 31};
+  uint8_t block[std::size(original)];
+  std::copy(std::begin(original), std::end(original), block);
+  {
+    UnverifiedAES256::CBC cbc(key, iv);
+    if (!MaybeDisableHardware(cbc)) {
+      GTEST_SKIP() << "AES instructions are not available";
+    }
+    size_t offset = 0;
+    for (const size_t chunk : kChunkBlocks) {
+      cbc.Transform(block + offset * UnverifiedAES256::kBlockBytes, chunk);
+      offset += chunk;
+    }
+    ASSERT_EQ(offset, kNumBlocks);
+  }
+  EXPECT_EQ_ARRAY(expected, block);
+
+  {
+    UnverifiedAES256::CBC cbc(key, iv);
+    ASSERT_TRUE(MaybeDisableHardware(cbc));
+    size_t offset = 0;
+    for (const size_t chunk : kChunkBlocks) {
+      cbc.InverseTransform(block + offset * UnverifiedAES256::kBlockBytes,
+                           chunk);
+      offset += chunk;
+    }
+  }
+  EXPECT_EQ_ARRAY(original, block);
+}
+
+INSTANTIATE_TEST_SUITE_P(Hardware, UnverifiedAES256CBCTest,
+                         ::testing::Values(false, true));
+
 // TODO(yukawa): Add more tests based on well-known test vectors.
 
 }  // namespace
@@ -341,12 +341,7 @@ bool IsUtf8TrailingByte(uint8_t c) { return (c & 0xc0) == 0x80; }
 }  // namespace
 
 size_t Util::CharsLen(absl::string_view str) {
-  size_t length = 0;
-  while (!str.empty()) {
-    ++length;
-    str = absl::ClippedSubstr(str, strings::OneCharLen(str.begin()));
-  }
-  return length;
+  return strings::CharsLen(str);
 }
 
 std::u32string Util::Utf8ToUtf32(absl::string_view str) {
@@ -511,6 +506,12 @@ bool Util::IsValidUtf8(absl::string_view s) {
   char32_t first;
   absl::string_view rest;
   while (!s.empty()) {
+    // ASCII runs are always valid.
+    s.remove_prefix(strings::SkipAscii(s.data(), s.data() + s.size()) -
+                    s.data());
+    if (s.empty()) {
+      break;
+    }
     if (!SplitFirstChar32(s, &first, &rest)) {
       return false;
     }
@@ -814,6 +815,22 @@ bool Util::IsEnglishTransliteration(absl::string_view value) {
 // TODO(yukawa, team): Make a mechanism to keep this classifier up-to-date
 //   based on the original data from Unicode.org.
 Util::ScriptType Util::GetScriptType(char32_t codepoint) {
+  // Fast paths for ASCII and kana, which are the most frequent.
+  if (codepoint < 0x80) {
+    const unsigned char c = static_cast<unsigned char>(codepoint);
+    if (absl::ascii_isdigit(c)) {
+      return NUMBER;
+    }
+    return absl::ascii_isalpha(c) ? ALPHABET : UNKNOWN_SCRIPT;
+  }
+  if (INRANGE(codepoint, 0x3041, 0x30FF)) {
+    if (codepoint <= 0x309F) {
+      return HIRAGANA;
+    }
+    // U+30A0 KATAKANA-HIRAGANA DOUBLE HYPHEN is neither.
+    return codepoint == 0x30A0 ? UNKNOWN_SCRIPT : KATAKANA;
+  }
+
   if (INRANGE(codepoint, 0x0030, 0x0039) ||  // ascii number
       INRANGE(codepoint, 0xFF10, 0xFF19)) {  // full width number
     return NUMBER;
@@ -993,27 +1010,50 @@ Util::ScriptType Util::GetScriptTypeWithoutSymbols(absl::string_view str) {
   return GetScriptTypeInternal(str, true);
 }
 
-// return true if all script_type in str is "type"
-bool Util::IsScriptType(absl::string_view str, Util::ScriptType type) {
-  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
-    const char32_t codepoint = iter.Get();
-    // Exception: 30FC (PROLONGEDSOUND MARK is categorized as HIRAGANA as well)
-    if (type != GetScriptType(codepoint) &&
-        (codepoint != 0x30FC || type != HIRAGANA)) {
+namespace {
+
+// Calls `f(codepoint)` for each character in `str` while it returns true, and
+// returns false if `f` returns false. Stops at an invalid UTF-8 sequence as
+// ConstChar32Iterator does. ASCII runs are found eight bytes at a time and
+// passed without decoding.
+template <typename Func>
+bool AllOfChar32(absl::string_view str, Func f) {
+  while (!str.empty()) {
+    const char* ascii_end =
+        strings::SkipAscii(str.data(), str.data() + str.size());
+    for (const char* ptr = str.data(); ptr != ascii_end; ++ptr) {
+      if (!f(static_cast<char32_t>(*ptr))) {
+        return false;
+      }
+    }
+    str.remove_prefix(ascii_end - str.data());
+    char32_t codepoint;
+    if (!Util::SplitFirstChar32(str, &codepoint, &str)) {
+      break;
+    }
+    if (!f(codepoint)) {
       return false;
     }
   }
   return true;
 }
 
+}  // namespace
+
+// return true if all script_type in str is "type"
+bool Util::IsScriptType(absl::string_view str, Util::ScriptType type) {
+  return AllOfChar32(str, [type](char32_t codepoint) {
+    // Exception: 30FC (PROLONGEDSOUND MARK is categorized as HIRAGANA as well)
+    return type == GetScriptType(codepoint) ||
+           (codepoint == 0x30FC && type == HIRAGANA);
+  });
+}
+
 // return true if the string contains script_type char
 bool Util::ContainsScriptType(absl::string_view str, ScriptType type) {
-  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
-    if (type == GetScriptType(iter.Get())) {
-      return true;
-    }
-  }
-  return false;
+  return !AllOfChar32(str, [type](char32_t codepoint) {
+    return type != GetScriptType(codepoint);
+  });
 }
 
 // return the Form Type of string
@@ -1021,15 +1061,16 @@ Util::FormType Util::GetFormType(absl::string_view str) {
   // TODO(hidehiko): get rid of using FORM_TYPE_SIZE.
   FormType result = FORM_TYPE_SIZE;
 
-  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
-    const FormType type = GetFormType(iter.Get());
+  const bool uniform = AllOfChar32(str, [&result](char32_t codepoint) {
+    const FormType type = GetFormType(codepoint);
     if (type == UNKNOWN_FORM || (result != FORM_TYPE_SIZE && type != result)) {
-      return UNKNOWN_FORM;
+      return false;
     }
     result = type;
-  }
+    return true;
+  });
 
-  return result;
+  return uniform ? result : UNKNOWN_FORM;
 }
 
 bool Util::IsAscii(absl::string_view str) {
@@ -670,6 +670,8 @@ TEST(UtilTest, ScriptType) {
   EXPECT_TRUE(Util::IsScriptType("abcABC", Util::ALPHABET));
   EXPECT_TRUE(Util::IsScriptType("ＡＢＣＤ", Util::ALPHABET));
   EXPECT_TRUE(Util::IsScriptType("@!#", Util::UNKNOWN_SCRIPT));
+  EXPECT_TRUE(Util::IsScriptType("0123456789012345", Util::NUMBER));
+  EXPECT_TRUE(Util::IsScriptType("abcdefghijklmnopＡＢＣ", Util::ALPHABET));
 
   EXPECT_FALSE(Util::IsScriptType("くどカう", Util::HIRAGANA));
   EXPECT_FALSE(Util::IsScriptType("京あ都", Util::KANJI));
@@ -681,6 +683,8 @@ TEST(UtilTest, ScriptType) {
   EXPECT_FALSE(Util::IsScriptType("ＡＢあＣＤ", Util::ALPHABET));
   EXPECT_FALSE(Util::IsScriptType("ぐーぐるグ", Util::HIRAGANA));
   EXPECT_FALSE(Util::IsScriptType("グーグルぐ", Util::KATAKANA));
+  EXPECT_FALSE(Util::IsScriptType("0123456789a12345", Util::NUMBER));
+  EXPECT_FALSE(Util::IsScriptType("abcdefghijklmno@", Util::ALPHABET));
 
   EXPECT_TRUE(Util::ContainsScriptType("グーグルsuggest", Util::ALPHABET));
   EXPECT_FALSE(Util::ContainsScriptType("グーグルサジェスト", Util::ALPHABET));
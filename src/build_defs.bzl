@@ -902,6 +902,12 @@ def mozc_select_enable_supplemental_model(on = [], off = []):
         "//conditions:default": off,
     })
 
+def mozc_select_enable_tracing(on = [], off = []):
+    return select({
+        "//:local_enable_tracing": on,
+        "//conditions:default": off,
+    })
+
 def mozc_select_enable_usage_rewriter(on = [], off = []):
     return select({
         "//:enable_usage_rewriter": on,
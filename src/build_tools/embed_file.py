@@ -124,7 +124,7 @@ def _EmbedAsUint64Array(input_path, name, output_file):
       #error "{name} was already included or defined elsewhere"
       #else
       #define MOZC_EMBEDDED_FILE_{name}
-      constexpr uint64_t {name}_data[] = {{
+      alignas(64) constexpr uint64_t {name}_data[] = {{
       """))
 
   with open(input_path, 'rb') as infile:
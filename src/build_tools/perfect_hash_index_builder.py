@@ -0,0 +1,150 @@
+# -*- coding: utf-8 -*-
+# Copyright 2010-2021, Google Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Generate a binary image of PerfectHashIndex."""
+import struct
+
+_MASK32 = 0xFFFFFFFF
+_MASK64 = 0xFFFFFFFFFFFFFFFF
+
+# The same parameters as base/container/perfect_hash_index.cc.
+_KEYS_PER_BUCKET = 4
+_MAX_SEED = 256
+_MIN_MAX_DISPLACEMENT = 1 << 16
+
+
+def Hash(key, seed):
+  """Returns 64-bit hash of key.  See PerfectHashIndex::Hash()."""
+  h = 0xCBF29CE484222325 ^ seed
+  for b in key:
+    h ^= b
+    h = (h * 0x100000001B3) & _MASK64
+  h ^= h >> 33
+  h = (h * 0xFF51AFD7ED558CCD) & _MASK64
+  h ^= h >> 33
+  h = (h * 0xC4CEB9FE1A85EC53) & _MASK64
+  h ^= h >> 33
+  return h
+
+
+def Mix32(h):
+  """Returns 32-bit mixed value of h.  See PerfectHashIndex::Mix32()."""
+  h ^= h >> 16
+  h = (h * 0x85EBCA6B) & _MASK32
+  h ^= h >> 13
+  h = (h * 0xC2B2AE35) & _MASK32
+  h ^= h >> 16
+  return h
+
+
+def _TryBuild(groups, num_buckets, seed):
+  """Returns (displacements, slot_to_group) or None on failure."""
+  num_keys = len(groups)
+  hashes = []
+  buckets = [[] for _ in range(num_buckets)]
+  for i, (key, _, _) in enumerate(groups):
+    h = Hash(key, seed)
+    hashes.append(h & _MASK32)
+    buckets[(h >> 32) % num_buckets].append(i)
+
+  # Place larger buckets first as they are harder to place.
+  order = sorted(range(num_buckets), key=lambda b: -len(buckets[b]))
+
+  displacements = [0] * num_buckets
+  slot_to_group = [None] * num_keys
+  max_displacement = max(_MIN_MAX_DISPLACEMENT, 64 * num_keys)
+  for b in order:
+    bucket = buckets[b]
+    if not bucket:
+      break
+    for d in range(max_displacement):
+      slots = []
+      for i in bucket:
+        slot = Mix32(hashes[i] ^ d) % num_keys
+        if slot_to_group[slot] is not None or slot in slots:
+          break
+        slots.append(slot)
+      if len(slots) == len(bucket):
+        for slot, i in zip(slots, bucket):
+          slot_to_group[slot] = i
+        displacements[b] = d
+        break
+    else:
+      return None
+  return (displacements, slot_to_group)
+
+
+def Build(keys):
+  """Builds a binary image of PerfectHashIndex.
+
+  For file format, see base/container/perfect_hash_index.h.
+
+  Args:
+    keys: A list of keys, where keys[i] is the key of the i-th entry of the
+      indexed array.  Entries of the same key must be contiguous.
+
+  Returns:
+    The binary image as bytes.
+  """
+  groups = []
+  seen = set()
+  for i, key in enumerate(keys):
+    if isinstance(key, str):
+      key = key.encode('utf-8')
+    if groups and groups[-1][0] == key:
+      groups[-1][2] = i + 1
+      continue
+    if key in seen:
+      raise ValueError('Entries of the same key must be contiguous: %r' % key)
+    seen.add(key)
+    groups.append([key, i, i + 1])
+
+  num_keys = len(groups)
+  num_buckets = (num_keys + _KEYS_PER_BUCKET - 1) // _KEYS_PER_BUCKET
+  for seed in range(_MAX_SEED):
+    result = _TryBuild(groups, num_buckets, seed)
+    if result is not None:
+      break
+  else:
+    raise RuntimeError('Failed to build a perfect hash index')
+  (displacements, slot_to_group) = result
+
+  values = [num_keys, num_buckets, seed]
+  values.extend(displacements)
+  for g in slot_to_group:
+    values.append(groups[g][1])
+    values.append(groups[g][2])
+  return struct.pack('<%dI' % len(values), *values)
+
+
+def BuildToFile(keys, filename):
+  """Builds a binary image of PerfectHashIndex and writes it to filename."""
+  with open(filename, 'wb') as f:
+    f.write(Build(keys))
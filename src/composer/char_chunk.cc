@@ -29,13 +29,16 @@
 
 #include "composer/char_chunk.h"
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/btree_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -123,12 +126,22 @@ CharChunk::CharChunk(Transliterators::Transliterator transliterator)
   DCHECK_NE(transliterator, Transliterators::LOCAL);
 }
 
+uint64_t CharChunk::NewRevision() {
+  static std::atomic<uint64_t> next_revision = 0;
+  return next_revision.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CharChunk::InvalidateCache() {
+  local_length_cache_ = std::string::npos;
+  revision_ = NewRevision();
+}
+
 void CharChunk::Clear() {
   raw_.clear();
   conversion_.clear();
   pending_.clear();
   ambiguous_.clear();
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
 }
 
 size_t CharChunk::GetLength(Transliterators::Transliterator t12r) const {
@@ -257,6 +270,26 @@ absl::btree_set<std::string> CharChunk::GetExpandedResults() const {
   return results;
 }
 
+std::vector<std::string> CharChunk::GetNextInputs() const {
+  std::vector<std::string> inputs;
+  if (pending_.empty()) {
+    return inputs;
+  }
+  std::vector<const Entry*> entries;
+  table_->LookUpPredictiveAll(pending_, &entries);
+  for (const Entry* entry : entries) {
+    if (entry->result().empty() || entry->input().size() <= pending_.size()) {
+      continue;
+    }
+    const absl::string_view input = entry->input().substr(pending_.size());
+    if (Util::CharsLen(input) != 1 || absl::c_linear_search(inputs, input)) {
+      continue;
+    }
+    inputs.emplace_back(input);
+  }
+  return inputs;
+}
+
 bool CharChunk::IsFixed() const { return pending_.empty(); }
 
 bool CharChunk::IsAppendable(Transliterators::Transliterator t12r,
@@ -284,7 +317,7 @@ bool CharChunk::IsConvertible(Transliterators::Transliterator t12r,
 void CharChunk::Combine(const CharChunk& left_chunk) {
   conversion_ = left_chunk.conversion_ + conversion_;
   raw_ = left_chunk.raw_ + raw_;
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
   // TODO(komatsu): This is a hacky way.  We should look up the
   // conversion table with the new |raw_| value.
   if (left_chunk.ambiguous_.empty()) {
@@ -308,7 +341,7 @@ std::pair<bool, absl::string_view> CharChunk::AddInputInternal(
   bool fixed = false;
   std::string key = absl::StrCat(pending_, input);
   const Entry* entry = table_->LookUpPrefix(key, &used_key_length, &fixed);
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
 
   if (entry == nullptr) {
     if (used_key_length == 0) {
@@ -427,7 +460,7 @@ void CharChunk::AddInput(std::string* input) {
 }
 
 void CharChunk::AddInputAndConvertedChar(CompositionInput* input) {
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
 
   if (input->is_asis()) {
     if (raw_.empty() && pending_.empty() && conversion_.empty()) {
@@ -525,7 +558,7 @@ bool CharChunk::ShouldInsertNewChunk(const CompositionInput& input) const {
 }
 
 void CharChunk::AddCompositionInput(CompositionInput* input) {
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
   if (!input->conversion().empty()) {
     AddInputAndConvertedChar(input);
     return;
@@ -544,13 +577,13 @@ void CharChunk::SetTransliterator(
     // Just ignore.
     return;
   }
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
   transliterator_ = transliterator;
 }
 
 void CharChunk::set_attributes(TableAttributes attributes) {
   attributes_ = attributes;
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
 }
 
 absl::StatusOr<CharChunk> CharChunk::SplitChunk(
@@ -560,7 +593,7 @@ absl::StatusOr<CharChunk> CharChunk::SplitChunk(
         absl::StrCat("Invalid position: ", position));
   }
 
-  local_length_cache_ = std::string::npos;
+  InvalidateCache();
   std::string raw_lhs, raw_rhs, converted_lhs, converted_rhs;
   Transliterators::GetTransliterator(GetTransliterator(t12r))
       ->Split(position, DeleteSpecialKeys(raw_),
@@ -31,10 +31,12 @@
 #define MOZC_COMPOSER_CHAR_CHUNK_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/container/btree_set.h"
@@ -85,6 +87,10 @@ class CharChunk final {
 
   // Get possible results from current chunk
   absl::btree_set<std::string> GetExpandedResults() const;
+  // Returns the inputs which turn the pending string into a table entry with a
+  // result, e.g. {"a", "e", "i", "o", "u"} for the pending "k". The inputs are
+  // in the order of the table.
+  std::vector<std::string> GetNextInputs() const;
   bool IsFixed() const;
 
   // True if IsAppendable() is true and this object is fixed (|pending_|=="")
@@ -141,7 +147,8 @@ class CharChunk final {
                             absl::string_view raw,
                             absl::string_view converted) const;
 
-  // The following accessors and mutators are for test only.
+  // The following accessors and mutators are for tests and for saving and
+  // restoring the chunk (see Composer::SaveState).
   Transliterators::Transliterator transliterator() const {
     return transliterator_;
   }
@@ -151,33 +158,38 @@ class CharChunk final {
   template <typename String>
   void set_raw(String&& raw) {
     strings::Assign(raw_, std::forward<String>(raw));
-    local_length_cache_ = std::string::npos;
+    InvalidateCache();
   }
 
   absl::string_view conversion() const { return conversion_; }
   template <typename String>
   void set_conversion(String&& conversion) {
     strings::Assign(conversion_, std::forward<String>(conversion));
-    local_length_cache_ = std::string::npos;
+    InvalidateCache();
   }
 
   absl::string_view pending() const { return pending_; }
   template <typename String>
   void set_pending(String&& pending) {
     strings::Assign(pending_, std::forward<String>(pending));
-    local_length_cache_ = std::string::npos;
+    InvalidateCache();
   }
 
   absl::string_view ambiguous() const { return ambiguous_; }
   template <typename String>
   void set_ambiguous(String&& ambiguous) {
     strings::Assign(ambiguous_, std::forward<String>(ambiguous));
-    local_length_cache_ = std::string::npos;
+    InvalidateCache();
   }
 
   TableAttributes attributes() const { return attributes_; }
   void set_attributes(TableAttributes attributes);
 
+  // Returns the revision of this chunk. A new revision, never used by any
+  // other chunk, is assigned whenever the chunk is modified. So a result
+  // computed from this chunk stays valid while the revision is unchanged.
+  uint64_t revision() const { return revision_; }
+
   friend bool operator==(const CharChunk& lhs, const CharChunk& rhs) {
     return std::tie(lhs.table_, lhs.raw_, lhs.conversion_, lhs.pending_,
                     lhs.ambiguous_, lhs.transliterator_, lhs.attributes_) ==
@@ -204,6 +216,11 @@ class CharChunk final {
   std::pair<bool, absl::string_view> AddInputInternal(absl::string_view input);
 
  private:
+  static uint64_t NewRevision();
+
+  // Drops the cached length and assigns a new revision.
+  void InvalidateCache();
+
   void AddInputAndConvertedChar(CompositionInput* composition_input);
 
   std::shared_ptr<const Table> table_;
@@ -240,6 +257,7 @@ class CharChunk final {
   TableAttributes attributes_ = NO_TABLE_ATTRIBUTE;
   // for thread safety.
   mutable CopyableAtomic<std::size_t> local_length_cache_{std::string::npos};
+  uint64_t revision_ = NewRevision();
 };
 
 }  // namespace composer
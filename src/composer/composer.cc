@@ -31,6 +31,7 @@
 
 #include "composer/composer.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -51,8 +52,10 @@
 #include "base/japanese_util.h"
 #include "base/strings/assign.h"
 #include "base/strings/unicode.h"
+#include "base/trace.h"
 #include "base/util.h"
 #include "base/vlog.h"
+#include "composer/char_chunk.h"
 #include "composer/composition.h"
 #include "composer/composition_input.h"
 #include "composer/key_event_util.h"
@@ -63,6 +66,7 @@
 #include "config/config_handler.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "transliteration/transliteration.h"
 
 namespace mozc {
@@ -72,6 +76,15 @@ namespace {
 using ::mozc::config::CharacterFormManager;
 using ::mozc::strings::OneCharLen;
 
+bool IsValidTransliterationType(int32_t type) {
+  return type >= 0 && type < transliteration::NUM_T13N_TYPES;
+}
+
+// LOCAL is not a valid transliterator of a chunk nor of the input.
+bool IsValidTransliterator(int32_t t12r) {
+  return t12r >= 0 && t12r < Transliterators::LOCAL;
+}
+
 Transliterators::Transliterator GetTransliterator(
     transliteration::TransliterationType comp_mode) {
   switch (comp_mode) {
@@ -586,6 +599,75 @@ void Composer::Reset() {
   compositions_for_handwriting_.clear();
 }
 
+Composer Composer::CreateResetComposer() const {
+  // The constructor calls Reset().
+  Composer composer(table_, request_, config_);
+  composer.SetInputMode(comeback_input_mode_);
+  composer.input_field_type_ = input_field_type_;
+  composer.max_length_ = max_length_;
+  composer.timestamp_msec_ = timestamp_msec_;
+  return composer;
+}
+
+void Composer::SaveState(protocol::ComposerState* state) const {
+  state->set_input_mode(input_mode_);
+  state->set_comeback_input_mode(comeback_input_mode_);
+  state->set_output_mode(output_mode_);
+  state->set_shifted_sequence_count(shifted_sequence_count_);
+  state->set_input_transliterator(composition_.input_t12r());
+  for (const CharChunk& chunk : composition_.chunks()) {
+    protocol::ComposerState::CharChunk* saved = state->add_chunks();
+    saved->set_transliterator(chunk.transliterator());
+    saved->set_raw(chunk.raw());
+    saved->set_conversion(chunk.conversion());
+    saved->set_pending(chunk.pending());
+    saved->set_ambiguous(chunk.ambiguous());
+    saved->set_attributes(chunk.attributes());
+  }
+  state->set_cursor(position_);
+  state->set_source_text(source_text_);
+  state->set_is_new_input(is_new_input_);
+}
+
+void Composer::RestoreState(const protocol::ComposerState& state) {
+  Reset();
+  if (IsValidTransliterationType(state.comeback_input_mode())) {
+    SetInputMode(static_cast<transliteration::TransliterationType>(
+        state.comeback_input_mode()));
+  }
+  if (state.input_mode() != state.comeback_input_mode() &&
+      IsValidTransliterationType(state.input_mode())) {
+    SetTemporaryInputMode(static_cast<transliteration::TransliterationType>(
+        state.input_mode()));
+  }
+  if (IsValidTransliterationType(state.output_mode())) {
+    output_mode_ =
+        static_cast<transliteration::TransliterationType>(state.output_mode());
+  }
+  shifted_sequence_count_ = state.shifted_sequence_count();
+  if (IsValidTransliterator(state.input_transliterator())) {
+    composition_.SetInputMode(static_cast<Transliterators::Transliterator>(
+        state.input_transliterator()));
+  }
+
+  for (const protocol::ComposerState::CharChunk& saved : state.chunks()) {
+    const Transliterators::Transliterator t12r =
+        IsValidTransliterator(saved.transliterator())
+            ? static_cast<Transliterators::Transliterator>(
+                  saved.transliterator())
+            : Transliterators::CONVERSION_STRING;
+    CharChunk& chunk = composition_.AppendChunk(t12r);
+    chunk.set_raw(saved.raw());
+    chunk.set_conversion(saved.conversion());
+    chunk.set_pending(saved.pending());
+    chunk.set_ambiguous(saved.ambiguous());
+    chunk.set_attributes(saved.attributes());
+  }
+  position_ = std::min<size_t>(state.cursor(), composition_.GetLength());
+  source_text_ = state.source_text();
+  is_new_input_ = state.is_new_input();
+}
+
 void Composer::ResetInputMode() { SetInputMode(comeback_input_mode_); }
 
 void Composer::ReloadConfig() {
@@ -852,6 +934,7 @@ bool Composer::InsertCharacterKeyAndPreedit(const absl::string_view key,
 }
 
 bool Composer::InsertCharacterKeyEvent(const commands::KeyEvent& key) {
+  MOZC_TRACE_SPAN("Composer::InsertCharacterKeyEvent");
   if (!EnableInsert()) {
     return false;
   }
@@ -1046,6 +1129,15 @@ Composer::GetQueriesForPrediction() const {
   return common::GetQueriesForPrediction(composition_, input_mode_);
 }
 
+std::vector<std::string> Composer::GetNextInputsForPrediction() const {
+  if (input_mode_ == transliteration::HALF_ASCII ||
+      input_mode_ == transliteration::FULL_ASCII ||
+      GetCursor() != GetLength()) {
+    return {};
+  }
+  return composition_.GetNextInputs();
+}
+
 std::string Composer::GetStringForTypeCorrection() const {
   return common::GetStringForTypeCorrection(composition_);
 }
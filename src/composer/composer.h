@@ -49,6 +49,7 @@
 #include "composer/transliterators.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "transliteration/transliteration.h"
 
 namespace mozc {
@@ -185,6 +186,17 @@ class Composer final {
   // Reset all composing data except table.
   void Reset();
 
+  // Returns a composer in the same state as a copy of this composer after
+  // Reset(), without copying the composition.
+  Composer CreateResetComposer() const;
+
+  // Saves the composition and the input modes to `state`, and restores them.
+  // The chunks are restored as they are, so the preedit is reproduced
+  // exactly including the segments typed in another input mode or
+  // transliterated by the user. Used to hibernate idle sessions.
+  void SaveState(protocol::ComposerState* state) const;
+  void RestoreState(const protocol::ComposerState& state);
+
   // Reset input mode.  When the current input mode is
   // HalfAlphanumeric by pressing shifted alphabet, this function
   // revert the input mode from HalfAlphanumeric to the previous input
@@ -244,6 +256,12 @@ class Composer final {
   // Returns a string to be used for type correction.
   std::string GetStringForTypeCorrection() const;
 
+  // Returns the inputs likely to come next, i.e. the inputs which resolve the
+  // pending romaji at the end of the composition, e.g. {"a", "e", "i", "o",
+  // "u"} for "かんk". Returns an empty vector in the Latin input modes or when
+  // the cursor is not at the end.
+  std::vector<std::string> GetNextInputsForPrediction() const;
+
   size_t GetLength() const;
   size_t GetCursor() const;
   void EditErase();
@@ -49,6 +49,8 @@
 #include "config/config_handler.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
+#include "testing/gmock.h"
 #include "testing/gunit.h"
 #include "testing/test_peer.h"
 #include "transliteration/transliteration.h"
@@ -70,6 +72,7 @@ using ::mozc::commands::KeyEvent;
 using ::mozc::commands::Request;
 using ::mozc::config::CharacterFormManager;
 using ::mozc::config::Config;
+using ::testing::ElementsAre;
 
 bool InsertKey(const absl::string_view key_string, Composer* composer) {
   commands::KeyEvent key;
@@ -154,6 +157,24 @@ TEST_F(ComposerTest, Reset) {
   EXPECT_EQ(composer_->GetOutputMode(), transliteration::HIRAGANA);
 }
 
+TEST_F(ComposerTest, CreateResetComposer) {
+  composer_->InsertCharacter("mozuku");
+  composer_->SetInputMode(transliteration::FULL_KATAKANA);
+  composer_->SetTemporaryInputMode(transliteration::HALF_ASCII);
+  composer_->SetOutputMode(transliteration::HALF_ASCII);
+  composer_->SetInputFieldType(commands::Context::PASSWORD);
+  composer_->set_max_length(6);
+
+  const Composer reset = composer_->CreateResetComposer();
+  composer_->Reset();
+
+  EXPECT_TRUE(reset.Empty());
+  EXPECT_EQ(reset.GetInputMode(), composer_->GetInputMode());
+  EXPECT_EQ(reset.GetOutputMode(), composer_->GetOutputMode());
+  EXPECT_EQ(reset.GetInputFieldType(), composer_->GetInputFieldType());
+  EXPECT_EQ(reset.max_length(), composer_->max_length());
+}
+
 TEST_F(ComposerTest, ResetInputMode) {
   composer_->InsertCharacter("mozuku");
 
@@ -504,6 +525,30 @@ TEST_F(ComposerTest, GetQueriesForPredictionRoman) {
   }
 }
 
+TEST_F(ComposerTest, GetNextInputsForPrediction) {
+  table_->AddRule("u", "う", "");
+  table_->AddRule("ss", "っ", "s");
+  table_->AddRule("sa", "さ", "");
+  table_->AddRule("si", "し", "");
+  table_->AddRule("sya", "しゃ", "");
+
+  composer_->EditErase();
+  composer_->InsertCharacter("u");
+  EXPECT_TRUE(composer_->GetNextInputsForPrediction().empty());
+
+  composer_->InsertCharacter("s");
+  EXPECT_THAT(composer_->GetNextInputsForPrediction(),
+              ElementsAre("a", "i", "s"));
+
+  // The next input is inserted at the cursor.
+  composer_->MoveCursorLeft();
+  EXPECT_TRUE(composer_->GetNextInputsForPrediction().empty());
+  composer_->MoveCursorRight();
+
+  composer_->SetInputMode(transliteration::HALF_ASCII);
+  EXPECT_TRUE(composer_->GetNextInputsForPrediction().empty());
+}
+
 TEST_F(ComposerTest, GetQueriesForPredictionMobile) {
   table_->AddRule("_", "", "い");
   table_->AddRule("い*", "", "ぃ");
@@ -1127,6 +1172,76 @@ TEST_F(ComposerTest, Copy) {
   }
 }
 
+TEST_F(ComposerTest, SaveAndRestoreState) {
+  table_->AddRule("a", "あ", "");
+  table_->AddRule("n", "ん", "");
+  table_->AddRule("na", "な", "");
+
+  auto save_and_restore = [this](const Composer& composer) {
+    protocol::ComposerState state;
+    composer.SaveState(&state);
+    Composer restored(table_, request_, config_);
+    restored.RestoreState(state);
+    return restored;
+  };
+
+  {
+    SCOPED_TRACE("Precomposition");
+
+    ExpectSameComposer(*composer_, save_and_restore(*composer_));
+  }
+
+  {
+    SCOPED_TRACE("Composition with pending input");
+
+    composer_->InsertCharacter("a");
+    composer_->InsertCharacter("n");
+    EXPECT_EQ(composer_->GetStringForSubmission(), "あｎ");
+
+    // The pending "n" is kept and combined with the next input.
+    Composer restored = save_and_restore(*composer_);
+    ExpectSameComposer(*composer_, restored);
+    restored.InsertCharacter("a");
+    EXPECT_EQ(restored.GetStringForPreedit(), "あな");
+  }
+
+  {
+    SCOPED_TRACE("Composition with temporary input mode");
+
+    composer_->Reset();
+    InsertKey("a", composer_.get());
+    InsertKey("A", composer_.get());
+    InsertKey("A", composer_.get());
+    InsertKey("a", composer_.get());
+    InsertKey("A", composer_.get());
+    EXPECT_EQ(composer_->GetStringForPreedit(), "あAAあA");
+    EXPECT_EQ(composer_->GetInputMode(), transliteration::HALF_ASCII);
+
+    Composer restored = save_and_restore(*composer_);
+    ExpectSameComposer(*composer_, restored);
+    InsertKey("a", composer_.get());
+    InsertKey("a", &restored);
+    ExpectSameComposer(*composer_, restored);
+    EXPECT_EQ(restored.GetStringForPreedit(), "あAAあAa");
+  }
+
+  {
+    SCOPED_TRACE("Composition with the cursor in the middle");
+
+    composer_->MoveCursorLeft();
+    composer_->MoveCursorLeft();
+    composer_->set_source_text("source");
+    ExpectSameComposer(*composer_, save_and_restore(*composer_));
+  }
+
+  {
+    SCOPED_TRACE("Composition with output mode");
+
+    composer_->SetOutputMode(transliteration::FULL_KATAKANA);
+    ExpectSameComposer(*composer_, save_and_restore(*composer_));
+  }
+}
+
 TEST_F(ComposerTest, ShiftKeyOperation) {
   table_->AddRule("a", "あ", "");
 
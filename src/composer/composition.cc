@@ -29,11 +29,14 @@
 
 #include "composer/composition.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/btree_set.h"
@@ -52,7 +55,19 @@
 namespace mozc {
 namespace composer {
 
-void Composition::Erase() { chunks_.clear(); }
+namespace {
+
+// The number of cached chunks to look ahead for an unchanged chunk when the
+// cached prefix is patched. It is enough to skip over a few deleted chunks.
+constexpr size_t kMaxPrefixLookahead = 4;
+
+}  // namespace
+
+void Composition::Erase() {
+  chunks_.clear();
+  prefix_cache_.clear();
+  prefix_chunks_.clear();
+}
 
 size_t Composition::InsertAt(size_t pos, std::string input) {
   CompositionInput composition_input;
@@ -99,6 +114,7 @@ size_t Composition::InsertInput(size_t pos, CompositionInput input) {
     chunks_.erase(left_chunk);
   }
 
+  UpdatePrefixCache();
   return GetPosition(Transliterators::LOCAL, right_chunk);
 }
 
@@ -133,6 +149,7 @@ size_t Composition::DeleteAt(const size_t position) {
       LOG(WARNING) << "SplitChunk: " << left_deleted_chunk.status();
     }
   }
+  UpdatePrefixCache();
   return new_position;
 }
 
@@ -221,6 +238,7 @@ void Composition::SetTransliterator(
     ++chunk_it;
   }
   end_it->SetTransliterator(transliterator);
+  UpdatePrefixCache();
 }
 
 Transliterators::Transliterator Composition::GetTransliterator(
@@ -245,21 +263,25 @@ std::string Composition::GetStringWithModes(
     return std::string();
   }
 
-  CharChunkList::const_iterator it;
   std::string composition;
-  for (it = chunks_.begin(); it != std::prev(chunks_.end()); ++it) {
-    it->AppendResult(transliterator, &composition);
+  if (transliterator == Transliterators::LOCAL) {
+    AppendPrefix(&composition);
+  } else {
+    for (auto it = chunks_.begin(); it != std::prev(chunks_.end()); ++it) {
+      it->AppendResult(transliterator, &composition);
+    }
   }
 
+  const CharChunk& last_chunk = chunks_.back();
   switch (trim_mode) {
     case TRIM:
-      it->AppendTrimedResult(transliterator, &composition);
+      last_chunk.AppendTrimedResult(transliterator, &composition);
       break;
     case ASIS:
-      it->AppendResult(transliterator, &composition);
+      last_chunk.AppendResult(transliterator, &composition);
       break;
     case FIX:
-      it->AppendFixedResult(transliterator, &composition);
+      last_chunk.AppendFixedResult(transliterator, &composition);
       break;
     default:
       LOG(WARNING) << "Unexpected trim mode: " << trim_mode;
@@ -277,11 +299,7 @@ Composition::GetExpandedStrings() const {
   }
 
   std::string base;
-  CharChunkList::const_iterator it;
-  for (it = chunks_.begin(); it != std::prev(chunks_.end()); ++it) {
-    it->AppendResult(transliterator, &base);
-  }
-
+  AppendPrefix(&base);
   chunks_.back().AppendTrimedResult(transliterator, &base);
   // Get expanded from the last chunk
   const absl::btree_set<std::string> expanded =
@@ -289,6 +307,13 @@ Composition::GetExpandedStrings() const {
   return std::make_pair(base, expanded);
 }
 
+std::vector<std::string> Composition::GetNextInputs() const {
+  if (chunks_.empty()) {
+    return {};
+  }
+  return chunks_.back().GetNextInputs();
+}
+
 std::string Composition::GetString() const {
   if (chunks_.empty()) {
     MOZC_VLOG(1) << "The composition size is zero.";
@@ -296,13 +321,82 @@ std::string Composition::GetString() const {
   }
 
   std::string composition;
-  for (CharChunkList::const_iterator it = chunks_.begin(); it != chunks_.end();
-       ++it) {
-    it->AppendResult(Transliterators::LOCAL, &composition);
-  }
+  AppendPrefix(&composition);
+  chunks_.back().AppendResult(Transliterators::LOCAL, &composition);
   return composition;
 }
 
+void Composition::AppendPrefix(std::string* result) const {
+  DCHECK(!chunks_.empty());
+  if (IsPrefixCacheValid()) {
+    result->append(prefix_cache_);
+    return;
+  }
+  for (auto it = chunks_.begin(); it != std::prev(chunks_.end()); ++it) {
+    it->AppendResult(Transliterators::LOCAL, result);
+  }
+}
+
+bool Composition::IsPrefixCacheValid() const {
+  if (chunks_.size() != prefix_chunks_.size() + 1) {
+    return false;
+  }
+  auto it = chunks_.begin();
+  for (const auto& [revision, end] : prefix_chunks_) {
+    if (it->revision() != revision) {
+      return false;
+    }
+    ++it;
+  }
+  return true;
+}
+
+void Composition::UpdatePrefixCache() {
+  const size_t prefix_size = chunks_.empty() ? 0 : chunks_.size() - 1;
+
+  // Keep the results of the leading chunks which are not modified.
+  size_t num_kept = 0;
+  auto it = chunks_.begin();
+  while (num_kept < prefix_size && num_kept < prefix_chunks_.size() &&
+         it->revision() == prefix_chunks_[num_kept].first) {
+    ++num_kept;
+    ++it;
+  }
+  if (num_kept == prefix_size && num_kept == prefix_chunks_.size()) {
+    return;
+  }
+
+  const std::string old_cache = std::move(prefix_cache_);
+  const std::vector<std::pair<uint64_t, size_t>> old_chunks =
+      std::move(prefix_chunks_);
+  prefix_chunks_.assign(old_chunks.begin(), old_chunks.begin() + num_kept);
+  prefix_cache_.assign(old_cache, 0,
+                       num_kept == 0 ? 0 : prefix_chunks_.back().second);
+
+  // Patch the rest. The results of the chunks following the modified ones
+  // are copied from the old cache instead of being transliterated again.
+  size_t old_index = num_kept;
+  for (size_t i = num_kept; i < prefix_size; ++i, ++it) {
+    const uint64_t revision = it->revision();
+    const auto lookahead_end =
+        old_chunks.begin() +
+        std::min(old_index + kMaxPrefixLookahead, old_chunks.size());
+    const auto found = std::find_if(
+        old_chunks.begin() + old_index, lookahead_end,
+        [revision](const auto& entry) { return entry.first == revision; });
+    if (found == lookahead_end) {
+      it->AppendResult(Transliterators::LOCAL, &prefix_cache_);
+    } else {
+      old_index = found - old_chunks.begin();
+      const size_t begin =
+          old_index == 0 ? 0 : old_chunks[old_index - 1].second;
+      prefix_cache_.append(old_cache, begin, found->second - begin);
+      ++old_index;
+    }
+    prefix_chunks_.emplace_back(revision, prefix_cache_.size());
+  }
+}
+
 std::string Composition::GetStringWithTransliterator(
     Transliterators::Transliterator transliterator) const {
   return GetStringWithModes(transliterator, FIX);
@@ -418,6 +512,12 @@ CharChunkList::iterator Composition::InsertChunk(
   return chunks_.insert(it, CharChunk(input_t12r_, table_));
 }
 
+CharChunk& Composition::AppendChunk(
+    Transliterators::Transliterator transliterator) {
+  DCHECK_NE(transliterator, Transliterators::LOCAL);
+  return chunks_.emplace_back(transliterator, table_);
+}
+
 const CharChunkList& Composition::GetCharChunkList() const { return chunks_; }
 
 bool Composition::ShouldCommit() const {
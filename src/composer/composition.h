@@ -31,11 +31,13 @@
 #define MOZC_COMPOSER_COMPOSITION_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/btree_set.h"
 #include "absl/log/check.h"
@@ -137,6 +139,8 @@ class Composition final {
   // Get string with consideration for ambiguity from pending input
   std::pair<std::string, absl::btree_set<std::string>> GetExpandedStrings()
       const;
+  // Get the inputs which resolve the pending input of the last chunk.
+  std::vector<std::string> GetNextInputs() const;
   void GetPreedit(size_t position, std::string* left, std::string* focused,
                   std::string* right) const;
 
@@ -149,6 +153,10 @@ class Composition final {
 
   bool IsToggleable(size_t position) const;
 
+  // Appends an empty chunk with the local `transliterator` to the end and
+  // returns it. Used to restore a saved composition.
+  CharChunk& AppendChunk(Transliterators::Transliterator transliterator);
+
   // Following methods are declared as public for unit test.
 
   // Return the focused CharChunk iterator at the `position`,
@@ -222,10 +230,28 @@ class Composition final {
   std::string GetStringWithModes(Transliterators::Transliterator transliterator,
                                  TrimMode trim_mode) const;
 
+  // Appends the LOCAL results of all the chunks but the last one. The cached
+  // prefix is used if it is still valid.
+  void AppendPrefix(std::string* result) const;
+  bool IsPrefixCacheValid() const;
+  // Brings the cached prefix up to date with `chunks_`. Only the results of
+  // the chunks modified since the last update are recomputed.
+  void UpdatePrefixCache();
+
   std::shared_ptr<const Table> table_;
   CharChunkList chunks_;
   Transliterators::Transliterator input_t12r_ =
       Transliterators::CONVERSION_STRING;
+
+  // The LOCAL results of all the chunks but the last one, i.e. the part of the
+  // preedit which usually does not change while the user is typing at the
+  // end. `prefix_chunks_` holds the revision of each of those chunks and the
+  // end offset of its result in `prefix_cache_`. The cache is only written by
+  // the non-const methods, so concurrent reads of a const Composition are
+  // safe. If the chunks are modified through the iterators for testing, the
+  // revisions do not match and the strings are computed from the chunks.
+  std::string prefix_cache_;
+  std::vector<std::pair<uint64_t, size_t>> prefix_chunks_;
 };
 
 }  // namespace composer
@@ -739,6 +739,46 @@ TEST_F(CompositionTest, GetStringWithTrimMode) {
   EXPECT_EQ(output_fix, "かん");
 }
 
+TEST_F(CompositionTest, GetStringAfterEditingInTheMiddle) {
+  table_->AddRule("ka", "か", "");
+  table_->AddRule("ki", "き", "");
+  table_->AddRule("ku", "く", "");
+  table_->AddRule("n", "ん", "");
+  table_->AddRule("na", "な", "");
+
+  // Concatenates the results of the chunks without the cached prefix.
+  auto get_string_from_chunks = [this]() {
+    std::string result;
+    for (const CharChunk& chunk : composition_.GetCharChunkList()) {
+      chunk.AppendResult(Transliterators::LOCAL, &result);
+    }
+    return result;
+  };
+
+  InsertCharacters("kakiku", 0, composition_);
+  EXPECT_EQ(composition_.GetString(), "かきく");
+
+  composition_.InsertAt(1, "n");
+  EXPECT_EQ(composition_.GetString(), "かnきく");
+  EXPECT_EQ(composition_.GetString(), get_string_from_chunks());
+  EXPECT_EQ(composition_.GetStringWithTrimMode(FIX), "かnきく");
+
+  composition_.DeleteAt(2);
+  EXPECT_EQ(composition_.GetString(), "かnく");
+  EXPECT_EQ(composition_.GetString(), get_string_from_chunks());
+
+  composition_.SetTransliterator(0, 1, Transliterators::HALF_ASCII);
+  EXPECT_EQ(composition_.GetString(), "kanく");
+  EXPECT_EQ(composition_.GetString(), get_string_from_chunks());
+
+  const Composition copied = composition_;
+  EXPECT_EQ(copied.GetString(), "kanく");
+
+  composition_.Erase();
+  EXPECT_EQ(composition_.GetString(), "");
+  EXPECT_EQ(copied.GetString(), "kanく");
+}
+
 TEST_F(CompositionTest, InsertKeyAndPreeditAt) {
   table_->AddRule("す゛", "ず", "");
   table_->AddRule("く゛", "ぐ", "");
@@ -351,6 +351,7 @@ const Entry* absl_nullable Table::AddRule(const absl::string_view input,
 const Entry* absl_nullable Table::AddRuleWithAttributes(
     const absl::string_view escaped_input, const absl::string_view output,
     const absl::string_view escaped_pending, const TableAttributes attributes) {
+  Decompile();
   if (attributes & NEW_CHUNK) {
     // TODO(komatsu): Make a new trie tree for checking the new chunk
     // attribute rather than reusing the conversion trie.
@@ -409,6 +410,7 @@ void Table::DeleteRule(const absl::string_view input) {
   //     - This method is not used.
   //     - This method has no tests.
   //     - This method is private scope.
+  Decompile();
   const Entry* old_entry;
   if (entries_.LookUp(input, &old_entry)) {
     DeleteEntry(old_entry);
@@ -490,39 +492,87 @@ bool Table::LoadFromStream(std::istream* is) {
   return true;
 }
 
+void Table::Compile() {
+  if (compiled_) {
+    return;
+  }
+  std::vector<std::pair<std::string, const Entry*>> entries;
+  entries.reserve(entry_set_.size());
+  for (const std::unique_ptr<Entry>& entry : entry_set_) {
+    entries.emplace_back(entry->input(), entry.get());
+  }
+  compiled_entries_ = DoubleArrayTrie<const Entry*>(std::move(entries));
+  EntryTrie().swap(entries_);
+  compiled_ = true;
+}
+
+void Table::Decompile() {
+  if (!compiled_) {
+    return;
+  }
+  for (const std::unique_ptr<Entry>& entry : entry_set_) {
+    entries_.AddEntry(entry->input(), entry.get());
+  }
+  compiled_entries_ = DoubleArrayTrie<const Entry*>();
+  compiled_ = false;
+}
+
+size_t Table::GetMemoryUsage() const {
+  size_t bytes = compiled_entries_.GetMemoryUsage();
+  for (const std::unique_ptr<Entry>& entry : entry_set_) {
+    bytes += sizeof(Entry) + entry->input().size() + entry->result().size() +
+             entry->pending().size();
+  }
+  if (!compiled_) {
+    // A rough estimate: a node of the pointer trie per rule.
+    bytes += entry_set_.size() * sizeof(EntryTrie);
+  }
+  return bytes;
+}
+
+absl::string_view Table::NormalizeInput(const absl::string_view input,
+                                        std::string* buffer) const {
+  if (case_sensitive_) {
+    return input;
+  }
+  buffer->assign(input);
+  Util::LowerString(buffer);
+  return *buffer;
+}
+
 const Entry* Table::LookUp(const absl::string_view input) const {
+  std::string buffer;
+  const absl::string_view key = NormalizeInput(input, &buffer);
   const Entry* entry = nullptr;
-  if (case_sensitive_) {
-    entries_.LookUp(input, &entry);
+  if (compiled_) {
+    compiled_entries_.LookUp(key, &entry);
   } else {
-    std::string normalized_input(input);
-    Util::LowerString(&normalized_input);
-    entries_.LookUp(normalized_input, &entry);
+    entries_.LookUp(key, &entry);
   }
   return entry;
 }
 
 const Entry* Table::LookUpPrefix(const absl::string_view input,
                                  size_t* key_length, bool* fixed) const {
+  std::string buffer;
+  const absl::string_view key = NormalizeInput(input, &buffer);
   const Entry* entry = nullptr;
-  if (case_sensitive_) {
-    entries_.LookUpPrefix(input, &entry, key_length, fixed);
+  if (compiled_) {
+    compiled_entries_.LookUpPrefix(key, &entry, key_length, fixed);
   } else {
-    std::string normalized_input(input);
-    Util::LowerString(&normalized_input);
-    entries_.LookUpPrefix(normalized_input, &entry, key_length, fixed);
+    entries_.LookUpPrefix(key, &entry, key_length, fixed);
   }
   return entry;
 }
 
 void Table::LookUpPredictiveAll(const absl::string_view input,
                                 std::vector<const Entry*>* results) const {
-  if (case_sensitive_) {
-    entries_.LookUpPredictiveAll(input, results);
+  std::string buffer;
+  const absl::string_view key = NormalizeInput(input, &buffer);
+  if (compiled_) {
+    compiled_entries_.LookUpPredictiveAll(key, results);
   } else {
-    std::string normalized_input(input);
-    Util::LowerString(&normalized_input);
-    entries_.LookUpPredictiveAll(normalized_input, results);
+    entries_.LookUpPredictiveAll(key, results);
   }
 }
 
@@ -543,13 +593,10 @@ bool Table::HasNewChunkEntry(const absl::string_view input) const {
 }
 
 bool Table::HasSubRules(const absl::string_view input) const {
-  if (case_sensitive_) {
-    return entries_.HasSubTrie(input);
-  } else {
-    std::string normalized_input(input);
-    Util::LowerString(&normalized_input);
-    return entries_.HasSubTrie(normalized_input);
-  }
+  std::string buffer;
+  const absl::string_view key = NormalizeInput(input, &buffer);
+  return compiled_ ? compiled_entries_.HasSubTrie(key)
+                   : entries_.HasSubTrie(key);
 }
 
 void Table::DeleteEntry(const Entry* entry) { entry_set_.erase(entry); }
@@ -612,6 +659,8 @@ std::shared_ptr<const Table> TableManager::GetTable(
   if (!table->InitializeWithRequestAndConfig(request, config)) {
     return nullptr;
   }
+  // The table is shared by all the sessions and never modified from now on.
+  table->Compile();
 
   table_map_.emplace(hash, table);
   return table;
@@ -619,5 +668,13 @@ std::shared_ptr<const Table> TableManager::GetTable(
 
 void TableManager::ClearCaches() { table_map_.clear(); }
 
+void TableManager::CollectMemoryUsage(MemoryUsageCollector& collector) const {
+  size_t bytes = 0;
+  for (const auto& [unused, table] : table_map_) {
+    bytes += table->GetMemoryUsage();
+  }
+  collector.AddHeap("composer.tables", bytes);
+}
+
 }  // namespace composer
 }  // namespace mozc
@@ -43,7 +43,9 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "base/container/double_array_trie.h"
 #include "base/container/trie.h"
+#include "base/memory_usage.h"
 #include "composer/special_key.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
@@ -112,6 +114,16 @@ class Table final {
   bool LoadFromString(absl::string_view str);
   bool LoadFromFile(absl::string_view filepath);
 
+  // Freezes the rules into a double-array trie, which makes the lookups
+  // faster and the table smaller. Rules can still be added or deleted after
+  // this call, but the lookups get back to the slower trie until the next
+  // call.
+  void Compile();
+  bool compiled() const { return compiled_; }
+
+  // Returns the approximate heap bytes used by the rules.
+  size_t GetMemoryUsage() const;
+
   const Entry* LookUp(absl::string_view input) const;
   const Entry* LookUpPrefix(absl::string_view input, size_t* key_length,
                             bool* fixed) const;
@@ -143,9 +155,20 @@ class Table final {
 
   bool LoadFromStream(std::istream* is);
   void DeleteEntry(const Entry* entry);
+  // Rebuilds `entries_` from `entry_set_` if the table is compiled, so that
+  // the rules can be modified.
+  void Decompile();
+  // Returns `input` as is if the table is case sensitive. Otherwise, stores
+  // the lower-cased `input` to `buffer` and returns it.
+  absl::string_view NormalizeInput(absl::string_view input,
+                                   std::string* buffer) const;
 
   using EntryTrie = Trie<const Entry*>;
   EntryTrie entries_;
+  // The frozen copy of `entries_`. While `compiled_` is true, the lookups use
+  // it and `entries_` is empty.
+  DoubleArrayTrie<const Entry*> compiled_entries_;
+  bool compiled_ = false;
   using EntrySet = absl::flat_hash_set<std::unique_ptr<Entry>>;
   EntrySet entry_set_;
 
@@ -167,6 +190,8 @@ class TableManager {
 
   void ClearCaches();
 
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const;
+
  private:
   // Table caches.
   // Key uint32_t is calculated hash and unique for
@@ -30,6 +30,7 @@
 #include "composer/table.h"
 
 #include <cstddef>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -41,6 +42,7 @@
 #include "data_manager/testing/mock_data_manager.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "testing/gmock.h"
 #include "testing/gunit.h"
 
 namespace mozc::composer {
@@ -49,6 +51,7 @@ namespace {
 using ::mozc::commands::Request;
 using ::mozc::composer::internal::DeleteSpecialKeys;
 using ::mozc::config::Config;
+using ::testing::UnorderedElementsAreArray;
 
 static void InitTable(Table* table) {
   table->AddRule("a", "あ", "");
@@ -130,6 +133,57 @@ TEST_F(TableTest, LookUpPredictiveAll) {
   EXPECT_EQ(results.size(), 6);
 }
 
+TEST_F(TableTest, Compile) {
+  Table table;
+  InitTable(&table);
+  EXPECT_FALSE(table.compiled());
+
+  constexpr absl::string_view kInputs[] = {"", "a", "k", "ka", "kk", "kka",
+                                           "n", "nn", "na", "x", "KA"};
+  struct Result {
+    const Entry* entry = nullptr;
+    const Entry* prefix_entry = nullptr;
+    size_t key_length = 0;
+    bool fixed = false;
+    std::vector<const Entry*> predictive_entries;
+    bool has_sub_rules = false;
+  };
+  auto look_up = [&table](const absl::string_view input) {
+    Result result;
+    result.entry = table.LookUp(input);
+    result.prefix_entry =
+        table.LookUpPrefix(input, &result.key_length, &result.fixed);
+    table.LookUpPredictiveAll(input, &result.predictive_entries);
+    result.has_sub_rules = table.HasSubRules(input);
+    return result;
+  };
+
+  std::vector<Result> expected;
+  for (const absl::string_view input : kInputs) {
+    expected.push_back(look_up(input));
+  }
+
+  table.Compile();
+  EXPECT_TRUE(table.compiled());
+  for (size_t i = 0; i < std::size(kInputs); ++i) {
+    SCOPED_TRACE(kInputs[i]);
+    const Result actual = look_up(kInputs[i]);
+    EXPECT_EQ(actual.entry, expected[i].entry);
+    EXPECT_EQ(actual.prefix_entry, expected[i].prefix_entry);
+    EXPECT_EQ(actual.key_length, expected[i].key_length);
+    EXPECT_EQ(actual.fixed, expected[i].fixed);
+    EXPECT_THAT(actual.predictive_entries,
+                UnorderedElementsAreArray(expected[i].predictive_entries));
+    EXPECT_EQ(actual.has_sub_rules, expected[i].has_sub_rules);
+  }
+
+  // Rules can be added to a compiled table.
+  const Entry* entry = table.AddRule("xa", "ぁ", "");
+  EXPECT_FALSE(table.compiled());
+  EXPECT_EQ(table.LookUp("xa"), entry);
+  EXPECT_EQ(table.LookUp("ka"), expected[3].entry);
+}
+
 TEST_F(TableTest, Punctuations) {
   constexpr struct TestCase {
     config::Config::PunctuationMethod method;
@@ -1029,6 +1083,7 @@ TEST_F(TableTest, TableManager) {
           std::shared_ptr<const Table> table =
               table_manager.GetTable(request, config);
           EXPECT_NE(table, nullptr);
+          EXPECT_TRUE(table->compiled());
           EXPECT_EQ(table_manager.GetTable(request, config), table);
           EXPECT_FALSE(table_set.contains(table));
           table_set.insert(table);
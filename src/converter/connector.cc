@@ -46,6 +46,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "base/bits.h"
+#include "base/memory_usage.h"
 #include "storage/louds/simple_succinct_bit_vector_index.h"
 
 namespace mozc {
@@ -273,6 +274,12 @@ absl::Status Connector::Init(absl::string_view connection_data) {
 #undef VALIDATE_SIZE
 }
 
+void Connector::CollectMemoryUsage(MemoryUsageCollector& collector) const {
+  collector.AddHeap("connector.cache",
+                    cache_ ? cache_->size() * sizeof(cache_t::value_type) : 0);
+  collector.AddHeap("connector.rows", GetHeapBytes(rows_));
+}
+
 int Connector::GetTransitionCost(uint16_t rid, uint16_t lid) const {
   // Note:
   // This function is called very frequently and has a significant impact on
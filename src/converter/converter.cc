@@ -50,6 +50,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/strings/assign.h"
+#include "base/trace.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "composer/composer.h"
@@ -143,15 +144,31 @@ Converter::Converter(
       reverse_converter_(*immutable_converter_),
       general_noun_id_(pos_matcher_.GetGeneralNounId()) {
   DCHECK(immutable_converter_);
-  predictor_ = predictor_factory(*modules_, *this, *immutable_converter_);
+  auto speculative_predictor =
+      std::make_unique<prediction::SpeculativePredictor>(
+          predictor_factory(*modules_, *this, *immutable_converter_));
+  speculative_predictor_ = speculative_predictor.get();
+  predictor_ = std::move(speculative_predictor);
   rewriter_ = rewriter_factory(*modules_);
   DCHECK(predictor_);
   DCHECK(rewriter_);
 }
 
+Converter::~Converter() {
+  // The speculative prediction uses the other members.
+  StopSpeculation();
+}
+
+void Converter::StopSpeculation() const {
+  if (speculative_predictor_) {
+    speculative_predictor_->StopSpeculation();
+  }
+}
+
 bool Converter::StartConversion(const ConversionRequest& request,
                                 Segments* segments) const {
   DCHECK_EQ(request.request_type(), ConversionRequest::CONVERSION);
+  MOZC_TRACE_SPAN("Converter::StartConversion");
 
   absl::string_view key = request.key();
   if (key.empty()) {
@@ -225,6 +242,7 @@ bool ValidateConversionRequestForPrediction(const ConversionRequest& request) {
 bool Converter::StartPrediction(const ConversionRequest& request,
                                 Segments* segments) const {
   DCHECK(ValidateConversionRequestForPrediction(request));
+  MOZC_TRACE_SPAN("Converter::StartPrediction");
 
   absl::string_view key = request.key();
   if (ShouldInitSegmentsForPrediction(key, *segments)) {
@@ -316,6 +334,7 @@ void Converter::FinishConversion(const ConversionRequest& request,
                                            .SetConversionRequestView(request)
                                            .SetHistoryResultView(history_result)
                                            .Build();
+  StopSpeculation();
   rewriter_->Finish(finish_req, *segments);
   predictor_->Finish(finish_req, committed_results, segments->revert_id());
 
@@ -350,6 +369,7 @@ void Converter::RevertConversion(Segments* segments) const {
   if (segments->revert_id() == 0) {
     return;
   }
+  StopSpeculation();
   rewriter_->Revert(*segments);
   predictor_->Revert(segments->revert_id());
   segments->set_revert_id(0);
@@ -363,6 +383,7 @@ bool Converter::DeleteCandidateFromHistory(const Segments& segments,
   DCHECK(segment.is_valid_index(candidate_index));
   const Candidate& candidate = segment.candidate(candidate_index);
   bool result = false;
+  StopSpeculation();
   result |=
       rewriter_->ClearHistoryEntry(segments, segment_index, candidate_index);
   result |= predictor_->ClearHistoryEntry(candidate.key, candidate.value);
@@ -651,6 +672,7 @@ void Converter::TrimCandidates(const ConversionRequest& request,
 }
 
 bool Converter::Reload() {
+  StopSpeculation();
   modules().GetUserDictionary().Reload();
   return rewriter().Reload() && predictor().Reload();
 }
@@ -662,6 +684,12 @@ bool Converter::Wait() {
   return predictor().Wait();
 }
 
+void Converter::CollectMemoryUsage(MemoryUsageCollector& collector) const {
+  modules().CollectMemoryUsage(collector);
+  predictor_->CollectMemoryUsage(collector);
+  rewriter_->CollectMemoryUsage(collector);
+}
+
 bool Converter::AddUserHistory(absl::string_view key, absl::string_view value) {
   value = absl::StripAsciiWhitespace(value);
   key = absl::StripAsciiWhitespace(key);
@@ -742,6 +770,19 @@ void Converter::PopulateReadingOfCommittedCandidateIfMissing(
   }
 }
 
+void Converter::SpeculatePrediction(
+    const ConversionRequest& request,
+    std::vector<composer::ComposerData> composers,
+    const Segments& segments) const {
+  DCHECK(speculative_predictor_);
+  const prediction::Result history_result = MakeHistoryResult(segments);
+  const ConversionRequest conv_req = ConversionRequestBuilder()
+                                         .SetConversionRequestView(request)
+                                         .SetHistoryResultView(history_result)
+                                         .Build();
+  speculative_predictor_->Speculate(conv_req, std::move(composers));
+}
+
 bool Converter::PredictForRequestWithSegments(const ConversionRequest& request,
                                               Segments* segments) const {
   DCHECK(segments);
@@ -42,6 +42,7 @@
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/memory_usage.h"
 #include "converter/candidate.h"
 #include "converter/converter_interface.h"
 #include "converter/history_reconstructor.h"
@@ -53,6 +54,7 @@
 #include "engine/modules.h"
 #include "prediction/predictor_interface.h"
 #include "prediction/result.h"
+#include "prediction/speculative_predictor.h"
 #include "request/conversion_request.h"
 #include "rewriter/rewriter_interface.h"
 
@@ -82,6 +84,7 @@ class Converter final : public ConverterInterface {
             const PredictorFactory& predictor_factory,
             const RewriterFactory& rewriter_factory);
   Converter() = delete;
+  ~Converter() override;
 
   [[nodiscard]]
   bool StartConversion(const ConversionRequest& request,
@@ -143,6 +146,10 @@ class Converter final : public ConverterInterface {
   // Syncs user-modified context.
   void CommitContext(const ConversionRequest& request) const override;
 
+  void SpeculatePrediction(const ConversionRequest& request,
+                           std::vector<composer::ComposerData> composers,
+                           const Segments& segments) const override;
+
   // Execute ImmutableConverter, Rewriters, SuppressionDictionary.
   // ApplyConversion does not initialize the Segment unlike StartConversion.
   void ApplyConversion(Segments* segments,
@@ -157,10 +164,18 @@ class Converter final : public ConverterInterface {
   // Waits for pending operations executed in different threads.
   bool Wait();
 
+  // Reports the memory used by the modules, the predictor and the rewriter.
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const;
+
   // Adds `key` and `value` to the user history storage.
   // Reverse conversion is used when the `key` is empty.
   bool AddUserHistory(absl::string_view key, absl::string_view value);
 
+  // Stops the speculative prediction running in background. As it reads the
+  // predictor, the rewriters and the dictionaries from another thread, this
+  // must be called before modifying them.
+  void StopSpeculation() const;
+
   prediction::PredictorInterface& predictor() const {
     DCHECK(predictor_);
     return *predictor_;
@@ -245,6 +260,8 @@ class Converter final : public ConverterInterface {
   std::unique_ptr<engine::Modules> modules_;
   std::unique_ptr<const ImmutableConverterInterface> immutable_converter_;
   std::unique_ptr<prediction::PredictorInterface> predictor_;
+  // Wraps the predictor created by the factory, owned by `predictor_`.
+  const prediction::SpeculativePredictor* speculative_predictor_ = nullptr;
   std::unique_ptr<RewriterInterface> rewriter_;
 
   const dictionary::PosMatcher& pos_matcher_;
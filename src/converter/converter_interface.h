@@ -32,9 +32,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "composer/composer.h"
 #include "converter/segments.h"
 #include "request/conversion_request.h"
 
@@ -166,6 +168,15 @@ class ConverterInterface {
   // Syncs user-modified context.
   virtual void CommitContext(const ConversionRequest& request) const = 0;
 
+  // Starts computing the predictions for the likely next key events in
+  // background. `composers` hold the compositions after each of the next
+  // inputs, and the rest of `request` is shared by them. A subsequent
+  // StartPrediction() for one of them may be answered from the results.
+  virtual void SpeculatePrediction(
+      const ConversionRequest& request,
+      std::vector<composer::ComposerData> composers,
+      const Segments& segments) const = 0;
+
  protected:
   ConverterInterface() = default;
 };
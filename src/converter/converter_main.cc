@@ -43,6 +43,7 @@
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -63,6 +64,7 @@
 #include "converter/pos_id_printer.h"
 #include "converter/segments.h"
 #include "data_manager/data_manager.h"
+#include "data_manager/dataset_access_profile.h"
 #include "engine/engine.h"
 #include "engine/supplemental_model_interface.h"
 #include "protocol/commands.pb.h"
@@ -97,6 +99,9 @@ ABSL_FLAG(std::string, id_def, "",
 ABSL_FLAG(std::string, decoder_experiment_params, "",
           "If nonempty, a DecoderExperimentParams is parsed from this text "
           "format and it is merged to the default value.");
+ABSL_FLAG(std::string, access_profile_output, "",
+          "If set, writes the data set pages accessed by the run to this file. "
+          "Pass it to dataset_writer_main --access_profile.");
 ABSL_FLAG(std::string, supplemental_model, "",
           "Supplemental model file. Default model is used when this is empty.");
 
@@ -626,6 +631,8 @@ int main(int argc, char** argv) {
                 absl::GetFlag(FLAGS_engine_data_path),
                 absl::GetFlag(FLAGS_magic));
   CHECK_OK(data_manager);
+  // Owned by the engine, which lives until the end of main().
+  const mozc::DataManager* data_manager_ptr = data_manager->get();
 
   mozc::config::Config config = mozc::config::ConfigHandler::DefaultConfig();
   mozc::commands::Request request;
@@ -665,5 +672,13 @@ int main(int argc, char** argv) {
   converter_main.LoadSupplementalModel(std::move(supplemental_model_path));
 
   converter_main.RunLoop();
+
+  if (const std::string path = absl::GetFlag(FLAGS_access_profile_output);
+      !path.empty()) {
+    absl::StatusOr<mozc::DataSetAccessProfile> profile =
+        data_manager_ptr->GetAccessProfile();
+    CHECK_OK(profile);
+    CHECK_OK(mozc::FileUtil::SetContents(path, profile->ToString()));
+  }
   return 0;
 }
@@ -32,9 +32,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "composer/composer.h"
 #include "converter/converter_interface.h"
 #include "converter/segments.h"
 #include "request/conversion_request.h"
@@ -99,6 +101,11 @@ class StrictMockConverter : public ConverterInterface {
               (const, override));
   MOCK_METHOD(void, CommitContext, (const ConversionRequest& request),
               (const, override));
+  MOCK_METHOD(void, SpeculatePrediction,
+              (const ConversionRequest& request,
+               std::vector<composer::ComposerData> composers,
+               const Segments& segments),
+              (const, override));
 };
 
 typedef ::testing::NiceMock<StrictMockConverter> MockConverter;
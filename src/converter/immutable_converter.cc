@@ -52,6 +52,7 @@
 #include "base/container/trie.h"
 #include "base/japanese_util.h"
 #include "base/strings/unicode.h"
+#include "base/trace.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "converter/attribute.h"
@@ -864,6 +865,7 @@ inline void ViterbiInternal(const Connector& connector, size_t pos,
 
 bool ImmutableConverter::Viterbi(const Segments& segments,
                                  Lattice* lattice) const {
+  MOZC_TRACE_SPAN("ImmutableConverter::Viterbi");
   absl::string_view key = lattice->key();
 
   // Process BOS.
@@ -983,6 +985,7 @@ bool ImmutableConverter::Viterbi(const Segments& segments,
 
 bool ImmutableConverter::PredictionViterbi(const Segments& segments,
                                            Lattice* lattice) const {
+  MOZC_TRACE_SPAN("ImmutableConverter::PredictionViterbi");
   const size_t key_length = lattice->key().size();
   size_t history_length = 0;
   for (const Segment& segment : segments.history_segments()) {
@@ -1103,6 +1106,7 @@ void ImmutableConverter::PredictionViterbiInternal(int calc_begin_pos,
 bool ImmutableConverter::MakeLattice(const ConversionOptions& options,
                                      Segments* segments,
                                      Lattice* lattice) const {
+  MOZC_TRACE_SPAN("ImmutableConverter::MakeLattice");
   if (segments == nullptr) {
     LOG(ERROR) << "Segments is nullptr";
     return false;
@@ -1644,8 +1648,12 @@ void ImmutableConverter::InsertCandidates(const ConversionOptions& options,
           NBestGenerator::BUILD_FROM_ONLY_FIRST_INNER_SEGMENT;
       nbest_options.candidate_mode |= NBestGenerator::FILL_INNER_SEGMENT_INFO;
     }
-    nbest_generator.Reset(prev, node->next, nbest_options);
-    nbest_generator.SetCandidates(options, original_key, expand_size, segment);
+    {
+      MOZC_TRACE_SPAN("NBestGenerator::SetCandidates");
+      nbest_generator.Reset(prev, node->next, nbest_options);
+      nbest_generator.SetCandidates(options, original_key, expand_size,
+                                    segment);
+    }
 
     if (type == MULTI_SEGMENTS || type == SINGLE_SEGMENT) {
       InsertDummyCandidates(segment, expand_size);
@@ -135,6 +135,7 @@ void NBestGenerator::Reset(const Node* absl_nonnull begin_node,
   top_nodes_.clear();
   filter_.Reset();
   viterbi_result_checked_ = false;
+  num_total_trials_ = 0;
   options_ = options;
 
   begin_node_ = begin_node;
@@ -418,6 +419,17 @@ bool NBestGenerator::Next(const ConversionOptions& options,
       return false;
     }
 
+    // Stops the expansion with the candidates found so far once the deadline
+    // has passed. The clock is read on the first trial after Reset() and then
+    // once per kDeadlineCheckInterval trials, counted across Next() calls.
+    constexpr int kDeadlineCheckInterval = 32;
+    if (num_total_trials_++ % kDeadlineCheckInterval == 0 &&
+        IsDeadlineExceeded(options)) {
+      MOZC_VLOG(2) << "deadline exceeded after " << num_total_trials_
+                   << " trials";
+      return false;
+    }
+
     // reached to the goal.
     if (rnode->end_pos == begin_node_->end_pos) {
       const CandidateFilter::ResultType filter_result =
@@ -225,6 +225,8 @@ class NBestGenerator {
   std::vector<const Node* absl_nonnull> top_nodes_;
   converter::CandidateFilter filter_;
   bool viterbi_result_checked_ = false;
+  // Number of trials since Reset(). Used to throttle the deadline checks.
+  int num_total_trials_ = 0;
   Options options_;
 
 #ifdef MOZC_CANDIDATE_DEBUG
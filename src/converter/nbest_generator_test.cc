@@ -37,7 +37,9 @@
 
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "base/clock.h"
 #include "converter/candidate.h"
 #include "converter/immutable_converter.h"
 #include "converter/lattice.h"
@@ -434,4 +436,58 @@ TEST_F(NBestGeneratorTest, NoAlphabetsConnection3Nodes) {
   }
 }
 
+TEST_F(NBestGeneratorTest, StopsAtDeadline) {
+  auto data_and_converter = std::make_unique<MockDataAndImmutableConverter>();
+  ImmutableConverterTestPeer converter =
+      data_and_converter->GetConverterTestPeer();
+
+  Segments segments;
+  {
+    Segment* segment = segments.add_segment();
+    segment->set_segment_type(Segment::FIXED_BOUNDARY);
+    segment->set_key("しんこう");
+
+    segment = segments.add_segment();
+    segment->set_segment_type(Segment::FREE);
+    segment->set_key("する");
+  }
+
+  Lattice lattice;
+  lattice.SetKey("しんこうする");
+  const ConversionRequest request = ConvReq(ConversionRequest::CONVERSION);
+  converter.MakeLattice(request.options(), &segments, &lattice);
+
+  const std::vector<uint16_t> group = converter.MakeGroup(segments);
+  converter.Viterbi(segments, &lattice);
+
+  std::unique_ptr<NBestGenerator> nbest_generator =
+      data_and_converter->CreateNBestGenerator(lattice);
+
+  constexpr bool kSingleSegment = false;
+  const Node* begin_node = lattice.bos_node();
+  const Node* end_node = GetEndNode(request, converter, segments, *begin_node,
+                                    group, kSingleSegment);
+  ConversionRequest::Options options = request.options();
+  {
+    options.deadline = Clock::GetAbslTime() + absl::Hours(1);
+    nbest_generator->Reset(
+        begin_node, end_node,
+        {NBestGenerator::ONLY_MID, NBestGenerator::CANDIDATE_MODE_NONE});
+    Segment result_segment;
+    nbest_generator->SetCandidates(options, "", 10, &result_segment);
+    EXPECT_EQ(result_segment.candidates_size(), 3);
+  }
+  {
+    // Only the Viterbi best result is returned once the deadline has passed.
+    options.deadline = Clock::GetAbslTime() - absl::Seconds(1);
+    nbest_generator->Reset(
+        begin_node, end_node,
+        {NBestGenerator::ONLY_MID, NBestGenerator::CANDIDATE_MODE_NONE});
+    Segment result_segment;
+    nbest_generator->SetCandidates(options, "", 10, &result_segment);
+    ASSERT_EQ(result_segment.candidates_size(), 1);
+    EXPECT_EQ(result_segment.candidate(0).value, "進行");
+  }
+}
+
 }  // namespace mozc
@@ -0,0 +1,219 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "converter/quality_regression_diff.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/memory_usage.h"
+#include "converter/quality_regression_util.h"
+
+namespace mozc {
+namespace quality_regression {
+namespace {
+
+void AppendJsonString(absl::string_view str, std::string* output) {
+  output->push_back('"');
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        output->append("\\\"");
+        break;
+      case '\\':
+        output->append("\\\\");
+        break;
+      case '\n':
+        output->append("\\n");
+        break;
+      case '\t':
+        output->append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppend(output, "\\u00", absl::Hex(c, absl::kZeroPad2));
+        } else {
+          output->push_back(c);
+        }
+    }
+  }
+  output->push_back('"');
+}
+
+void AppendJsonBool(bool value, std::string* output) {
+  output->append(value ? "true" : "false");
+}
+
+void AppendCaseResult(const CaseResult& case_result, std::string* output) {
+  const QualityRegressionUtil::TestResult& result = case_result.result;
+  output->append("{\"passed\":");
+  AppendJsonBool(result.passed, output);
+  output->append(",\"actual\":");
+  AppendJsonString(result.actual_value, output);
+  absl::StrAppend(output, ",\"rank\":", result.actual_rank, ",\"top\":[");
+  for (size_t i = 0; i < result.top_candidates.size(); ++i) {
+    if (i > 0) {
+      output->push_back(',');
+    }
+    AppendJsonString(result.top_candidates[i], output);
+  }
+  absl::StrAppend(output, "],\"latency_us\":",
+                  absl::ToInt64Microseconds(case_result.latency), "}");
+}
+
+}  // namespace
+
+void ConfigStats::Add(const QualityRegressionUtil::TestItem& item,
+                      const CaseResult& result) {
+  if (result.result.passed) {
+    ++passed_;
+    passed_weight_ += item.accuracy;
+  } else {
+    ++failed_;
+  }
+  total_weight_ += item.accuracy;
+  latencies_.push_back(result.latency);
+  total_latency_ += result.latency;
+}
+
+void ConfigStats::SetMemoryUsage(absl::Span<const MemoryUsage> usages) {
+  heap_bytes_ = 0;
+  mapped_bytes_ = 0;
+  resident_bytes_.reset();
+  for (const MemoryUsage& usage : usages) {
+    heap_bytes_ += usage.heap_bytes;
+    mapped_bytes_ += usage.mapped_bytes;
+    if (usage.resident_bytes.has_value()) {
+      resident_bytes_ = resident_bytes_.value_or(0) + *usage.resident_bytes;
+    }
+  }
+}
+
+double ConfigStats::weighted_accuracy() const {
+  return total_weight_ > 0 ? passed_weight_ / total_weight_ : 0;
+}
+
+absl::Duration ConfigStats::GetLatencyPercentile(double percentile) const {
+  if (latencies_.empty()) {
+    return absl::ZeroDuration();
+  }
+  // Nearest-rank method.
+  std::vector<absl::Duration> sorted = latencies_;
+  std::sort(sorted.begin(), sorted.end());
+  const size_t rank = static_cast<size_t>(
+      std::ceil(std::clamp(percentile, 0.0, 1.0) * sorted.size()));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+void ConfigStats::AppendJson(std::string* output) const {
+  const size_t size = latencies_.size();
+  const absl::Duration mean =
+      size > 0 ? total_latency_ / static_cast<int64_t>(size)
+               : absl::ZeroDuration();
+  absl::StrAppend(
+      output, "{\"passed\":", passed_, ",\"failed\":", failed_,
+      ",\"accuracy\":", weighted_accuracy(),
+      ",\"latency_us\":{\"mean\":", absl::ToInt64Microseconds(mean),
+      ",\"p50\":", absl::ToInt64Microseconds(GetLatencyPercentile(0.5)),
+      ",\"p90\":", absl::ToInt64Microseconds(GetLatencyPercentile(0.9)),
+      ",\"p99\":", absl::ToInt64Microseconds(GetLatencyPercentile(0.99)),
+      "},\"memory\":{\"heap_bytes\":", heap_bytes_,
+      ",\"mapped_bytes\":", mapped_bytes_);
+  if (resident_bytes_.has_value()) {
+    absl::StrAppend(output, ",\"resident_bytes\":", *resident_bytes_);
+  }
+  output->append("}}");
+}
+
+void DiffReport::AddCase(const QualityRegressionUtil::TestItem& item,
+                         const CaseResult& baseline,
+                         const CaseResult& candidate, std::string* output) {
+  baseline_.Add(item, baseline);
+  candidate_.Add(item, candidate);
+
+  absl::string_view status;
+  if (baseline.result.passed == candidate.result.passed) {
+    status = candidate.result.passed ? "pass" : "fail";
+  } else if (baseline.result.passed) {
+    status = "regressed";
+    ++regressed_;
+  } else {
+    status = "fixed";
+    ++fixed_;
+  }
+  const bool ranking_changed =
+      baseline.result.actual_rank != candidate.result.actual_rank ||
+      baseline.result.top_candidates != candidate.result.top_candidates;
+  if (ranking_changed) {
+    ++ranking_changed_;
+  }
+
+  output->append("{\"type\":\"case\",\"label\":");
+  AppendJsonString(item.label, output);
+  output->append(",\"key\":");
+  AppendJsonString(item.key, output);
+  output->append(",\"command\":");
+  AppendJsonString(item.command, output);
+  output->append(",\"expected\":");
+  AppendJsonString(item.expected_value, output);
+  absl::StrAppend(output, ",\"expected_rank\":", item.expected_rank,
+                  ",\"status\":\"", status, "\",\"ranking_changed\":");
+  AppendJsonBool(ranking_changed, output);
+  absl::StrAppend(output, ",\"latency_delta_us\":",
+                  absl::ToInt64Microseconds(candidate.latency) -
+                      absl::ToInt64Microseconds(baseline.latency),
+                  ",\"baseline\":");
+  AppendCaseResult(baseline, output);
+  output->append(",\"candidate\":");
+  AppendCaseResult(candidate, output);
+  output->append("}\n");
+}
+
+void DiffReport::AppendSummary(std::string* output) const {
+  absl::StrAppend(output, "{\"type\":\"summary\",\"cases\":",
+                  baseline_.passed() + baseline_.failed(),
+                  ",\"regressed\":", regressed_, ",\"fixed\":", fixed_,
+                  ",\"ranking_changed\":", ranking_changed_, ",\"baseline\":");
+  baseline_.AppendJson(output);
+  output->append(",\"candidate\":");
+  candidate_.AppendJson(output);
+  output->append("}\n");
+}
+
+}  // namespace quality_regression
+}  // namespace mozc
@@ -0,0 +1,118 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Differential report of the quality regression tests on two engine
+// configurations, e.g. the current and a new data set. The report is written
+// in JSON Lines so that the release tools can gate on it.
+
+#ifndef MOZC_CONVERTER_QUALITY_REGRESSION_DIFF_H_
+#define MOZC_CONVERTER_QUALITY_REGRESSION_DIFF_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/memory_usage.h"
+#include "converter/quality_regression_util.h"
+
+namespace mozc {
+namespace quality_regression {
+
+// Result of a test item on an engine configuration.
+struct CaseResult {
+  QualityRegressionUtil::TestResult result;
+  absl::Duration latency;
+};
+
+// Aggregated results of an engine configuration.
+class ConfigStats {
+ public:
+  void Add(const QualityRegressionUtil::TestItem& item,
+           const CaseResult& result);
+  void SetMemoryUsage(absl::Span<const MemoryUsage> usages);
+
+  int passed() const { return passed_; }
+  int failed() const { return failed_; }
+  // Sum of the accuracy weights of the passed items divided by the sum of all
+  // the weights.
+  double weighted_accuracy() const;
+  // Latency of the given percentile, e.g. 0.5 for the median.
+  absl::Duration GetLatencyPercentile(double percentile) const;
+
+  // Appends the statistics as a JSON object.
+  void AppendJson(std::string* output) const;
+
+ private:
+  int passed_ = 0;
+  int failed_ = 0;
+  double passed_weight_ = 0;
+  double total_weight_ = 0;
+  std::vector<absl::Duration> latencies_;
+  absl::Duration total_latency_;
+  size_t heap_bytes_ = 0;
+  size_t mapped_bytes_ = 0;
+  std::optional<size_t> resident_bytes_;
+};
+
+class DiffReport {
+ public:
+  // Appends a JSON line of the case to |output| and updates the statistics.
+  void AddCase(const QualityRegressionUtil::TestItem& item,
+               const CaseResult& baseline, const CaseResult& candidate,
+               std::string* output);
+
+  // Appends a JSON line of the aggregated results to |output|.
+  void AppendSummary(std::string* output) const;
+
+  ConfigStats& baseline() { return baseline_; }
+  ConfigStats& candidate() { return candidate_; }
+
+  // Number of the cases passing on the baseline but failing on the candidate.
+  int regressed() const { return regressed_; }
+  // Number of the cases failing on the baseline but passing on the candidate.
+  int fixed() const { return fixed_; }
+  // Number of the cases whose rank or top candidates differ.
+  int ranking_changed() const { return ranking_changed_; }
+
+ private:
+  ConfigStats baseline_;
+  ConfigStats candidate_;
+  int regressed_ = 0;
+  int fixed_ = 0;
+  int ranking_changed_ = 0;
+};
+
+}  // namespace quality_regression
+}  // namespace mozc
+
+#endif  // MOZC_CONVERTER_QUALITY_REGRESSION_DIFF_H_
@@ -0,0 +1,152 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "converter/quality_regression_diff.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "base/memory_usage.h"
+#include "converter/quality_regression_util.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace quality_regression {
+namespace {
+
+QualityRegressionUtil::TestItem MakeItem(absl::string_view key,
+                                         double accuracy) {
+  QualityRegressionUtil::TestItem item;
+  item.label = "label";
+  item.key = std::string(key);
+  item.expected_value = "value";
+  item.command = "Conversion Expected";
+  item.expected_rank = 0;
+  item.accuracy = accuracy;
+  item.platform = QualityRegressionUtil::DESKTOP;
+  return item;
+}
+
+CaseResult MakeResult(bool passed, int rank, std::vector<std::string> top,
+                      absl::Duration latency) {
+  CaseResult result;
+  result.result.passed = passed;
+  result.result.actual_value = top.empty() ? "" : top[0];
+  result.result.actual_rank = rank;
+  result.result.top_candidates = std::move(top);
+  result.latency = latency;
+  return result;
+}
+
+TEST(QualityRegressionDiffTest, AddCase) {
+  DiffReport report;
+  std::string output;
+  report.AddCase(
+      MakeItem("a", 1.0),
+      MakeResult(true, 0, {"value", "x"}, absl::Microseconds(100)),
+      MakeResult(false, 1, {"x", "value"}, absl::Microseconds(150)), &output);
+  EXPECT_EQ(
+      output,
+      "{\"type\":\"case\",\"label\":\"label\",\"key\":\"a\","
+      "\"command\":\"Conversion Expected\",\"expected\":\"value\","
+      "\"expected_rank\":0,\"status\":\"regressed\",\"ranking_changed\":true,"
+      "\"latency_delta_us\":50,"
+      "\"baseline\":{\"passed\":true,\"actual\":\"value\",\"rank\":0,"
+      "\"top\":[\"value\",\"x\"],\"latency_us\":100},"
+      "\"candidate\":{\"passed\":false,\"actual\":\"x\",\"rank\":1,"
+      "\"top\":[\"x\",\"value\"],\"latency_us\":150}}\n");
+
+  output.clear();
+  report.AddCase(MakeItem("b", 1.0),
+                 MakeResult(false, -1, {"y"}, absl::Microseconds(100)),
+                 MakeResult(true, 0, {"value"}, absl::Microseconds(50)),
+                 &output);
+  EXPECT_NE(output.find("\"status\":\"fixed\""), std::string::npos);
+
+  output.clear();
+  report.AddCase(MakeItem("c", 1.0),
+                 MakeResult(true, 0, {"value"}, absl::Microseconds(10)),
+                 MakeResult(true, 0, {"value"}, absl::Microseconds(10)),
+                 &output);
+  EXPECT_NE(output.find("\"status\":\"pass\",\"ranking_changed\":false"),
+            std::string::npos);
+
+  EXPECT_EQ(report.regressed(), 1);
+  EXPECT_EQ(report.fixed(), 1);
+  EXPECT_EQ(report.ranking_changed(), 2);
+  EXPECT_EQ(report.baseline().passed(), 2);
+  EXPECT_EQ(report.candidate().passed(), 2);
+}
+
+TEST(QualityRegressionDiffTest, EscapeString) {
+  DiffReport report;
+  std::string output;
+  report.AddCase(MakeItem("\"\\\n\x01", 1.0),
+                 MakeResult(true, 0, {}, absl::ZeroDuration()),
+                 MakeResult(true, 0, {}, absl::ZeroDuration()), &output);
+  EXPECT_NE(output.find("\"key\":\"\\\"\\\\\\n\\u0001\""), std::string::npos)
+      << output;
+}
+
+TEST(QualityRegressionDiffTest, ConfigStats) {
+  ConfigStats stats;
+  for (int i = 1; i <= 100; ++i) {
+    stats.Add(MakeItem("a", i <= 10 ? 2.0 : 1.0),
+              MakeResult(i <= 10, 0, {}, absl::Microseconds(i)));
+  }
+  EXPECT_EQ(stats.passed(), 10);
+  EXPECT_EQ(stats.failed(), 90);
+  EXPECT_DOUBLE_EQ(stats.weighted_accuracy(), 20.0 / 110.0);
+  EXPECT_EQ(stats.GetLatencyPercentile(0.5), absl::Microseconds(50));
+  EXPECT_EQ(stats.GetLatencyPercentile(0.9), absl::Microseconds(90));
+  EXPECT_EQ(stats.GetLatencyPercentile(1.0), absl::Microseconds(100));
+  EXPECT_EQ(stats.GetLatencyPercentile(0.0), absl::Microseconds(1));
+
+  const std::vector<MemoryUsage> usages = {
+      {.name = "a", .heap_bytes = 10},
+      {.name = "b", .mapped_bytes = 100, .resident_bytes = 40},
+  };
+  stats.SetMemoryUsage(usages);
+  std::string output;
+  stats.AppendJson(&output);
+  EXPECT_NE(output.find("\"latency_us\":{\"mean\":50,\"p50\":50,\"p90\":90,"
+                        "\"p99\":99}"),
+            std::string::npos)
+      << output;
+  EXPECT_NE(output.find("\"memory\":{\"heap_bytes\":10,\"mapped_bytes\":100,"
+                        "\"resident_bytes\":40}"),
+            std::string::npos)
+      << output;
+}
+
+}  // namespace
+}  // namespace quality_regression
+}  // namespace mozc
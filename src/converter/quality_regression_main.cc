@@ -27,11 +27,15 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -39,11 +43,17 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "base/file/temp_dir.h"
 #include "base/init_mozc.h"
+#include "base/memory_usage.h"
 #include "base/system_util.h"
+#include "base/thread.h"
+#include "converter/quality_regression_diff.h"
 #include "converter/quality_regression_util.h"
 #include "engine/engine.h"
 #include "engine/eval_engine_factory.h"
@@ -55,22 +65,42 @@ ABSL_FLAG(std::string, data_file, "", "engine data file");
 ABSL_FLAG(std::string, data_type, "", "engine data type");
 ABSL_FLAG(std::string, engine_type, "desktop", "engine type");
 ABSL_FLAG(std::string, output, "", "output file");
+ABSL_FLAG(std::string, baseline_data_file, "",
+          "If set, compares --data_file with this data file and outputs the "
+          "differences in JSON Lines.");
+ABSL_FLAG(std::string, baseline_data_type, "",
+          "engine data type of --baseline_data_file. Same as --data_type if "
+          "empty.");
+ABSL_FLAG(int32_t, num_threads, 1,
+          "number of threads running the tests in the differential mode");
+ABSL_FLAG(int32_t, top_k, 5,
+          "number of the top candidates compared in the differential mode");
+ABSL_FLAG(int32_t, max_regressions, -1,
+          "exits with an error if more cases regress in the differential "
+          "mode. Not checked if negative.");
 
 namespace {
 
 using ::mozc::Engine;
+using ::mozc::MemoryUsageCollector;
 using ::mozc::TempDirectory;
+using ::mozc::quality_regression::CaseResult;
+using ::mozc::quality_regression::DiffReport;
 using ::mozc::quality_regression::QualityRegressionUtil;
 
-absl::Status Run(std::ostream& out, const Engine& engine,
-                 absl::string_view engine_type,
-                 absl::Span<const QualityRegressionUtil::TestItem> items) {
-  QualityRegressionUtil util(engine.GetConverter());
+void SetRequest(absl::string_view engine_type, QualityRegressionUtil& util) {
   if (engine_type == "mobile") {
     mozc::commands::Request request;
     mozc::request_test_util::FillMobileRequest(&request);
     util.SetRequest(request);
   }
+}
+
+absl::Status Run(std::ostream& out, const Engine& engine,
+                 absl::string_view engine_type,
+                 absl::Span<const QualityRegressionUtil::TestItem> items) {
+  QualityRegressionUtil util(engine.GetConverter());
+  SetRequest(engine_type, util);
   for (const QualityRegressionUtil::TestItem& item : items) {
     std::string actual_value;
     const absl::StatusOr<bool> result =
@@ -89,6 +119,139 @@ absl::Status Run(std::ostream& out, const Engine& engine,
   return absl::OkStatus();
 }
 
+// Runs the tests of the items assigned to a worker on both of the engine
+// configurations. Each worker owns its engines as the converters are not
+// thread-safe.
+class DiffWorker {
+ public:
+  DiffWorker(absl::Span<const QualityRegressionUtil::TestItem> items,
+             size_t begin, size_t step, std::vector<CaseResult>& baseline,
+             std::vector<CaseResult>& candidate)
+      : items_(items),
+        begin_(begin),
+        step_(step),
+        baseline_results_(baseline),
+        candidate_results_(candidate) {}
+
+  absl::Status Run() {
+    absl::StatusOr<std::unique_ptr<Engine>> baseline = mozc::CreateEvalEngine(
+        absl::GetFlag(FLAGS_baseline_data_file), GetBaselineDataType());
+    if (!baseline.ok()) {
+      return std::move(baseline).status();
+    }
+    absl::StatusOr<std::unique_ptr<Engine>> candidate =
+        mozc::CreateEvalEngine(absl::GetFlag(FLAGS_data_file),
+                               absl::GetFlag(FLAGS_data_type));
+    if (!candidate.ok()) {
+      return std::move(candidate).status();
+    }
+
+    const std::string engine_type = absl::GetFlag(FLAGS_engine_type);
+    QualityRegressionUtil baseline_util((*baseline)->GetConverter());
+    QualityRegressionUtil candidate_util((*candidate)->GetConverter());
+    SetRequest(engine_type, baseline_util);
+    SetRequest(engine_type, candidate_util);
+    const size_t top_k = std::max(absl::GetFlag(FLAGS_top_k), 0);
+    for (size_t i = begin_; i < items_.size(); i += step_) {
+      absl::Status status =
+          Test(baseline_util, items_[i], top_k, baseline_results_[i]);
+      if (status.ok()) {
+        status = Test(candidate_util, items_[i], top_k, candidate_results_[i]);
+      }
+      if (!status.ok()) {
+        LOG(INFO) << "Failed to convert: " << items_[i].key;
+        return status;
+      }
+    }
+
+    (*baseline)->CollectMemoryUsage(baseline_memory_);
+    (*candidate)->CollectMemoryUsage(candidate_memory_);
+    return absl::OkStatus();
+  }
+
+  const MemoryUsageCollector& baseline_memory() const {
+    return baseline_memory_;
+  }
+  const MemoryUsageCollector& candidate_memory() const {
+    return candidate_memory_;
+  }
+
+ private:
+  static std::string GetBaselineDataType() {
+    const std::string data_type = absl::GetFlag(FLAGS_baseline_data_type);
+    return data_type.empty() ? absl::GetFlag(FLAGS_data_type) : data_type;
+  }
+
+  static absl::Status Test(QualityRegressionUtil& util,
+                           const QualityRegressionUtil::TestItem& item,
+                           size_t top_k, CaseResult& case_result) {
+    const absl::Time start = absl::Now();
+    absl::StatusOr<QualityRegressionUtil::TestResult> result =
+        util.Test(item, top_k);
+    case_result.latency = absl::Now() - start;
+    if (!result.ok()) {
+      return std::move(result).status();
+    }
+    case_result.result = *std::move(result);
+    return absl::OkStatus();
+  }
+
+  absl::Span<const QualityRegressionUtil::TestItem> items_;
+  const size_t begin_;
+  const size_t step_;
+  std::vector<CaseResult>& baseline_results_;
+  std::vector<CaseResult>& candidate_results_;
+  MemoryUsageCollector baseline_memory_;
+  MemoryUsageCollector candidate_memory_;
+};
+
+absl::Status RunDiff(std::ostream& out,
+                     absl::Span<const QualityRegressionUtil::TestItem> items) {
+  const size_t num_threads = std::max(absl::GetFlag(FLAGS_num_threads), 1);
+  std::vector<CaseResult> baseline_results(items.size());
+  std::vector<CaseResult> candidate_results(items.size());
+  std::vector<std::unique_ptr<DiffWorker>> workers;
+  std::vector<absl::Status> statuses(num_threads);
+  {
+    std::vector<mozc::Thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+      workers.push_back(std::make_unique<DiffWorker>(
+          items, i, num_threads, baseline_results, candidate_results));
+      threads.emplace_back(
+          [&worker = *workers.back(), &status = statuses[i]] {
+            status = worker.Run();
+          });
+    }
+  }  // Joins the threads.
+  for (const absl::Status& status : statuses) {
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  DiffReport report;
+  // The engines of the workers are identical. Report the first one.
+  report.baseline().SetMemoryUsage(workers[0]->baseline_memory().usages());
+  report.candidate().SetMemoryUsage(workers[0]->candidate_memory().usages());
+  std::string output;
+  for (size_t i = 0; i < items.size(); ++i) {
+    output.clear();
+    report.AddCase(items[i], baseline_results[i], candidate_results[i],
+                   &output);
+    out << output;
+  }
+  output.clear();
+  report.AppendSummary(&output);
+  out << output << std::flush;
+
+  const int max_regressions = absl::GetFlag(FLAGS_max_regressions);
+  if (max_regressions >= 0 && report.regressed() > max_regressions) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(report.regressed(), " cases regressed"));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
@@ -98,14 +261,6 @@ int main(int argc, char** argv) {
   CHECK_OK(temp_dir);
   mozc::SystemUtil::SetUserProfileDirectory(temp_dir->path());
 
-  absl::StatusOr<std::unique_ptr<Engine>> create_result =
-      mozc::CreateEvalEngine(absl::GetFlag(FLAGS_data_file),
-                             absl::GetFlag(FLAGS_data_type));
-  if (!create_result.ok()) {
-    LOG(ERROR) << create_result.status();
-    return static_cast<int>(create_result.status().code());
-  }
-
   std::vector<QualityRegressionUtil::TestItem> items;
   const absl::Status parse_result = QualityRegressionUtil::ParseFiles(
       absl::GetFlag(FLAGS_test_files), &items);
@@ -114,14 +269,25 @@ int main(int argc, char** argv) {
     return static_cast<int>(parse_result.code());
   }
 
-  absl::Status status;
+  std::ofstream file;
   if (!absl::GetFlag(FLAGS_output).empty()) {
-    std::ofstream out(absl::GetFlag(FLAGS_output));
+    file.open(absl::GetFlag(FLAGS_output));
+  }
+  std::ostream& out = file.is_open() ? file : std::cout;
+
+  absl::Status status;
+  if (!absl::GetFlag(FLAGS_baseline_data_file).empty()) {
+    status = RunDiff(out, items);
+  } else {
+    absl::StatusOr<std::unique_ptr<Engine>> create_result =
+        mozc::CreateEvalEngine(absl::GetFlag(FLAGS_data_file),
+                               absl::GetFlag(FLAGS_data_type));
+    if (!create_result.ok()) {
+      LOG(ERROR) << create_result.status();
+      return static_cast<int>(create_result.status().code());
+    }
     status = Run(out, *create_result.value(), absl::GetFlag(FLAGS_engine_type),
                  items);
-  } else {
-    status = Run(std::cout, *create_result.value(),
-                 absl::GetFlag(FLAGS_engine_type), items);
   }
   if (!status.ok()) {
     LOG(ERROR) << status;
@@ -240,15 +240,26 @@ absl::Status QualityRegressionUtil::ParseFiles(
 
 absl::StatusOr<bool> QualityRegressionUtil::ConvertAndTest(
     const TestItem& item, std::string* actual_value) {
+  CHECK(actual_value);
+  absl::StatusOr<TestResult> result = Test(item, 0);
+  if (!result.ok()) {
+    actual_value->clear();
+    return std::move(result).status();
+  }
+  *actual_value = std::move(result->actual_value);
+  return result->passed;
+}
+
+absl::StatusOr<QualityRegressionUtil::TestResult> QualityRegressionUtil::Test(
+    const TestItem& item, size_t top_k) {
   absl::string_view key = item.key;
   absl::string_view expected_value = item.expected_value;
   absl::string_view command = item.command;
   const int expected_rank = item.expected_rank;
 
-  CHECK(actual_value);
   Segments segments;
   converter_->ResetConversion(&segments);
-  actual_value->clear();
+  TestResult result;
 
   auto table = std::make_shared<composer::Table>();
   config_.set_use_typing_correction(true);
@@ -357,29 +368,42 @@ absl::StatusOr<bool> QualityRegressionUtil::ConvertAndTest(
       (segments.segments_size() == 0 ||
        (segments.segments_size() >= 1 &&
         segments.segment(0).candidates_size() == 0))) {
-    return true;
+    result.passed = true;
+    return result;
   }
 
   for (const Segment& segment : segments) {
-    absl::StrAppend(actual_value, segment.candidate(0).value);
+    absl::StrAppend(&result.actual_value, segment.candidate(0).value);
+  }
+  if (segments.segments_size() > 0) {
+    const Segment& segment = segments.segment(0);
+    for (size_t i = 0;
+         i < segment.candidates_size() && result.top_candidates.size() < top_k;
+         ++i) {
+      result.top_candidates.push_back(segment.candidate(i).value);
+    }
   }
+  result.actual_rank = GetRank(expected_value, segments, 0);
 
   if (command == kConversionMatch) {
-    return (actual_value->find(expected_value) != std::string::npos);
+    result.passed =
+        (result.actual_value.find(expected_value) != std::string::npos);
+    return result;
   }
   if (command == kConversionNotMatch) {
-    return (actual_value->find(expected_value) == std::string::npos);
+    result.passed =
+        (result.actual_value.find(expected_value) == std::string::npos);
+    return result;
   }
 
-  const int32_t actual_rank = GetRank(expected_value, segments, 0);
-
-  bool result = (actual_rank >= 0 && actual_rank <= expected_rank);
+  result.passed =
+      (result.actual_rank >= 0 && result.actual_rank <= expected_rank);
 
   if (command == kConversionNotExpect ||
       command == kReverseConversionNotExpect ||
       command == kPredictionNotExpect || command == kSuggestionNotExpect ||
       command == kZeroQueryNotExpect) {
-    result = !result;
+    result.passed = !result.passed;
   }
 
   return result;
@@ -30,6 +30,7 @@
 #ifndef MOZC_CONVERTER_QUALITY_REGRESSION_UTIL_H_
 #define MOZC_CONVERTER_QUALITY_REGRESSION_UTIL_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -72,6 +73,17 @@ class QualityRegressionUtil {
     absl::Status ParseFromTSV(absl::string_view tsv_line);
   };
 
+  // Result of a test item with the details of the conversion.
+  struct TestResult {
+    bool passed = false;
+    // Concatenation of the top candidates of the segments.
+    std::string actual_value;
+    // Rank of the expected value, or -1 if it's not in the candidates.
+    int32_t actual_rank = -1;
+    // Values of the top candidates of the first segment.
+    std::vector<std::string> top_candidates;
+  };
+
   explicit QualityRegressionUtil(
       std::shared_ptr<const ConverterInterface> converter);
   QualityRegressionUtil(const QualityRegressionUtil&) = delete;
@@ -87,6 +99,10 @@ class QualityRegressionUtil {
   absl::StatusOr<bool> ConvertAndTest(const TestItem& item,
                                       std::string* actual_value);
 
+  // Same as ConvertAndTest() but returns the details. Up to |top_k| candidates
+  // of the first segment are returned.
+  absl::StatusOr<TestResult> Test(const TestItem& item, size_t top_k);
+
   void SetRequest(const commands::Request& request);
   void SetConfig(const config::Config& config);
   static std::string GetPlatformString(uint32_t platform_bitfiled);
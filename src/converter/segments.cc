@@ -47,6 +47,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/memory_usage.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "converter/candidate.h"
@@ -56,6 +57,15 @@ namespace converter {
 
 namespace {
 constexpr size_t kMaxHistorySize = 32;
+
+// Returns the heap bytes owned by the strings of `candidate`.
+size_t GetCandidateHeapBytes(const Candidate& candidate) {
+  return GetHeapBytes(candidate.key) + GetHeapBytes(candidate.value) +
+         GetHeapBytes(candidate.content_key) +
+         GetHeapBytes(candidate.content_value) +
+         GetHeapBytes(candidate.description) +
+         GetHeapBytes(candidate.display_value);
+}
 }  // namespace
 
 Segment::Segment(const Segment& x)
@@ -250,6 +260,20 @@ void Segment::DeepCopyCandidates(const std::deque<Candidate*>& candidates) {
   }
 }
 
+size_t Segment::GetMemoryUsage() const {
+  size_t bytes = GetHeapBytes(key_) + GetHeapBytes(meta_candidates_) +
+                 GetHeapBytes(pool_) +
+                 candidates_.size() * sizeof(Candidate*);
+  // All the candidates are allocated in `pool_`.
+  for (const std::unique_ptr<Candidate>& candidate : pool_) {
+    bytes += sizeof(Candidate) + GetCandidateHeapBytes(*candidate);
+  }
+  for (const Candidate& candidate : meta_candidates_) {
+    bytes += GetCandidateHeapBytes(candidate);
+  }
+  return bytes;
+}
+
 std::string Segment::DebugString() const {
   std::stringstream os;
   os << "[segtype=" << segment_type() << " key=" << key() << std::endl;
@@ -573,6 +597,14 @@ std::string Segments::history_value(int size) const {
   return history_value;
 }
 
+size_t Segments::GetMemoryUsage() const {
+  size_t bytes = segments_.size() * sizeof(Segment*);
+  for (const Segment* segment : segments_) {
+    bytes += sizeof(Segment) + segment->GetMemoryUsage();
+  }
+  return bytes;
+}
+
 std::string Segments::DebugString() const {
   std::stringstream os;
   os << "{" << std::endl;
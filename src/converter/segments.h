@@ -143,6 +143,9 @@ class Segment final {
   // Keep clear() method as other modules are still using the old method
   void clear() { Clear(); }
 
+  // Returns the approximate heap size of the key and the candidates.
+  size_t GetMemoryUsage() const;
+
   std::string DebugString() const;
 
   friend std::ostream& operator<<(std::ostream& os, const Segment& segment) {
@@ -425,6 +428,9 @@ class Segments final {
   // clear segments
   void Clear();
 
+  // Returns the approximate heap size of the segments in use.
+  size_t GetMemoryUsage() const;
+
   // Dump Segments structure
   std::string DebugString() const;
 
@@ -376,6 +376,24 @@ TEST(SegmentsTest, InitForCommit) {
   EXPECT_EQ(segment.candidate(0).content_value, "value");
 }
 
+TEST(SegmentsTest, GetMemoryUsage) {
+  Segments segments;
+  EXPECT_EQ(segments.GetMemoryUsage(), 0);
+
+  segments.InitForConvert("key");
+  const size_t empty_segment_usage = segments.GetMemoryUsage();
+  EXPECT_GE(empty_segment_usage, sizeof(Segment));
+
+  Segment* segment = segments.mutable_conversion_segment(0);
+  Candidate* candidate = segment->add_candidate();
+  candidate->value = std::string(100, 'v');
+  EXPECT_GE(segments.GetMemoryUsage(),
+            empty_segment_usage + sizeof(Candidate) + 100);
+
+  segments.Clear();
+  EXPECT_EQ(segments.GetMemoryUsage(), 0);
+}
+
 TEST(SegmentsTest, PrependCandidates) {
   Segments segments;
   segments.InitForConvert("key");
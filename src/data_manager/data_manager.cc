@@ -49,10 +49,13 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/bits.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
+#include "base/memory_usage.h"
 #include "base/mmap.h"
 #include "base/version.h"
 #include "base/vlog.h"
+#include "data_manager/dataset_access_profile.h"
 #include "data_manager/dataset_reader.h"
 #include "data_manager/serialized_dictionary.h"
 #include "protocol/segmenter_data.pb.h"
@@ -68,6 +71,17 @@ constexpr absl::string_view kDataSetMagicNumber = "\xEFMOZC\r\n";
 
 constexpr absl::string_view kDataSetMagicNumberOss = "\xEFMOZC\r\n";
 
+// Names of the lookup tables that may have a PerfectHashIndex section.
+constexpr absl::string_view kLookupIndexNames[] = {
+    "emoji",
+    "emoticon",
+    "reading_correction",
+    "single_kanji_noun_prefix",
+    "a11y_description",
+    "zero_query",
+    "zero_query_number",
+};
+
 absl::Status InitUserPosManagerDataFromReader(
     const DataSetReader& reader, absl::string_view* pos_matcher_data,
     absl::string_view* user_pos_token_array_data,
@@ -188,6 +202,7 @@ absl::Status DataManager::InitFromArray(absl::string_view array,
     return absl::DataLossError(
         absl::StrCat("Binary data of size ", array.size(), " is broken"));
   }
+  data_set_ = array;
   return InitFromReader(reader);
 }
 
@@ -198,6 +213,7 @@ absl::Status DataManager::InitFromArray(absl::string_view array,
     return absl::DataLossError(
         absl::StrCat("Binary data of size ", array.size(), " is broken"));
   }
+  data_set_ = array;
   return InitFromReader(reader);
 }
 
@@ -389,6 +405,20 @@ absl::Status DataManager::InitFromReader(const DataSetReader& reader) {
     return absl::DataLossError("Zero query data is broken");
   }
 
+  // PerfectHashIndex sections are optional.  They are stored as
+  // "<table name>_index", e.g., "emoji_index".
+  for (absl::string_view name : kLookupIndexNames) {
+    absl::string_view index_data;
+    if (!reader.Get(absl::StrCat(name, "_index"), &index_data)) {
+      continue;
+    }
+    if (!PerfectHashIndex::VerifyData(index_data)) {
+      return absl::DataLossError(
+          absl::StrCat("Lookup index data is broken: ", name));
+    }
+    lookup_index_data_[name] = index_data;
+  }
+
   if (!reader.Get("usage_item_array", &usage_items_data_)) {
     MOZC_VLOG(2) << "Usage dictionary is not provided";
     // Usage dictionary is optional, so don't return false here.
@@ -425,6 +455,12 @@ absl::Status DataManager::InitFromReader(const DataSetReader& reader) {
                        components[0], " (", data_version_, ")"));
     }
   }
+
+  for (const auto& [name, unused_data] : reader.name_to_data_map()) {
+    offset_and_size_[name] = *reader.GetOffsetAndSize(name);
+  }
+  hot_ranges_.assign(reader.hot_ranges().begin(), reader.hot_ranges().end());
+  PrefetchHotRanges();
   return absl::OkStatus();
 }
 
@@ -559,6 +595,15 @@ std::array<absl::string_view, 4> DataManager::GetZeroQueryData() const {
           zero_query_number_string_array_data_};
 }
 
+absl::string_view DataManager::GetLookupIndexData(
+    absl::string_view name) const {
+  if (const auto iter = lookup_index_data_.find(name);
+      iter != lookup_index_data_.end()) {
+    return iter->second;
+  }
+  return "";
+}
+
 #ifndef NO_USAGE_REWRITER
 std::array<absl::string_view, 5> DataManager::GetUsageRewriterData() const {
   return {usage_base_conjugation_suffix_data_, usage_conjugation_suffix_data_,
@@ -578,4 +623,37 @@ std::optional<std::pair<size_t, size_t>> DataManager::GetOffsetAndSize(
   return std::nullopt;
 }
 
+void DataManager::PrefetchHotRanges() const {
+  for (const absl::string_view range : hot_ranges_) {
+    Mmap::MaybePrefetch(range.data(), range.size());
+  }
+  if (!hot_ranges_.empty()) {
+    MOZC_VLOG(1) << "Prefetched " << hot_ranges_.size() << " hot ranges";
+  }
+}
+
+absl::StatusOr<DataSetAccessProfile> DataManager::GetAccessProfile() const {
+  DataSetAccessProfile profile;
+  for (const auto& [name, offset_and_size] : offset_and_size_) {
+    const auto [offset, size] = offset_and_size;
+    absl::StatusOr<std::vector<std::pair<size_t, size_t>>> ranges =
+        Mmap::GetResidentRanges(data_set_.data() + offset, size);
+    if (!ranges.ok()) {
+      return ranges.status();
+    }
+    for (const auto& [range_offset, range_size] : *ranges) {
+      profile.AddRange(name, range_offset, range_size);
+    }
+  }
+  return profile;
+}
+
+void DataManager::CollectMemoryUsage(MemoryUsageCollector& collector) const {
+  for (const auto& [name, offset_and_size] : offset_and_size_) {
+    const auto [offset, size] = offset_and_size;
+    collector.AddMapped(absl::StrCat("data_manager.", name),
+                        data_set_.substr(offset, size));
+  }
+}
+
 }  // namespace mozc
@@ -38,13 +38,16 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/memory_usage.h"
 #include "base/mmap.h"
+#include "data_manager/dataset_access_profile.h"
 
 namespace mozc {
 
@@ -136,6 +139,13 @@ class DataManager {
   //  zero_query_number_token_array_data, zero_query_number_string_array_data]
   virtual std::array<absl::string_view, 4> GetZeroQueryData() const;
 
+  // Returns the optional PerfectHashIndex image for the lookup table |name|,
+  // which is one of "emoji", "emoticon", "reading_correction",
+  // "single_kanji_noun_prefix", "a11y_description", "zero_query" and
+  // "zero_query_number".  Returns an empty string if the data set has no index
+  // for the table; callers then fall back to binary search.
+  virtual absl::string_view GetLookupIndexData(absl::string_view name) const;
+
 #ifndef NO_USAGE_REWRITER
   // [base_conjugation_suffix_data, conjugation_suffix_data,
   //  conjugation_index_data, usage_items_data, string_array_data]
@@ -147,6 +157,22 @@ class DataManager {
   virtual std::optional<std::pair<size_t, size_t>> GetOffsetAndSize(
       absl::string_view name) const;
 
+  // Asks the OS to read the hot ranges recorded in the data set ahead.  This
+  // is called on initialization, so callers usually don't need to call it.
+  // Does nothing if the data set was built without an access profile.
+  void PrefetchHotRanges() const;
+
+  // Returns the ranges of each entry that are resident in memory, i.e., that
+  // have been accessed by this process since the data set was mapped.  The OS
+  // may also map the neighbors of accessed pages if they are in the page
+  // cache, so record the profile from a cold page cache for better accuracy.
+  // Pass the result to dataset_writer_main --access_profile.
+  absl::StatusOr<DataSetAccessProfile> GetAccessProfile() const;
+
+  // Reports the size of each entry of the data set and how much of it is
+  // resident in memory.
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const;
+
  protected:
   DataManager() = default;
   friend std::unique_ptr<DataManager> std::make_unique<DataManager>();
@@ -180,6 +206,8 @@ class DataManager {
 
   std::optional<std::string> filename_ = std::nullopt;
   Mmap mmap_;
+  absl::string_view data_set_;
+  std::vector<absl::string_view> hot_ranges_;
   absl::string_view pos_matcher_data_;
   absl::string_view user_pos_token_array_data_;
   absl::string_view user_pos_string_array_data_;
@@ -228,6 +256,7 @@ class DataManager {
   absl::string_view usage_string_array_data_;
   absl::string_view data_version_;
   absl::flat_hash_map<std::string, std::pair<size_t, size_t>> offset_and_size_;
+  absl::flat_hash_map<std::string, absl::string_view> lookup_index_data_;
 };
 
 }  // namespace mozc
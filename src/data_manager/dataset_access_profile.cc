@@ -0,0 +1,119 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "data_manager/dataset_access_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace mozc {
+
+absl::StatusOr<DataSetAccessProfile> DataSetAccessProfile::Parse(
+    absl::string_view text) {
+  DataSetAccessProfile profile;
+  for (absl::string_view line : absl::StrSplit(text, '\n')) {
+    if (line.ends_with('\r')) {
+      line.remove_suffix(1);
+    }
+    if (line.empty() || line.starts_with('#')) {
+      continue;
+    }
+    const std::vector<absl::string_view> fields = absl::StrSplit(line, '\t');
+    uint64_t offset = 0, size = 0;
+    if (fields.size() != 3 || fields[0].empty() ||
+        !absl::SimpleAtoi(fields[1], &offset) ||
+        !absl::SimpleAtoi(fields[2], &size)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid access profile line: ", line));
+    }
+    profile.AddRange(fields[0], offset, size);
+  }
+  return profile;
+}
+
+void DataSetAccessProfile::AddRange(absl::string_view name, uint64_t offset,
+                                    uint64_t size) {
+  if (size == 0) {
+    return;
+  }
+  std::vector<Range>& ranges = ranges_[name];
+  uint64_t begin = offset;
+  uint64_t end = offset + size;
+
+  // Find the ranges overlapping or adjacent to [begin, end) and merge them.
+  auto first = std::lower_bound(
+      ranges.begin(), ranges.end(), begin,
+      [](const Range& r, uint64_t b) { return r.first + r.second < b; });
+  auto last = first;
+  for (; last != ranges.end() && last->first <= end; ++last) {
+    begin = std::min(begin, last->first);
+    end = std::max(end, last->first + last->second);
+  }
+  first = ranges.erase(first, last);
+  ranges.emplace(first, begin, end - begin);
+}
+
+absl::Span<const DataSetAccessProfile::Range> DataSetAccessProfile::GetRanges(
+    absl::string_view name) const {
+  if (const auto it = ranges_.find(name); it != ranges_.end()) {
+    return it->second;
+  }
+  return {};
+}
+
+uint64_t DataSetAccessProfile::GetHotBytes(absl::string_view name) const {
+  uint64_t bytes = 0;
+  for (const auto& [offset, size] : GetRanges(name)) {
+    bytes += size;
+  }
+  return bytes;
+}
+
+std::string DataSetAccessProfile::ToString() const {
+  std::string result;
+  for (const auto& [name, ranges] : ranges_) {
+    for (const auto& [offset, size] : ranges) {
+      absl::StrAppend(&result, name, "\t", offset, "\t", size, "\n");
+    }
+  }
+  return result;
+}
+
+}  // namespace mozc
@@ -0,0 +1,81 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_DATA_MANAGER_DATASET_ACCESS_PROFILE_H_
+#define MOZC_DATA_MANAGER_DATASET_ACCESS_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace mozc {
+
+// Byte ranges of each data set entry accessed by a workload, e.g., the
+// conversion of the first key event after the server starts.  Profiles are
+// recorded by DataManager::GetAccessProfile() and consumed by
+// dataset_writer_main to lay out and prefetch the hot data.
+//
+// The text format has one range per line: "<name>\t<offset>\t<size>", where
+// <name> is the entry name passed to DataSetWriter and <offset> is relative to
+// the beginning of the entry.  Empty lines and lines starting with '#' are
+// ignored.
+class DataSetAccessProfile {
+ public:
+  // {offset, size}
+  using Range = std::pair<uint64_t, uint64_t>;
+
+  static absl::StatusOr<DataSetAccessProfile> Parse(absl::string_view text);
+
+  // Adds a range to `name`.  Overlapping and adjacent ranges are merged.
+  void AddRange(absl::string_view name, uint64_t offset, uint64_t size);
+
+  // Returns the ranges of `name` sorted by offset.
+  absl::Span<const Range> GetRanges(absl::string_view name) const;
+
+  // Returns the total size of the ranges of `name`.
+  uint64_t GetHotBytes(absl::string_view name) const;
+
+  bool empty() const { return ranges_.empty(); }
+
+  std::string ToString() const;
+
+ private:
+  absl::btree_map<std::string, std::vector<Range>> ranges_;
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_DATA_MANAGER_DATASET_ACCESS_PROFILE_H_
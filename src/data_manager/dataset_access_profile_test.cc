@@ -0,0 +1,98 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "data_manager/dataset_access_profile.h"
+
+#include "absl/status/statusor.h"
+#include "testing/gmock.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+TEST(DataSetAccessProfileTest, AddRangeMergesRanges) {
+  DataSetAccessProfile profile;
+  EXPECT_TRUE(profile.empty());
+
+  profile.AddRange("dict", 100, 10);
+  profile.AddRange("dict", 0, 10);
+  profile.AddRange("dict", 50, 0);  // Ignored.
+  EXPECT_THAT(profile.GetRanges("dict"),
+              ElementsAre(Pair(0, 10), Pair(100, 10)));
+
+  // Adjacent to the first range.
+  profile.AddRange("dict", 10, 5);
+  EXPECT_THAT(profile.GetRanges("dict"),
+              ElementsAre(Pair(0, 15), Pair(100, 10)));
+
+  // Overlaps both ranges.
+  profile.AddRange("dict", 12, 90);
+  EXPECT_THAT(profile.GetRanges("dict"), ElementsAre(Pair(0, 110)));
+
+  profile.AddRange("conn", 4096, 4096);
+  EXPECT_EQ(profile.GetHotBytes("dict"), 110);
+  EXPECT_EQ(profile.GetHotBytes("conn"), 4096);
+  EXPECT_EQ(profile.GetHotBytes("sugg"), 0);
+  EXPECT_THAT(profile.GetRanges("sugg"), IsEmpty());
+}
+
+TEST(DataSetAccessProfileTest, ParseAndToString) {
+  constexpr absl::string_view kText =
+      "# comment\n"
+      "dict\t4096\t8192\n"
+      "\n"
+      "conn\t0\t4096\r\n"
+      "dict\t0\t4096\n";
+  absl::StatusOr<DataSetAccessProfile> profile =
+      DataSetAccessProfile::Parse(kText);
+  ASSERT_OK(profile);
+  EXPECT_THAT(profile->GetRanges("dict"), ElementsAre(Pair(0, 12288)));
+  EXPECT_THAT(profile->GetRanges("conn"), ElementsAre(Pair(0, 4096)));
+  EXPECT_EQ(profile->ToString(), "conn\t0\t4096\ndict\t0\t12288\n");
+
+  absl::StatusOr<DataSetAccessProfile> reparsed =
+      DataSetAccessProfile::Parse(profile->ToString());
+  ASSERT_OK(reparsed);
+  EXPECT_EQ(reparsed->ToString(), profile->ToString());
+}
+
+TEST(DataSetAccessProfileTest, ParseFailsForBrokenLines) {
+  EXPECT_FALSE(DataSetAccessProfile::Parse("dict\t0").ok());
+  EXPECT_FALSE(DataSetAccessProfile::Parse("dict\t0\tx").ok());
+  EXPECT_FALSE(DataSetAccessProfile::Parse("\t0\t1").ok());
+  EXPECT_FALSE(DataSetAccessProfile::Parse("dict 0 1").ok());
+}
+
+}  // namespace
+}  // namespace mozc
@@ -52,12 +52,6 @@ constexpr size_t kFooterSize = 36;
 }  // namespace
 
 bool DataSetReader::Init(absl::string_view memblock, absl::string_view magic) {
-  memblock_ = memblock;
-  name_to_data_map_.clear();
-
-  // Initializes |name_to_data_map_| from |memblock|.  For binary data format,
-  // see dataset.proto.
-
   // Check the file magic string.
   if (!memblock.starts_with(magic)) {
     LOG(ERROR) << "Invalid format: magic number doesn't match: "
@@ -70,6 +64,13 @@ bool DataSetReader::Init(absl::string_view memblock, absl::string_view magic) {
 }
 
 bool DataSetReader::Init(absl::string_view memblock, size_t magic_length) {
+  memblock_ = memblock;
+  name_to_data_map_.clear();
+  hot_ranges_.clear();
+
+  // Initializes |name_to_data_map_| from |memblock|.  For binary data format,
+  // see dataset.proto.
+
   // Check minimum required data size.
   if (memblock.size() < magic_length + kFooterSize) {
     LOG(ERROR) << "Broken: data is too small";
@@ -137,9 +138,19 @@ bool DataSetReader::Init(absl::string_view memblock, size_t magic_length) {
                  << ", metadata offset = " << metadata_offset;
       return false;
     }
-    name_to_data_map_[e.name()] =
+    const absl::string_view data =
         absl::ClippedSubstr(memblock, e.offset(), e.size());
+    name_to_data_map_[e.name()] = data;
     prev_chunk_end = e.offset() + e.size();
+
+    for (const DataSetMetadata::Range& range : e.hot_ranges()) {
+      if (range.offset() > e.size() ||
+          range.size() > e.size() - range.offset()) {
+        LOG(ERROR) << "Broken: Hot range is out of range: " << e;
+        return false;
+      }
+      hot_ranges_.push_back(data.substr(range.offset(), range.size()));
+    }
   }
 
   return true;
@@ -34,9 +34,11 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace mozc {
 
@@ -68,11 +70,16 @@ class DataSetReader {
     return name_to_data_map_;
   }
 
+  // Returns the byte blocks marked as hot by DataSetWriter::AddHotRange(), in
+  // the order of the data chunks.
+  absl::Span<const absl::string_view> hot_ranges() const { return hot_ranges_; }
+
  private:
   absl::string_view memblock_;
 
   // The value points to a block of the specified |memblock|.
   absl::flat_hash_map<std::string, absl::string_view> name_to_data_map_;
+  std::vector<absl::string_view> hot_ranges_;
 };
 
 }  // namespace mozc
@@ -51,6 +51,7 @@
 namespace mozc {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::Optional;
 using ::testing::Pair;
 
@@ -86,6 +87,61 @@ TEST(DataSetReaderTest, ValidData) {
   EXPECT_EQ(r.GetOffsetAndSize("foo"), std::nullopt);
 }
 
+TEST(DataSetReaderTest, HotRanges) {
+  constexpr absl::string_view kGoogle("GOOGLE"), kMozc("m\0zc\xEF", 5);
+  std::string image;
+  {
+    DataSetWriter w(kTestMagicNumber);
+    w.Add("google", 16, kGoogle);
+    w.Add("mozc", 64, kMozc);
+    w.AddHotRange("mozc", 1, 3);
+    w.AddHotRange("google", 0, 2);
+    std::stringstream out;
+    w.Finish(&out);
+    image = out.str();
+  }
+
+  DataSetReader r;
+  ASSERT_TRUE(r.Init(image, kTestMagicNumber));
+  // Ordered by the data chunks.
+  EXPECT_THAT(r.hot_ranges(), ElementsAre("GO", absl::string_view("\0zc", 3)));
+
+  // The ranges point to the data chunks.
+  absl::string_view data;
+  ASSERT_TRUE(r.Get("mozc", &data));
+  EXPECT_EQ(r.hot_ranges()[1].data(), data.data() + 1);
+}
+
+TEST(DataSetReaderTest, BrokenHotRange) {
+  std::string image;
+  {
+    DataSetWriter w(kTestMagicNumber);
+    w.Add("google", 16, "GOOGLE");
+    std::stringstream out;
+    w.Finish(&out);
+    image = out.str();
+  }
+  // Rewrite the metadata with a hot range exceeding the data.
+  DataSetReader r;
+  ASSERT_TRUE(r.Init(image, kTestMagicNumber));
+  DataSetMetadata md;
+  auto e = md.add_entries();
+  e->set_name("google");
+  e->set_offset(r.GetOffsetAndSize("google")->first);
+  e->set_size(6);
+  auto range = e->add_hot_ranges();
+  range->set_offset(4);
+  range->set_size(3);
+  const std::string md_str = md.SerializeAsString();
+  std::string broken = image.substr(0, e->offset() + e->size());
+  absl::StrAppend(&broken, md_str, Util::SerializeUint64(md_str.size()));
+  // Checksum is not verified by Init(), so just append a dummy one.
+  broken.append(20, '\0');
+  broken.append(Util::SerializeUint64(broken.size() + 8));
+  EXPECT_FALSE(r.Init(broken, kTestMagicNumber));
+  EXPECT_TRUE(r.hot_ranges().empty());
+}
+
 TEST(DataSetReaderTest, InvalidMagicString) {
   DataSetReader r;
   EXPECT_FALSE(r.Init("", kTestMagicNumber));
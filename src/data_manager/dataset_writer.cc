@@ -30,12 +30,14 @@
 #include "data_manager/dataset_writer.h"
 
 #include <bit>
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <utility>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "base/file_util.h"
@@ -72,6 +74,22 @@ void DataSetWriter::AddFile(absl::string_view name, int alignment,
   Add(name, alignment, *content);
 }
 
+void DataSetWriter::AddHotRange(absl::string_view name, uint64_t offset,
+                                uint64_t size) {
+  for (DataSetMetadata::Entry& entry : *metadata_.mutable_entries()) {
+    if (entry.name() != name) {
+      continue;
+    }
+    CHECK_LE(offset, entry.size()) << "Invalid hot range for " << name;
+    CHECK_LE(size, entry.size() - offset) << "Invalid hot range for " << name;
+    DataSetMetadata::Range* range = entry.add_hot_ranges();
+    range->set_offset(offset);
+    range->set_size(size);
+    return;
+  }
+  LOG(FATAL) << name << " has not been added";
+}
+
 void DataSetWriter::Finish(std::ostream* output) {
   const std::string s = metadata_.SerializeAsString();
   image_.append(s);                                // Metadata
@@ -30,6 +30,7 @@
 #ifndef MOZC_DATA_MANAGER_DATASET_WRITER_H_
 #define MOZC_DATA_MANAGER_DATASET_WRITER_H_
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 
@@ -54,6 +55,10 @@ class DataSetWriter {
   void AddFile(absl::string_view name, int alignment,
                absl::string_view filepath);
 
+  // Marks [offset, offset + size) of the data `name` as hot, i.e., accessed
+  // soon after the data set is loaded.  `name` must have been added.
+  void AddHotRange(absl::string_view name, uint64_t offset, uint64_t size);
+
   // Writes the image to output.  If |output| is a file, it should be opened in
   // binary mode.
   void Finish(std::ostream* output);
@@ -42,14 +42,24 @@
 // where alignment must be a power of 2 greater than or equal to 8 (i.e., 8, 16,
 // 32, 64, ...). Each packed file can be retrieved by DataSetReader through its
 // name.
+//
+// If --access_profile is given (see data_manager/dataset_access_profile.h),
+// files with more hot bytes are packed first so that the hot data is
+// contiguous, and the hot ranges are recorded in the metadata so that the
+// loader can prefetch them.
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <ios>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
@@ -58,11 +68,19 @@
 #include "base/file_util.h"
 #include "base/init_mozc.h"
 #include "base/number_util.h"
+#include "base/parallel.h"
+#include "base/stopwatch.h"
 #include "base/vlog.h"
+#include "data_manager/dataset_access_profile.h"
 #include "data_manager/dataset_writer.h"
 
 ABSL_FLAG(std::string, magic, "", "Hex-encoded magic number to be embedded");
 ABSL_FLAG(std::string, output, "", "Output file");
+ABSL_FLAG(std::string, access_profile, "",
+          "Access profile recorded by DataManager::GetAccessProfile()");
+ABSL_FLAG(int32_t, num_threads, 0,
+          "Number of threads to read input files. 0 means the number of "
+          "hardware threads.");
 
 int main(int argc, char** argv) {
   mozc::InitMozc(argv[0], &argc, &argv);
@@ -96,17 +114,62 @@ int main(int argc, char** argv) {
 
   CHECK(!absl::GetFlag(FLAGS_output).empty()) << "--output is required";
 
+  mozc::DataSetAccessProfile profile;
+  if (const std::string path = absl::GetFlag(FLAGS_access_profile);
+      !path.empty()) {
+    absl::StatusOr<std::string> text = mozc::FileUtil::GetContents(path);
+    CHECK_OK(text) << ": Failed to read " << path;
+    absl::StatusOr<mozc::DataSetAccessProfile> parsed =
+        mozc::DataSetAccessProfile::Parse(*text);
+    CHECK_OK(parsed);
+    profile = *std::move(parsed);
+    // Move hotter files to the front. The order of the others is unchanged.
+    std::stable_sort(inputs.begin(), inputs.end(),
+                     [&profile](const Input& lhs, const Input& rhs) {
+                       return profile.GetHotBytes(lhs.name) >
+                              profile.GetHotBytes(rhs.name);
+                     });
+  }
+
   // DataSetWriter directly writes to the specified stream, so if it fails for
   // an input, the output contains a partial result.  To avoid such partial file
   // creation, write to a temporary file then rename it.
   const std::string tmpfile = absl::GetFlag(FLAGS_output) + ".tmp";
   {
+    // Read the input files in parallel, then pack them in the given order.
+    const mozc::Stopwatch stopwatch = mozc::Stopwatch::StartNew();
+    std::vector<std::string> contents(inputs.size());
+    mozc::ParallelForChunks(
+        inputs.size(), absl::GetFlag(FLAGS_num_threads),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            absl::StatusOr<std::string> content =
+                mozc::FileUtil::GetContents(inputs[i].filename);
+            CHECK_OK(content) << ": Failed to read " << inputs[i].filename;
+            contents[i] = *std::move(content);
+          }
+        },
+        1);
+    MOZC_VLOG(1) << "Read " << inputs.size() << " files in "
+                 << stopwatch.GetElapsed();
+
     mozc::DataSetWriter writer(magic);
-    for (const auto& input : inputs) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      const Input& input = inputs[i];
       MOZC_VLOG(1) << "Writing " << input.name
                    << ", alignment = " << input.alignment
                    << ", file = " << input.filename;
-      writer.AddFile(input.name, input.alignment, input.filename);
+      writer.Add(input.name, input.alignment, contents[i]);
+      for (const auto& [offset, size] : profile.GetRanges(input.name)) {
+        // The profile may be recorded with an older data set.
+        if (offset < contents[i].size()) {
+          writer.AddHotRange(input.name, offset,
+                             std::min<uint64_t>(size,
+                                                contents[i].size() - offset));
+        }
+      }
+      // Release the memory as soon as it's copied to the writer.
+      std::string().swap(contents[i]);
     }
     mozc::OutputFileStream output(tmpfile,
                                   std::ios_base::out | std::ios_base::binary);
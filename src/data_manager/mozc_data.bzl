@@ -65,7 +65,10 @@ def mozc_dataset(
         zero_query_number_def,
         suggestion_filter_safe_def_srcs = [],
         usage_dict = None,
-        extra_data = []):
+        extra_data = [],
+        access_profile = None,
+        emit_token_blocks = False,
+        emit_double_array_key_trie = False):
     """Macro for Mozc data set.
 
     This macro defines a set of genrules each of which has name "name + @xxx",
@@ -138,6 +141,15 @@ def mozc_dataset(
       suggestion_filter_safe_def_srcs: safe list for suggestion filter.
       usage_dict: usage dictionary data.
       extra_data: a list of any data files to include.
+      access_profile: [Optional] access profile recorded by
+              converter_main --access_profile_output.  If provided, hot entries
+              are packed first and their hot ranges are prefetched on load.
+      emit_token_blocks: if true, the system dictionary also has the
+              fixed-width token blocks, which are used with
+              --system_dictionary_use_token_blocks.
+      emit_double_array_key_trie: if true, the system dictionary also has the
+              double-array key trie, which is used with
+              --system_dictionary_use_double_array_key_trie.
     """
     sources = [
         ":" + name + "@user_pos",
@@ -168,11 +180,11 @@ def mozc_dataset(
         "pos_matcher:32:$(@D)/pos_matcher.data " +
         "user_pos_token:32:$(@D)/user_pos_token_array.data " +
         "user_pos_string:32:$(@D)/user_pos_string_array.data " +
-        "coll:32:$(location :" + name + "@collocation) " +
-        "cols:32:$(location :" + name + "@collocation_suppression) " +
+        "coll:512:$(location :" + name + "@collocation) " +
+        "cols:512:$(location :" + name + "@collocation_suppression) " +
         "conn:32:$(location :" + name + "@connection) " +
         "dict:32:$(location :" + name + "@dictionary) " +
-        "sugg:32:$(location :" + name + "@suggestion_filter) " +
+        "sugg:512:$(location :" + name + "@suggestion_filter) " +
         "posg:32:$(location :" + name + "@pos_group) " +
         "bdry:32:$(location :" + name + "@boundary) " +
         "segmenter_sizeinfo:32:$(@D)/segmenter_sizeinfo.data " +
@@ -186,12 +198,15 @@ def mozc_dataset(
         "reading_correction_value:32:$(@D)/reading_correction_value.data " +
         "reading_correction_error:32:$(@D)/reading_correction_error.data " +
         "reading_correction_correction:32:$(@D)/reading_correction_correction.data " +
+        "reading_correction_index:32:$(@D)/reading_correction_index.data " +
         "symbol_token:32:$(@D)/symbol_token.data " +
         "symbol_string:32:$(@D)/symbol_string.data " +
         "emoticon_token:32:$(@D)/emoticon_token.data " +
         "emoticon_string:32:$(@D)/emoticon_string.data " +
+        "emoticon_index:32:$(@D)/emoticon_index.data " +
         "emoji_token:32:$(@D)/emoji_token.data " +
         "emoji_string:32:$(@D)/emoji_string.data " +
+        "emoji_index:32:$(@D)/emoji_index.data " +
         "single_kanji_token:32:$(@D)/single_kanji_token.data " +
         "single_kanji_string:32:$(@D)/single_kanji_string.data " +
         "single_kanji_variant_type:32:$(@D)/single_kanji_variant_type.data " +
@@ -199,12 +214,16 @@ def mozc_dataset(
         "single_kanji_variant_string:32:$(@D)/single_kanji_variant_string.data " +
         "single_kanji_noun_prefix_token:32:$(@D)/single_kanji_noun_prefix_token.data " +
         "single_kanji_noun_prefix_string:32:$(@D)/single_kanji_noun_prefix_string.data " +
+        "single_kanji_noun_prefix_index:32:$(@D)/single_kanji_noun_prefix_index.data " +
         "zero_query_token_array:32:$(@D)/zero_query_token.data " +
         "zero_query_string_array:32:$(@D)/zero_query_string.data " +
+        "zero_query_index:32:$(@D)/zero_query_index.data " +
         "zero_query_number_token_array:32:$(@D)/zero_query_number_token.data " +
         "zero_query_number_string_array:32:$(@D)/zero_query_number_string.data " +
+        "zero_query_number_index:32:$(@D)/zero_query_number_index.data " +
         "a11y_description_token:32:$(@D)/a11y_description_token.data " +
         "a11y_description_string:32:$(@D)/a11y_description_string.data " +
+        "a11y_description_index:32:$(@D)/a11y_description_index.data " +
         "version:32:$(location :" + name + "@version) "
     )
     if usage_dict:
@@ -222,6 +241,10 @@ def mozc_dataset(
         sources.append(target)
         arguments += "%s:%s:$(location %s) " % (key, alignment, target)
 
+    if access_profile:
+        sources.append(access_profile)
+        arguments = "--access_profile=$(location " + access_profile + ") " + arguments
+
     native.genrule(
         name = name,
         srcs = sources,
@@ -371,6 +394,8 @@ def mozc_dataset(
             "$(location //dictionary:gen_system_dictionary_data_main) " +
             "--input=\"" + " ".join(["$(locations %s)" % s for s in dictionary_srcs]) + "\" " +
             "--user_pos_manager_data=$(location :" + name + "@user_pos_manager_data) " +
+            "--emit_token_blocks=" + ("true" if emit_token_blocks else "false") + " " +
+            "--emit_double_array_key_trie=" + ("true" if emit_double_array_key_trie else "false") + " " +
             "--output=$@"
         ),
         tools = ["//dictionary:gen_system_dictionary_data_main"],
@@ -510,13 +535,15 @@ def mozc_dataset(
             "reading_correction_value.data",
             "reading_correction_error.data",
             "reading_correction_correction.data",
+            "reading_correction_index.data",
         ],
         cmd = (
             "$(location //rewriter:gen_reading_correction_data) " +
             "--input=$< " +
             "--output_value_array=$(@D)/reading_correction_value.data " +
             "--output_error_array=$(@D)/reading_correction_error.data " +
-            "--output_correction_array=$(@D)/reading_correction_correction.data"
+            "--output_correction_array=$(@D)/reading_correction_correction.data " +
+            "--output_index=$(@D)/reading_correction_index.data"
         ),
         tools = ["//rewriter:gen_reading_correction_data"],
     )
@@ -551,12 +578,14 @@ def mozc_dataset(
         outs = [
             "emoticon_token.data",
             "emoticon_string.data",
+            "emoticon_index.data",
         ],
         cmd = (
             "$(location //rewriter:gen_emoticon_rewriter_data) " +
             "--input=$< " +
             "--output_token_array=$(location :emoticon_token.data) " +
-            "--output_string_array=$(location :emoticon_string.data)"
+            "--output_string_array=$(location :emoticon_string.data) " +
+            "--output_index=$(location :emoticon_index.data)"
         ),
         tools = ["//rewriter:gen_emoticon_rewriter_data"],
     )
@@ -567,12 +596,14 @@ def mozc_dataset(
         outs = [
             "emoji_token.data",
             "emoji_string.data",
+            "emoji_index.data",
         ],
         cmd = (
             "$(location //rewriter:gen_emoji_rewriter_data) " +
             "--input=$< " +
             "--output_token_array=$(location :emoji_token.data) " +
-            "--output_string_array=$(location :emoji_string.data)"
+            "--output_string_array=$(location :emoji_string.data) " +
+            "--output_index=$(location :emoji_index.data)"
         ),
         tools = ["//rewriter:gen_emoji_rewriter_data"],
     )
@@ -608,11 +639,13 @@ def mozc_dataset(
         outs = [
             "single_kanji_noun_prefix_token.data",
             "single_kanji_noun_prefix_string.data",
+            "single_kanji_noun_prefix_index.data",
         ],
         cmd = (
             "$(location //rewriter:gen_single_kanji_noun_prefix_data) " +
             "--output_token_array=$(location :single_kanji_noun_prefix_token.data) " +
-            "--output_string_array=$(location :single_kanji_noun_prefix_string.data)"
+            "--output_string_array=$(location :single_kanji_noun_prefix_string.data) " +
+            "--output_index=$(location :single_kanji_noun_prefix_index.data)"
         ),
         tools = ["//rewriter:gen_single_kanji_noun_prefix_data"],
     )
@@ -629,6 +662,7 @@ def mozc_dataset(
             "zero_query_data.tsv",
             "zero_query_token.data",
             "zero_query_string.data",
+            "zero_query_index.data",
         ],
         cmd = (
             "$(location //prediction:gen_zero_query_data) " +
@@ -638,7 +672,8 @@ def mozc_dataset(
             "--input_emoticon=$(location " + emoticon_categorized_src + ") " +
             "--output_tsv=$(location :zero_query_data.tsv) " +
             "--output_token_array=$(location :zero_query_token.data) " +
-            "--output_string_array=$(location :zero_query_string.data)"
+            "--output_string_array=$(location :zero_query_string.data) " +
+            "--output_index=$(location :zero_query_index.data)"
         ),
         tools = ["//prediction:gen_zero_query_data"],
     )
@@ -649,12 +684,14 @@ def mozc_dataset(
         outs = [
             "zero_query_number_token.data",
             "zero_query_number_string.data",
+            "zero_query_number_index.data",
         ],
         cmd = (
             "$(location //prediction:gen_zero_query_number_data) " +
             "--input=$< " +
             "--output_token_array=$(location :zero_query_number_token.data) " +
-            "--output_string_array=$(location :zero_query_number_string.data)"
+            "--output_string_array=$(location :zero_query_number_string.data) " +
+            "--output_index=$(location :zero_query_number_index.data)"
         ),
         tools = ["//prediction:gen_zero_query_number_data"],
     )
@@ -667,12 +704,14 @@ def mozc_dataset(
         outs = [
             "a11y_description_token.data",
             "a11y_description_string.data",
+            "a11y_description_index.data",
         ],
         cmd = (
             "$(location //rewriter:gen_a11y_description_rewriter_data) " +
             "--input=$(location " + a11y_description_src + ") " +
             "--output_token_array=$(location :a11y_description_token.data) " +
-            "--output_string_array=$(location :a11y_description_string.data) "
+            "--output_string_array=$(location :a11y_description_string.data) " +
+            "--output_index=$(location :a11y_description_index.data) "
         ),
         tools = ["//rewriter:gen_a11y_description_rewriter_data"],
     )
@@ -42,9 +42,11 @@
 
 #include "absl/container/btree_map.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "base/bits.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 #include "base/file_stream.h"
 #include "base/file_util.h"
@@ -87,14 +89,23 @@ void LoadTokens(std::istream* ifs, std::map<std::string, TokenList>* dic) {
 }  // namespace
 
 SerializedDictionary::SerializedDictionary(absl::string_view token_array,
-                                           absl::string_view string_array_data)
+                                           absl::string_view string_array_data,
+                                           absl::string_view index_data)
     : token_array_(token_array) {
   DCHECK(VerifyData(token_array, string_array_data));
   string_array_.Set(string_array_data);
+  if (!index_data.empty() && !index_.Init(index_data, size())) {
+    LOG(WARNING) << "Invalid index is ignored";
+  }
 }
 
 SerializedDictionary::IterRange SerializedDictionary::equal_range(
     absl::string_view key) const {
+  if (!index_.empty()) {
+    const auto [first, last] =
+        index_.Find(key, [this](uint32_t i) { return (begin() + i).key(); });
+    return IterRange(begin() + first, begin() + last);
+  }
   // TODO(noriyukit): Instead of comparing key as string, we can do binary
   // search using key index to minimize string comparison cost.
   return std::equal_range(begin(), end(), key);
@@ -189,24 +200,34 @@ std::pair<absl::string_view, absl::string_view> SerializedDictionary::Compile(
 
 void SerializedDictionary::CompileToFiles(
     absl::string_view input, absl::string_view output_token_array,
-    absl::string_view output_string_array) {
+    absl::string_view output_string_array, absl::string_view output_index) {
   InputFileStream ifs(input);
   CHECK(ifs.good());
   std::map<std::string, TokenList> dic;
   LoadTokens(&ifs, &dic);
-  CompileToFiles(dic, output_token_array, output_string_array);
+  CompileToFiles(dic, output_token_array, output_string_array, output_index);
 }
 
 void SerializedDictionary::CompileToFiles(
     const std::map<std::string, TokenList>& dic,
     absl::string_view output_token_array,
-    absl::string_view output_string_array) {
+    absl::string_view output_string_array, absl::string_view output_index) {
   std::unique_ptr<uint32_t[]> buf1, buf2;
   const std::pair<absl::string_view, absl::string_view> data =
       Compile(dic, &buf1, &buf2);
   CHECK(VerifyData(data.first, data.second));
   CHECK_OK(FileUtil::SetContents(output_token_array, data.first));
   CHECK_OK(FileUtil::SetContents(output_string_array, data.second));
+  if (output_index.empty()) {
+    return;
+  }
+  const SerializedDictionary serialized_dic(data.first, data.second);
+  std::vector<absl::string_view> keys;
+  keys.reserve(serialized_dic.size());
+  for (auto it = serialized_dic.begin(); it != serialized_dic.end(); ++it) {
+    keys.push_back(it.key());
+  }
+  PerfectHashIndex::BuildToFile(keys, std::string(output_index));
 }
 
 bool SerializedDictionary::VerifyData(absl::string_view token_array_data,
@@ -43,6 +43,7 @@
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "base/bits.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 
 namespace mozc {
@@ -75,6 +76,10 @@ namespace mozc {
 // designed to have similar interfaces to std::multimap<string, Value>, so
 // values can be looked up by equal_range(), etc.
 //
+// Optionally, a PerfectHashIndex over the token array can be generated by
+// CompileToFiles() and passed to the constructor, in which case equal_range()
+// looks up keys by hash instead of binary search.
+//
 // * Binary format
 //
 // ** String array
@@ -280,22 +285,27 @@ class SerializedDictionary {
       std::unique_ptr<uint32_t[]>* output_token_array_buf,
       std::unique_ptr<uint32_t[]>* output_string_array_buf);
 
-  // Creates serialized data and writes them to files.
+  // Creates serialized data and writes them to files.  If |output_index| is
+  // not empty, a PerfectHashIndex over the token array is written to it, too.
   static void CompileToFiles(absl::string_view input,
                              absl::string_view output_token_array,
-                             absl::string_view output_string_array);
+                             absl::string_view output_string_array,
+                             absl::string_view output_index = "");
   static void CompileToFiles(const std::map<std::string, TokenList>& dic,
                              absl::string_view output_token_array,
-                             absl::string_view output_string_array);
+                             absl::string_view output_string_array,
+                             absl::string_view output_index = "");
 
   // Validates the serialized data.
   static bool VerifyData(absl::string_view token_array_data,
                          absl::string_view string_array_data);
 
   // Both |token_array| and |string_array_data| must be aligned at 4-byte
-  // boundary.
+  // boundary.  |index_data| is an optional PerfectHashIndex image generated by
+  // CompileToFiles(), which is ignored if it's empty or invalid.
   SerializedDictionary(absl::string_view token_array,
-                       absl::string_view string_array_data);
+                       absl::string_view string_array_data,
+                       absl::string_view index_data = "");
   ~SerializedDictionary() = default;
 
   std::size_t size() const { return token_array_.size() / kTokenByteLength; }
@@ -319,6 +329,7 @@ class SerializedDictionary {
  private:
   absl::string_view token_array_;
   SerializedStringArray string_array_;
+  PerfectHashIndex index_;
 };
 
 }  // namespace mozc
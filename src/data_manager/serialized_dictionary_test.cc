@@ -34,8 +34,10 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 #include "testing/gunit.h"
 
@@ -183,5 +185,33 @@ TEST_F(SerializedDictionaryTest, EqualRange) {
   }
 }
 
+TEST_F(SerializedDictionaryTest, EqualRangeWithIndex) {
+  const SerializedDictionary dic_without_index(token_array_data_,
+                                               string_array_data_);
+  std::vector<absl::string_view> keys;
+  for (auto it = dic_without_index.begin(); it != dic_without_index.end();
+       ++it) {
+    keys.push_back(it.key());
+  }
+  std::unique_ptr<uint32_t[]> buf;
+  const absl::string_view index_data =
+      PerfectHashIndex::BuildToBuffer(keys, &buf);
+
+  const SerializedDictionary dic(token_array_data_, string_array_data_,
+                                 index_data);
+  for (absl::string_view key : {"key1", "key2", "mozc", ""}) {
+    const SerializedDictionary::IterRange expected =
+        dic_without_index.equal_range(key);
+    const SerializedDictionary::IterRange actual = dic.equal_range(key);
+    ASSERT_EQ(actual.second - actual.first, expected.second - expected.first)
+        << key;
+    for (auto it1 = actual.first, it2 = expected.first; it1 != actual.second;
+         ++it1, ++it2) {
+      EXPECT_EQ(it1.key(), it2.key());
+      EXPECT_EQ(it1.value(), it2.value());
+    }
+  }
+}
+
 }  // namespace
 }  // namespace mozc
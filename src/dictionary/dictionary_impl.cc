@@ -247,6 +247,13 @@ void DictionaryImpl::ClearReverseLookupCache() const {
   }
 }
 
+void DictionaryImpl::CollectMemoryUsage(
+    MemoryUsageCollector& collector) const {
+  // The user dictionary is not owned by this class and reported by its owner.
+  system_dictionary_->CollectMemoryUsage(collector);
+  value_dictionary_->CollectMemoryUsage(collector);
+}
+
 absl::Span<const DictionaryInterface* const> DictionaryImpl::GetDictionaries(
     bool incognito_mode) const {
   // Removes the last user dictionary when incognito_mode.
@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "base/memory_usage.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/pos_matcher.h"
 #include "request/options.h"
@@ -94,6 +95,7 @@ class DictionaryImpl : public DictionaryInterface {
                      std::string* comment) const override;
   void PopulateReverseLookupCache(absl::string_view str) const override;
   void ClearReverseLookupCache() const override;
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
 
  private:
   absl::Span<const DictionaryInterface* const> GetDictionaries(
@@ -36,6 +36,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "base/memory_usage.h"
 #include "dictionary/dictionary_token.h"
 #include "protocol/user_dictionary_storage.pb.h"
 #include "request/options.h"
@@ -199,6 +200,9 @@ class DictionaryInterface {
   virtual void PopulateReverseLookupCache(absl::string_view str) const {}
   virtual void ClearReverseLookupCache() const {}
 
+  // Reports the memory used by this dictionary, e.g. its caches and indices.
+  virtual void CollectMemoryUsage(MemoryUsageCollector& collector) const {}
+
  protected:
   // Do not allow instantiation
   DictionaryInterface() = default;
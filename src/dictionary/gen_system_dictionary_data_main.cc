@@ -34,6 +34,7 @@
 //  --output="output.h"
 //  --make_header
 
+#include <cstdint>
 #include <ios>
 #include <memory>
 #include <ostream>
@@ -44,11 +45,14 @@
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "base/file_stream.h"
 #include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "base/system_util.h"
 #include "data_manager/data_manager.h"
 #include "dictionary/pos_matcher.h"
 #include "dictionary/system/system_dictionary_builder.h"
@@ -57,6 +61,13 @@
 ABSL_FLAG(std::string, input, "", "space separated input text files");
 ABSL_FLAG(std::string, user_pos_manager_data, "", "user pos manager data");
 ABSL_FLAG(std::string, output, "", "output binary file");
+ABSL_FLAG(int32_t, num_threads, 0,
+          "number of threads to build the dictionary. 0 means the number of "
+          "hardware threads. The output is the same regardless of this value.");
+ABSL_FLAG(bool, emit_token_blocks, false,
+          "write the fixed-width token blocks in addition to the token array.");
+ABSL_FLAG(bool, emit_double_array_key_trie, false,
+          "write the double-array key trie in addition to the LOUDS key trie.");
 
 namespace mozc {
 namespace {
@@ -90,6 +101,12 @@ std::pair<std::string, std::string> GetInputFileName(
           absl::StrJoin(reading_correction_inputs, kDelimiter)};
 }
 
+void LogPhase(absl::string_view name, const Stopwatch& stopwatch) {
+  LOG(INFO) << name << ": " << stopwatch.GetElapsed() << ", peak memory: "
+            << SystemUtil::GetPeakResidentMemorySize() / (1024 * 1024)
+            << " MiB";
+}
+
 }  // namespace
 }  // namespace mozc
 
@@ -111,15 +128,27 @@ int main(int argc, char** argv) {
   const mozc::dictionary::PosMatcher pos_matcher(
       data_manager.value()->GetPosMatcherData());
 
+  const int num_threads = absl::GetFlag(FLAGS_num_threads);
+  mozc::Stopwatch stopwatch = mozc::Stopwatch::StartNew();
   mozc::dictionary::TextDictionaryLoader loader(pos_matcher);
+  loader.set_num_threads(num_threads);
   loader.Load(system_dictionary_input, reading_correction_input);
+  mozc::LogPhase("Load", stopwatch);
 
+  stopwatch = mozc::Stopwatch::StartNew();
   mozc::dictionary::SystemDictionaryBuilder builder;
+  builder.set_num_threads(num_threads);
+  builder.set_emit_token_blocks(absl::GetFlag(FLAGS_emit_token_blocks));
+  builder.set_emit_double_array_key_trie(
+      absl::GetFlag(FLAGS_emit_double_array_key_trie));
   builder.BuildFromTokens(loader.tokens());
+  mozc::LogPhase("Build", stopwatch);
 
+  stopwatch = mozc::Stopwatch::StartNew();
   auto output_stream = std::make_unique<mozc::OutputFileStream>(
       absl::GetFlag(FLAGS_output), std::ios::out | std::ios::binary);
   builder.WriteToStream(absl::GetFlag(FLAGS_output), output_stream.get());
+  mozc::LogPhase("Write", stopwatch);
 
   return 0;
 }
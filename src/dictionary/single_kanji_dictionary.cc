@@ -57,7 +57,8 @@ SingleKanjiDictionary::SingleKanjiDictionary(
     absl::string_view variant_token_array_data,
     absl::string_view variant_string_array_data,
     absl::string_view noun_prefix_token_array_data,
-    absl::string_view noun_prefix_string_array_data)
+    absl::string_view noun_prefix_string_array_data,
+    absl::string_view noun_prefix_index_data)
     : single_kanji_token_array_(token_array_data),
       variant_token_array_(variant_token_array_data) {
   // Single Kanji token array is an array of uint32_t.  Its size must be
@@ -78,7 +79,8 @@ SingleKanjiDictionary::SingleKanjiDictionary(
   DCHECK(SerializedDictionary::VerifyData(noun_prefix_token_array_data,
                                           noun_prefix_string_array_data));
   noun_prefix_dictionary_ = std::make_unique<SerializedDictionary>(
-      noun_prefix_token_array_data, noun_prefix_string_array_data);
+      noun_prefix_token_array_data, noun_prefix_string_array_data,
+      noun_prefix_index_data);
 }
 
 // The underlying token array, |single_kanji_token_array_|, has the following
@@ -51,7 +51,8 @@ class SingleKanjiDictionary {
                         absl::string_view variant_token_array_data,
                         absl::string_view variant_string_array_data,
                         absl::string_view noun_prefix_token_array_data,
-                        absl::string_view noun_prefix_string_array_data);
+                        absl::string_view noun_prefix_string_array_data,
+                        absl::string_view noun_prefix_index_data = "");
 
   SingleKanjiDictionary(const SingleKanjiDictionary&) = delete;
   SingleKanjiDictionary& operator=(const SingleKanjiDictionary&) = delete;
@@ -39,6 +39,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/bits.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "dictionary/dictionary_token.h"
@@ -53,6 +54,8 @@ constexpr absl::string_view kKeySectionName = "k";
 constexpr absl::string_view kValueSectionName = "v";
 constexpr absl::string_view kTokensSectionName = "t";
 constexpr absl::string_view kPosSectionName = "p";
+constexpr absl::string_view kTokenBlocksSectionName = "b";
+constexpr absl::string_view kDoubleArrayKeySectionName = "d";
 
 //// Constants for validation ////
 // 12 bits
@@ -169,6 +172,16 @@ constexpr uint8_t kUpperCrammedIDMask = 0x3f;
 // This token is last token for a index word
 constexpr uint8_t kLastTokenFlag = 0x80;
 
+//// Token block ////
+// pos: lid (12 bits) | rid (12 bits) | spelling correction (1 bit)
+constexpr int kTokenBlockRidShift = 12;
+constexpr uint32_t kTokenBlockSpellingCorrectionBit = 1 << 24;
+// value: id in value trie (22 bits) | value type (2 bits)
+// SAME_AS_PREV_VALUE is stored as DEFAULT_VALUE with the resolved id so that
+// every token is decoded without the previous one.
+constexpr int kTokenBlockValueTypeShift = 30;
+constexpr size_t kTokenBlockSizeMax = 0xffff;
+
 // Swap the area for Hiragana, prolonged sound mark and middle dot with
 // the one for control codes and alphabets.
 //
@@ -526,6 +539,15 @@ absl::string_view SystemDictionaryCodec::GetSectionNameForPos() const {
   return kPosSectionName;
 }
 
+absl::string_view SystemDictionaryCodec::GetSectionNameForTokenBlocks() const {
+  return kTokenBlocksSectionName;
+}
+
+absl::string_view SystemDictionaryCodec::GetSectionNameForDoubleArrayKey()
+    const {
+  return kDoubleArrayKeySectionName;
+}
+
 std::string SystemDictionaryCodec::EncodeKey(absl::string_view src) const {
   return EncodeDecodeKeyImpl(src);
 }
@@ -769,6 +791,78 @@ bool SystemDictionaryCodec::ReadTokenForReverseLookup(const uint8_t* ptr,
   return !(flags & kLastTokenFlag);
 }
 
+std::string SystemDictionaryCodec::EncodeTokenBlock(
+    absl::Span<const TokenInfo> tokens) const {
+  CHECK(!tokens.empty());
+  CHECK_LE(tokens.size(), kTokenBlockSizeMax);
+  const size_t size = tokens.size();
+  std::string output(TokenBlock::GetByteSize(size), '\0');
+  char* const ptr = output.data();
+
+  for (size_t i = 0; i < size; ++i) {
+    const TokenInfo& token_info = tokens[i];
+    const Token* token = token_info.token;
+    CHECK_LE(token->cost, kCostMax) << "Assuming cost is within 15bits.";
+    CHECK_LE(token->lid, kPosMax);
+    CHECK_LE(token->rid, kPosMax);
+
+    // Drops the lower 8 bits as the small cost encoding does so that both
+    // formats decode the same cost.
+    uint16_t cost = token->cost;
+    if (token_info.cost_type == TokenInfo::CAN_USE_SMALL_ENCODING) {
+      cost &= kSmallCostMask << 8;
+    }
+
+    uint32_t pos = token->lid | (token->rid << kTokenBlockRidShift);
+    if (token->attributes & Token::SPELLING_CORRECTION) {
+      pos |= kTokenBlockSpellingCorrectionBit;
+    }
+
+    TokenInfo::ValueType value_type = token_info.value_type;
+    if (value_type == TokenInfo::SAME_AS_PREV_VALUE) {
+      value_type = TokenInfo::DEFAULT_VALUE;
+    }
+    uint32_t value = static_cast<uint32_t>(value_type)
+                     << kTokenBlockValueTypeShift;
+    if (value_type == TokenInfo::DEFAULT_VALUE) {
+      CHECK_GE(token_info.id_in_value_trie, 0);
+      CHECK_LE(token_info.id_in_value_trie, kValueTrieIdMax);
+      value |= token_info.id_in_value_trie;
+    }
+
+    StoreUnaligned<uint16_t>(cost, ptr + TokenBlock::kHeaderSize + i * 2);
+    StoreUnaligned<uint32_t>(pos,
+                             ptr + TokenBlock::GetPosOffset(size) + i * 4);
+    StoreUnaligned<uint32_t>(value,
+                             ptr + TokenBlock::GetValueOffset(size) + i * 4);
+  }
+  StoreUnaligned<uint16_t>(size, ptr);
+  return output;
+}
+
+void SystemDictionaryCodec::DecodeTokenBlock(const TokenBlock& block,
+                                             size_t index,
+                                             TokenInfo* token_info) const {
+  DCHECK_LT(index, block.size());
+  DCHECK(token_info);
+  Token* token = token_info->token;
+
+  const uint32_t pos = block.pos(index);
+  token->lid = pos & kPosMax;
+  token->rid = (pos >> kTokenBlockRidShift) & kPosMax;
+  if (pos & kTokenBlockSpellingCorrectionBit) {
+    token->attributes = Token::SPELLING_CORRECTION;
+  }
+  token->cost = block.cost(index);
+
+  const uint32_t value = block.value(index);
+  token_info->value_type =
+      static_cast<TokenInfo::ValueType>(value >> kTokenBlockValueTypeShift);
+  if (token_info->value_type == TokenInfo::DEFAULT_VALUE) {
+    token_info->id_in_value_trie = value & kValueTrieIdMax;
+  }
+}
+
 #endif  // GOOGLE_JAPANESE_INPUT_BUILD
 
 }  // namespace dictionary
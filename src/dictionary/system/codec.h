@@ -37,11 +37,13 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/bits.h"
 
 namespace mozc {
 namespace dictionary {
 
 struct TokenInfo;
+class TokenBlock;
 
 class SystemDictionaryCodec {
  public:
@@ -59,6 +61,12 @@ class SystemDictionaryCodec {
   // Return section name for frequent pos map
   virtual absl::string_view GetSectionNameForPos() const;
 
+  // Return section name for token blocks
+  virtual absl::string_view GetSectionNameForTokenBlocks() const;
+
+  // Return section name for double-array key trie
+  virtual absl::string_view GetSectionNameForDoubleArrayKey() const;
+
   // Compresses key string into small bytes.
   virtual std::string EncodeKey(absl::string_view src) const;
 
@@ -93,10 +101,66 @@ class SystemDictionaryCodec {
 
   virtual uint8_t GetTokensTerminationFlag() const;
 
+  // Compress tokens into a token block. Unlike EncodeTokens, every token
+  // takes the same number of bytes so the tokens can be decoded by index.
+  virtual std::string EncodeTokenBlock(
+      absl::Span<const TokenInfo> tokens) const;
+
+  // Decompress the `index`-th token of `block`. The same fields as
+  // DecodeToken are updated except that the pos is always decoded.
+  virtual void DecodeTokenBlock(const TokenBlock& block, size_t index,
+                                TokenInfo* token_info) const;
+
  private:
   std::string EncodeToken(absl::Span<const TokenInfo> tokens, int index) const;
 };
 
+// View of a token block, the fixed-width encoding of the tokens of a key.
+// Each field is stored in its own column at a fixed offset:
+//
+//   uint16_t size
+//   uint16_t cost[size]   (padded to a multiple of 4 bytes with the header)
+//   uint32_t pos[size]
+//   uint32_t value[size]
+//
+// The bit layout of pos and value is defined by SystemDictionaryCodec.
+class TokenBlock {
+ public:
+  TokenBlock() = default;
+  explicit TokenBlock(const uint8_t* ptr)
+      : ptr_(ptr), size_(LoadUnaligned<uint16_t>(ptr)) {}
+
+  size_t size() const { return size_; }
+
+  uint16_t cost(size_t index) const {
+    return LoadUnaligned<uint16_t>(ptr_ + kHeaderSize + index * 2);
+  }
+  uint32_t pos(size_t index) const {
+    return LoadUnaligned<uint32_t>(ptr_ + GetPosOffset(size_) + index * 4);
+  }
+  uint32_t value(size_t index) const {
+    return LoadUnaligned<uint32_t>(ptr_ + GetValueOffset(size_) + index * 4);
+  }
+
+  static constexpr size_t kHeaderSize = 2;
+
+  // Returns the offsets of the columns and the total byte size of a block of
+  // `size` tokens.
+  static constexpr size_t GetPosOffset(size_t size) {
+    return (kHeaderSize + size * 2 + 3) / 4 * 4;
+  }
+  static constexpr size_t GetValueOffset(size_t size) {
+    return GetPosOffset(size) + size * 4;
+  }
+  static constexpr size_t GetByteSize(size_t size) {
+    return GetValueOffset(size) + size * 4;
+  }
+
+ private:
+  const uint8_t* ptr_ = nullptr;
+  size_t size_ = 0;
+};
+
 }  // namespace dictionary
 }  // namespace mozc
 
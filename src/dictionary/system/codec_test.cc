@@ -29,6 +29,7 @@
 
 #include "dictionary/system/codec.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -653,6 +654,58 @@ TEST_F(SystemDictionaryCodecTest, ReadTokenRandomTest) {
   EXPECT_EQ(read_num, source_tokens_.size());
 }
 
+TEST_F(SystemDictionaryCodecTest, TokenBlockRandomTest) {
+  auto codec = std::make_unique<SystemDictionaryCodec>();
+  InitTokens(50);
+  for (TokenInfo& token_info : source_tokens_) {
+    SetDefaultPos(&token_info);
+  }
+  SetRandCost();
+  SetRandValue();
+  SetRandLabel();
+  // Resolves the ids of SAME_AS_PREV_VALUE as SystemDictionaryBuilder does.
+  for (size_t i = 1; i < source_tokens_.size(); ++i) {
+    TokenInfo& token_info = source_tokens_[i];
+    if (token_info.value_type != TokenInfo::SAME_AS_PREV_VALUE) {
+      continue;
+    }
+    const TokenInfo& prev_token_info = source_tokens_[i - 1];
+    if (prev_token_info.value_type == TokenInfo::AS_IS_HIRAGANA ||
+        prev_token_info.value_type == TokenInfo::AS_IS_KATAKANA) {
+      SetDefaultValue(&token_info);
+    } else {
+      token_info.id_in_value_trie = prev_token_info.id_in_value_trie;
+    }
+  }
+  const std::string encoded = codec->EncodeTokenBlock(source_tokens_);
+  EXPECT_EQ(encoded.size(), TokenBlock::GetByteSize(source_tokens_.size()));
+  EXPECT_EQ(encoded.size() % 4, 0);
+
+  // SAME_AS_PREV_VALUE is decoded as DEFAULT_VALUE with the resolved id.
+  for (TokenInfo& token_info : source_tokens_) {
+    if (token_info.value_type == TokenInfo::SAME_AS_PREV_VALUE) {
+      token_info.value_type = TokenInfo::DEFAULT_VALUE;
+    }
+  }
+
+  // Every token is decoded by its index without the previous tokens.
+  const TokenBlock block(reinterpret_cast<const uint8_t*>(encoded.data()));
+  ASSERT_EQ(block.size(), source_tokens_.size());
+  for (size_t i = block.size(); i > 0; --i) {
+    decoded_tokens_.push_back(TokenInfo(token_arena_.Alloc()));
+    codec->DecodeTokenBlock(block, i - 1, &decoded_tokens_.back());
+  }
+  std::reverse(decoded_tokens_.begin(), decoded_tokens_.end());
+  CheckDecoded();
+
+  // Both formats decode the same costs, including the small cost encoding.
+  const std::vector<TokenInfo> tokens =
+      DecodeTokens(*codec, codec->EncodeTokens(source_tokens_));
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(decoded_tokens_[i].token->cost, tokens[i].token->cost);
+  }
+}
+
 TEST_F(SystemDictionaryCodecTest, CodecTest) {
   auto codec = std::make_unique<SystemDictionaryCodec>();
   {  // Token
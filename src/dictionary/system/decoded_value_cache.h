@@ -0,0 +1,97 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_DICTIONARY_SYSTEM_DECODED_VALUE_CACHE_H_
+#define MOZC_DICTIONARY_SYSTEM_DECODED_VALUE_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "base/container/flat_concurrent_cache.h"
+
+namespace mozc {
+namespace dictionary {
+
+// Bounded cache from the id in the value trie to the decoded value string.
+// Restoring a value requires a leaf-to-root walk in the LOUDS trie followed by
+// DecodeValue, which dominates the cost of looking up common words. The cache
+// is owned by SystemDictionary and thus shared by all the sessions. All the
+// methods are thread-safe.
+class DecodedValueCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  explicit DecodedValueCache(size_t size) : cache_(size) {}
+
+  DecodedValueCache(const DecodedValueCache&) = delete;
+  DecodedValueCache& operator=(const DecodedValueCache&) = delete;
+
+  // Copies the cached value of `id` to `value` and returns true if found.
+  bool Lookup(int id, std::string* value) const {
+    if (cache_.Lookup(id, value)) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  void Insert(int id, const std::string& value) { cache_.Insert(id, value); }
+
+  void Clear() {
+    cache_.Clear();
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+  }
+
+  // Returns the bytes allocated for the cache entries, excluding the contents
+  // of the cached strings.
+  size_t GetMemoryUsage() const { return cache_.GetMemoryUsage(); }
+
+  Stats GetStats() const {
+    return {hits_.load(std::memory_order_relaxed),
+            misses_.load(std::memory_order_relaxed)};
+  }
+
+ private:
+  FlatConcurrentCache<int, std::string> cache_;
+  mutable std::atomic<uint64_t> hits_ = 0;
+  mutable std::atomic<uint64_t> misses_ = 0;
+};
+
+}  // namespace dictionary
+}  // namespace mozc
+
+#endif  // MOZC_DICTIONARY_SYSTEM_DECODED_VALUE_CACHE_H_
@@ -0,0 +1,82 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "dictionary/system/decoded_value_cache.h"
+
+#include <string>
+
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace dictionary {
+namespace {
+
+TEST(DecodedValueCacheTest, LookupAndInsert) {
+  DecodedValueCache cache(16);
+  std::string value;
+  EXPECT_FALSE(cache.Lookup(1, &value));
+  cache.Insert(1, "私");
+  cache.Insert(2, "の");
+  EXPECT_TRUE(cache.Lookup(1, &value));
+  EXPECT_EQ(value, "私");
+  EXPECT_TRUE(cache.Lookup(2, &value));
+  EXPECT_EQ(value, "の");
+  EXPECT_FALSE(cache.Lookup(3, &value));
+
+  const DecodedValueCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 2);
+
+  cache.Clear();
+  EXPECT_EQ(cache.GetStats().hits, 0);
+  EXPECT_EQ(cache.GetStats().misses, 0);
+  EXPECT_FALSE(cache.Lookup(1, &value));
+}
+
+TEST(DecodedValueCacheTest, Bounded) {
+  DecodedValueCache cache(16);
+  for (int i = 0; i < 1000; ++i) {
+    cache.Insert(i, std::to_string(i));
+  }
+  int found = 0;
+  std::string value;
+  for (int i = 0; i < 1000; ++i) {
+    if (cache.Lookup(i, &value)) {
+      EXPECT_EQ(value, std::to_string(i));
+      ++found;
+    }
+  }
+  EXPECT_GT(found, 0);
+  EXPECT_LT(found, 1000);
+}
+
+}  // namespace
+}  // namespace dictionary
+}  // namespace mozc
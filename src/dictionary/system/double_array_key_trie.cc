@@ -0,0 +1,205 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "dictionary/system/double_array_key_trie.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "base/bits.h"
+#include "storage/louds/louds_trie.h"
+
+namespace mozc {
+namespace dictionary {
+
+using ::mozc::storage::louds::LoudsTrie;
+
+std::string DoubleArrayKeyTrie::BuildImage(const LoudsTrie& louds_trie) {
+  constexpr Unit kUnusedUnit = {0, -1, -1, 0, 0};
+  std::vector<Unit> units(1, kUnusedUnit);
+  std::vector<bool> used(1, true);
+  // next_free[i] leads to the first open unit at or after i, where an open
+  // unit is a free unit that is still worth trying as the first child of a
+  // node. The links are compressed as they are followed, so the search skips
+  // the densely packed area in amortized constant time. The last entry is an
+  // open sentinel and the units beyond it are open as well.
+  std::vector<size_t> next_free = {1, 1};
+  // The number of the failed trials to place the first child at each unit. A
+  // unit is closed after too many failures, which bounds the search in the
+  // area fragmented by the nodes with many children.
+  constexpr uint8_t kMaxTrials = 16;
+  std::vector<uint8_t> trials(2, 0);
+  auto find_free = [&next_free](size_t pos) {
+    if (pos >= next_free.size()) {
+      return pos;
+    }
+    size_t free = pos;
+    while (next_free[free] != free) {
+      free = next_free[free];
+    }
+    while (next_free[pos] != free) {
+      pos = std::exchange(next_free[pos], free);
+    }
+    return free;
+  };
+  auto is_used = [&used](size_t pos) { return pos < used.size() && used[pos]; };
+  auto close = [&next_free](size_t pos) { next_free[pos] = pos + 1; };
+
+  // Returns the smallest base whose slots for all the `labels` are free, and
+  // extends `units` to cover them.
+  auto find_base = [&](const std::vector<uint8_t>& labels) -> int32_t {
+    for (size_t pos = find_free(0);; pos = find_free(pos + 1)) {
+      // Tries only the bases that put the first child into a free unit.
+      if (pos < labels.front()) {
+        continue;
+      }
+      const size_t base = pos - labels.front();
+      bool fits = true;
+      for (const uint8_t label : labels) {
+        if (is_used(base + label)) {
+          fits = false;
+          break;
+        }
+      }
+      if (!fits) {
+        if (pos < trials.size() && ++trials[pos] >= kMaxTrials) {
+          close(pos);
+        }
+        continue;
+      }
+      const size_t required = base + 256;
+      if (units.size() < required) {
+        units.resize(required, kUnusedUnit);
+        used.resize(required, false);
+        trials.resize(required + 1, 0);
+        for (size_t i = next_free.size(); i <= required; ++i) {
+          next_free.push_back(i);
+        }
+      }
+      return static_cast<int32_t>(base);
+    }
+  };
+
+  // Places the nodes in BFS order so that the siblings and the children of
+  // the nodes at the same depth stay close.
+  std::queue<std::pair<LoudsTrie::Node, int32_t>> queue;
+  queue.emplace(LoudsTrie::Node(), 0);
+  std::vector<uint8_t> labels;
+  std::vector<LoudsTrie::Node> children;
+  while (!queue.empty()) {
+    const auto [louds_node, index] = queue.front();
+    queue.pop();
+    if (louds_trie.IsTerminalNode(louds_node)) {
+      units[index].key_id = louds_trie.GetKeyIdOfTerminalNode(louds_node);
+    }
+
+    labels.clear();
+    children.clear();
+    for (LoudsTrie::Node child = louds_trie.MoveToFirstChild(louds_node);
+         louds_trie.IsValidNode(child); LoudsTrie::MoveToNextSibling(&child)) {
+      labels.push_back(louds_trie.GetEdgeLabelToParentNode(child));
+      children.push_back(child);
+    }
+    if (children.empty()) {
+      continue;
+    }
+
+    const int32_t base = find_base(labels);
+    units[index].base = base;
+    units[index].child = labels.front() + 1;
+    for (size_t i = 0; i < labels.size(); ++i) {
+      const int32_t child_index = base + labels[i];
+      Unit& unit = units[child_index];
+      unit.check = index;
+      unit.sibling = i + 1 < labels.size() ? labels[i + 1] + 1 : 0;
+      used[child_index] = true;
+      close(child_index);
+      queue.emplace(children[i], child_index);
+    }
+  }
+
+  // Drops the trailing unused units.
+  size_t size = units.size();
+  while (size > 1 && !is_used(size - 1)) {
+    --size;
+  }
+  return std::string(reinterpret_cast<const char*>(units.data()),
+                     size * sizeof(Unit));
+}
+
+bool DoubleArrayKeyTrie::Open(absl::string_view image) {
+  units_ = MakeAlignedConstSpan<Unit>(image);
+  if (units_.empty()) {
+    return false;
+  }
+  // The root has no parent, and its first child, if any, points back to it.
+  const Unit& root = units_[0];
+  bool valid = root.check == -1;
+  if (valid && root.child != 0) {
+    const int64_t index = static_cast<int64_t>(root.base) + root.child - 1;
+    valid = index > 0 && static_cast<size_t>(index) < units_.size() &&
+            units_[index].check == 0;
+  }
+  if (!valid) {
+    units_ = {};
+  }
+  return valid;
+}
+
+absl::string_view DoubleArrayKeyTrie::RestoreKeyString(Node node,
+                                                       char* buf) const {
+  // Ensure the returned string view is null-terminated.
+  char* const buf_end = buf + kMaxDepth;
+  *buf_end = '\0';
+
+  // Climb up the trie to the root and fill |buf| backward.
+  char* ptr = buf_end;
+  for (; node.index_ != 0; node.index_ = units_[node.index_].check) {
+    *--ptr = GetEdgeLabelToParentNode(node);
+  }
+  return absl::string_view(ptr, buf_end - ptr);
+}
+
+int DoubleArrayKeyTrie::ExactSearch(absl::string_view key) const {
+  Node node;
+  for (const char c : key) {
+    if (!MoveToChildByLabel(c, &node)) {
+      return -1;
+    }
+  }
+  return IsTerminalNode(node) ? GetKeyIdOfTerminalNode(node) : -1;
+}
+
+}  // namespace dictionary
+}  // namespace mozc
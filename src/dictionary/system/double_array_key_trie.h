@@ -0,0 +1,150 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_DICTIONARY_SYSTEM_DOUBLE_ARRAY_KEY_TRIE_H_
+#define MOZC_DICTIONARY_SYSTEM_DOUBLE_ARRAY_KEY_TRIE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "storage/louds/louds_trie.h"
+
+namespace mozc {
+namespace dictionary {
+
+// Double-array representation of the key trie of the system dictionary. It is
+// built from the LOUDS key trie and keeps its key IDs and the order of the
+// children, so it can replace the LOUDS trie in forward lookups. A move to a
+// child or a sibling is a few array accesses instead of the rank/select
+// operations of LOUDS, at the cost of 16 bytes per node.
+class DoubleArrayKeyTrie {
+ public:
+  static constexpr size_t kMaxDepth = storage::louds::LoudsTrie::kMaxDepth;
+
+  // Traversal state. The default instance represents the root.
+  class Node {
+   public:
+    friend constexpr bool operator==(const Node& x, const Node& y) {
+      return x.index_ == y.index_;
+    }
+
+   private:
+    int32_t index_ = 0;
+    friend class DoubleArrayKeyTrie;
+  };
+
+  DoubleArrayKeyTrie() = default;
+
+  DoubleArrayKeyTrie(const DoubleArrayKeyTrie&) = delete;
+  DoubleArrayKeyTrie& operator=(const DoubleArrayKeyTrie&) = delete;
+
+  // Builds the image of the trie that has the same keys and key IDs as
+  // `louds_trie`.
+  static std::string BuildImage(const storage::louds::LoudsTrie& louds_trie);
+
+  // Opens the image built by BuildImage(). This class doesn't own the image.
+  // Returns false if the image is misaligned, has a partial unit or has a
+  // broken root. The other units are not validated so that opening doesn't
+  // touch the whole image.
+  bool Open(absl::string_view image);
+
+  bool IsValidNode(const Node& node) const { return node.index_ >= 0; }
+
+  bool IsTerminalNode(const Node& node) const {
+    return units_[node.index_].key_id >= 0;
+  }
+
+  char GetEdgeLabelToParentNode(const Node& node) const {
+    const Unit& unit = units_[node.index_];
+    return static_cast<char>(node.index_ - units_[unit.check].base);
+  }
+
+  // REQUIRES: |node| is a terminal node.
+  int GetKeyIdOfTerminalNode(const Node& node) const {
+    return units_[node.index_].key_id;
+  }
+
+  // Same as LoudsTrie::RestoreKeyString.
+  // REQUIRES: |buf| is longer than kMaxDepth + 1.
+  absl::string_view RestoreKeyString(Node node, char* buf) const;
+
+  void MoveToFirstChild(Node* node) const {
+    const Unit& unit = units_[node->index_];
+    node->index_ = unit.child == 0 ? -1 : unit.base + unit.child - 1;
+  }
+
+  void MoveToNextSibling(Node* node) const {
+    const Unit& unit = units_[node->index_];
+    node->index_ =
+        unit.sibling == 0 ? -1 : units_[unit.check].base + unit.sibling - 1;
+  }
+
+  // Moves |node| to its child connected by the edge with |label|. If there's
+  // no edge having |label|, |node| becomes invalid and false is returned.
+  bool MoveToChildByLabel(char label, Node* node) const {
+    const size_t index = static_cast<size_t>(units_[node->index_].base) +
+                         static_cast<uint8_t>(label);
+    if (index >= units_.size() || units_[index].check != node->index_) {
+      node->index_ = -1;
+      return false;
+    }
+    node->index_ = static_cast<int32_t>(index);
+    return true;
+  }
+
+  bool HasKey(absl::string_view key) const { return ExactSearch(key) >= 0; }
+
+  // Returns the key ID of |key|, or -1 if it doesn't exist.
+  int ExactSearch(absl::string_view key) const;
+
+ private:
+  struct Unit {
+    // The children of this node are at `base + label`.
+    int32_t base;
+    // The index of the parent node, or -1 for the root and unused units.
+    int32_t check;
+    // The key ID if this node is terminal, or -1.
+    int32_t key_id;
+    // The labels of the first child and the next sibling plus one, or 0 if
+    // there is none.
+    uint16_t child;
+    uint16_t sibling;
+  };
+  static_assert(sizeof(Unit) == 16);
+
+  absl::Span<const Unit> units_;
+};
+
+}  // namespace dictionary
+}  // namespace mozc
+
+#endif  // MOZC_DICTIONARY_SYSTEM_DOUBLE_ARRAY_KEY_TRIE_H_
@@ -0,0 +1,163 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "dictionary/system/double_array_key_trie.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "absl/random/random.h"
+#include "absl/strings/string_view.h"
+#include "base/bits.h"
+#include "storage/louds/louds_trie.h"
+#include "storage/louds/louds_trie_builder.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace dictionary {
+namespace {
+
+using ::mozc::storage::louds::LoudsTrie;
+using ::mozc::storage::louds::LoudsTrieBuilder;
+
+class DoubleArrayKeyTrieTest : public ::testing::Test {
+ protected:
+  void Build(const std::vector<std::string>& keys) {
+    for (const std::string& key : keys) {
+      builder_.Add(key);
+    }
+    builder_.Build();
+    ASSERT_TRUE(louds_trie_.Open(
+        reinterpret_cast<const uint8_t*>(builder_.image().data())));
+    image_ = DoubleArrayKeyTrie::BuildImage(louds_trie_);
+    ASSERT_TRUE(trie_.Open(image_));
+  }
+
+  // Checks that the subtrees of both nodes have the same children in the same
+  // order, terminal flags, key IDs and key strings.
+  void ExpectSameSubtree(LoudsTrie::Node louds_node,
+                         DoubleArrayKeyTrie::Node node) {
+    ASSERT_EQ(trie_.IsTerminalNode(node),
+              louds_trie_.IsTerminalNode(louds_node));
+    if (louds_trie_.IsTerminalNode(louds_node)) {
+      EXPECT_EQ(trie_.GetKeyIdOfTerminalNode(node),
+                louds_trie_.GetKeyIdOfTerminalNode(louds_node));
+    }
+    char buf[DoubleArrayKeyTrie::kMaxDepth + 1];
+    char louds_buf[LoudsTrie::kMaxDepth + 1];
+    EXPECT_EQ(trie_.RestoreKeyString(node, buf),
+              louds_trie_.RestoreKeyString(louds_node, louds_buf));
+
+    louds_trie_.MoveToFirstChild(&louds_node);
+    trie_.MoveToFirstChild(&node);
+    for (; louds_trie_.IsValidNode(louds_node);
+         louds_trie_.MoveToNextSibling(&louds_node),
+         trie_.MoveToNextSibling(&node)) {
+      ASSERT_TRUE(trie_.IsValidNode(node));
+      ASSERT_EQ(trie_.GetEdgeLabelToParentNode(node),
+                louds_trie_.GetEdgeLabelToParentNode(louds_node));
+      ExpectSameSubtree(louds_node, node);
+    }
+    EXPECT_FALSE(trie_.IsValidNode(node));
+  }
+
+  LoudsTrieBuilder builder_;
+  LoudsTrie louds_trie_;
+  std::string image_;
+  DoubleArrayKeyTrie trie_;
+};
+
+TEST_F(DoubleArrayKeyTrieTest, Basic) {
+  Build({"a", "aa", "ab", "abc", "abd", "b", "bcd", "bce", "c"});
+
+  for (absl::string_view key :
+       {"a", "aa", "ab", "abc", "abd", "b", "bcd", "bce", "c"}) {
+    EXPECT_TRUE(trie_.HasKey(key)) << key;
+    EXPECT_EQ(trie_.ExactSearch(key), louds_trie_.ExactSearch(key)) << key;
+  }
+  for (absl::string_view key : {"", "abcd", "bc", "d", "ac"}) {
+    EXPECT_FALSE(trie_.HasKey(key)) << key;
+    EXPECT_EQ(trie_.ExactSearch(key), -1) << key;
+  }
+
+  DoubleArrayKeyTrie::Node node;
+  EXPECT_TRUE(trie_.MoveToChildByLabel('b', &node));
+  EXPECT_TRUE(trie_.IsTerminalNode(node));
+  EXPECT_TRUE(trie_.MoveToChildByLabel('c', &node));
+  EXPECT_FALSE(trie_.IsTerminalNode(node));
+  EXPECT_FALSE(trie_.MoveToChildByLabel('a', &node));
+  EXPECT_FALSE(trie_.IsValidNode(node));
+
+  ExpectSameSubtree(LoudsTrie::Node(), DoubleArrayKeyTrie::Node());
+}
+
+TEST_F(DoubleArrayKeyTrieTest, RandomKeys) {
+  absl::BitGen gen;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 3000; ++i) {
+    std::string key(absl::Uniform(gen, 1, 8), '\0');
+    for (char& c : key) {
+      // Covers all the byte values including 0x00 and 0xff.
+      c = static_cast<char>(absl::Uniform<int>(gen, 0, 256));
+    }
+    keys.push_back(key);
+  }
+  Build(keys);
+
+  for (const std::string& key : keys) {
+    EXPECT_EQ(trie_.ExactSearch(key), louds_trie_.ExactSearch(key));
+  }
+  ExpectSameSubtree(LoudsTrie::Node(), DoubleArrayKeyTrie::Node());
+}
+
+TEST_F(DoubleArrayKeyTrieTest, BrokenRoot) {
+  Build({"a", "b"});
+  // Moves the children of the root out of the image.
+  std::string image = image_;
+  StoreUnaligned<int32_t>(0x7fffff00, image.data());
+  DoubleArrayKeyTrie trie;
+  EXPECT_FALSE(trie.Open(image));
+}
+
+TEST(DoubleArrayKeyTrieOpenTest, BrokenImage) {
+  DoubleArrayKeyTrie trie;
+  EXPECT_FALSE(trie.Open(""));
+  EXPECT_FALSE(trie.Open("123"));
+
+  // A root unit whose check is not -1.
+  alignas(int32_t) char image[16] = {};
+  EXPECT_FALSE(trie.Open(absl::string_view(image, sizeof(image))));
+}
+
+}  // namespace
+}  // namespace dictionary
+}  // namespace mozc
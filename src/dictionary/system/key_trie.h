@@ -0,0 +1,156 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_DICTIONARY_SYSTEM_KEY_TRIE_H_
+#define MOZC_DICTIONARY_SYSTEM_KEY_TRIE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "dictionary/system/double_array_key_trie.h"
+#include "storage/louds/louds_trie.h"
+
+namespace mozc {
+namespace dictionary {
+
+// Key trie of the system dictionary. Forward lookups traverse the double-array
+// trie if it's opened, and the LOUDS trie otherwise. Both have the same key
+// IDs. The LOUDS trie is always needed because only it can restore the key
+// from a key ID, which the reverse lookup relies on.
+class KeyTrie {
+ public:
+  static constexpr size_t kMaxDepth = storage::louds::LoudsTrie::kMaxDepth;
+
+  // Traversal state. The default instance represents the root.
+  class Node {
+   private:
+    storage::louds::LoudsTrie::Node louds_;
+    DoubleArrayKeyTrie::Node double_array_;
+    friend class KeyTrie;
+  };
+
+  KeyTrie() = default;
+
+  KeyTrie(const KeyTrie&) = delete;
+  KeyTrie& operator=(const KeyTrie&) = delete;
+
+  // Opens the LOUDS trie. See LoudsTrie::Open() for the cache sizes.
+  bool Open(const uint8_t* louds_image, size_t louds_lb0_cache_size,
+            size_t louds_lb1_cache_size, size_t louds_select0_cache_size,
+            size_t louds_select1_cache_size, size_t termvec_lb1_cache_size) {
+    return louds_.Open(louds_image, louds_lb0_cache_size, louds_lb1_cache_size,
+                       louds_select0_cache_size, louds_select1_cache_size,
+                       termvec_lb1_cache_size);
+  }
+
+  // Opens the double-array trie built from the LOUDS trie. Returns false if
+  // DoubleArrayKeyTrie::Open() rejects the image, in which case the LOUDS trie
+  // keeps being used.
+  bool OpenDoubleArray(absl::string_view image) {
+    use_double_array_ = double_array_.Open(image);
+    return use_double_array_;
+  }
+
+  bool IsValidNode(const Node& node) const {
+    return use_double_array_ ? double_array_.IsValidNode(node.double_array_)
+                             : louds_.IsValidNode(node.louds_);
+  }
+
+  bool IsTerminalNode(const Node& node) const {
+    return use_double_array_ ? double_array_.IsTerminalNode(node.double_array_)
+                             : louds_.IsTerminalNode(node.louds_);
+  }
+
+  char GetEdgeLabelToParentNode(const Node& node) const {
+    return use_double_array_
+               ? double_array_.GetEdgeLabelToParentNode(node.double_array_)
+               : louds_.GetEdgeLabelToParentNode(node.louds_);
+  }
+
+  // REQUIRES: |node| is a terminal node.
+  int GetKeyIdOfTerminalNode(const Node& node) const {
+    return use_double_array_
+               ? double_array_.GetKeyIdOfTerminalNode(node.double_array_)
+               : louds_.GetKeyIdOfTerminalNode(node.louds_);
+  }
+
+  // REQUIRES: |buf| is longer than kMaxDepth + 1.
+  absl::string_view RestoreKeyString(const Node& node, char* buf) const {
+    return use_double_array_
+               ? double_array_.RestoreKeyString(node.double_array_, buf)
+               : louds_.RestoreKeyString(node.louds_, buf);
+  }
+
+  // REQUIRES: |buf| is longer than kMaxDepth + 1.
+  absl::string_view RestoreKeyString(int key_id, char* buf) const {
+    return louds_.RestoreKeyString(key_id, buf);
+  }
+
+  void MoveToFirstChild(Node* node) const {
+    if (use_double_array_) {
+      double_array_.MoveToFirstChild(&node->double_array_);
+    } else {
+      louds_.MoveToFirstChild(&node->louds_);
+    }
+  }
+
+  void MoveToNextSibling(Node* node) const {
+    if (use_double_array_) {
+      double_array_.MoveToNextSibling(&node->double_array_);
+    } else {
+      louds_.MoveToNextSibling(&node->louds_);
+    }
+  }
+
+  bool MoveToChildByLabel(char label, Node* node) const {
+    return use_double_array_
+               ? double_array_.MoveToChildByLabel(label, &node->double_array_)
+               : louds_.MoveToChildByLabel(label, &node->louds_);
+  }
+
+  bool HasKey(absl::string_view key) const {
+    return use_double_array_ ? double_array_.HasKey(key) : louds_.HasKey(key);
+  }
+
+  int ExactSearch(absl::string_view key) const {
+    return use_double_array_ ? double_array_.ExactSearch(key)
+                             : louds_.ExactSearch(key);
+  }
+
+ private:
+  storage::louds::LoudsTrie louds_;
+  DoubleArrayKeyTrie double_array_;
+  bool use_double_array_ = false;
+};
+
+}  // namespace dictionary
+}  // namespace mozc
+
+#endif  // MOZC_DICTIONARY_SYSTEM_KEY_TRIE_H_
@@ -43,6 +43,11 @@
 //       Frequenty appearing POSs are stored as POS ids in token info for
 //       reducing binary size. This table is the map from the id to the
 //       actual ids.
+//  (5) Token blocks (optional)
+//       Fixed-width encoding of the token array for forward lookups.
+//  (6) Double-array key trie (optional)
+//       The key trie in double-array form for forward lookups. It has the
+//       same ids as the key trie.
 
 #include "dictionary/system/system_dictionary.h"
 
@@ -79,6 +84,7 @@
 #include "dictionary/file/dictionary_file.h"
 #include "dictionary/system/codec.h"
 #include "dictionary/system/key_expansion_table.h"
+#include "dictionary/system/key_trie.h"
 #include "dictionary/system/token_decode_iterator.h"
 #include "dictionary/system/words_info.h"
 #include "storage/louds/bit_vector_based_array.h"
@@ -109,6 +115,14 @@ constexpr size_t kValueTrieSelect0CacheSize = 1 * 1024;
 constexpr size_t kValueTrieSelect1CacheSize = 16 * 1024;
 constexpr size_t kValueTrieTermvecCacheSize = 4 * 1024;
 
+// Bounds of the prefix search with key expansion.  Each expanded character
+// costs a spatial penalty in conversion (see converter/node_list_builder.h), so
+// the keys with more expanded characters than kMaxKeyExpansions hardly win.
+// kMaxKeyExpansionSearchNodes bounds the latency for long keys that consist
+// of expandable characters.
+constexpr int kMaxKeyExpansions = 4;
+constexpr size_t kMaxKeyExpansionSearchNodes = 4096;
+
 // Expansion table format:
 // "<Character to expand>[<Expanded character 1><Expanded character 2>...]"
 //
@@ -154,6 +168,27 @@ inline const uint8_t* GetTokenArrayPtr(const BitVectorBasedArray& token_array,
   return reinterpret_cast<const uint8_t*>(token_array.Get(key_id, &length));
 }
 
+// Returns the iterator over the tokens of `key_id`. The tokens are decoded
+// from `token_blocks` if it is not null.
+inline TokenDecodeIterator DecodeTokens(
+    const SystemDictionaryCodec& codec, const LoudsTrie& value_trie,
+    absl::Span<const uint32_t> frequent_pos,
+    const BitVectorBasedArray& token_array,
+    const BitVectorBasedArray* token_blocks, absl::string_view key,
+    int key_id, DecodedValueCache* value_cache = nullptr) {
+  if (token_blocks != nullptr) {
+    size_t length = 0;
+    return TokenDecodeIterator(
+        codec, value_trie, key,
+        TokenBlock(reinterpret_cast<const uint8_t*>(
+            token_blocks->Get(key_id, &length))),
+        value_cache);
+  }
+  return TokenDecodeIterator(codec, value_trie, frequent_pos, key,
+                             GetTokenArrayPtr(token_array, key_id),
+                             value_cache);
+}
+
 // Iterator for scanning token array.
 // This iterator does not return actual token info but returns
 // id data and the position only.
@@ -337,6 +372,14 @@ class SystemDictionary::ReverseLookupIndex {
 
   ~ReverseLookupIndex() = default;
 
+  size_t GetMemoryUsage() const {
+    size_t bytes = index_size_ * sizeof(ReverseLookupResultArray);
+    for (size_t i = 0; i < index_size_; ++i) {
+      bytes += index_[i].size * sizeof(ReverseLookupResult);
+    }
+    return bytes;
+  }
+
   void FillResultMap(
       const absl::btree_set<int>& id_set,
       absl::btree_multimap<int, ReverseLookupResult>* result_map) const {
@@ -365,11 +408,11 @@ class SystemDictionary::ReverseLookupIndex {
 
 struct SystemDictionary::PredictiveLookupSearchState {
   PredictiveLookupSearchState() : key_pos(0), num_expanded(0) {}
-  PredictiveLookupSearchState(const storage::louds::LoudsTrie::Node& n,
-                              size_t pos, int expanded)
+  PredictiveLookupSearchState(const KeyTrie::Node& n, size_t pos,
+                              int expanded)
       : node(n), key_pos(pos), num_expanded(expanded) {}
 
-  storage::louds::LoudsTrie::Node node;
+  KeyTrie::Node node;
   size_t key_pos;
   int num_expanded;
 };
@@ -388,6 +431,12 @@ SystemDictionary::Builder& SystemDictionary::Builder::SetOptions(
   return *this;
 }
 
+SystemDictionary::Builder& SystemDictionary::Builder::SetValueCacheSize(
+    size_t size) {
+  spec_->value_cache_size = size;
+  return *this;
+}
+
 absl::StatusOr<std::unique_ptr<SystemDictionary>>
 SystemDictionary::Builder::Build() {
   auto codec = std::make_unique<SystemDictionaryCodec>();
@@ -422,10 +471,17 @@ SystemDictionary::Builder::Build() {
   }
 
   if (!instance->OpenDictionaryFile(
-          (spec_->options & ENABLE_REVERSE_LOOKUP_INDEX) != 0)) {
+          (spec_->options & ENABLE_REVERSE_LOOKUP_INDEX) != 0,
+          (spec_->options & USE_TOKEN_BLOCKS) != 0,
+          (spec_->options & USE_DOUBLE_ARRAY_KEY_TRIE) != 0)) {
     return absl::UnknownError("Failed to create system dictionary");
   }
 
+  if (spec_->value_cache_size > 0) {
+    instance->value_cache_ =
+        std::make_unique<DecodedValueCache>(spec_->value_cache_size);
+  }
+
   return instance;
 }
 
@@ -438,7 +494,9 @@ SystemDictionary::SystemDictionary(
 
 SystemDictionary::~SystemDictionary() = default;
 
-bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
+bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index,
+                                          bool use_token_blocks,
+                                          bool use_double_array_key_trie) {
   std::optional<absl::string_view> key_image =
       dictionary_file_->GetSection(codec_->GetSectionNameForKey());
   std::optional<absl::string_view> value_image =
@@ -461,6 +519,18 @@ bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
     return false;
   }
 
+  if (use_double_array_key_trie) {
+    // Dictionaries without a valid double-array key trie fall back to the
+    // LOUDS key trie.
+    const std::optional<absl::string_view> double_array_image =
+        dictionary_file_->GetSection(
+            codec_->GetSectionNameForDoubleArrayKey());
+    if (double_array_image.has_value() &&
+        !key_trie_.OpenDoubleArray(*double_array_image)) {
+      LOG(WARNING) << "cannot open double-array key trie. Use the LOUDS trie.";
+    }
+  }
+
   BuildHiraganaExpansionTable(*codec_, &hiragana_expansion_table_);
 
   if (!value_trie_.Open(reinterpret_cast<const uint8_t*>(value_image->data()),
@@ -474,6 +544,18 @@ bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
   token_array_.Open(reinterpret_cast<const uint8_t*>(token_image->data()));
   frequent_pos_ = MakeAlignedConstSpan<uint32_t>(frequent_pos_image.value());
 
+  if (use_token_blocks) {
+    // Dictionaries built without the token blocks fall back to the token
+    // array.
+    const std::optional<absl::string_view> token_block_image =
+        dictionary_file_->GetSection(codec_->GetSectionNameForTokenBlocks());
+    if (token_block_image.has_value()) {
+      token_block_array_.Open(
+          reinterpret_cast<const uint8_t*>(token_block_image->data()));
+      token_blocks_ = &token_block_array_;
+    }
+  }
+
   if (enable_reverse_lookup_index) {
     InitReverseLookupIndex();
   }
@@ -524,12 +606,10 @@ bool SystemDictionary::HasValue(absl::string_view value) const {
   // (mozc, mozc) is NOT stored, HasValue("mozc") wrongly returns
   // true.
 
-  // Get the block of tokens for this key.
-  const uint8_t* encoded_tokens_ptr = GetTokenArrayPtr(token_array_, key_id);
-
   // Check tokens.
-  for (TokenDecodeIterator iter(*codec_, value_trie_, frequent_pos_, key,
-                                encoded_tokens_ptr);
+  for (TokenDecodeIterator iter =
+           DecodeTokens(*codec_, value_trie_, frequent_pos_, token_array_,
+                        token_blocks_, key, key_id);
        !iter.Done(); iter.Next()) {
     const Token* token = iter.Get().token;
     if (value == token->value) {
@@ -543,7 +623,7 @@ void SystemDictionary::CollectPredictiveNodesInBfsOrder(
     absl::string_view encoded_key, const KeyExpansionTable& table, size_t limit,
     std::vector<PredictiveLookupSearchState>* result) const {
   std::queue<PredictiveLookupSearchState> queue;
-  queue.push(PredictiveLookupSearchState(LoudsTrie::Node(), 0, false));
+  queue.push(PredictiveLookupSearchState(KeyTrie::Node(), 0, false));
   do {
     PredictiveLookupSearchState state = queue.front();
     queue.pop();
@@ -685,9 +765,9 @@ void SystemDictionary::LookupPredictive(absl::string_view key,
     }
 
     const int key_id = key_trie_.GetKeyIdOfTerminalNode(state.node);
-    for (TokenDecodeIterator iter(*codec_, value_trie_, frequent_pos_,
-                                  actual_key,
-                                  GetTokenArrayPtr(token_array_, key_id));
+    for (TokenDecodeIterator iter = DecodeTokens(
+             *codec_, value_trie_, frequent_pos_, token_array_, token_blocks_,
+             actual_key, key_id, value_cache_.get());
          !iter.Done(); iter.Next()) {
       const TokenInfo& token_info = iter.Get();
       const Callback::ResultType result =
@@ -708,7 +788,7 @@ namespace {
 // An implementation of prefix search without key expansion.  Runs |callback|
 // for prefixes of |encoded_key| in |key_trie|.
 // Args:
-//   key_trie, value_trie, token_array, codec, frequent_pos:
+//   key_trie, value_trie, token_array, token_blocks, codec, frequent_pos:
 //     Members in SystemDictionary.
 //   key:
 //     The head address of the original key before applying codec.
@@ -721,13 +801,14 @@ namespace {
 //     this functor returns true are passed to callback function.
 template <typename Func>
 void RunCallbackOnEachPrefix(
-    const LoudsTrie& key_trie, const LoudsTrie& value_trie,
-    const BitVectorBasedArray& token_array, const SystemDictionaryCodec& codec,
-    absl::Span<const uint32_t> frequent_pos, absl::string_view key,
-    absl::string_view encoded_key, DictionaryInterface::Callback* callback,
-    Func token_filter) {
+    const KeyTrie& key_trie, const LoudsTrie& value_trie,
+    const BitVectorBasedArray& token_array,
+    const BitVectorBasedArray* token_blocks, const SystemDictionaryCodec& codec,
+    absl::Span<const uint32_t> frequent_pos, DecodedValueCache* value_cache,
+    absl::string_view key, absl::string_view encoded_key,
+    DictionaryInterface::Callback* callback, Func token_filter) {
   typedef DictionaryInterface::Callback Callback;
-  LoudsTrie::Node node;
+  KeyTrie::Node node;
   for (absl::string_view::size_type i = 0; i < encoded_key.size();) {
     if (!key_trie.MoveToChildByLabel(encoded_key[i], &node)) {
       return;
@@ -761,8 +842,9 @@ void RunCallbackOnEachPrefix(
     }
 
     const int key_id = key_trie.GetKeyIdOfTerminalNode(node);
-    for (TokenDecodeIterator iter(codec, value_trie, frequent_pos, prefix,
-                                  GetTokenArrayPtr(token_array, key_id));
+    for (TokenDecodeIterator iter =
+             DecodeTokens(codec, value_trie, frequent_pos, token_array,
+                          token_blocks, prefix, key_id, value_cache);
          !iter.Done(); iter.Next()) {
       const TokenInfo& token_info = iter.Get();
       if (!token_filter(token_info)) {
@@ -798,106 +880,129 @@ class ReverseLookupCallbackWrapper : public DictionaryInterface::Callback {
 
 }  // namespace
 
-// Recursive implementation of depth-first prefix search with key expansion.
+// Prefix search with key expansion.  The search visits the trie nodes in the
+// increasing order of the number of expanded characters, and then of the
+// depth, so the prefixes matched without expansion always come first.  That
+// matters because callers usually stop the traversal after collecting enough
+// tokens.  The frontier is bounded by both the number of expanded characters
+// and the number of visited nodes, which keeps long keys with many expandable
+// characters from blowing up the search.  Each trie node is reached by exactly
+// one path from the root, so a node never enters the frontier twice and the
+// search doesn't need a visited set.
 // Input parameters:
 //   key:
-//     The head address of the original key before applying codec.
+//     The original key before applying codec.
 //   encoded_key:
 //     The encoded |key|.
 //   table:
 //     Key expansion table.
 //   callback:
 //     A callback function to be called.
-// Parameters for recursion:
-//   node:
-//     Stores the current location in |key_trie_|.
-//   key_pos:
-//     Depth of node, i.e., encoded_key.substr(0, key_pos) is the current prefix
-//     for search.
-//   num_expanded:
-//     the number of chharacters expanded. if non zero, characters are expanded.
-//   actual_key_buffer:
-//     Buffer for storing actually used characters to reach this node, i.e.,
-//     absl::string_view(actual_key_buffer, key_pos) is the matched prefix using
-//     key expansion.
-//   actual_prefix:
-//     A reused string for decoded actual key.  This is just for performance
-//     purpose.
-DictionaryInterface::Callback::ResultType
-SystemDictionary::LookupPrefixWithKeyExpansionImpl(
+void SystemDictionary::LookupPrefixWithKeyExpansion(
     absl::string_view key, absl::string_view encoded_key,
-    const KeyExpansionTable& table, Callback* callback, LoudsTrie::Node node,
-    absl::string_view::size_type key_pos, int num_expanded,
-    char* actual_key_buffer, std::string* actual_prefix) const {
-  // This do-block handles a terminal node and callback.  do-block is used to
-  // break the block and continue to the subsequent traversal phase.
-  do {
-    if (!key_trie_.IsTerminalNode(node)) {
-      break;
-    }
-
-    const absl::string_view encoded_prefix = encoded_key.substr(0, key_pos);
-    const absl::string_view prefix =
-        key.substr(0, codec_->GetDecodedKeyLength(encoded_prefix));
-    Callback::ResultType result = callback->OnKey(prefix);
-    if (result == Callback::TRAVERSE_DONE ||
-        result == Callback::TRAVERSE_CULL) {
-      return result;
-    }
-    if (result == Callback::TRAVERSE_NEXT_KEY) {
-      break;  // Go to the traversal phase.
-    }
+    const KeyExpansionTable& table, Callback* callback) const {
+  // frontier[n] holds the nodes reached with n expanded characters.  Each of
+  // them is processed in FIFO order, i.e., in the increasing order of depth.
+  std::vector<PredictiveLookupSearchState> frontier[kMaxKeyExpansions + 1];
+  frontier[0].push_back(PredictiveLookupSearchState(KeyTrie::Node(), 0, 0));
 
-    const absl::string_view encoded_actual_prefix(actual_key_buffer, key_pos);
-    *actual_prefix = codec_->DecodeKey(encoded_actual_prefix);
-    result = callback->OnActualKey(prefix, *actual_prefix, num_expanded);
-    if (result == Callback::TRAVERSE_DONE ||
-        result == Callback::TRAVERSE_CULL) {
-      return result;
-    }
-    if (result == Callback::TRAVERSE_NEXT_KEY) {
-      break;  // Go to the traversal phase.
-    }
+  // Reused buffer and instances inside the following loop.
+  char encoded_actual_key_buffer[KeyTrie::kMaxDepth + 1];
+  std::string actual_prefix;
+  actual_prefix.reserve(key.size() * 3);
+  size_t num_visited = 0;
+  for (int num_expanded = 0; num_expanded <= kMaxKeyExpansions;
+       ++num_expanded) {
+    std::vector<PredictiveLookupSearchState>& states = frontier[num_expanded];
+    // The loop appends states to |states|, so iterate by index.
+    for (size_t i = 0; i < states.size(); ++i) {
+      if (++num_visited > kMaxKeyExpansionSearchNodes) {
+        return;
+      }
+      const PredictiveLookupSearchState state = states[i];
+      switch (LookupPrefixWithKeyExpansionAt(key, encoded_key, state,
+                                             encoded_actual_key_buffer,
+                                             &actual_prefix, callback)) {
+        case Callback::TRAVERSE_DONE:
+          return;
+        case Callback::TRAVERSE_CULL:
+          continue;
+        default:
+          break;
+      }
 
-    const int key_id = key_trie_.GetKeyIdOfTerminalNode(node);
-    for (TokenDecodeIterator iter(*codec_, value_trie_, frequent_pos_,
-                                  *actual_prefix,
-                                  GetTokenArrayPtr(token_array_, key_id));
-         !iter.Done(); iter.Next()) {
-      const TokenInfo& token_info = iter.Get();
-      result = callback->OnToken(prefix, *actual_prefix, *token_info.token);
-      if (result == Callback::TRAVERSE_DONE ||
-          result == Callback::TRAVERSE_CULL) {
-        return result;
+      if (state.key_pos == encoded_key.size()) {
+        continue;
       }
-      if (result == Callback::TRAVERSE_NEXT_KEY) {
-        break;  // Go to the traversal phase.
+      const char current_char = encoded_key[state.key_pos];
+      const ExpandedKey& chars = table.ExpandKey(current_char);
+      KeyTrie::Node node = state.node;
+      for (key_trie_.MoveToFirstChild(&node); key_trie_.IsValidNode(node);
+           key_trie_.MoveToNextSibling(&node)) {
+        const char c = key_trie_.GetEdgeLabelToParentNode(node);
+        if (!chars.IsHit(c)) {
+          continue;
+        }
+        const int child_num_expanded =
+            num_expanded + static_cast<int>(c != current_char);
+        if (child_num_expanded > kMaxKeyExpansions) {
+          continue;
+        }
+        frontier[child_num_expanded].push_back(PredictiveLookupSearchState(
+            node, state.key_pos + 1, child_num_expanded));
       }
     }
-  } while (false);
+  }
+}
 
-  // Traversal phase.
-  if (key_pos == encoded_key.size()) {
+// Runs |callback| for the key and the tokens at |state| if its node is
+// terminal.  Returns TRAVERSE_CULL if the children of the node should not be
+// traversed, and TRAVERSE_DONE if the search should stop.
+DictionaryInterface::Callback::ResultType
+SystemDictionary::LookupPrefixWithKeyExpansionAt(
+    absl::string_view key, absl::string_view encoded_key,
+    const PredictiveLookupSearchState& state, char* encoded_actual_key_buffer,
+    std::string* actual_prefix, Callback* callback) const {
+  if (!key_trie_.IsTerminalNode(state.node)) {
     return Callback::TRAVERSE_CONTINUE;
   }
-  const char current_char = encoded_key[key_pos];
-  const ExpandedKey& chars = table.ExpandKey(current_char);
-  for (key_trie_.MoveToFirstChild(&node); key_trie_.IsValidNode(node);
-       key_trie_.MoveToNextSibling(&node)) {
-    const char c = key_trie_.GetEdgeLabelToParentNode(node);
-    if (!chars.IsHit(c)) {
-      continue;
+
+  const absl::string_view encoded_prefix = encoded_key.substr(0, state.key_pos);
+  const absl::string_view prefix =
+      key.substr(0, codec_->GetDecodedKeyLength(encoded_prefix));
+  Callback::ResultType result = callback->OnKey(prefix);
+  if (result != Callback::TRAVERSE_CONTINUE) {
+    return result == Callback::TRAVERSE_NEXT_KEY ? Callback::TRAVERSE_CONTINUE
+                                                 : result;
+  }
+
+  // The actual key equals the prefix unless some characters are expanded.
+  const absl::string_view encoded_actual_prefix =
+      state.num_expanded == 0
+          ? encoded_prefix
+          : key_trie_.RestoreKeyString(state.node, encoded_actual_key_buffer);
+  *actual_prefix = codec_->DecodeKey(encoded_actual_prefix);
+  result = callback->OnActualKey(prefix, *actual_prefix, state.num_expanded);
+  if (result != Callback::TRAVERSE_CONTINUE) {
+    return result == Callback::TRAVERSE_NEXT_KEY ? Callback::TRAVERSE_CONTINUE
+                                                 : result;
+  }
+
+  const int key_id = key_trie_.GetKeyIdOfTerminalNode(state.node);
+  for (TokenDecodeIterator iter = DecodeTokens(
+           *codec_, value_trie_, frequent_pos_, token_array_, token_blocks_,
+           *actual_prefix, key_id, value_cache_.get());
+       !iter.Done(); iter.Next()) {
+    const TokenInfo& token_info = iter.Get();
+    result = callback->OnToken(prefix, *actual_prefix, *token_info.token);
+    if (result == Callback::TRAVERSE_DONE ||
+        result == Callback::TRAVERSE_CULL) {
+      return result;
     }
-    actual_key_buffer[key_pos] = c;
-    const Callback::ResultType result = LookupPrefixWithKeyExpansionImpl(
-        key, encoded_key, table, callback, node, key_pos + 1,
-        num_expanded + static_cast<int>(c != current_char), actual_key_buffer,
-        actual_prefix);
-    if (result == Callback::TRAVERSE_DONE) {
-      return Callback::TRAVERSE_DONE;
+    if (result == Callback::TRAVERSE_NEXT_KEY) {
+      break;
     }
   }
-
   return Callback::TRAVERSE_CONTINUE;
 }
 
@@ -906,19 +1011,17 @@ void SystemDictionary::LookupPrefix(absl::string_view key,
   const std::string encoded_key = codec_->EncodeKey(key);
 
   if (!callback->IsKanaModifierInsensitiveConversion()) {
-    RunCallbackOnEachPrefix(key_trie_, value_trie_, token_array_, *codec_,
-                            frequent_pos_, key.data(), encoded_key, callback,
+    RunCallbackOnEachPrefix(key_trie_, value_trie_, token_array_,
+                            token_blocks_, *codec_, frequent_pos_,
+                            value_cache_.get(), key.data(), encoded_key,
+                            callback,
                             // Select all tokens.
                             [](const TokenInfo& token_info) { return true; });
     return;
   }
 
-  char actual_key_buffer[LoudsTrie::kMaxDepth + 1];
-  std::string actual_prefix;
-  actual_prefix.reserve(key.size() * 3);
-  LookupPrefixWithKeyExpansionImpl(
-      key.data(), encoded_key, hiragana_expansion_table_, callback,
-      LoudsTrie::Node(), 0, false, actual_key_buffer, &actual_prefix);
+  LookupPrefixWithKeyExpansion(key, encoded_key, hiragana_expansion_table_,
+                               callback);
 }
 
 void SystemDictionary::LookupExact(absl::string_view key,
@@ -936,8 +1039,9 @@ void SystemDictionary::LookupExact(absl::string_view key,
     return;
   }
   // Callback on each token.
-  for (TokenDecodeIterator iter(*codec_, value_trie_, frequent_pos_, key,
-                                GetTokenArrayPtr(token_array_, key_id));
+  for (TokenDecodeIterator iter =
+           DecodeTokens(*codec_, value_trie_, frequent_pos_, token_array_,
+                        token_blocks_, key, key_id, value_cache_.get());
        !iter.Done(); iter.Next()) {
     if (callback->OnToken(key, key, *iter.Get().token) !=
         Callback::TRAVERSE_CONTINUE) {
@@ -997,6 +1101,32 @@ void SystemDictionary::ClearReverseLookupCache() const {
   reverse_lookup_cache_.store(nullptr);
 }
 
+void SystemDictionary::CollectMemoryUsage(
+    MemoryUsageCollector& collector) const {
+  collector.AddHeap("dictionary.system.reverse_lookup_index",
+                    reverse_lookup_index_ == nullptr
+                        ? 0
+                        : reverse_lookup_index_->GetMemoryUsage());
+  const std::shared_ptr<ReverseLookupCache> reverse_lookup_cache =
+      reverse_lookup_cache_.load();
+  collector.AddHeap(
+      "dictionary.system.reverse_lookup_cache",
+      reverse_lookup_cache == nullptr
+          ? 0
+          : reverse_lookup_cache->results.size() *
+                sizeof(decltype(reverse_lookup_cache->results)::value_type));
+  collector.AddHeap(
+      "dictionary.system.value_cache",
+      value_cache_ == nullptr ? 0 : value_cache_->GetMemoryUsage());
+}
+
+DecodedValueCache::Stats SystemDictionary::GetValueCacheStats() const {
+  if (value_cache_ == nullptr) {
+    return {};
+  }
+  return value_cache_->GetStats();
+}
+
 void SystemDictionary::RegisterReverseLookupTokensForT13N(
     absl::string_view value, Callback* callback) const {
   const std::string hiragana_value = japanese_util::KatakanaToHiragana(value);
@@ -1004,8 +1134,10 @@ void SystemDictionary::RegisterReverseLookupTokensForT13N(
   std::string prev_value;
   prev_value.reserve(LoudsTrie::kMaxDepth * 3);
   RunCallbackOnEachPrefix(
-      key_trie_, value_trie_, token_array_, *codec_, frequent_pos_,
-      hiragana_value, encoded_key, callback, [&](const TokenInfo& token_info) {
+      key_trie_, value_trie_, token_array_, token_blocks_, *codec_,
+      frequent_pos_, /* value_cache= */ nullptr, hiragana_value, encoded_key,
+      callback,
+      [&](const TokenInfo& token_info) {
         // Skip spelling corrections.
         if (token_info.token->attributes & Token::SPELLING_CORRECTION) {
           return false;
@@ -40,12 +40,15 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/memory_usage.h"
 #include "base/thread.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/file/codec.h"
 #include "dictionary/file/dictionary_file.h"
 #include "dictionary/system/codec.h"
+#include "dictionary/system/decoded_value_cache.h"
 #include "dictionary/system/key_expansion_table.h"
+#include "dictionary/system/key_trie.h"
 #include "storage/louds/bit_vector_based_array.h"
 #include "storage/louds/louds_trie.h"
 
@@ -61,6 +64,16 @@ class SystemDictionary : public DictionaryInterface {
     // from the id in value trie to the id in key trie.
     // That consumes more memory but we can perform reverse lookup more quickly.
     ENABLE_REVERSE_LOOKUP_INDEX = 1,
+    // If USE_TOKEN_BLOCKS is set, lookups by key decode the tokens from the
+    // fixed-width token blocks when the dictionary has them. This includes
+    // the prefix lookup of the hiragana form in LookupReverse(). The lookup by
+    // value in LookupReverse() always uses the token array.
+    USE_TOKEN_BLOCKS = 2,
+    // If USE_DOUBLE_ARRAY_KEY_TRIE is set, lookups by key traverse the
+    // double-array key trie when the dictionary has it. This includes the
+    // prefix lookup of the hiragana form in LookupReverse(). The lookup by
+    // value in LookupReverse() restores the keys from the LOUDS key trie.
+    USE_DOUBLE_ARRAY_KEY_TRIE = 4,
   };
 
   // Builder class for system dictionary
@@ -83,6 +96,9 @@ class SystemDictionary : public DictionaryInterface {
     // Sets options (default: NONE)
     Builder& SetOptions(Options options);
 
+    // Sets the number of decoded values to cache (default: 0, disabled).
+    Builder& SetValueCacheSize(size_t size);
+
     // Builds and returns system dictionary.
     absl::StatusOr<std::unique_ptr<SystemDictionary>> Build();
 
@@ -95,7 +111,11 @@ class SystemDictionary : public DictionaryInterface {
 
       Specification(InputType t, absl::string_view fn, absl::string_view image,
                     Options o)
-          : type(t), filename(fn), image(image), options(o) {}
+          : type(t),
+            filename(fn),
+            image(image),
+            options(o),
+            value_cache_size(0) {}
 
       InputType type;
 
@@ -106,6 +126,7 @@ class SystemDictionary : public DictionaryInterface {
       absl::string_view image;
 
       Options options;
+      size_t value_cache_size;
     };
 
     std::unique_ptr<Specification> spec_;
@@ -133,6 +154,11 @@ class SystemDictionary : public DictionaryInterface {
 
   void PopulateReverseLookupCache(absl::string_view str) const override;
   void ClearReverseLookupCache() const override;
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
+
+  // Returns the hit/miss counts of the decoded value cache. Both are zero when
+  // the cache is disabled.
+  DecodedValueCache::Stats GetValueCacheStats() const;
 
  private:
   class ReverseLookupCache;
@@ -142,7 +168,9 @@ class SystemDictionary : public DictionaryInterface {
   SystemDictionary(std::unique_ptr<const SystemDictionaryCodec> codec,
                    std::unique_ptr<const DictionaryFileCodec> file_codec);
 
-  bool OpenDictionaryFile(bool enable_reverse_lookup_index);
+  bool OpenDictionaryFile(bool enable_reverse_lookup_index,
+                          bool use_token_blocks,
+                          bool use_double_array_key_trie);
 
   void RegisterReverseLookupTokensForT13N(absl::string_view value,
                                           Callback* callback) const;
@@ -155,20 +183,26 @@ class SystemDictionary : public DictionaryInterface {
                                     Callback* callback) const;
   void InitReverseLookupIndex();
 
-  Callback::ResultType LookupPrefixWithKeyExpansionImpl(
+  void LookupPrefixWithKeyExpansion(absl::string_view key,
+                                    absl::string_view encoded_key,
+                                    const KeyExpansionTable& table,
+                                    Callback* callback) const;
+  Callback::ResultType LookupPrefixWithKeyExpansionAt(
       absl::string_view key, absl::string_view encoded_key,
-      const KeyExpansionTable& table, Callback* callback,
-      storage::louds::LoudsTrie::Node node,
-      absl::string_view::size_type key_pos, int num_expanded,
-      char* actual_key_buffer, std::string* actual_prefix) const;
+      const PredictiveLookupSearchState& state,
+      char* encoded_actual_key_buffer, std::string* actual_prefix,
+      Callback* callback) const;
 
   void CollectPredictiveNodesInBfsOrder(
       absl::string_view encoded_key, const KeyExpansionTable& table,
       size_t limit, std::vector<PredictiveLookupSearchState>* result) const;
 
-  storage::louds::LoudsTrie key_trie_;
+  KeyTrie key_trie_;
   storage::louds::LoudsTrie value_trie_;
   storage::louds::BitVectorBasedArray token_array_;
+  storage::louds::BitVectorBasedArray token_block_array_;
+  // Points to `token_block_array_` if the token blocks are used.
+  const storage::louds::BitVectorBasedArray* token_blocks_ = nullptr;
   absl::Span<const uint32_t> frequent_pos_;
   std::unique_ptr<const SystemDictionaryCodec> codec_;
   std::unique_ptr<const DictionaryFileCodec> file_codec_;
@@ -176,6 +210,8 @@ class SystemDictionary : public DictionaryInterface {
   std::unique_ptr<DictionaryFile> dictionary_file_;
   mutable AtomicSharedPtr<ReverseLookupCache> reverse_lookup_cache_;
   std::unique_ptr<ReverseLookupIndex> reverse_lookup_index_;
+  // Null when disabled. Shared by all the sessions using this dictionary.
+  std::unique_ptr<DecodedValueCache> value_cache_;
 };
 
 }  // namespace dictionary
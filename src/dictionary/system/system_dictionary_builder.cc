@@ -31,11 +31,13 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <ios>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <tuple>
@@ -55,14 +57,20 @@
 #include "base/file_stream.h"
 #include "base/file_util.h"
 #include "base/japanese_util.h"
+#include "base/parallel.h"
+#include "base/stopwatch.h"
+#include "base/system_util.h"
+#include "base/thread.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/file/codec.h"
 #include "dictionary/file/section.h"
 #include "dictionary/system/codec.h"
+#include "dictionary/system/double_array_key_trie.h"
 #include "dictionary/system/words_info.h"
 #include "storage/louds/bit_vector_based_array_builder.h"
+#include "storage/louds/louds_trie.h"
 #include "storage/louds/louds_trie_builder.h"
 
 ABSL_FLAG(bool, preserve_intermediate_dictionary, false,
@@ -74,6 +82,16 @@ namespace mozc {
 namespace dictionary {
 namespace {
 
+// Runs `phase` and logs its wall time and the peak memory usage so far.
+template <class F>
+void RunPhase(absl::string_view name, F phase) {
+  const Stopwatch stopwatch = Stopwatch::StartNew();
+  phase();
+  LOG(INFO) << name << ": " << stopwatch.GetElapsed() << ", peak memory: "
+            << SystemUtil::GetPeakResidentMemorySize() / (1024 * 1024)
+            << " MiB";
+}
+
 void WriteSectionToFile(const DictionaryFileSection& section,
                         absl::string_view filename) {
   if (absl::Status s =
@@ -95,22 +113,51 @@ void SystemDictionaryBuilder::BuildFromTokens(
   BuildFromTokensInternal(std::move(ptrs));
 }
 
+void SystemDictionaryBuilder::set_num_threads(int num_threads) {
+  num_threads_ = num_threads;
+}
+
 void SystemDictionaryBuilder::BuildFromTokensInternal(
     std::vector<Token*> tokens) {
-  KeyInfoList key_info_list = ReadTokens(std::move(tokens));
-
-  BuildFrequentPos(key_info_list);
-  BuildValueTrie(key_info_list);
-  BuildKeyTrie(key_info_list);
-
-  SetIdForValue(&key_info_list);
-  SetIdForKey(&key_info_list);
-  SortTokenInfo(&key_info_list);
-  SetCostType(&key_info_list);
-  SetPosType(&key_info_list);
-  SetValueType(&key_info_list);
+  KeyInfoList key_info_list;
+  RunPhase("ReadTokens", [&] {
+    key_info_list = ReadTokens(std::move(tokens));
+  });
+
+  // The tries are independent of each other, so build them concurrently. The
+  // threads are split between them not to exceed the number of threads.
+  RunPhase("BuildTries", [&] {
+    const int num_threads = GetNumParallelThreads(num_threads_);
+    std::optional<BackgroundFuture<void>> key_trie;
+    if (num_threads > 1) {
+      key_trie.emplace([&] { BuildKeyTrie(key_info_list, num_threads / 2); });
+    } else {
+      BuildKeyTrie(key_info_list, 1);
+    }
+    BuildFrequentPos(key_info_list);
+    BuildValueTrie(key_info_list, num_threads - num_threads / 2);
+    if (key_trie.has_value()) {
+      key_trie->Wait();
+    }
+  });
+  if (emit_double_array_key_trie_) {
+    RunPhase("BuildDoubleArrayKeyTrie", [&] { BuildDoubleArrayKeyTrie(); });
+  }
 
-  BuildTokenArray(key_info_list);
+  RunPhase("SetTokenInfo", [&] {
+    SetIdForValue(&key_info_list);
+    SetIdForKey(&key_info_list);
+    SortTokenInfo(&key_info_list);
+    SetCostType(&key_info_list);
+    SetPosType(&key_info_list);
+    SetValueType(&key_info_list);
+  });
+
+  RunPhase("BuildTokenArray", [&] { BuildTokenArray(key_info_list); });
+  if (emit_token_blocks_) {
+    RunPhase("BuildTokenBlockArray",
+             [&] { BuildTokenBlockArray(key_info_list); });
+  }
 }
 
 void SystemDictionaryBuilder::WriteToFile(absl::string_view output_file) const {
@@ -149,6 +196,22 @@ void SystemDictionaryBuilder::WriteToStream(
       file_codec_->GetSectionName(codec_->GetSectionNameForPos()));
   sections.push_back(frequent_pos_section);
 
+  std::optional<DictionaryFileSection> token_block_array_section;
+  if (emit_token_blocks_) {
+    token_block_array_section.emplace(
+        token_block_array_builder_.image(),
+        file_codec_->GetSectionName(codec_->GetSectionNameForTokenBlocks()));
+    sections.push_back(*token_block_array_section);
+  }
+
+  std::optional<DictionaryFileSection> double_array_key_trie_section;
+  if (emit_double_array_key_trie_) {
+    double_array_key_trie_section.emplace(
+        double_array_key_trie_image_,
+        file_codec_->GetSectionName(codec_->GetSectionNameForDoubleArrayKey()));
+    sections.push_back(*double_array_key_trie_section);
+  }
+
   if (absl::GetFlag(FLAGS_preserve_intermediate_dictionary) &&
       !intermediate_output_file_base_path.empty()) {
     // Write out intermediate results to files.
@@ -159,6 +222,14 @@ void SystemDictionaryBuilder::WriteToStream(
     WriteSectionToFile(token_array_section, absl::StrCat(basepath, ".tokens"));
     WriteSectionToFile(frequent_pos_section,
                        absl::StrCat(basepath, ".freq_pos"));
+    if (token_block_array_section.has_value()) {
+      WriteSectionToFile(*token_block_array_section,
+                         absl::StrCat(basepath, ".token_blocks"));
+    }
+    if (double_array_key_trie_section.has_value()) {
+      WriteSectionToFile(*double_array_key_trie_section,
+                         absl::StrCat(basepath, ".double_array_key"));
+    }
   }
 
   LOG(INFO) << "Start writing dictionary file.";
@@ -229,9 +300,10 @@ SystemDictionaryBuilder::KeyInfoList SystemDictionaryBuilder::ReadTokens(
   //    [KeyInfo(key:aaa)[Token 1][Token 2]][KeyInfo(key:abc)[Token 3]][...]
 
   // Step 1.
-  std::stable_sort(
+  ParallelStableSort(
       tokens.begin(), tokens.end(),
-      [](const Token* l, const Token* r) { return l->key < r->key; });
+      [](const Token* l, const Token* r) { return l->key < r->key; },
+      num_threads_);
 
   // Step 2.
   KeyInfoList key_info_list;
@@ -247,9 +319,14 @@ SystemDictionaryBuilder::KeyInfoList SystemDictionaryBuilder::ReadTokens(
       last_key_info.key = token->key;
     }
     last_key_info.tokens.emplace_back(token);
-    last_key_info.tokens.back().value_type = GetValueType(token);
   }
   key_info_list.push_back(std::move(last_key_info));
+
+  ParallelFor(key_info_list.size(), num_threads_, [&](size_t i) {
+    for (TokenInfo& token_info : key_info_list[i].tokens) {
+      token_info.value_type = GetValueType(token_info.token);
+    }
+  });
   return key_info_list;
 }
 
@@ -301,7 +378,9 @@ void SystemDictionaryBuilder::BuildFrequentPos(
                << " tokens";
 }
 
-void SystemDictionaryBuilder::BuildValueTrie(const KeyInfoList& key_info_list) {
+void SystemDictionaryBuilder::BuildValueTrie(const KeyInfoList& key_info_list,
+                                             int num_threads) {
+  std::vector<const Token*> tokens;
   for (const KeyInfo& key_info : key_info_list) {
     for (const TokenInfo& token_info : key_info.tokens) {
       if (token_info.value_type == TokenInfo::AS_IS_HIRAGANA ||
@@ -309,25 +388,33 @@ void SystemDictionaryBuilder::BuildValueTrie(const KeyInfoList& key_info_list) {
         // These values will be stored in token array as flags
         continue;
       }
-      std::string value_str = codec_->EncodeValue(token_info.token->value);
-      value_trie_builder_.Add(std::move(value_str));
+      tokens.push_back(token_info.token);
     }
   }
+  std::vector<std::string> values(tokens.size());
+  ParallelFor(tokens.size(), num_threads, [&](size_t i) {
+    values[i] = codec_->EncodeValue(tokens[i]->value);
+  });
+  for (std::string& value_str : values) {
+    value_trie_builder_.Add(std::move(value_str));
+  }
+  value_trie_builder_.set_num_threads(num_threads);
   value_trie_builder_.Build();
 }
 
 void SystemDictionaryBuilder::SetIdForValue(KeyInfoList* key_info_list) const {
-  for (KeyInfo& key_info : *key_info_list) {
-    for (TokenInfo& token_info : key_info.tokens) {
+  ParallelFor(key_info_list->size(), num_threads_, [&](size_t i) {
+    for (TokenInfo& token_info : (*key_info_list)[i].tokens) {
       const std::string value_str =
           codec_->EncodeValue(token_info.token->value);
       token_info.id_in_value_trie = value_trie_builder_.GetId(value_str);
     }
-  }
+  });
 }
 
 void SystemDictionaryBuilder::SortTokenInfo(KeyInfoList* key_info_list) const {
-  for (KeyInfo& key_info : *key_info_list) {
+  ParallelFor(key_info_list->size(), num_threads_, [&](size_t i) {
+    KeyInfo& key_info = (*key_info_list)[i];
     std::stable_sort(
         key_info.tokens.begin(), key_info.tokens.end(),
         [](const TokenInfo& lhs, const TokenInfo& rhs) {
@@ -337,7 +424,7 @@ void SystemDictionaryBuilder::SortTokenInfo(KeyInfoList* key_info_list) const {
                  std::tie(lhs.token->lid, lhs.token->rid, rhs.id_in_value_trie,
                           rhs.token->attributes);
         });
-  }
+  });
 }
 
 void SystemDictionaryBuilder::SetCostType(KeyInfoList* key_info_list) const {
@@ -367,17 +454,18 @@ void SystemDictionaryBuilder::SetCostType(KeyInfoList* key_info_list) const {
 
   const int min_key_len =
       absl::GetFlag(FLAGS_min_key_length_to_use_small_cost_encoding);
-  for (KeyInfo& key_info : *key_info_list) {
+  ParallelFor(key_info_list->size(), num_threads_, [&](size_t i) {
+    KeyInfo& key_info = (*key_info_list)[i];
     if (Util::CharsLen(key_info.key) < min_key_len) {
       // Do not use small cost encoding for short keys.
-      continue;
+      return;
     }
     if (HasHomonymsInSamePos(key_info)) {
-      continue;
+      return;
     }
     if (HasHeterophones(key_info, heterophone_values)) {
       // We want to keep the cost order for LookupReverse().
-      continue;
+      return;
     }
 
     for (TokenInfo& token_info : key_info.tokens) {
@@ -387,11 +475,12 @@ void SystemDictionaryBuilder::SetCostType(KeyInfoList* key_info_list) const {
       }
       token_info.cost_type = TokenInfo::CAN_USE_SMALL_ENCODING;
     }
-  }
+  });
 }
 
 void SystemDictionaryBuilder::SetPosType(KeyInfoList* key_info_list) const {
-  for (KeyInfo& key_info : *key_info_list) {
+  ParallelFor(key_info_list->size(), num_threads_, [&](size_t key_index) {
+    KeyInfo& key_info = (*key_info_list)[key_index];
     for (size_t i = 0; i < key_info.tokens.size(); ++i) {
       TokenInfo* token_info = &(key_info.tokens[i]);
       const uint32_t pos =
@@ -410,11 +499,12 @@ void SystemDictionaryBuilder::SetPosType(KeyInfoList* key_info_list) const {
         }
       }
     }
-  }
+  });
 }
 
 void SystemDictionaryBuilder::SetValueType(KeyInfoList* key_info_list) const {
-  for (KeyInfo& key_info : *key_info_list) {
+  ParallelFor(key_info_list->size(), num_threads_, [&](size_t key_index) {
+    KeyInfo& key_info = (*key_info_list)[key_index];
     for (size_t i = 1; i < key_info.tokens.size(); ++i) {
       const TokenInfo& prev_token_info = key_info.tokens[i - 1];
       TokenInfo* token_info = &(key_info.tokens[i]);
@@ -424,21 +514,37 @@ void SystemDictionaryBuilder::SetValueType(KeyInfoList* key_info_list) const {
         token_info->value_type = TokenInfo::SAME_AS_PREV_VALUE;
       }
     }
-  }
+  });
 }
 
-void SystemDictionaryBuilder::BuildKeyTrie(const KeyInfoList& key_info_list) {
-  for (const KeyInfo& key_info : key_info_list) {
-    key_trie_builder_.Add(codec_->EncodeKey(key_info.key));
+void SystemDictionaryBuilder::BuildKeyTrie(const KeyInfoList& key_info_list,
+                                           int num_threads) {
+  std::vector<std::string> keys(key_info_list.size());
+  ParallelFor(key_info_list.size(), num_threads, [&](size_t i) {
+    keys[i] = codec_->EncodeKey(key_info_list[i].key);
+  });
+  for (std::string& key : keys) {
+    key_trie_builder_.Add(std::move(key));
   }
+  key_trie_builder_.set_num_threads(num_threads);
   key_trie_builder_.Build();
 }
 
+void SystemDictionaryBuilder::BuildDoubleArrayKeyTrie() {
+  // The double array is converted from the LOUDS trie so that both have the
+  // same key IDs.
+  storage::louds::LoudsTrie key_trie;
+  CHECK(key_trie.Open(
+      reinterpret_cast<const uint8_t*>(key_trie_builder_.image().data())));
+  double_array_key_trie_image_ = DoubleArrayKeyTrie::BuildImage(key_trie);
+}
+
 void SystemDictionaryBuilder::SetIdForKey(KeyInfoList* key_info_list) const {
-  for (KeyInfo& key_info : *key_info_list) {
+  ParallelFor(key_info_list->size(), num_threads_, [&](size_t i) {
+    KeyInfo& key_info = (*key_info_list)[i];
     key_info.id_in_key_trie =
         key_trie_builder_.GetId(codec_->EncodeKey(key_info.key));
-  }
+  });
 }
 
 void SystemDictionaryBuilder::BuildTokenArray(
@@ -453,8 +559,13 @@ void SystemDictionaryBuilder::BuildTokenArray(
       id_to_keyinfo_table[id] = &key_info;
     }
 
-    for (const KeyInfo* key_info : id_to_keyinfo_table) {
-      token_array_builder_.Add(codec_->EncodeTokens(key_info->tokens));
+    // Encode the tokens in parallel, then add them in the id order.
+    std::vector<std::string> encoded_tokens(id_to_keyinfo_table.size());
+    ParallelFor(encoded_tokens.size(), num_threads_, [&](size_t i) {
+      encoded_tokens[i] = codec_->EncodeTokens(id_to_keyinfo_table[i]->tokens);
+    });
+    for (std::string& tokens : encoded_tokens) {
+      token_array_builder_.Add(std::move(tokens));
     }
   }
 
@@ -462,5 +573,25 @@ void SystemDictionaryBuilder::BuildTokenArray(
   token_array_builder_.Build();
 }
 
+void SystemDictionaryBuilder::BuildTokenBlockArray(
+    const KeyInfoList& key_info_list) {
+  std::vector<const KeyInfo*> id_to_keyinfo_table(key_info_list.size());
+  for (const KeyInfo& key_info : key_info_list) {
+    id_to_keyinfo_table[key_info.id_in_key_trie] = &key_info;
+  }
+
+  std::vector<std::string> encoded_blocks(id_to_keyinfo_table.size());
+  ParallelFor(encoded_blocks.size(), num_threads_, [&](size_t i) {
+    encoded_blocks[i] =
+        codec_->EncodeTokenBlock(id_to_keyinfo_table[i]->tokens);
+  });
+  // Token blocks are always a multiple of 4 bytes. Keeps them aligned.
+  token_block_array_builder_.SetSize(4, 4);
+  for (std::string& block : encoded_blocks) {
+    token_block_array_builder_.Add(std::move(block));
+  }
+  token_block_array_builder_.Build();
+}
+
 }  // namespace dictionary
 }  // namespace mozc
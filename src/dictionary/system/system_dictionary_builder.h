@@ -78,6 +78,25 @@ class SystemDictionaryBuilder final {
   }
   void BuildFromTokens(absl::Span<const std::unique_ptr<Token>> token);
 
+  // Sets the number of threads used to build the dictionary. Non-positive
+  // value means the number of hardware threads. The output image is the same
+  // regardless of this value. The default is 1.
+  void set_num_threads(int num_threads);
+
+  // Sets whether to write the token blocks in addition to the token array.
+  // The token array is always written as the reverse lookup depends on it.
+  // The default is false.
+  void set_emit_token_blocks(bool emit_token_blocks) {
+    emit_token_blocks_ = emit_token_blocks;
+  }
+
+  // Sets whether to write the double-array key trie in addition to the LOUDS
+  // key trie. The LOUDS key trie is always written as the reverse lookup
+  // depends on it. The default is false.
+  void set_emit_double_array_key_trie(bool emit_double_array_key_trie) {
+    emit_double_array_key_trie_ = emit_double_array_key_trie;
+  }
+
   void WriteToFile(absl::string_view output_file) const;
   void WriteToStream(absl::string_view intermediate_output_file_base_path,
                      std::ostream* output_stream) const;
@@ -93,9 +112,12 @@ class SystemDictionaryBuilder final {
   KeyInfoList ReadTokens(std::vector<Token*> tokens) const;
 
   void BuildFrequentPos(const KeyInfoList& key_info_list);
-  void BuildValueTrie(const KeyInfoList& key_info_list);
-  void BuildKeyTrie(const KeyInfoList& key_info_list);
+  // The tries are built concurrently, each from `num_threads` threads.
+  void BuildValueTrie(const KeyInfoList& key_info_list, int num_threads);
+  void BuildKeyTrie(const KeyInfoList& key_info_list, int num_threads);
+  void BuildDoubleArrayKeyTrie();
   void BuildTokenArray(const KeyInfoList& key_info_list);
+  void BuildTokenBlockArray(const KeyInfoList& key_info_list);
 
   void SetIdForValue(KeyInfoList* key_info_list) const;
   void SetIdForKey(KeyInfoList* key_info_list) const;
@@ -108,12 +130,17 @@ class SystemDictionaryBuilder final {
   storage::louds::LoudsTrieBuilder value_trie_builder_;
   storage::louds::LoudsTrieBuilder key_trie_builder_;
   storage::louds::BitVectorBasedArrayBuilder token_array_builder_;
+  storage::louds::BitVectorBasedArrayBuilder token_block_array_builder_;
+  std::string double_array_key_trie_image_;
 
   // mapping from {left_id, right_id} to POS index (0--255)
   std::map<uint32_t, int> frequent_pos_;
 
   std::unique_ptr<const SystemDictionaryCodec> codec_;
   std::unique_ptr<const DictionaryFileCodec> file_codec_;
+  int num_threads_ = 1;
+  bool emit_token_blocks_ = false;
+  bool emit_double_array_key_trie_ = false;
 };
 
 }  // namespace dictionary
@@ -36,7 +36,9 @@
 #include <limits>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -55,6 +57,7 @@
 #include "dictionary/dictionary_test_util.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/pos_matcher.h"
+#include "dictionary/system/decoded_value_cache.h"
 #include "dictionary/system/system_dictionary_builder.h"
 #include "dictionary/text_dictionary_loader.h"
 #include "protocol/commands.pb.h"
@@ -74,6 +77,7 @@ namespace {
 
 using ::testing::_;
 using ::testing::AtLeast;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Return;
 
@@ -425,6 +429,183 @@ class LookupPrefixTestCallback : public TokenCallbackBase {
   std::set<std::pair<std::string, std::string>> result_;
 };
 
+TEST_F(SystemDictionaryTest, LookupWithValueCache) {
+  absl::Span<const std::unique_ptr<Token>> source_tokens = text_dict_.tokens();
+  std::unique_ptr<SystemDictionary> system_dic =
+      BuildSystemDictionary(MakeTokenPointers(&source_tokens),
+                            absl::GetFlag(FLAGS_dictionary_test_size));
+  ASSERT_TRUE(system_dic);
+  EXPECT_EQ(system_dic->GetValueCacheStats().hits, 0);
+  EXPECT_EQ(system_dic->GetValueCacheStats().misses, 0);
+
+  std::unique_ptr<SystemDictionary> cached_dic =
+      SystemDictionary::Builder(dic_fn_).SetValueCacheSize(256).Build().value();
+  ASSERT_TRUE(cached_dic);
+
+  // The cached dictionary returns the same tokens, also for the second time
+  // when values are served from the cache.
+  for (int trial = 0; trial < 2; ++trial) {
+    for (size_t i = 0; i < std::min<size_t>(source_tokens.size(), 100); ++i) {
+      const std::string& key = source_tokens[i]->key;
+      CollectTokenCallback expected, actual;
+      system_dic->LookupPrefix(key, &expected);
+      cached_dic->LookupPrefix(key, &actual);
+      ASSERT_EQ(actual.tokens().size(), expected.tokens().size()) << key;
+      for (size_t j = 0; j < expected.tokens().size(); ++j) {
+        EXPECT_EQ(actual.tokens()[j].value, expected.tokens()[j].value);
+      }
+    }
+  }
+  const DecodedValueCache::Stats stats = cached_dic->GetValueCacheStats();
+  EXPECT_GT(stats.hits, 0);
+  EXPECT_GT(stats.misses, 0);
+
+  // Reverse lookups bypass the cache.
+  for (size_t i = 0; i < std::min<size_t>(source_tokens.size(), 100); ++i) {
+    CollectTokenCallback callback;
+    cached_dic->LookupReverse(source_tokens[i]->key, &callback);
+  }
+  EXPECT_EQ(cached_dic->GetValueCacheStats().hits, stats.hits);
+  EXPECT_EQ(cached_dic->GetValueCacheStats().misses, stats.misses);
+}
+
+TEST_F(SystemDictionaryTest, LookupWithTokenBlocks) {
+  // Also covers the small cost encoding, which both formats decode the same.
+  absl::SetFlag(&FLAGS_min_key_length_to_use_small_cost_encoding, 1);
+  absl::Span<const std::unique_ptr<Token>> source_tokens = text_dict_.tokens();
+  {
+    SystemDictionaryBuilder builder;
+    builder.set_emit_token_blocks(true);
+    builder.BuildFromTokens(source_tokens);
+    builder.WriteToFile(dic_fn_);
+  }
+  std::unique_ptr<SystemDictionary> system_dic =
+      SystemDictionary::Builder(dic_fn_).Build().value();
+  std::unique_ptr<SystemDictionary> block_dic =
+      SystemDictionary::Builder(dic_fn_)
+          .SetOptions(SystemDictionary::USE_TOKEN_BLOCKS)
+          .Build()
+          .value();
+
+  auto expect_same_tokens = [&](const CollectTokenCallback& expected,
+                                const CollectTokenCallback& actual) {
+    ASSERT_EQ(actual.tokens().size(), expected.tokens().size());
+    for (size_t i = 0; i < expected.tokens().size(); ++i) {
+      EXPECT_TRUE(CompareTokensForLookup(actual.tokens()[i],
+                                         expected.tokens()[i], false))
+          << PrintToken(actual.tokens()[i]) << " vs "
+          << PrintToken(expected.tokens()[i]);
+    }
+  };
+  for (size_t i = 0; i < std::min<size_t>(source_tokens.size(), 300); ++i) {
+    const Token& token = *source_tokens[i];
+    {
+      CollectTokenCallback expected, actual;
+      system_dic->LookupPrefix(token.key, &expected);
+      block_dic->LookupPrefix(token.key, &actual);
+      expect_same_tokens(expected, actual);
+    }
+    {
+      CollectTokenCallback expected, actual;
+      system_dic->LookupExact(token.key, &expected);
+      block_dic->LookupExact(token.key, &actual);
+      expect_same_tokens(expected, actual);
+    }
+    {
+      CollectTokenCallback expected, actual;
+      system_dic->LookupPredictive(token.key, &expected);
+      block_dic->LookupPredictive(token.key, &actual);
+      expect_same_tokens(expected, actual);
+    }
+    EXPECT_EQ(block_dic->HasValue(token.value),
+              system_dic->HasValue(token.value));
+  }
+
+  // Dictionaries without the token blocks fall back to the token array.
+  BuildAndWriteSystemDictionary(MakeTokenPointers(&source_tokens), 100,
+                                dic_fn_);
+  EXPECT_TRUE(SystemDictionary::Builder(dic_fn_)
+                  .SetOptions(SystemDictionary::USE_TOKEN_BLOCKS)
+                  .Build()
+                  .ok());
+}
+
+TEST_F(SystemDictionaryTest, LookupWithDoubleArrayKeyTrie) {
+  absl::Span<const std::unique_ptr<Token>> source_tokens = text_dict_.tokens();
+  {
+    SystemDictionaryBuilder builder;
+    builder.set_emit_double_array_key_trie(true);
+    builder.BuildFromTokens(source_tokens);
+    builder.WriteToFile(dic_fn_);
+  }
+  std::unique_ptr<SystemDictionary> system_dic =
+      SystemDictionary::Builder(dic_fn_).Build().value();
+  std::unique_ptr<SystemDictionary> double_array_dic =
+      SystemDictionary::Builder(dic_fn_)
+          .SetOptions(SystemDictionary::USE_DOUBLE_ARRAY_KEY_TRIE)
+          .Build()
+          .value();
+
+  auto expect_same_tokens = [&](const CollectTokenCallback& expected,
+                                const CollectTokenCallback& actual) {
+    ASSERT_EQ(actual.tokens().size(), expected.tokens().size());
+    for (size_t i = 0; i < expected.tokens().size(); ++i) {
+      EXPECT_TRUE(CompareTokensForLookup(actual.tokens()[i],
+                                         expected.tokens()[i], false))
+          << PrintToken(actual.tokens()[i]) << " vs "
+          << PrintToken(expected.tokens()[i]);
+    }
+  };
+  for (size_t i = 0; i < std::min<size_t>(source_tokens.size(), 300); ++i) {
+    const Token& token = *source_tokens[i];
+    for (const bool kana_modifier_insensitive : {false, true}) {
+      {
+        CollectTokenCallback expected, actual;
+        expected.SetKanaModifierInsensitiveConversion(
+            kana_modifier_insensitive);
+        actual.SetKanaModifierInsensitiveConversion(kana_modifier_insensitive);
+        system_dic->LookupPrefix(token.key, &expected);
+        double_array_dic->LookupPrefix(token.key, &actual);
+        expect_same_tokens(expected, actual);
+      }
+      {
+        CollectTokenCallback expected, actual;
+        expected.SetKanaModifierInsensitiveConversion(
+            kana_modifier_insensitive);
+        actual.SetKanaModifierInsensitiveConversion(kana_modifier_insensitive);
+        system_dic->LookupPredictive(token.key, &expected);
+        double_array_dic->LookupPredictive(token.key, &actual);
+        expect_same_tokens(expected, actual);
+      }
+    }
+    {
+      CollectTokenCallback expected, actual;
+      system_dic->LookupExact(token.key, &expected);
+      double_array_dic->LookupExact(token.key, &actual);
+      expect_same_tokens(expected, actual);
+    }
+    {
+      CollectTokenCallback expected, actual;
+      system_dic->LookupReverse(token.value, &expected);
+      double_array_dic->LookupReverse(token.value, &actual);
+      expect_same_tokens(expected, actual);
+    }
+    EXPECT_TRUE(double_array_dic->HasKey(token.key));
+    EXPECT_EQ(double_array_dic->HasValue(token.value),
+              system_dic->HasValue(token.value));
+  }
+  EXPECT_FALSE(double_array_dic->HasKey("ゔゔゔゔゔゔ"));
+
+  // Dictionaries without the double-array key trie fall back to the LOUDS key
+  // trie.
+  BuildAndWriteSystemDictionary(MakeTokenPointers(&source_tokens), 100,
+                                dic_fn_);
+  EXPECT_TRUE(SystemDictionary::Builder(dic_fn_)
+                  .SetOptions(SystemDictionary::USE_DOUBLE_ARRAY_KEY_TRIE)
+                  .Build()
+                  .ok());
+}
+
 TEST_F(SystemDictionaryTest, LookupPrefix) {
   // Set up a test dictionary.
   struct {
@@ -834,6 +1015,33 @@ TEST_F(SystemDictionaryTest, EnableNoModifierTargetWithLoudsTrie) {
   }
 }
 
+TEST_F(SystemDictionaryTest, LookupPrefixWithFewerExpansionsFirst) {
+  std::vector<Token> tokens = {
+      {"ぱぱ", "パパ", 0, 0, 0, Token::NONE},
+      {"ばは", "馬歯", 0, 0, 0, Token::NONE},
+      {"はは", "母", 0, 0, 0, Token::NONE},
+      {"は", "葉", 0, 0, 0, Token::NONE},
+      {"ぱぱぱぱは", "4", 0, 0, 0, Token::NONE},
+      {"ぱぱぱぱぱ", "5", 0, 0, 0, Token::NONE},
+  };
+  std::vector<Token*> source_tokens = MakeTokenPointers(&tokens);
+  std::unique_ptr<SystemDictionary> system_dic =
+      BuildSystemDictionary(source_tokens, source_tokens.size());
+  ASSERT_TRUE(system_dic);
+
+  // The prefixes without expansion come first, and then the ones with fewer
+  // expanded characters.  The key with five expanded characters exceeds the
+  // limit.
+  CollectTokenCallback callback;
+  callback.SetKanaModifierInsensitiveConversion(true);
+  system_dic->LookupPrefix("ははははは", &callback);
+  std::vector<std::string> values;
+  for (const Token& token : callback.tokens()) {
+    values.push_back(token.value);
+  }
+  EXPECT_THAT(values, ElementsAre("葉", "母", "馬歯", "パパ", "4"));
+}
+
 TEST_F(SystemDictionaryTest, NoModifierForKanaEntries) {
   Token t0 = {"ていすてぃんぐ", "テイスティング", 0, 0, 0, Token::NONE};
   Token t1 = {"てすとです", "てすとです", 0, 0, 0, Token::NONE};
@@ -939,6 +1147,44 @@ TEST_F(SystemDictionaryTest, ShouldNotUseSmallCostEncodingForHeteronyms) {
   }
 }
 
+TEST_F(SystemDictionaryTest, ParallelBuildIsDeterministic) {
+  // Enable small cost encoding to cover all the phases.
+  absl::SetFlag(&FLAGS_min_key_length_to_use_small_cost_encoding,
+                original_flags_min_key_length_to_use_small_cost_encoding_);
+
+  // The parallel loader returns the same tokens in the same order.
+  TextDictionaryLoader parallel_text_dict(pos_matcher_);
+  parallel_text_dict.set_num_threads(4);
+  parallel_text_dict.LoadWithLineLimit(
+      mozc::testing::GetSourceFileOrDie(
+          {"data", "dictionary_oss", "dictionary00.txt"}),
+      "", absl::GetFlag(FLAGS_dictionary_test_size));
+  ASSERT_EQ(parallel_text_dict.tokens().size(), text_dict_.tokens().size());
+  for (size_t i = 0; i < text_dict_.tokens().size(); ++i) {
+    const Token& expected = *text_dict_.tokens()[i];
+    const Token& actual = *parallel_text_dict.tokens()[i];
+    EXPECT_EQ(std::tie(actual.key, actual.value, actual.cost, actual.lid,
+                       actual.rid, actual.attributes),
+              std::tie(expected.key, expected.value, expected.cost,
+                       expected.lid, expected.rid, expected.attributes))
+        << PrintToken(expected);
+  }
+
+  // The parallel builder writes the same image.
+  auto build = [this](int num_threads) {
+    SystemDictionaryBuilder builder;
+    builder.set_num_threads(num_threads);
+    builder.BuildFromTokens(text_dict_.tokens());
+    std::ostringstream image;
+    builder.WriteToStream("", &image);
+    return image.str();
+  };
+  const std::string serial_image = build(1);
+  EXPECT_FALSE(serial_image.empty());
+  EXPECT_TRUE(build(4) == serial_image);
+  EXPECT_TRUE(build(0) == serial_image);
+}
+
 }  // namespace
 }  // namespace dictionary
 }  // namespace mozc
@@ -30,6 +30,7 @@
 #ifndef MOZC_DICTIONARY_SYSTEM_TOKEN_DECODE_ITERATOR_H_
 #define MOZC_DICTIONARY_SYSTEM_TOKEN_DECODE_ITERATOR_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -41,6 +42,7 @@
 #include "base/japanese_util.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/system/codec.h"
+#include "dictionary/system/decoded_value_cache.h"
 #include "dictionary/system/words_info.h"
 #include "storage/louds/louds_trie.h"
 
@@ -51,10 +53,18 @@ class TokenDecodeIterator {
  public:
   TokenDecodeIterator(const TokenDecodeIterator&) = delete;
   TokenDecodeIterator& operator=(const TokenDecodeIterator&) = delete;
+  // If `value_cache` is not null, decoded values are looked up from and stored
+  // to it.
   TokenDecodeIterator(const SystemDictionaryCodec& codec,
                       const storage::louds::LoudsTrie& value_trie,
                       absl::Span<const uint32_t> frequent_pos,
-                      absl::string_view key, const uint8_t* ptr);
+                      absl::string_view key, const uint8_t* ptr,
+                      DecodedValueCache* value_cache = nullptr);
+  // Decodes the tokens from a token block instead of the token array.
+  TokenDecodeIterator(const SystemDictionaryCodec& codec,
+                      const storage::louds::LoudsTrie& value_trie,
+                      absl::string_view key, TokenBlock block,
+                      DecodedValueCache* value_cache = nullptr);
   ~TokenDecodeIterator() = default;
 
   const TokenInfo& Get() const { return token_info_; }
@@ -70,23 +80,33 @@ class TokenDecodeIterator {
 
   void NextInternal();
 
-  std::string LookupValue(int id) const {
+  void LookupValue(int id, std::string* value) const {
+    if (value_cache_ != nullptr && value_cache_->Lookup(id, value)) {
+      return;
+    }
     char buffer[storage::louds::LoudsTrie::kMaxDepth + 1];
     const absl::string_view encoded_value =
         value_trie_.RestoreKeyString(id, buffer);
-    return codec_.DecodeValue(encoded_value);
+    *value = codec_.DecodeValue(encoded_value);
+    if (value_cache_ != nullptr) {
+      value_cache_->Insert(id, *value);
+    }
   }
 
   const SystemDictionaryCodec& codec_;
   const storage::louds::LoudsTrie& value_trie_;
   absl::Span<const uint32_t> frequent_pos_;
+  DecodedValueCache* value_cache_;
 
   const absl::string_view key_;
   // Katakana key will be lazily initialized.
   std::string key_katakana_;
 
   State state_;
+  // Null when decoding `block_`.
   const uint8_t* ptr_;
+  TokenBlock block_;
+  size_t block_index_ = 0;
 
   TokenInfo token_info_;
   Token token_;
@@ -98,10 +118,11 @@ inline TokenDecodeIterator::TokenDecodeIterator(
     const SystemDictionaryCodec& codec,
     const storage::louds::LoudsTrie& value_trie,
     absl::Span<const uint32_t> frequent_pos, absl::string_view key,
-    const uint8_t* ptr)
+    const uint8_t* ptr, DecodedValueCache* value_cache)
     : codec_(codec),
       value_trie_(value_trie),
       frequent_pos_(frequent_pos),
+      value_cache_(value_cache),
       key_(key),
       state_(HAS_NEXT),
       ptr_(ptr),
@@ -110,6 +131,23 @@ inline TokenDecodeIterator::TokenDecodeIterator(
   NextInternal();
 }
 
+inline TokenDecodeIterator::TokenDecodeIterator(
+    const SystemDictionaryCodec& codec,
+    const storage::louds::LoudsTrie& value_trie, absl::string_view key,
+    TokenBlock block, DecodedValueCache* value_cache)
+    : codec_(codec),
+      value_trie_(value_trie),
+      value_cache_(value_cache),
+      key_(key),
+      state_(HAS_NEXT),
+      ptr_(nullptr),
+      block_(block),
+      token_info_(nullptr) {
+  DCHECK_GT(block_.size(), 0);
+  token_.key.assign(key.data(), key.size());
+  NextInternal();
+}
+
 inline void TokenDecodeIterator::Next() {
   DCHECK_NE(state_, DONE);
   if (state_ == LAST_TOKEN) {
@@ -143,16 +181,26 @@ inline void TokenDecodeIterator::NextInternal() {
   // reset it everytime.
   // This kind of structure should be packed in the codec or some
   // related but new class.
-  int read_bytes;
-  if (!codec_.DecodeToken(ptr_, &token_info_, &read_bytes)) {
-    state_ = LAST_TOKEN;
+  if (ptr_ == nullptr) {
+    // A token block has no SAME_AS_PREV_POS, FREQUENT_POS nor
+    // SAME_AS_PREV_VALUE, so every field is decoded by index without looking
+    // at the previous tokens.
+    codec_.DecodeTokenBlock(block_, block_index_, &token_info_);
+    if (++block_index_ == block_.size()) {
+      state_ = LAST_TOKEN;
+    }
+  } else {
+    int read_bytes;
+    if (!codec_.DecodeToken(ptr_, &token_info_, &read_bytes)) {
+      state_ = LAST_TOKEN;
+    }
+    ptr_ += read_bytes;
   }
-  ptr_ += read_bytes;
 
   // Fill remaining values.
   switch (token_info_.value_type) {
     case TokenInfo::DEFAULT_VALUE: {
-      token_.value = LookupValue(token_info_.id_in_value_trie);
+      LookupValue(token_info_.id_in_value_trie, &token_.value);
       break;
     }
     case TokenInfo::SAME_AS_PREV_VALUE: {
@@ -34,6 +34,7 @@
 #include "dictionary/text_dictionary_loader.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <limits>
@@ -52,6 +53,7 @@
 #include "absl/types/span.h"
 #include "base/japanese_util.h"
 #include "base/multifile.h"
+#include "base/parallel.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "dictionary/dictionary_token.h"
@@ -167,14 +169,33 @@ void TextDictionaryLoader::LoadWithLineLimit(
 
   // Read system dictionary.
   {
+    // Lines are read in batches and parsed in parallel. Each line is parsed
+    // into its own slot, so the order of tokens is the same as the serial
+    // reading.
+    constexpr int kMaxBatchSize = 1 << 16;
     InputMultiFile file(dictionary_filename);
+    std::vector<std::string> lines;
+    std::vector<std::unique_ptr<Token>> batch;
     std::string line;
-    while (limit > 0 && file.ReadLine(&line)) {
-      Util::ChopReturns(&line);
-      std::unique_ptr<Token> token = ParseTSVLine(line);
-      if (token) {
-        tokens_.push_back(std::move(token));
-        --limit;
+    while (limit > 0) {
+      lines.clear();
+      const size_t batch_size = std::min(limit, kMaxBatchSize);
+      while (lines.size() < batch_size && file.ReadLine(&line)) {
+        Util::ChopReturns(&line);
+        lines.push_back(std::move(line));
+      }
+      if (lines.empty()) {
+        break;
+      }
+      batch.clear();
+      batch.resize(lines.size());
+      ParallelFor(lines.size(), num_threads_,
+                  [&](size_t i) { batch[i] = ParseTSVLine(lines[i]); });
+      for (std::unique_ptr<Token>& token : batch) {
+        if (token) {
+          tokens_.push_back(std::move(token));
+          --limit;
+        }
       }
     }
     LOG(INFO) << tokens_.size() << " tokens from " << dictionary_filename;
@@ -192,7 +213,8 @@ void TextDictionaryLoader::LoadWithLineLimit(
   //   2. Accessing all the tokens that have the same value: Since tokens are
   //      also sorted in order of value, this can be done by finding a range of
   //      tokens that have the same value.
-  std::stable_sort(tokens_.begin(), tokens_.end(), OrderByValueThenByKey());
+  ParallelStableSort(tokens_.begin(), tokens_.end(), OrderByValueThenByKey(),
+                     num_threads_);
 
   std::vector<std::unique_ptr<Token>> reading_correction_tokens =
       LoadReadingCorrectionTokens(reading_correction_filename, tokens_, &limit);
@@ -70,6 +70,11 @@ class TextDictionaryLoader {
                          absl::string_view reading_correction_filename,
                          int limit);
 
+  // Sets the number of threads used to parse the files. Non-positive value
+  // means the number of hardware threads. The loaded tokens are the same
+  // regardless of this value. The default is 1.
+  void set_num_threads(int num_threads) { num_threads_ = num_threads; }
+
   // Clears the loaded tokens.
   void Clear() { tokens_.clear(); }
 
@@ -106,6 +111,7 @@ class TextDictionaryLoader {
 
   const uint16_t zipcode_id_;
   const uint16_t isolated_word_id_;
+  int num_threads_ = 1;
   std::vector<std::unique_ptr<Token>> tokens_;
 };
 
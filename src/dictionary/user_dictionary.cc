@@ -29,7 +29,6 @@
 
 #include "dictionary/user_dictionary.h"
 
-#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -53,6 +52,8 @@
 #include "absl/synchronization/mutex.h"
 #include "base/file_util.h"
 #include "base/hash.h"
+#include "base/memory_usage.h"
+#include "base/mmap.h"
 #include "base/strings/assign.h"
 #include "base/strings/japanese.h"
 #include "base/strings/unicode.h"
@@ -61,6 +62,7 @@
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/pos_matcher.h"
+#include "dictionary/user_dictionary_image.h"
 #include "dictionary/user_dictionary_importer.h"
 #include "dictionary/user_dictionary_storage.h"
 #include "dictionary/user_dictionary_util.h"
@@ -72,33 +74,6 @@ namespace mozc {
 namespace dictionary {
 namespace {
 
-struct OrderByKey {
-  bool operator()(const UserPos::Token& token, absl::string_view key) const {
-    return token.key < key;
-  }
-
-  bool operator()(absl::string_view key, const UserPos::Token& token) const {
-    return key < token.key;
-  }
-};
-
-struct OrderByKeyPrefix {
-  bool operator()(const UserPos::Token& token, absl::string_view prefix) const {
-    return absl::string_view(token.key).substr(0, prefix.size()) < prefix;
-  }
-
-  bool operator()(absl::string_view prefix, const UserPos::Token& token) const {
-    return prefix < absl::string_view(token.key).substr(0, prefix.size());
-  }
-};
-
-struct OrderByKeyThenById {
-  bool operator()(const UserPos::Token& lhs, const UserPos::Token& rhs) const {
-    const int comp = lhs.key.compare(rhs.key);
-    return comp == 0 ? (lhs.id < rhs.id) : (comp < 0);
-  }
-};
-
 class SuppressionDictionary {
  public:
   bool AddEntry(std::string key, std::string value) {
@@ -143,28 +118,55 @@ class SuppressionDictionary {
   absl::flat_hash_set<std::string> keys_only_;
   absl::flat_hash_set<std::string> values_only_;
 };
+
+// The tokens are released before loading a dictionary of this size, to avoid
+// holding two large dictionaries at the same time.
+constexpr size_t kVeryBigUserDictionarySize = 100000;
+
+// Returns the fingerprint of the token expansion by `user_pos`. The compiled
+// image depends on the POS ids and the conjugation forms given by UserPos.
+uint64_t GetUserPosFingerprint(const UserPos& user_pos) {
+  std::string data;
+  for (int i = user_dictionary::UserDictionary::PosType_MIN;
+       i <= user_dictionary::UserDictionary::PosType_MAX; ++i) {
+    if (!user_dictionary::UserDictionary::PosType_IsValid(i)) {
+      continue;
+    }
+    for (const UserPos::Token& token : user_pos.GetTokens(
+             "key", "value",
+             static_cast<user_dictionary::UserDictionary::PosType>(i))) {
+      absl::StrAppend(&data, i, "\t", token.key, "\t", token.value, "\t",
+                      token.id, "\t", token.attributes, "\n");
+    }
+  }
+  return CityFingerprint(data);
+}
+
 }  // namespace
 
+// TokensIndex holds the compiled image of the tokens either on the heap or on
+// the memory-mapped cache file.
 class UserDictionary::TokensIndex {
  public:
-  explicit TokensIndex(const UserPos& user_pos) : user_pos_(user_pos) {}
+  TokensIndex() = default;
 
   ~TokensIndex() = default;
 
-  bool empty() const { return user_pos_tokens_.empty(); }
-  size_t size() const { return user_pos_tokens_.size(); }
+  bool empty() const { return image_.empty(); }
+  size_t size() const { return image_.size(); }
+  const UserDictionaryImage& image() const { return image_; }
 
-  std::vector<UserPos::Token>::const_iterator begin() const {
-    return user_pos_tokens_.begin();
-  }
-  std::vector<UserPos::Token>::const_iterator end() const {
-    return user_pos_tokens_.end();
+  // Returns the byte image of the tokens.
+  absl::string_view data() const {
+    return mmap_.size() > 0 ? mmap_.string_view() : absl::string_view(buffer_);
   }
 
-  void Load(const user_dictionary::UserDictionaryStorage& storage,
-            std::atomic<bool>* canceled_signal) {
+  void Load(const UserPos& user_pos,
+            const user_dictionary::UserDictionaryStorage& storage,
+            uint64_t fingerprint, std::atomic<bool>* canceled_signal) {
     DCHECK(canceled_signal);
-    user_pos_tokens_.clear();
+    std::vector<UserPos::Token> user_pos_tokens;
+    std::vector<std::pair<std::string, std::string>> suppression_entries;
     absl::flat_hash_set<uint64_t> seen;
 
     for (const UserDictionaryStorage::UserDictionary& dic :
@@ -200,25 +202,40 @@ class UserDictionary::TokensIndex {
 
         if (entry.pos() == user_dictionary::UserDictionary::SUPPRESSION_WORD) {
           // "抑制単語"
-          suppression_dictionary_.AddEntry(std::move(reading), entry.value());
+          suppression_entries.emplace_back(std::move(reading), entry.value());
         } else {
           const absl::string_view comment =
               absl::StripAsciiWhitespace(entry.comment());
           for (auto& token :
-               user_pos_.GetTokens(reading, entry.value(), entry.pos())) {
+               user_pos.GetTokens(reading, entry.value(), entry.pos())) {
             strings::Assign(token.comment, comment);
-            user_pos_tokens_.push_back(std::move(token));
+            user_pos_tokens.push_back(std::move(token));
           }
         }
       }
     }
-    user_pos_tokens_.shrink_to_fit();
 
-    // Sort first by key and then by POS ID.
-    std::sort(user_pos_tokens_.begin(), user_pos_tokens_.end(),
-              OrderByKeyThenById());
+    buffer_ = UserDictionaryImage::Build(
+        fingerprint, std::move(user_pos_tokens), suppression_entries);
+    CHECK(image_.Init(buffer_));
+    InitSuppressionDictionary();
+
+    MOZC_VLOG(1) << image_.size() << " user dic entries loaded";
+  }
 
-    MOZC_VLOG(1) << user_pos_tokens_.size() << " user dic entries loaded";
+  // Opens the compiled image in `mmap`. Returns false if the image is broken
+  // or is not compiled from the data identified by `fingerprint`.
+  bool Open(Mmap mmap, uint64_t fingerprint) {
+    if (!image_.Init(mmap.string_view()) ||
+        image_.fingerprint() != fingerprint) {
+      image_ = UserDictionaryImage();
+      return false;
+    }
+    mmap_ = std::move(mmap);
+    InitSuppressionDictionary();
+
+    MOZC_VLOG(1) << image_.size() << " user dic entries mapped";
+    return true;
   }
 
   bool IsSuppressedEntry(absl::string_view key, absl::string_view value) const {
@@ -229,10 +246,27 @@ class UserDictionary::TokensIndex {
     return !suppression_dictionary_.IsEmpty();
   }
 
+  // The suppression entries are not counted as they are usually a handful.
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const {
+    if (mmap_.size() > 0) {
+      collector.AddMapped("dictionary.user.tokens", mmap_.string_view());
+    } else {
+      collector.AddHeap("dictionary.user.tokens", GetHeapBytes(buffer_));
+    }
+  }
+
  private:
-  const UserPos& user_pos_;
+  void InitSuppressionDictionary() {
+    for (size_t i = 0; i < image_.suppression_size(); ++i) {
+      const auto [key, value] = image_.suppression_entry(i);
+      suppression_dictionary_.AddEntry(std::string(key), std::string(value));
+    }
+  }
+
+  std::string buffer_;
+  Mmap mmap_;
+  UserDictionaryImage image_;
   SuppressionDictionary suppression_dictionary_;
-  std::vector<UserPos::Token> user_pos_tokens_;
 };
 
 class UserDictionary::UserDictionaryReloader {
@@ -277,6 +311,30 @@ class UserDictionary::UserDictionaryReloader {
 
  private:
   void ThreadMain() {
+    // The compiled cache is identified by the contents of the file, as the
+    // modification time is not reliable across the processes.
+    absl::StatusOr<Mmap> source =
+        Mmap::Map(dic_.GetFileName(), Mmap::READ_ONLY);
+    if (!source.ok()) {
+      LoadFromStorage();
+      return;
+    }
+    const uint64_t fingerprint = CityFingerprintWithSeed(
+        source->string_view(), GetUserPosFingerprint(*dic_.user_pos_));
+    if (dic_.LoadFromCache(fingerprint)) {
+      return;
+    }
+
+    user_dictionary::UserDictionaryStorage proto;
+    if (!proto.ParseFromArray(source->data(), source->size())) {
+      LOG(ERROR) << "Failed to parse the user dictionary";
+      return;
+    }
+    source = Mmap();
+    dic_.LoadAndSaveCache(proto, fingerprint);
+  }
+
+  void LoadFromStorage() {
     UserDictionaryStorage storage(dic_.GetFileName());
 
     // Load from file
@@ -304,7 +362,7 @@ UserDictionary::UserDictionary(std::unique_ptr<const UserPos> user_pos,
     : reloader_(std::make_unique<UserDictionaryReloader>(*this)),
       user_pos_(std::move(user_pos)),
       pos_matcher_(pos_matcher),
-      tokens_(std::make_shared<TokensIndex>(*user_pos_)),
+      tokens_(std::make_shared<TokensIndex>()),
       filename_(std::move(filename)) {
   DCHECK(user_pos_);
   DCHECK(!canceled_signal_);
@@ -346,11 +404,10 @@ void UserDictionary::LookupPredictive(absl::string_view key,
   }
 
   // Find the starting point of iteration over dictionary contents.
+  const UserDictionaryImage& image = tokens->image();
   Token token;
-  for (auto [begin, end] = std::equal_range(tokens->begin(), tokens->end(), key,
-                                            OrderByKeyPrefix());
-       begin != end; ++begin) {
-    const UserPos::Token& user_pos_token = *begin;
+  for (auto [begin, end] = image.PrefixRange(key); begin != end; ++begin) {
+    const UserDictionaryImage::Token user_pos_token = image[begin];
     switch (callback->OnKey(user_pos_token.key)) {
       case Callback::TRAVERSE_DONE:
         return;
@@ -366,7 +423,7 @@ void UserDictionary::LookupPredictive(absl::string_view key,
         Callback::TRAVERSE_DONE) {
       return;
     }
-    PopulateTokenFromUserPosToken(user_pos_token, PREDICTIVE, &token);
+    PopulateToken(user_pos_token, PREDICTIVE, &token);
     if (callback->OnToken(user_pos_token.key, user_pos_token.key, token) ==
         Callback::TRAVERSE_DONE) {
       return;
@@ -390,11 +447,10 @@ void UserDictionary::LookupPrefix(absl::string_view key,
 
   // Find the starting point for iteration over dictionary contents.
   const absl::string_view first_char = Utf8AsChars(key).front();
+  const UserDictionaryImage& image = tokens->image();
   Token token;
-  for (auto it = std::lower_bound(tokens->begin(), tokens->end(), first_char,
-                                  OrderByKey());
-       it != tokens->end(); ++it) {
-    const UserPos::Token& user_pos_token = *it;
+  for (size_t i = image.LowerBound(first_char); i < image.size(); ++i) {
+    const UserDictionaryImage::Token user_pos_token = image[i];
     if (user_pos_token.key > key) {
       break;
     }
@@ -421,7 +477,7 @@ void UserDictionary::LookupPrefix(absl::string_view key,
         Callback::TRAVERSE_DONE) {
       return;
     }
-    PopulateTokenFromUserPosToken(user_pos_token, PREFIX, &token);
+    PopulateToken(user_pos_token, PREFIX, &token);
     switch (callback->OnToken(user_pos_token.key, user_pos_token.key, token)) {
       case Callback::TRAVERSE_DONE:
         return;
@@ -441,8 +497,8 @@ void UserDictionary::LookupExact(absl::string_view key,
   if (key.empty() || tokens->empty()) {
     return;
   }
-  auto [begin, end] =
-      std::equal_range(tokens->begin(), tokens->end(), key, OrderByKey());
+  const UserDictionaryImage& image = tokens->image();
+  auto [begin, end] = image.EqualRange(key);
   if (begin == end) {
     return;
   }
@@ -456,12 +512,12 @@ void UserDictionary::LookupExact(absl::string_view key,
 
   Token token;
   for (; begin != end; ++begin) {
-    const UserPos::Token& user_pos_token = *begin;
+    const UserDictionaryImage::Token user_pos_token = image[begin];
     if (user_pos_token.pos_type() ==
         user_dictionary::UserDictionary::SUGGESTION_ONLY) {
       continue;
     }
-    PopulateTokenFromUserPosToken(user_pos_token, EXACT, &token);
+    PopulateToken(user_pos_token, EXACT, &token);
     if (callback->OnToken(key, key, token) != Callback::TRAVERSE_CONTINUE) {
       return;
     }
@@ -485,10 +541,9 @@ bool UserDictionary::LookupComment(absl::string_view key,
   }
 
   // Set the comment that was found first.
-  for (auto [begin, end] =
-           std::equal_range(tokens->begin(), tokens->end(), key, OrderByKey());
-       begin != end; ++begin) {
-    const UserPos::Token& token = *begin;
+  const UserDictionaryImage& image = tokens->image();
+  for (auto [begin, end] = image.EqualRange(key); begin != end; ++begin) {
+    const UserDictionaryImage::Token token = image[begin];
     if (token.value == value && !token.comment.empty()) {
       comment->assign(token.comment);
       return true;
@@ -519,29 +574,99 @@ bool UserDictionary::Load(
     const user_dictionary::UserDictionaryStorage& storage) {
   const size_t size = GetTokens()->size();
 
-  constexpr size_t kVeryBigUserDictionarySize = 100000;
-
   if (size >= kVeryBigUserDictionarySize) {
-    auto placeholder_empty_tokens = std::make_shared<TokensIndex>(*user_pos_);
+    auto placeholder_empty_tokens = std::make_shared<TokensIndex>();
     SetTokens(std::move(placeholder_empty_tokens));
   }
 
-  auto tokens = std::make_shared<TokensIndex>(*user_pos_);
-  tokens->Load(storage, &canceled_signal_);
+  auto tokens = std::make_shared<TokensIndex>();
+  tokens->Load(*user_pos_, storage, 0, &canceled_signal_);
 
   SetTokens(tokens);
   return true;
 }
 
+std::string UserDictionary::GetCacheFileName() const {
+  return absl::StrCat(filename_, ".cache");
+}
+
+bool UserDictionary::LoadFromCache(uint64_t fingerprint) {
+  absl::StatusOr<Mmap> mmap = Mmap::Map(GetCacheFileName(), Mmap::READ_ONLY);
+  if (!mmap.ok()) {
+    return false;
+  }
+  auto tokens = std::make_shared<TokensIndex>();
+  if (!tokens->Open(*std::move(mmap), fingerprint)) {
+    LOG(INFO) << "The compiled user dictionary is stale";
+    return false;
+  }
+  SetTokens(std::move(tokens));
+  return true;
+}
+
+void UserDictionary::LoadAndSaveCache(
+    const user_dictionary::UserDictionaryStorage& storage,
+    uint64_t fingerprint) {
+  // Builds the tokens in the same way as Load() and saves the image, so that
+  // this and other processes can map it next time.
+  if (GetTokens()->size() >= kVeryBigUserDictionarySize) {
+    SetTokens(std::make_shared<TokensIndex>());
+  }
+
+  auto tokens = std::make_shared<TokensIndex>();
+  tokens->Load(*user_pos_, storage, fingerprint, &canceled_signal_);
+  if (canceled_signal_.load()) {
+    return;
+  }
+
+  const std::string cache_filename = GetCacheFileName();
+  const std::string tmp_filename = absl::StrCat(cache_filename, ".tmp");
+  if (absl::Status s = FileUtil::SetContents(tmp_filename, tokens->data());
+      !s.ok()) {
+    LOG(ERROR) << "Cannot write the compiled user dictionary: " << s;
+    SetTokens(std::move(tokens));
+    return;
+  }
+  if (absl::Status s = FileUtil::AtomicRename(tmp_filename, cache_filename);
+      !s.ok()) {
+    LOG(ERROR) << "AtomicRename failed: " << s;
+    SetTokens(std::move(tokens));
+    return;
+  }
+
+  // Uses the mapped image to share the pages with other processes.
+  if (!LoadFromCache(fingerprint)) {
+    SetTokens(std::move(tokens));
+  }
+}
+
 std::vector<std::string> UserDictionary::GetPosList() const {
   return user_pos_->GetPosList();
 }
 
 std::string UserDictionary::GetFileName() const { return filename_; }
 
+void UserDictionary::CollectMemoryUsage(MemoryUsageCollector& collector) const {
+  GetTokens()->CollectMemoryUsage(collector);
+}
+
 void UserDictionary::PopulateTokenFromUserPosToken(
     const UserPos::Token& user_pos_token, RequestType request_type,
     Token* token) const {
+  PopulateToken(UserDictionaryImage::Token{.key = user_pos_token.key,
+                                           .value = user_pos_token.value,
+                                           .comment = user_pos_token.comment,
+                                           .id = user_pos_token.id,
+                                           .attributes =
+                                               user_pos_token.attributes,
+                                           .raw_pos_type =
+                                               user_pos_token.raw_pos_type},
+                request_type, token);
+}
+
+void UserDictionary::PopulateToken(
+    const UserDictionaryImage::Token& user_pos_token, RequestType request_type,
+    Token* token) const {
   token->key = user_pos_token.key;
   token->value = user_pos_token.value;
   token->lid = token->rid = user_pos_token.id;
@@ -31,6 +31,8 @@
 #define MOZC_DICTIONARY_USER_DICTIONARY_H_
 
 #include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -40,10 +42,12 @@
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "base/memory_usage.h"
 #include "base/thread.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/pos_matcher.h"
+#include "dictionary/user_dictionary_image.h"
 #include "dictionary/user_pos.h"
 #include "protocol/user_dictionary_storage.pb.h"
 
@@ -111,10 +115,28 @@ class UserDictionary : public UserDictionaryInterface {
 
   std::string GetFileName() const override;
 
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
+
  private:
   class TokensIndex;
   class UserDictionaryReloader;
 
+  // Returns the filename of the compiled image of the tokens. The image is
+  // saved next to the user dictionary when it is loaded from the protobuf,
+  // and is mapped instead of the protobuf while the source file is unchanged.
+  std::string GetCacheFileName() const;
+
+  // Maps the compiled image if it is built from the data identified by
+  // `fingerprint`.
+  bool LoadFromCache(uint64_t fingerprint);
+
+  // Loads `storage` and saves the compiled image with `fingerprint`.
+  void LoadAndSaveCache(const user_dictionary::UserDictionaryStorage& storage,
+                        uint64_t fingerprint);
+
+  void PopulateToken(const UserDictionaryImage::Token& user_pos_token,
+                     RequestType request_type, Token* token) const;
+
   std::shared_ptr<const TokensIndex> GetTokens() const {
     return tokens_.load();
   }
@@ -0,0 +1,233 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "dictionary/user_dictionary_image.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "base/container/serialized_string_array.h"
+#include "dictionary/user_pos.h"
+
+namespace mozc {
+namespace dictionary {
+namespace {
+
+static_assert(std::endian::native == std::endian::little,
+              "Little endian is assumed");
+
+constexpr char kMagic[4] = {'M', 'Z', 'U', 'D'};
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint64_t fingerprint;
+  uint32_t token_size;
+  uint32_t string_array_size;
+  uint32_t suppression_array_size;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 32);
+
+// Appends `strs` as SerializedStringArray padded to 4 bytes, and returns the
+// padded size.
+uint32_t AppendStringArray(absl::Span<const absl::string_view> strs,
+                           std::string* output) {
+  std::unique_ptr<uint32_t[]> buffer;
+  const absl::string_view array =
+      SerializedStringArray::SerializeToBuffer(strs, &buffer);
+  const size_t begin = output->size();
+  output->append(array);
+  output->resize((output->size() + 3) & ~size_t{3}, '\0');
+  return static_cast<uint32_t>(output->size() - begin);
+}
+
+}  // namespace
+
+std::string UserDictionaryImage::Build(
+    uint64_t fingerprint, std::vector<UserPos::Token> tokens,
+    absl::Span<const std::pair<std::string, std::string>>
+        suppression_entries) {
+  // Sort first by key and then by POS ID.
+  std::stable_sort(tokens.begin(), tokens.end(),
+                   [](const UserPos::Token& lhs, const UserPos::Token& rhs) {
+                     return std::tie(lhs.key, lhs.id) <
+                            std::tie(rhs.key, rhs.id);
+                   });
+
+  // Shares the same strings, e.g., the key and the value of hiragana words.
+  std::vector<absl::string_view> strings;
+  absl::flat_hash_map<absl::string_view, uint32_t> string_indices;
+  auto get_index = [&](absl::string_view str) {
+    const auto [it, inserted] =
+        string_indices.try_emplace(str, static_cast<uint32_t>(strings.size()));
+    if (inserted) {
+      strings.push_back(str);
+    }
+    return it->second;
+  };
+
+  std::vector<TokenData> token_array;
+  token_array.reserve(tokens.size());
+  for (const UserPos::Token& token : tokens) {
+    token_array.push_back({.key_index = get_index(token.key),
+                           .value_index = get_index(token.value),
+                           .comment_index = get_index(token.comment),
+                           .id = token.id,
+                           .attributes = token.attributes,
+                           .raw_pos_type = token.raw_pos_type});
+  }
+
+  std::vector<absl::string_view> suppression_strings;
+  suppression_strings.reserve(suppression_entries.size() * 2);
+  for (const auto& [key, value] : suppression_entries) {
+    suppression_strings.push_back(key);
+    suppression_strings.push_back(value);
+  }
+
+  Header header = {
+      .version = kVersion,
+      .fingerprint = fingerprint,
+      .token_size = static_cast<uint32_t>(token_array.size()),
+  };
+  std::copy_n(kMagic, sizeof(kMagic), header.magic);
+
+  std::string image(sizeof(Header), '\0');
+  image.append(reinterpret_cast<const char*>(token_array.data()),
+               token_array.size() * sizeof(TokenData));
+  header.string_array_size = AppendStringArray(strings, &image);
+  header.suppression_array_size =
+      AppendStringArray(suppression_strings, &image);
+  std::memcpy(image.data(), &header, sizeof(Header));
+  return image;
+}
+
+bool UserDictionaryImage::Init(
+    absl::string_view data_aligned_at_4byte_boundary) {
+  *this = UserDictionaryImage();
+
+  absl::string_view data = data_aligned_at_4byte_boundary;
+  if (data.size() < sizeof(Header)) {
+    LOG(ERROR) << "Image is too small: " << data.size();
+    return false;
+  }
+  Header header;
+  std::memcpy(&header, data.data(), sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion) {
+    LOG(WARNING) << "Unknown image format";
+    return false;
+  }
+  const uint64_t token_array_size =
+      static_cast<uint64_t>(header.token_size) * sizeof(TokenData);
+  if (sizeof(Header) + token_array_size + header.string_array_size +
+          header.suppression_array_size !=
+      data.size()) {
+    LOG(ERROR) << "Image size mismatch: " << data.size();
+    return false;
+  }
+  data.remove_prefix(sizeof(Header));
+
+  const absl::Span<const TokenData> tokens(
+      std::launder(reinterpret_cast<const TokenData*>(data.data())),
+      header.token_size);
+  data.remove_prefix(token_array_size);
+
+  SerializedStringArray strings, suppression;
+  if (!strings.Init(data.substr(0, header.string_array_size)) ||
+      !suppression.Init(data.substr(header.string_array_size)) ||
+      suppression.size() % 2 != 0) {
+    LOG(ERROR) << "Broken string array";
+    return false;
+  }
+
+  // Makes sure that a broken image is never accessed out of bounds.
+  for (const TokenData& token : tokens) {
+    if (token.key_index >= strings.size() ||
+        token.value_index >= strings.size() ||
+        token.comment_index >= strings.size()) {
+      LOG(ERROR) << "Broken token array";
+      return false;
+    }
+  }
+
+  fingerprint_ = header.fingerprint;
+  tokens_ = tokens;
+  strings_.swap(strings);
+  suppression_.swap(suppression);
+  return true;
+}
+
+UserDictionaryImage::Token UserDictionaryImage::operator[](size_t i) const {
+  const TokenData& token = tokens_[i];
+  return Token{.key = strings_[token.key_index],
+               .value = strings_[token.value_index],
+               .comment = strings_[token.comment_index],
+               .id = token.id,
+               .attributes = token.attributes,
+               .raw_pos_type = token.raw_pos_type};
+}
+
+size_t UserDictionaryImage::LowerBound(absl::string_view key) const {
+  return PartitionPoint([key](absl::string_view k) { return k < key; });
+}
+
+std::pair<size_t, size_t> UserDictionaryImage::EqualRange(
+    absl::string_view key) const {
+  return {LowerBound(key),
+          PartitionPoint([key](absl::string_view k) { return k <= key; })};
+}
+
+std::pair<size_t, size_t> UserDictionaryImage::PrefixRange(
+    absl::string_view prefix) const {
+  return {PartitionPoint([prefix](absl::string_view k) {
+            return k.substr(0, prefix.size()) < prefix;
+          }),
+          PartitionPoint([prefix](absl::string_view k) {
+            return k.substr(0, prefix.size()) <= prefix;
+          })};
+}
+
+}  // namespace dictionary
+}  // namespace mozc
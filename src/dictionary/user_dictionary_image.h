@@ -0,0 +1,186 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_DICTIONARY_USER_DICTIONARY_IMAGE_H_
+#define MOZC_DICTIONARY_USER_DICTIONARY_IMAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "base/container/serialized_string_array.h"
+#include "dictionary/user_pos.h"
+#include "protocol/user_dictionary_storage.pb.h"
+
+namespace mozc {
+namespace dictionary {
+
+// UserDictionaryImage is a compiled, immutable image of the user dictionary
+// tokens expanded by UserPos.  The image can be written to a file and used
+// directly on the memory-mapped file, so that the user dictionary doesn't need
+// to parse the protobuf and to expand the entries again on every reload.
+//
+// * Prerequisite
+// Little endian is assumed.
+//
+// * Binary format
+//
+// +---------------------------------------+
+// | Header (32 bytes)                     |
+// +---------------------------------------+
+// | Token array (16 bytes * N)            |
+// +---------------------------------------+
+// | String array (padded to 4 bytes)      |
+// +---------------------------------------+
+// | Suppression array (padded to 4 bytes) |
+// +---------------------------------------+
+//
+// ** Header
+// The magic number, the format version, the fingerprint given by the creator,
+// the number of tokens N, and the byte sizes of the string array and the
+// suppression array.
+//
+// ** Token array
+// The tokens sorted by key and then by POS id.  Each token has the indices of
+// its key, value and comment in the string array, followed by the POS id
+// (2 bytes), the attributes (1 byte) and the POS type (1 byte).
+//
+// ** String array
+// SerializedStringArray of all the distinct strings referred by the tokens.
+//
+// ** Suppression array
+// SerializedStringArray of the keys and values of the suppression words,
+// stored alternately.
+class UserDictionaryImage {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  // A token in the image.  The strings point to the image.
+  struct Token {
+    absl::string_view key;
+    absl::string_view value;
+    absl::string_view comment;
+    uint16_t id = 0;
+    uint8_t attributes = 0;
+    uint8_t raw_pos_type = 0;
+
+    bool has_attribute(UserPos::Token::Attribute attr) const {
+      return attributes & attr;
+    }
+    user_dictionary::UserDictionary::PosType pos_type() const {
+      return static_cast<user_dictionary::UserDictionary::PosType>(
+          raw_pos_type);
+    }
+  };
+
+  // Creates a byte image of `tokens` and the suppression words
+  // `suppression_entries`, which are pairs of a key and a value.  `fingerprint`
+  // is stored as is so that the creator can identify the source of the image.
+  static std::string Build(
+      uint64_t fingerprint, std::vector<UserPos::Token> tokens,
+      absl::Span<const std::pair<std::string, std::string>>
+          suppression_entries);
+
+  // Initializes the image from the memory block created by Build().  The block
+  // must be aligned at 4 byte boundary and outlive this instance.  Returns
+  // false when the data is invalid.
+  bool Init(absl::string_view data_aligned_at_4byte_boundary);
+
+  uint64_t fingerprint() const { return fingerprint_; }
+
+  size_t size() const { return tokens_.size(); }
+  bool empty() const { return tokens_.empty(); }
+
+  Token operator[](size_t i) const;
+  absl::string_view key(size_t i) const {
+    return strings_[tokens_[i].key_index];
+  }
+
+  // Returns the index of the first token whose key is not less than `key`.
+  size_t LowerBound(absl::string_view key) const;
+
+  // Returns the range [begin, end) of the tokens whose key is `key`.
+  std::pair<size_t, size_t> EqualRange(absl::string_view key) const;
+
+  // Returns the range [begin, end) of the tokens whose key starts with
+  // `prefix`.
+  std::pair<size_t, size_t> PrefixRange(absl::string_view prefix) const;
+
+  // Returns the number of the suppression words and the i-th pair of key and
+  // value.
+  size_t suppression_size() const { return suppression_.size() / 2; }
+  std::pair<absl::string_view, absl::string_view> suppression_entry(
+      size_t i) const {
+    return {suppression_[2 * i], suppression_[2 * i + 1]};
+  }
+
+ private:
+  struct TokenData {
+    uint32_t key_index;
+    uint32_t value_index;
+    uint32_t comment_index;
+    uint16_t id;
+    uint8_t attributes;
+    uint8_t raw_pos_type;
+  };
+
+  static_assert(sizeof(TokenData) == 16);
+
+  // Returns the index of the first token whose key doesn't satisfy `pred`,
+  // assuming the tokens are partitioned by `pred`.
+  template <typename Pred>
+  size_t PartitionPoint(Pred pred) const {
+    size_t begin = 0, size = tokens_.size();
+    while (size > 0) {
+      const size_t half = size / 2;
+      if (pred(key(begin + half))) {
+        begin += half + 1;
+        size -= half + 1;
+      } else {
+        size = half;
+      }
+    }
+    return begin;
+  }
+
+  uint64_t fingerprint_ = 0;
+  absl::Span<const TokenData> tokens_;
+  SerializedStringArray strings_;
+  SerializedStringArray suppression_;
+};
+
+}  // namespace dictionary
+}  // namespace mozc
+
+#endif  // MOZC_DICTIONARY_USER_DICTIONARY_IMAGE_H_
@@ -0,0 +1,168 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "dictionary/user_dictionary_image.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "dictionary/user_pos.h"
+#include "protocol/user_dictionary_storage.pb.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace dictionary {
+namespace {
+
+UserPos::Token MakeToken(absl::string_view key, absl::string_view value,
+                         uint16_t id, absl::string_view comment = "") {
+  UserPos::Token token{.key = std::string(key),
+                       .value = std::string(value),
+                       .id = id,
+                       .comment = std::string(comment)};
+  token.set_pos_type(user_dictionary::UserDictionary::NOUN);
+  return token;
+}
+
+std::vector<std::string> GetKeys(const UserDictionaryImage& image,
+                                 std::pair<size_t, size_t> range) {
+  std::vector<std::string> keys;
+  for (size_t i = range.first; i < range.second; ++i) {
+    keys.emplace_back(image.key(i));
+  }
+  return keys;
+}
+
+TEST(UserDictionaryImageTest, BuildAndInit) {
+  std::vector<UserPos::Token> tokens = {
+      MakeToken("start", "start", 200),
+      MakeToken("star", "star", 100),
+      MakeToken("start", "Start", 100),
+      MakeToken("stamp", "stamp", 100),
+      MakeToken("smile", "smile", 200, "comment"),
+  };
+  tokens[4].add_attribute(UserPos::Token::NON_JA_LOCALE);
+  const std::vector<std::pair<std::string, std::string>> suppression = {
+      {"key", "value"}, {"", "value_only"}};
+
+  const std::string data =
+      UserDictionaryImage::Build(1234, std::move(tokens), suppression);
+  UserDictionaryImage image;
+  ASSERT_TRUE(image.Init(data));
+  EXPECT_EQ(image.fingerprint(), 1234);
+  ASSERT_EQ(image.size(), 5);
+
+  // Sorted by key and then by id.
+  EXPECT_EQ(GetKeys(image, {0, image.size()}),
+            (std::vector<std::string>{"smile", "stamp", "star", "start",
+                                      "start"}));
+  EXPECT_EQ(image[3].value, "Start");
+  EXPECT_EQ(image[3].id, 100);
+  EXPECT_EQ(image[4].value, "start");
+  EXPECT_EQ(image[4].id, 200);
+
+  const UserDictionaryImage::Token smile = image[0];
+  EXPECT_EQ(smile.value, "smile");
+  EXPECT_EQ(smile.comment, "comment");
+  EXPECT_TRUE(smile.has_attribute(UserPos::Token::NON_JA_LOCALE));
+  EXPECT_EQ(smile.pos_type(), user_dictionary::UserDictionary::NOUN);
+  EXPECT_TRUE(image[1].comment.empty());
+  EXPECT_FALSE(image[1].has_attribute(UserPos::Token::NON_JA_LOCALE));
+
+  ASSERT_EQ(image.suppression_size(), 2);
+  EXPECT_EQ(image.suppression_entry(0),
+            (std::pair<absl::string_view, absl::string_view>("key", "value")));
+  EXPECT_EQ(image.suppression_entry(1),
+            (std::pair<absl::string_view, absl::string_view>("",
+                                                             "value_only")));
+}
+
+TEST(UserDictionaryImageTest, Ranges) {
+  std::vector<UserPos::Token> tokens = {
+      MakeToken("start", "start", 200),
+      MakeToken("star", "star", 100),
+      MakeToken("start", "Start", 100),
+      MakeToken("stamp", "stamp", 100),
+      MakeToken("smile", "smile", 200),
+  };
+  const std::string data = UserDictionaryImage::Build(0, std::move(tokens), {});
+  UserDictionaryImage image;
+  ASSERT_TRUE(image.Init(data));
+
+  EXPECT_EQ(GetKeys(image, image.EqualRange("start")),
+            (std::vector<std::string>{"start", "start"}));
+  EXPECT_EQ(GetKeys(image, image.EqualRange("sta")),
+            std::vector<std::string>());
+  EXPECT_EQ(GetKeys(image, image.PrefixRange("sta")),
+            (std::vector<std::string>{"stamp", "star", "start", "start"}));
+  EXPECT_EQ(GetKeys(image, image.PrefixRange("s")).size(), 5);
+  EXPECT_EQ(GetKeys(image, image.PrefixRange("x")),
+            std::vector<std::string>());
+  EXPECT_EQ(image.LowerBound("sta"), 1);
+  EXPECT_EQ(image.LowerBound("z"), 5);
+}
+
+TEST(UserDictionaryImageTest, Empty) {
+  const std::string data = UserDictionaryImage::Build(0, {}, {});
+  UserDictionaryImage image;
+  ASSERT_TRUE(image.Init(data));
+  EXPECT_TRUE(image.empty());
+  EXPECT_EQ(image.suppression_size(), 0);
+  EXPECT_EQ(image.EqualRange("a"), (std::pair<size_t, size_t>(0, 0)));
+}
+
+TEST(UserDictionaryImageTest, BrokenData) {
+  std::vector<UserPos::Token> tokens = {MakeToken("key", "value", 100)};
+  const std::string data = UserDictionaryImage::Build(0, std::move(tokens), {});
+
+  UserDictionaryImage image;
+  EXPECT_FALSE(image.Init(""));
+  EXPECT_FALSE(image.Init(absl::string_view(data).substr(0, 31)));
+  EXPECT_FALSE(image.Init(absl::string_view(data).substr(0, data.size() - 4)));
+
+  // Unknown magic.
+  std::string broken = data;
+  broken[0] = 'X';
+  EXPECT_FALSE(image.Init(broken));
+
+  // Out of range string index.
+  broken = data;
+  broken[32] = '\x7f';
+  EXPECT_FALSE(image.Init(broken));
+  EXPECT_TRUE(image.empty());
+}
+
+}  // namespace
+}  // namespace dictionary
+}  // namespace mozc
@@ -30,6 +30,7 @@
 #include "dictionary/user_dictionary.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -48,6 +49,7 @@
 #include "base/container/tuple.h"
 #include "base/file/temp_dir.h"
 #include "base/file_util.h"
+#include "base/memory_usage.h"
 #include "base/random.h"
 #include "base/system_util.h"
 #include "base/thread.h"
@@ -759,6 +761,66 @@ TEST_F(UserDictionaryTest, AsyncLoadTest) {
   }
 }
 
+TEST_F(UserDictionaryTest, CompiledCache) {
+  TempDirectory temp_dir = testing::MakeTempDirectoryOrDie();
+  const std::string filename =
+      FileUtil::JoinPath(temp_dir.path(), "compiled_cache_test.db");
+  const std::string cache_filename = absl::StrCat(filename, ".cache");
+  auto save = [&filename](absl::string_view contents) {
+    UserDictionaryStorage storage(filename);
+    LoadFromString(contents, &storage);
+    ASSERT_TRUE(storage.Lock());
+    ASSERT_OK(storage.Save());
+    ASSERT_TRUE(storage.UnLock());
+  };
+  auto get_mapped_bytes = [](const UserDictionary& dic) {
+    MemoryUsageCollector collector;
+    dic.CollectMemoryUsage(collector);
+    size_t mapped_bytes = 0;
+    for (const MemoryUsage& usage : collector.usages()) {
+      mapped_bytes += usage.mapped_bytes;
+    }
+    return mapped_bytes;
+  };
+
+  save(kUserDictionary0);
+  std::vector<Entry> expected;
+  {
+    // Compiles the protobuf and saves the cache.
+    std::unique_ptr<UserDictionary> dic(CreateDictionaryWithFilename(filename));
+    dic->WaitForReloader();
+    EXPECT_OK(FileUtil::FileExists(cache_filename));
+    EXPECT_GT(get_mapped_bytes(*dic), 0);
+    expected = LookupPredictive("s", *dic);
+    EXPECT_FALSE(expected.empty());
+  }
+  {
+    // Maps the cache.
+    std::unique_ptr<UserDictionary> dic(CreateDictionaryWithFilename(filename));
+    dic->WaitForReloader();
+    EXPECT_GT(get_mapped_bytes(*dic), 0);
+    EXPECT_EQ(LookupPredictive("s", *dic), expected);
+    EXPECT_EQ(LookupComment(*dic, "comment_key2", "comment_value2"),
+              "comment");
+  }
+  {
+    // The cache is stale after the dictionary is updated.
+    save("end\tend\tnoun\n");
+    std::unique_ptr<UserDictionary> dic(CreateDictionaryWithFilename(filename));
+    dic->WaitForReloader();
+    EXPECT_TRUE(LookupPredictive("s", *dic).empty());
+    EXPECT_FALSE(LookupExact("end", *dic).empty());
+  }
+  {
+    // The broken cache is rebuilt.
+    ASSERT_OK(FileUtil::SetContents(cache_filename, "broken"));
+    std::unique_ptr<UserDictionary> dic(CreateDictionaryWithFilename(filename));
+    dic->WaitForReloader();
+    EXPECT_FALSE(LookupExact("end", *dic).empty());
+    EXPECT_GT(get_mapped_bytes(*dic), 0);
+  }
+}
+
 TEST_F(UserDictionaryTest, TestSuppressionDictionary) {
   std::unique_ptr<UserDictionary> user_dic(CreateDictionaryWithMockPos());
   user_dic->WaitForReloader();
@@ -129,6 +129,7 @@ bool Engine::ReloadAndWait() { return Reload() && Wait(); }
 
 bool Engine::ClearUserHistory() {
   if (converter_) {
+    converter_->StopSpeculation();
     converter_->rewriter().Clear();
   }
   return true;
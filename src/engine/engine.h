@@ -38,6 +38,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "base/memory_usage.h"
 #include "converter/converter.h"
 #include "converter/converter_interface.h"
 #include "data_manager/data_manager.h"
@@ -115,6 +116,12 @@ class Engine : public EngineInterface {
     return {};
   }
 
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override {
+    if (converter_) {
+      converter_->CollectMemoryUsage(collector);
+    }
+  }
+
   // For testing only.
   engine::Modules& GetModulesForTesting() const {
     DCHECK(converter_);
@@ -44,7 +44,10 @@
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/clock.h"
 #include "base/text_normalizer.h"
+#include "base/trace.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "composer/composer.h"
@@ -120,7 +123,8 @@ EngineConverter::EngineConverter(
       state_(COMPOSITION),
       request_type_(ConversionRequest::CONVERSION),
       client_revision_(0),
-      candidate_list_visible_(false) {
+      candidate_list_visible_(false),
+      degraded_(false) {
   DCHECK(request_);
   DCHECK(converter_);
   DCHECK(config);
@@ -157,6 +161,7 @@ bool EngineConverter::ConvertWithPreferences(
   ConversionRequest::Options options;
   options.enable_user_history_for_conversion = preferences.use_history;
   SetRequestType(ConversionRequest::CONVERSION, options);
+  SetDeadline(options);
   const ConversionRequest conversion_request =
       ConversionRequestBuilder()
           .SetComposer(composer)
@@ -170,6 +175,7 @@ bool EngineConverter::ConvertWithPreferences(
     ResetState();
     return false;
   }
+  degraded_ = conversion_request.IsDeadlineExceeded();
 
   segment_index_ = 0;
   state_ = CONVERSION;
@@ -543,6 +549,8 @@ bool EngineConverter::SuggestWithPreferences(
     }
   }
 
+  SetDeadline(options);
+
   DCHECK(config_);
   const ConversionRequest conversion_request =
       ConversionRequestBuilder()
@@ -555,6 +563,7 @@ bool EngineConverter::SuggestWithPreferences(
 
   // Start actual suggestion/prediction.
   bool result = converter_->StartPrediction(conversion_request, &segments_);
+  degraded_ = conversion_request.IsDeadlineExceeded();
   if (!result) {
     MOZC_VLOG(1)
         << "Start(Partial?)(Suggestion|Prediction)ForRequest() returns no "
@@ -606,6 +615,10 @@ bool EngineConverter::SuggestWithPreferences(
   UpdateCandidateList();
   candidate_list_visible_ = true;
   InitializeSelectedCandidateIndices();
+
+  if (request_->enable_speculative_prediction()) {
+    SpeculateNextPrediction(composer, conversion_request);
+  }
   return true;
 }
 
@@ -632,6 +645,7 @@ bool EngineConverter::PredictWithPreferences(
   DCHECK(request_);
   DCHECK(config_);
   SetRequestType(ConversionRequest::PREDICTION, options);
+  SetDeadline(options);
   options.use_actual_converter_for_realtime_conversion = true;
   const ConversionRequest conversion_request =
       ConversionRequestBuilder()
@@ -665,6 +679,7 @@ bool EngineConverter::PredictWithPreferences(
     converter_->PrependCandidates(conversion_request, previous_suggestions_,
                                   &segments_);
   }
+  degraded_ = conversion_request.IsDeadlineExceeded();
 
   segment_index_ = 0;
   state_ = PREDICTION;
@@ -1223,6 +1238,7 @@ void EngineConverter::FillPreedit(const composer::Composer& composer,
 
 void EngineConverter::FillOutput(const composer::Composer& composer,
                                  commands::Output* output) const {
+  MOZC_TRACE_SPAN("EngineConverter::FillOutput");
   if (!output) {
     LOG(ERROR) << "output is nullptr.";
     return;
@@ -1258,6 +1274,9 @@ void EngineConverter::FillOutput(const composer::Composer& composer,
       candidate_list_visible_) {
     FillCandidateWindow(output->mutable_candidate_window());
   }
+  if (degraded_) {
+    output->set_degraded(true);
+  }
 
   // All candidate words
   if (CheckState(SUGGESTION | PREDICTION | CONVERSION)) {
@@ -1275,6 +1294,12 @@ void EngineConverter::FillOutput(const composer::Composer& composer,
   }
 }
 
+size_t EngineConverter::GetMemoryUsage() const {
+  return sizeof(*this) + segments_.GetMemoryUsage() +
+         incognito_segments_.GetMemoryUsage() +
+         previous_suggestions_.GetMemoryUsage() + result_.ByteSizeLong();
+}
+
 EngineConverter* EngineConverter::Clone() const {
   EngineConverter* engine_converter =
       new EngineConverter(converter_, request_, config_);
@@ -1294,6 +1319,7 @@ void EngineConverter::ResetResult() { result_.Clear(); }
 
 void EngineConverter::ResetState() {
   state_ = COMPOSITION;
+  degraded_ = false;
   segment_index_ = 0;
   previous_suggestions_.clear();
   candidate_list_visible_ = false;
@@ -1888,5 +1914,36 @@ void EngineConverter::SetRequestType(
   options.request_type = request_type;
 }
 
+void EngineConverter::SetDeadline(ConversionRequest::Options& options) const {
+  if (const int32_t budget_msec = request_->conversion_time_budget_msec();
+      budget_msec > 0) {
+    options.deadline = Clock::GetAbslTime() + absl::Milliseconds(budget_msec);
+  }
+}
+
+void EngineConverter::SpeculateNextPrediction(
+    const composer::Composer& composer,
+    const ConversionRequest& request) const {
+  // Covers the five vowels following a consonant in the romaji input.
+  constexpr size_t kMaxSpeculativeInputs = 5;
+
+  std::vector<std::string> inputs = composer.GetNextInputsForPrediction();
+  if (inputs.empty()) {
+    return;
+  }
+  if (inputs.size() > kMaxSpeculativeInputs) {
+    inputs.resize(kMaxSpeculativeInputs);
+  }
+
+  std::vector<composer::ComposerData> composers;
+  composers.reserve(inputs.size());
+  for (std::string& input : inputs) {
+    composer::Composer next_composer = composer;
+    next_composer.InsertCharacter(std::move(input));
+    composers.push_back(next_composer.CreateComposerData());
+  }
+  converter_->SpeculatePrediction(request, std::move(composers), segments_);
+}
+
 }  // namespace engine
 }  // namespace mozc
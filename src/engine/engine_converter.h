@@ -261,6 +261,8 @@ class EngineConverter : public EngineConverterInterface {
     use_cascading_window_ = use_cascading_window;
   }
 
+  size_t GetMemoryUsage() const override;
+
   // Meaning that all the composition characters are consumed.
   // c.f. CommitSuggestionInternal
   static constexpr size_t kConsumedAllCharacters =
@@ -363,6 +365,12 @@ class EngineConverter : public EngineConverterInterface {
   // Sets request type and update the engine_converter's state
   void SetRequestType(ConversionRequest::RequestType request_type,
                       ConversionRequest::Options& options);
+  // Sets the deadline from Request.conversion_time_budget_msec.
+  void SetDeadline(ConversionRequest::Options& options) const;
+  // Starts the prediction for the likely next inputs of `composer` in
+  // background. See Request.enable_speculative_prediction.
+  void SpeculateNextPrediction(const composer::Composer& composer,
+                               const ConversionRequest& request) const;
 
   std::shared_ptr<const ConverterInterface> converter_;
 
@@ -413,6 +421,9 @@ class EngineConverter : public EngineConverterInterface {
 
   bool candidate_list_visible_;
 
+  // True if the current candidates were computed after the deadline.
+  bool degraded_;
+
   // Mutable values of |config_|.  These values may be changed temporarily per
   // session.
   bool use_cascading_window_;
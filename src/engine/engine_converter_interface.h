@@ -243,6 +243,9 @@ class EngineConverterInterface {
       config::Config::SelectionShortcut selection_shortcut) = 0;
 
   virtual void set_use_cascading_window(bool use_cascading_window) = 0;
+
+  // Returns the approximate heap size of the conversion state, e.g. segments.
+  virtual size_t GetMemoryUsage() const { return 0; }
 };
 
 }  // namespace engine
@@ -47,7 +47,10 @@
 
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "base/clock.h"
+#include "base/clock_mock.h"
 #include "base/util.h"
 #include "composer/composer.h"
 #include "composer/table.h"
@@ -81,6 +84,7 @@ using ::mozc::config::Config;
 using ::testing::_;
 using ::testing::DoAll;
 using ::testing::Eq;
+using ::testing::InvokeWithoutArgs;
 using ::testing::Mock;
 using ::testing::Pointee;
 using ::testing::Property;
@@ -475,6 +479,46 @@ TEST_F(EngineConverterTest, Convert) {
   EXPECT_FALSE(IsCandidateListVisible(converter));
 }
 
+TEST_F(EngineConverterTest, ConvertAfterDeadline) {
+  ClockMock clock(absl::FromUnixSeconds(1000));
+  Clock::SetClockForUnitTest(&clock);
+  request_->set_conversion_time_budget_msec(100);
+
+  auto mock_converter = std::make_shared<MockConverter>();
+  EngineConverter converter(mock_converter, request_, config_);
+  Segments segments;
+  SetAiueo(&segments);
+  composer_->InsertCharacterPreedit(kChars_Aiueo);
+
+  // The conversion finishes in time.
+  EXPECT_CALL(*mock_converter, StartConversion(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(segments), Return(true)));
+  ASSERT_TRUE(converter.Convert(*composer_));
+  commands::Output output;
+  converter.FillOutput(*composer_, &output);
+  EXPECT_FALSE(output.degraded());
+
+  // The conversion takes longer than the budget.
+  converter.Cancel();
+  EXPECT_CALL(*mock_converter, StartConversion(_, _))
+      .WillOnce(DoAll(InvokeWithoutArgs([&clock] {
+                        clock.Advance(absl::Milliseconds(100));
+                      }),
+                      SetArgPointee<1>(segments), Return(true)));
+  ASSERT_TRUE(converter.Convert(*composer_));
+  output.Clear();
+  converter.FillOutput(*composer_, &output);
+  EXPECT_TRUE(output.degraded());
+
+  // The flag is cleared with the conversion.
+  converter.Cancel();
+  output.Clear();
+  converter.FillOutput(*composer_, &output);
+  EXPECT_FALSE(output.degraded());
+
+  Clock::SetClockForUnitTest(nullptr);
+}
+
 TEST_F(EngineConverterTest, ConvertWithSpellingCorrection) {
   auto mock_converter = std::make_shared<MockConverter>();
   EngineConverter converter(mock_converter, request_, config_);
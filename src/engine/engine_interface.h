@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "base/memory_usage.h"
 #include "engine/engine_converter_interface.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
@@ -113,6 +114,9 @@ class EngineInterface {
 
   virtual void ImportUserDictionary(std::string name, std::string tsv) {}
 
+  // Reports the memory used by the engine and its components.
+  virtual void CollectMemoryUsage(MemoryUsageCollector& collector) const {}
+
  protected:
   EngineInterface() = default;
 };
@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "base/memory_usage.h"
 #include "engine/engine_converter_interface.h"
 #include "engine/engine_interface.h"
 #include "protocol/commands.pb.h"
@@ -56,6 +57,8 @@ class MockEngine : public EngineInterface {
   MOCK_METHOD(bool, ClearUnusedUserPrediction, (), (override));
   MOCK_METHOD(bool, ReloadAndWait, (), (override));
   MOCK_METHOD(std::vector<std::string>, GetPosList, (), (const, override));
+  MOCK_METHOD(void, CollectMemoryUsage, (MemoryUsageCollector & collector),
+              (const, override));
 };
 
 }  // namespace mozc
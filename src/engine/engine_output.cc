@@ -61,6 +61,8 @@ namespace mozc {
 namespace engine {
 namespace {
 
+// Fills the annotation directly in the output message, which may be allocated
+// on the arena of the request. Returns false if there is no annotation.
 bool FillAnnotation(const converter::Candidate& candidate_value,
                     commands::Annotation* annotation) {
   bool is_modified = false;
@@ -104,9 +106,9 @@ void FillCandidateWord(const converter::Candidate& segment_candidate,
   }
   candidate_word_proto->set_value(segment_candidate.value);
 
-  commands::Annotation annotation;
-  if (FillAnnotation(segment_candidate, &annotation)) {
-    *candidate_word_proto->mutable_annotation() = annotation;
+  if (!FillAnnotation(segment_candidate,
+                      candidate_word_proto->mutable_annotation())) {
+    candidate_word_proto->clear_annotation();
   }
 
   if (segment_candidate.attributes & converter::Attribute::USER_DICTIONARY) {
@@ -193,9 +195,8 @@ void FillCandidate(const Segment& segment, const Candidate& candidate,
 
   candidate_proto->set_id(candidate.id());
   // Set annotations
-  commands::Annotation annotation;
-  if (FillAnnotation(candidate_value, &annotation)) {
-    *candidate_proto->mutable_annotation() = annotation;
+  if (!FillAnnotation(candidate_value, candidate_proto->mutable_annotation())) {
+    candidate_proto->clear_annotation();
   }
 
   if (!candidate_value.usage_title.empty()) {
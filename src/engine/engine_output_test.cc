@@ -35,6 +35,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "base/protobuf/arena.h"
 #include "base/text_normalizer.h"
 #include "base/util.h"
 #include "converter/attribute.h"
@@ -125,6 +126,24 @@ TEST(EngineOutputTest, FillCandidate) {
   EXPECT_FALSE(candidate_proto.has_annotation());
 }
 
+TEST(EngineOutputTest, FillCandidateOnArena) {
+  Segment segment;
+  converter::Candidate* segment_candidate = segment.push_back_candidate();
+  segment_candidate->value = "value";
+  segment_candidate->description = "description";
+  Candidate candidate;
+  candidate.set_id(0);
+
+  protobuf::Arena arena;
+  commands::CandidateWindow_Candidate* candidate_proto =
+      protobuf::Arena::Create<commands::CandidateWindow_Candidate>(&arena);
+  output::FillCandidate(segment, candidate, candidate_proto);
+  EXPECT_EQ(candidate_proto->value(), "value");
+  ASSERT_TRUE(candidate_proto->has_annotation());
+  EXPECT_EQ(candidate_proto->annotation().description(), "description");
+  EXPECT_EQ(candidate_proto->annotation().GetArena(), &arena);
+}
+
 TEST(EngineOutputTest, FillCandidateWindow) {
   Segment segment;
   CandidateList candidate_list(true);
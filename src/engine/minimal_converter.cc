@@ -32,11 +32,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/strings/assign.h"
+#include "composer/composer.h"
 #include "converter/attribute.h"
 #include "converter/candidate.h"
 #include "converter/converter_interface.h"
@@ -162,6 +164,10 @@ class MinimalConverter : public ConverterInterface {
   }
 
   void CommitContext(const ConversionRequest& request) const override {}
+
+  void SpeculatePrediction(const ConversionRequest& request,
+                           std::vector<composer::ComposerData> composers,
+                           const Segments& segments) const override {}
 };
 }  // namespace
 
@@ -29,11 +29,13 @@
 
 #include "engine/modules.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <memory>
 #include <utility>
 
+#include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -41,6 +43,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/container/tuple.h"
+#include "base/memory_usage.h"
 #include "converter/connector.h"
 #include "converter/segmenter.h"
 #include "data_manager/data_manager.h"
@@ -58,6 +61,15 @@
 #include "prediction/suggestion_filter.h"
 #include "prediction/user_history_storage.h"
 
+ABSL_FLAG(int32_t, system_dictionary_value_cache_size, 4096,
+          "number of decoded values cached by the system dictionary. "
+          "the cache is shared by all the sessions. 0 disables the cache.");
+ABSL_FLAG(bool, system_dictionary_use_token_blocks, false,
+          "decode the tokens of the system dictionary from the fixed-width "
+          "token blocks if the data set has them.");
+ABSL_FLAG(bool, system_dictionary_use_double_array_key_trie, false,
+          "look up the keys of the system dictionary with the double-array "
+          "trie if the data set has it.");
 
 using ::mozc::dictionary::DictionaryImpl;
 using ::mozc::dictionary::PosGroup;
@@ -107,9 +119,19 @@ absl::Status Modules::Init(std::unique_ptr<const DataManager> data_manager) {
     absl::string_view dictionary_data =
         data_manager_->GetSystemDictionaryData();
 
+    int options = SystemDictionary::NONE;
+    if (absl::GetFlag(FLAGS_system_dictionary_use_token_blocks)) {
+      options |= SystemDictionary::USE_TOKEN_BLOCKS;
+    }
+    if (absl::GetFlag(FLAGS_system_dictionary_use_double_array_key_trie)) {
+      options |= SystemDictionary::USE_DOUBLE_ARRAY_KEY_TRIE;
+    }
     absl::StatusOr<std::unique_ptr<SystemDictionary>> sysdic =
         SystemDictionary::Builder(dictionary_data.data(),
                                   dictionary_data.size())
+            .SetOptions(static_cast<SystemDictionary::Options>(options))
+            .SetValueCacheSize(std::max(
+                0, absl::GetFlag(FLAGS_system_dictionary_value_cache_size)))
             .Build();
     if (!sysdic.ok()) {
       return std::move(sysdic).status();
@@ -161,7 +183,8 @@ absl::Status Modules::Init(std::unique_ptr<const DataManager> data_manager) {
   if (!single_kanji_dictionary_) {
     single_kanji_dictionary_ =
         make_unique_from_tuples<dictionary::SingleKanjiDictionary>(
-            data_manager_->GetSingleKanjiRewriterData());
+            data_manager_->GetSingleKanjiRewriterData(),
+            data_manager_->GetLookupIndexData("single_kanji_noun_prefix"));
     RETURN_IF_NULL(single_kanji_dictionary_);
   }
 
@@ -169,8 +192,11 @@ absl::Status Modules::Init(std::unique_ptr<const DataManager> data_manager) {
   //  zero_query_number_token_array_data, zero_query_number_string_array_data]
   const std::array<absl::string_view, 4> zero_query_data =
       data_manager_->GetZeroQueryData();
-  zero_query_dict_.Init(zero_query_data[0], zero_query_data[1]);
-  zero_query_number_dict_.Init(zero_query_data[2], zero_query_data[3]);
+  zero_query_dict_.Init(zero_query_data[0], zero_query_data[1],
+                        data_manager_->GetLookupIndexData("zero_query"));
+  zero_query_number_dict_.Init(
+      zero_query_data[2], zero_query_data[3],
+      data_manager_->GetLookupIndexData("zero_query_number"));
 
   if (!supplemental_model_) {
     // `g_supplemental_model` is static and initialized only once
@@ -198,6 +224,23 @@ absl::Status Modules::Init(std::unique_ptr<const DataManager> data_manager) {
 #undef RETURN_IF_NULL
 }
 
+void Modules::CollectMemoryUsage(MemoryUsageCollector& collector) const {
+  if (data_manager_) {
+    data_manager_->CollectMemoryUsage(collector);
+  }
+  connector_.CollectMemoryUsage(collector);
+  if (dictionary_) {
+    dictionary_->CollectMemoryUsage(collector);
+  }
+  if (user_dictionary_) {
+    user_dictionary_->CollectMemoryUsage(collector);
+  }
+  if (user_history_storage_) {
+    collector.AddHeap("user_history_storage",
+                      user_history_storage_->GetMemoryUsage());
+  }
+}
+
 ModulesPresetBuilder::ModulesPresetBuilder()
     : modules_(std::make_unique<Modules>()) {}
 
@@ -34,6 +34,7 @@
 
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "base/memory_usage.h"
 #include "converter/connector.h"
 #include "converter/segmenter.h"
 #include "data_manager/data_manager.h"
@@ -121,6 +122,10 @@ class Modules {
     return *supplemental_model_;
   }
 
+  // Reports the memory used by the data set, the dictionaries and the user
+  // history held by these modules.
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const;
+
  private:
   friend class ModulesPresetBuilder;
   // For the constructor.
@@ -30,17 +30,56 @@
 #include "engine/modules.h"
 
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "data_manager/testing/mock_data_manager.h"
 #include "dictionary/dictionary_interface.h"
+#include "dictionary/dictionary_token.h"
 #include "dictionary/dictionary_mock.h"
 #include "dictionary/pos_matcher.h"
 #include "engine/supplemental_model_interface.h"
 #include "testing/gunit.h"
 
+ABSL_DECLARE_FLAG(bool, system_dictionary_use_token_blocks);
+ABSL_DECLARE_FLAG(bool, system_dictionary_use_double_array_key_trie);
+
 namespace mozc {
 namespace engine {
+namespace {
+
+class CollectTokenCallback : public dictionary::DictionaryInterface::Callback {
+ public:
+  ResultType OnToken(absl::string_view key, absl::string_view actual_key,
+                     const dictionary::Token& token) override {
+    tokens_.push_back(absl::StrCat(token.key, "\t", token.value, "\t",
+                                   token.lid, "\t", token.rid, "\t",
+                                   token.cost));
+    return TRAVERSE_CONTINUE;
+  }
+
+  const std::vector<std::string>& tokens() const { return tokens_; }
+
+ private:
+  std::vector<std::string> tokens_;
+};
+
+std::vector<std::string> LookupAll(const Modules& modules) {
+  const dictionary::DictionaryInterface& dictionary = modules.GetDictionary();
+  CollectTokenCallback callback;
+  dictionary.LookupPredictive("あい", &callback);
+  dictionary.LookupPrefix("あいうえお", &callback);
+  dictionary.LookupExact("あい", &callback);
+  return callback.tokens();
+}
+
+}  // namespace
 
 TEST(ModulesTest, CreateTest) {
   std::unique_ptr<const engine::Modules> modules =
@@ -124,5 +163,21 @@ TEST(ModulesTest, SupplementalModelTest) {
             &modules4->GetSupplementalModel());
 }
 
+TEST(ModulesTest, SystemDictionaryOptionsTest) {
+  absl::FlagSaver flag_saver;
+  std::unique_ptr<Modules> modules =
+      Modules::Create(std::make_unique<testing::MockDataManager>()).value();
+  const std::vector<std::string> expected = LookupAll(*modules);
+  ASSERT_FALSE(expected.empty());
+
+  // The test data set has both the token blocks and the double-array key
+  // trie, and the lookups return the same tokens with them.
+  absl::SetFlag(&FLAGS_system_dictionary_use_token_blocks, true);
+  absl::SetFlag(&FLAGS_system_dictionary_use_double_array_key_trie, true);
+  modules =
+      Modules::Create(std::make_unique<testing::MockDataManager>()).value();
+  EXPECT_EQ(LookupAll(*modules), expected);
+}
+
 }  // namespace engine
 }  // namespace mozc
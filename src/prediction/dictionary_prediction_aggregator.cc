@@ -51,6 +51,7 @@
 #include "base/japanese_util.h"
 #include "base/number_util.h"
 #include "base/strings/unicode.h"
+#include "base/trace.h"
 #include "base/util.h"
 #include "composer/query.h"
 #include "config/character_form_manager.h"
@@ -521,6 +522,9 @@ std::vector<Result> DictionaryPredictionAggregator::AggregateResultsForDesktop(
 std::vector<Result> DictionaryPredictionAggregator::
     AggregateTypingCorrectedResultsForMixedConversion(
         const ConversionRequest& request) const {
+  MOZC_TRACE_SPAN(
+      "DictionaryPredictionAggregator::"
+      "AggregateTypingCorrectedResultsForMixedConversion");
   const std::optional<std::vector<TypeCorrectedQuery>> corrected =
       modules_.GetSupplementalModel().CorrectComposition(request);
   if (!corrected) {
@@ -604,6 +608,7 @@ std::vector<Result> DictionaryPredictionAggregator::
 void DictionaryPredictionAggregator::AggregateUnigram(
     const ConversionRequest& request, std::vector<Result>* results,
     int* min_unigram_key_len) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregateUnigram");
   DCHECK(results);
   DCHECK(min_unigram_key_len);
   *min_unigram_key_len = 0;
@@ -658,6 +663,7 @@ void DictionaryPredictionAggregator::AggregateUnigram(
 
 void DictionaryPredictionAggregator::AggregateZeroQuery(
     const ConversionRequest& request, std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregateZeroQuery");
   DCHECK(results);
 
   // There are 4 sources in zero query suggestion.
@@ -730,6 +736,7 @@ void DictionaryPredictionAggregator::AggregateRealtime(
     const ConversionRequest& request, size_t realtime_candidates_size,
     bool insert_realtime_top_from_actual_converter,
     std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregateRealtime");
   DCHECK(results);
 
   ConversionRequest::Options options = request.options();
@@ -849,6 +856,7 @@ void DictionaryPredictionAggregator::AggregateUnigramForMixedConversion(
 
 void DictionaryPredictionAggregator::AggregateBigram(
     const ConversionRequest& request, std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregateBigram");
   DCHECK(results);
 
   // Disables bigram zero query just in case.
@@ -914,6 +922,7 @@ bool DictionaryPredictionAggregator::AggregateNumberZeroQuery(
 
 void DictionaryPredictionAggregator::AggregateEnglish(
     const ConversionRequest& request, std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregateEnglish");
   DCHECK(results);
 
   const ResultsSizeAdjuster adjuster(request, results);
@@ -927,6 +936,8 @@ void DictionaryPredictionAggregator::AggregateEnglish(
 
 void DictionaryPredictionAggregator::AggregateEnglishUsingRawInput(
     const ConversionRequest& request, std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN(
+      "DictionaryPredictionAggregator::AggregateEnglishUsingRawInput");
   DCHECK(results);
 
   const ResultsSizeAdjuster adjuster(request, results);
@@ -940,6 +951,7 @@ void DictionaryPredictionAggregator::AggregateEnglishUsingRawInput(
 
 void DictionaryPredictionAggregator::AggregateNumber(
     const ConversionRequest& request, std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregateNumber");
   DCHECK(results);
   std::vector<Result> number_results =
       NumberDecoder(modules_.GetPosMatcher()).Decode(request);
@@ -948,6 +960,7 @@ void DictionaryPredictionAggregator::AggregateNumber(
 
 void DictionaryPredictionAggregator::AggregatePrefix(
     const ConversionRequest& request, std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregatePrefix");
   DCHECK(results);
 
   absl::string_view request_key = request.key();
@@ -1008,6 +1021,7 @@ void DictionaryPredictionAggregator::AggregatePrefix(
 
 void DictionaryPredictionAggregator::AggregateSingleKanji(
     const ConversionRequest& request, std::vector<Result>* results) const {
+  MOZC_TRACE_SPAN("DictionaryPredictionAggregator::AggregateSingleKanji");
   DCHECK(results);
 
   const std::vector<Result> single_kaji_results =
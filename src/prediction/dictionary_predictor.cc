@@ -48,6 +48,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/trace.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "composer/composer.h"
@@ -155,6 +156,7 @@ DictionaryPredictor::DictionaryPredictor(
 
 std::vector<Result> DictionaryPredictor::Predict(
     const ConversionRequest& request) const {
+  MOZC_TRACE_SPAN("DictionaryPredictor::Predict");
   if (request.request_type() == ConversionRequest::CONVERSION) {
     MOZC_VLOG(2) << "request type is CONVERSION";
     return {};
@@ -166,10 +168,14 @@ std::vector<Result> DictionaryPredictor::Predict(
   if (IsMixedConversionEnabled(request)) {
     std::vector<Result> literal_results =
         aggregator_->AggregateResultsForMixedConversion(request);
-    std::vector<Result> tc_results =
-        AggregateTypingCorrectedResultsForMixedConversion(request);
     absl::c_move(literal_results, std::back_inserter(results));
-    absl::c_move(tc_results, std::back_inserter(results));
+    // Typing correction is optional, so it is skipped once the deadline has
+    // passed.
+    if (!request.IsDeadlineExceeded()) {
+      std::vector<Result> tc_results =
+          AggregateTypingCorrectedResultsForMixedConversion(request);
+      absl::c_move(tc_results, std::back_inserter(results));
+    }
   } else {
     results = aggregator_->AggregateResultsForDesktop(request);
   }
@@ -46,7 +46,9 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "base/clock.h"
 #include "base/strings/assign.h"
 #include "base/util.h"
 #include "composer/composer.h"
@@ -1431,6 +1433,44 @@ TEST_F(DictionaryPredictorTest, AggregateTypingCorrectedResultsTest) {
   }
 }
 
+TEST_F(DictionaryPredictorTest, SkipTypingCorrectionAfterDeadline) {
+  auto data_and_predictor = std::make_unique<MockDataAndPredictor>();
+  const DictionaryPredictor& predictor = data_and_predictor->predictor();
+  MockAggregator* aggregator = data_and_predictor->mutable_aggregator();
+  EXPECT_CALL(*aggregator, AggregateResultsForMixedConversion(_))
+      .WillRepeatedly(Return(std::vector<Result>{
+          CreateResult5("とあきよう", "とあきよう", 500, prediction::UNIGRAM,
+                        Token::NONE),
+      }));
+  // Called only for the request without a deadline.
+  EXPECT_CALL(*aggregator, AggregateTypingCorrectedResultsForMixedConversion(_))
+      .WillOnce(Return(std::vector<Result>{
+          CreateResult7("とうきょう", "東京", 100, 0,
+                        prediction::UNIGRAM | prediction::TYPING_CORRECTION,
+                        Token::NONE, 0.8),
+      }));
+
+  request_test_util::FillMobileRequest(request_.get());
+  config_->set_use_typing_correction(true);
+
+  {
+    ConversionRequest::Options options;
+    options.request_type = ConversionRequest::PREDICTION;
+    const ConversionRequest convreq =
+        CreateConversionRequestWithOptions(std::move(options), "とあきよう");
+    predictor.Predict(convreq);
+  }
+  {
+    ConversionRequest::Options options;
+    options.request_type = ConversionRequest::PREDICTION;
+    options.deadline = Clock::GetAbslTime() - absl::Seconds(1);
+    const ConversionRequest convreq =
+        CreateConversionRequestWithOptions(std::move(options), "とあきよう");
+    const std::vector<Result> results = predictor.Predict(convreq);
+    EXPECT_FALSE(FindCandidateByValue(results, "東京"));
+  }
+}
+
 TEST_F(DictionaryPredictorTest, Rescoring) {
   auto supplemental_model = std::make_unique<engine::MockSupplementalModel>();
   EXPECT_CALL(*supplemental_model, RescoreResults(_, _))
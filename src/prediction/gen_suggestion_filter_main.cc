@@ -58,6 +58,7 @@ ABSL_FLAG(std::string, safe_list_files, "",
 namespace {
 using ::mozc::storage::ExistenceFilter;
 using ::mozc::storage::ExistenceFilterBuilder;
+using ::mozc::storage::ExistenceFilterParams;
 
 std::vector<std::string> ReadWords(const std::string& name) {
   std::string line;
@@ -98,8 +99,9 @@ ExistenceFilterBuilder GetFilter(const size_t num_bytes,
                                  absl::Span<const std::string> word_list) {
   LOG(INFO) << "num_bytes: " << num_bytes;
 
-  ExistenceFilterBuilder filter(
-      ExistenceFilterBuilder::CreateOptimal(num_bytes, word_list.size()));
+  ExistenceFilterBuilder filter(ExistenceFilterBuilder::CreateOptimal(
+      num_bytes, word_list.size(), ExistenceFilterParams::kDefaultFpType,
+      ExistenceFilterParams::BLOCKED));
   for (absl::string_view word : word_list) {
     filter.Insert(word);
   }
@@ -123,7 +125,8 @@ ExistenceFilterBuilder SetupFilter(
     const size_t num_bytes, absl::Span<const std::string> word_list,
     absl::Span<const std::string> safe_word_list) {
   constexpr int kNumRetryMax = 10;
-  constexpr int kSizeOffset = 8;
+  // Keeps the size a multiple of the 64-byte block of the blocked layout.
+  constexpr int kSizeOffset = 64;
   // Prevent filtering of common words by false positive.
   for (int i = 0; i < kNumRetryMax; ++i) {
     ExistenceFilterBuilder filter =
@@ -155,10 +158,10 @@ int main(int argc, char** argv) {
   LOG(INFO) << word_list.size() << " words found";
 
   static constexpr float kErrorRate = 0.00001;
-  const size_t num_bytes =
-      std::max(ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
-                   kErrorRate, word_list.size()),
-               kMinimumFilterBytes);
+  const size_t num_bytes = std::max(
+      ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
+          kErrorRate, word_list.size(), ExistenceFilterParams::BLOCKED),
+      kMinimumFilterBytes);
 
   const std::vector<std::string> safe_word_list =
       ReadSafeWords(absl::GetFlag(FLAGS_safe_list_files));
@@ -265,6 +265,11 @@ def ParseOptions() -> argparse.Namespace:
       dest='output_string_array',
       help='output string array file',
   )
+  parser.add_argument(
+      '--output_index',
+      dest='output_index',
+      help='output perfect hash index file (optional)',
+  )
   return parser.parse_args()
 
 
@@ -294,6 +299,7 @@ def main():
       merged_zero_query_dict,
       options.output_token_array,
       options.output_string_array,
+      options.output_index,
   )
 
   if options.output_tsv:
@@ -73,6 +73,11 @@ def ParseOption():
       dest='output_string_array',
       help='Output string array file path',
   )
+  parser.add_option(
+      '--output_index',
+      dest='output_index',
+      help='Output perfect hash index file path (optional)',
+  )
   return parser.parse_args()[0]
 
 
@@ -81,7 +86,10 @@ def main():
   with codecs.open(options.input, 'r', encoding='utf-8') as input_stream:
     zero_query_dict = ReadZeroQueryNumberData(input_stream)
   util.WriteZeroQueryData(
-      zero_query_dict, options.output_token_array, options.output_string_array
+      zero_query_dict,
+      options.output_token_array,
+      options.output_string_array,
+      options.output_index,
   )
 
 
@@ -35,6 +35,7 @@ For output format, see zero_query_dict.h.
 
 import struct
 
+from build_tools import perfect_hash_index_builder
 from build_tools import serialized_string_array_builder
 
 
@@ -52,7 +53,7 @@ class ZeroQueryEntry(object):
 
 
 def WriteZeroQueryData(
-    zero_query_dict, output_token_array, output_string_array
+    zero_query_dict, output_token_array, output_string_array, output_index=None
 ):
   # Collect all the strings and assign index in ascending order
   string_index = {}
@@ -76,3 +77,10 @@ def WriteZeroQueryData(
   serialized_string_array_builder.SerializeToFile(
       sorted_strings, output_string_array
   )
+
+  if output_index:
+    # Keys of the token array, one per entry, for PerfectHashIndex.
+    keys = []
+    for key in sorted(zero_query_dict):
+      keys.extend([key] * len(zero_query_dict[key]))
+    perfect_hash_index_builder.BuildToFile(keys, output_index)
@@ -41,6 +41,7 @@
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/memory_usage.h"
 #include "base/util.h"
 #include "converter/attribute.h"
 #include "converter/converter_interface.h"
@@ -185,6 +186,15 @@ bool Predictor::Sync() { return user_history_predictor_->Sync(); }
 
 bool Predictor::Reload() { return user_history_predictor_->Reload(); }
 
+void Predictor::CollectMemoryUsage(MemoryUsageCollector& collector) const {
+  if (realtime_decoder_) {
+    collector.AddHeap("prediction.realtime_decoder.suffix_cache",
+                      realtime_decoder_->GetMemoryUsage());
+  }
+  dictionary_predictor_->CollectMemoryUsage(collector);
+  user_history_predictor_->CollectMemoryUsage(collector);
+}
+
 std::vector<Result> Predictor::PredictForDesktop(
     const ConversionRequest& request) const {
   DCHECK(!IsMixedConversionEnabled(request));
@@ -96,6 +96,8 @@ class Predictor : public PredictorInterface {
   // Waits for syncer to complete.
   bool Wait() override;
 
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
+
  private:
   friend class PredictorTestPeer;
 
@@ -35,6 +35,7 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/memory_usage.h"
 #include "prediction/result.h"
 #include "request/conversion_request.h"
 
@@ -98,6 +99,9 @@ class PredictorInterface {
   // Waits for syncer thread to complete.
   virtual bool Wait() { return true; }
 
+  // Reports the memory used by the caches and the history of this predictor.
+  virtual void CollectMemoryUsage(MemoryUsageCollector& collector) const {}
+
   virtual absl::string_view GetPredictorName() const = 0;
 };
 
@@ -142,6 +142,7 @@ bool RealtimeDecoder::PushBackTopConversionResult(
   options.create_partial_candidates = false;
   options.used_in_predictor_realtime_conversion = true;
   options.request_type = ConversionRequest::CONVERSION;
+  options.deadline = request.options().deadline;
   const ConversionRequest tmp_request = ConversionRequestBuilder()
                                             .SetConversionRequestView(request)
                                             .SetOptions(std::move(options))
@@ -202,6 +203,10 @@ std::vector<Result> RealtimeDecoder::Decode(
     if (!PushBackTopConversionResult(request_for_realtime, &results)) {
       LOG(WARNING) << "Realtime conversion with converter failed";
     }
+    // The top result is good enough when the deadline has already passed.
+    if (!results.empty() && request.IsDeadlineExceeded()) {
+      return results;
+    }
   }
 
   // non-CONVERSION request returns concatenated single segment.
@@ -74,6 +74,9 @@ class RealtimeDecoder {
                                              uint16_t prefix_rid,
                                              absl::string_view suffix) const;
 
+  // Returns the approximate heap size of the suffix cache.
+  size_t GetMemoryUsage() const { return suffix_cache_.GetMemoryUsage(); }
+
  private:
   bool PushBackTopConversionResult(const ConversionRequest& request,
                                    std::vector<Result>* results) const;
@@ -37,6 +37,8 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/clock.h"
 #include "converter/attribute.h"
 #include "converter/converter_mock.h"
 #include "converter/immutable_converter_interface.h"
@@ -210,6 +212,46 @@ TEST(RealtimeDecoderTest, Decode) {
   }
 }
 
+TEST(RealtimeDecoderTest, DecodeStopsAtDeadline) {
+  MockConverter converter;
+  MockImmutableConverter immutable_converter;
+
+  const RealtimeDecoder decoder(immutable_converter, converter);
+
+  constexpr absl::string_view kKey = "わたしのなまえはなかのです";
+  {
+    Segments segments;
+    Segment* segment = segments.add_segment();
+    segment->set_key(kKey);
+    converter::Candidate* candidate = segment->add_candidate();
+    candidate->key = kKey;
+    candidate->value = "私の名前は中野です";
+    EXPECT_CALL(converter, StartConversion(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(segments), Return(true)));
+  }
+  // The extra results from the immutable converter are skipped.
+  EXPECT_CALL(immutable_converter, Convert(_, _)).Times(0);
+
+  Segments segments;
+  Segment* seg = segments.add_segment();
+  seg->set_key(kKey);
+  seg->set_segment_type(Segment::FREE);
+
+  ConversionRequest::Options options;
+  options.max_conversion_candidates_size = 10;
+  options.use_actual_converter_for_realtime_conversion = true;
+  options.request_type = ConversionRequest::PREDICTION;
+  options.deadline = Clock::GetAbslTime() - absl::Seconds(1);
+
+  const ConversionRequest convreq =
+      ConversionRequestBuilder().SetOptions(std::move(options)).Build();
+  ASSERT_TRUE(convreq.IsDeadlineExceeded());
+  const std::vector<Result> results = decoder.Decode(convreq);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].value, "私の名前は中野です");
+  EXPECT_TRUE(results[0].attributes & Attribute::REALTIME_TOP);
+}
+
 TEST(RealtimeDecoderTest, DecodeSuffix) {
   MockConverter converter;
   MockImmutableConverter immutable_converter;
@@ -0,0 +1,322 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "prediction/speculative_predictor.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "base/clock.h"
+#include "base/hash.h"
+#include "base/memory_usage.h"
+#include "base/thread.h"
+#include "base/vlog.h"
+#include "composer/composer.h"
+#include "prediction/predictor_interface.h"
+#include "prediction/result.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+#include "request/conversion_request.h"
+
+namespace mozc::prediction {
+namespace {
+
+constexpr absl::string_view kDelimiter = "\t";
+
+void AppendOptions(const ConversionRequest::Options& options,
+                   std::string* str) {
+  // The deadline is not included as it differs for every request.
+  absl::StrAppend(
+      str, static_cast<int>(options.request_type), kDelimiter,
+      static_cast<int>(options.composer_key_selection), kDelimiter,
+      options.max_conversion_candidates_size, kDelimiter,
+      options.max_user_history_prediction_candidates_size, kDelimiter,
+      options.max_user_history_prediction_candidates_size_for_zero_query,
+      kDelimiter, options.max_dictionary_prediction_candidates_size,
+      kDelimiter);
+  absl::StrAppend(
+      str, options.use_actual_converter_for_realtime_conversion,
+      options.skip_slow_rewriters, options.create_partial_candidates,
+      options.enable_user_history_for_conversion,
+      options.kana_modifier_insensitive_conversion,
+      options.use_already_typing_corrected_key,
+      static_cast<int>(options.input_mode), options.use_spelling_correction,
+      options.use_zip_code_conversion, options.use_t13n_conversion,
+      options.incognito_mode, options.disable_prefix_penalty,
+      options.used_in_predictor_realtime_conversion, kDelimiter,
+      options.bos_id, kDelimiter);
+}
+
+}  // namespace
+
+SpeculativePredictor::SpeculativePredictor(
+    std::unique_ptr<PredictorInterface> predictor)
+    : predictor_(std::move(predictor)) {
+  DCHECK(predictor_);
+}
+
+SpeculativePredictor::~SpeculativePredictor() { StopSpeculation(); }
+
+std::vector<Result> SpeculativePredictor::Predict(
+    const ConversionRequest& request) const {
+  if (!IsSpeculationEnabled(request)) {
+    return predictor_->Predict(request);
+  }
+
+  // The remaining speculative requests are for the inputs which the user
+  // didn't type.
+  cancelled_.store(true);
+
+  const uint64_t fingerprint = GetFingerprint(request);
+  if (std::optional<std::vector<Result>> results = LookupCache(fingerprint)) {
+    MOZC_VLOG(2) << "Speculative prediction hit: " << request.key();
+    return *std::move(results);
+  }
+
+  // The wrapped predictor is not thread-safe. Waits for the speculative
+  // request being computed, which may also be the one for `request`.
+  StopSpeculation();
+  if (std::optional<std::vector<Result>> results = LookupCache(fingerprint)) {
+    MOZC_VLOG(2) << "Speculative prediction hit after wait: " << request.key();
+    return *std::move(results);
+  }
+  return predictor_->Predict(request);
+}
+
+std::vector<Result> SpeculativePredictor::Convert(
+    const ConversionRequest& request) const {
+  StopSpeculation();
+  return predictor_->Convert(request);
+}
+
+std::optional<std::vector<Result>> SpeculativePredictor::LookupCache(
+    uint64_t fingerprint) const {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& [cached_fingerprint, results] : cache_) {
+    if (cached_fingerprint == fingerprint) {
+      return results;
+    }
+  }
+  return std::nullopt;
+}
+
+void SpeculativePredictor::Speculate(
+    const ConversionRequest& request,
+    std::vector<composer::ComposerData> composers) const {
+  if (composers.empty() || !IsSpeculationEnabled(request)) {
+    return;
+  }
+
+  absl::MutexLock lock(&worker_mutex_);
+  if (worker_.has_value() && !worker_->Ready()) {
+    // Never waits for the previous worker not to block the caller.
+    MOZC_VLOG(2) << "Previous speculation is still running.";
+    return;
+  }
+
+  SpeculationBase base = {
+      .request = request.request(),
+      .context = request.context(),
+      .config = request.config(),
+      .history_result = request.history_result(),
+      .options = request.options(),
+  };
+  base.options.deadline = Clock::GetAbslTime() + kSpeculationBudget;
+
+  cancelled_.store(false);
+  worker_.emplace([this, base = std::move(base),
+                   composers = std::move(composers)]() mutable {
+    RunSpeculation(base, std::move(composers));
+  });
+}
+
+void SpeculativePredictor::RunSpeculation(
+    const SpeculationBase& base,
+    std::vector<composer::ComposerData> composers) const {
+  for (composer::ComposerData& composer : composers) {
+    if (cancelled_.load()) {
+      return;
+    }
+    const ConversionRequest request =
+        ConversionRequestBuilder()
+            .SetComposerData(std::move(composer))
+            .SetRequestView(base.request)
+            .SetContextView(base.context)
+            .SetConfigView(base.config)
+            .SetHistoryResultView(base.history_result)
+            .SetOptions(base.options)
+            .Build();
+    std::vector<Result> results = predictor_->Predict(request);
+    if (request.IsDeadlineExceeded()) {
+      // The results may be partial, and the budget is spent anyway.
+      MOZC_VLOG(2) << "Speculation budget is exceeded: " << request.key();
+      return;
+    }
+
+    const uint64_t fingerprint = GetFingerprint(request);
+    absl::MutexLock lock(&mutex_);
+    if (cache_.size() >= kMaxCacheSize) {
+      cache_.pop_front();
+    }
+    cache_.emplace_back(fingerprint, std::move(results));
+  }
+}
+
+void SpeculativePredictor::WaitForSpeculation() const {
+  absl::MutexLock lock(&worker_mutex_);
+  if (worker_.has_value()) {
+    worker_->Wait();
+  }
+}
+
+void SpeculativePredictor::StopSpeculation() const {
+  cancelled_.store(true);
+  WaitForSpeculation();
+}
+
+void SpeculativePredictor::Invalidate() const {
+  StopSpeculation();
+  absl::MutexLock lock(&mutex_);
+  cache_.clear();
+}
+
+void SpeculativePredictor::Finish(const ConversionRequest& request,
+                                  absl::Span<const Result> results,
+                                  uint32_t revert_id) {
+  Invalidate();
+  predictor_->Finish(request, results, revert_id);
+}
+
+void SpeculativePredictor::Revert(uint32_t revert_id) {
+  Invalidate();
+  predictor_->Revert(revert_id);
+}
+
+void SpeculativePredictor::CommitContext(
+    const ConversionRequest& request) const {
+  Invalidate();
+  predictor_->CommitContext(request);
+}
+
+bool SpeculativePredictor::ClearAllHistory() {
+  Invalidate();
+  return predictor_->ClearAllHistory();
+}
+
+bool SpeculativePredictor::ClearUnusedHistory() {
+  Invalidate();
+  return predictor_->ClearUnusedHistory();
+}
+
+bool SpeculativePredictor::ClearHistoryEntry(const absl::string_view key,
+                                             const absl::string_view value) {
+  Invalidate();
+  return predictor_->ClearHistoryEntry(key, value);
+}
+
+bool SpeculativePredictor::AddHistoryEntry(const absl::string_view key,
+                                           const absl::string_view value) {
+  Invalidate();
+  return predictor_->AddHistoryEntry(key, value);
+}
+
+bool SpeculativePredictor::Reload() {
+  Invalidate();
+  return predictor_->Reload();
+}
+
+void SpeculativePredictor::CollectMemoryUsage(
+    MemoryUsageCollector& collector) const {
+  size_t bytes = 0;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const auto& [fp, results] : cache_) {
+      bytes += sizeof(fp) + GetHeapBytes(results);
+      for (const Result& result : results) {
+        bytes += GetHeapBytes(result.key) + GetHeapBytes(result.value);
+      }
+    }
+  }
+  collector.AddHeap("prediction.speculative.cache", bytes);
+  predictor_->CollectMemoryUsage(collector);
+}
+
+// static
+bool SpeculativePredictor::IsSpeculationEnabled(
+    const ConversionRequest& request) {
+  // DictionaryPredictor keeps the previous top result for the candidate
+  // consistency, so its results depend on the previous request as well.
+  return request.request().enable_speculative_prediction() &&
+         request.request()
+                 .decoder_experiment_params()
+                 .candidate_consistency_cost_max_diff() == 0 &&
+         (request.request_type() == ConversionRequest::SUGGESTION ||
+          request.request_type() == ConversionRequest::PREDICTION) &&
+         request.composer().GetHandwritingCompositions().empty();
+}
+
+// static
+uint64_t SpeculativePredictor::GetFingerprint(
+    const ConversionRequest& request) {
+  const composer::ComposerData& composer = request.composer();
+  const auto [base_query, expanded] = composer.GetQueriesForPrediction();
+  std::string str = absl::StrCat(
+      request.key(), kDelimiter, composer.GetRawString(), kDelimiter,
+      composer.GetStringForPreedit(), kDelimiter, base_query, kDelimiter,
+      absl::StrJoin(expanded, ","), kDelimiter,
+      composer.GetStringForTypeCorrection(), kDelimiter, composer.GetCursor(),
+      kDelimiter, static_cast<int>(composer.GetInputMode()), kDelimiter,
+      composer.source_text(), kDelimiter);
+
+  const Result& history = request.history_result();
+  absl::StrAppend(&str, history.key, kDelimiter, history.value, kDelimiter,
+                  history.lid, kDelimiter, history.rid, kDelimiter,
+                  history.cost, kDelimiter,
+                  absl::StrJoin(history.inner_segment_boundary, ","),
+                  kDelimiter);
+
+  AppendOptions(request.options(), &str);
+  absl::StrAppend(&str, request.request().SerializeAsString(), kDelimiter,
+                  request.context().SerializeAsString(), kDelimiter,
+                  request.config().SerializeAsString());
+  return CityFingerprint(str);
+}
+
+}  // namespace mozc::prediction
@@ -0,0 +1,166 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_PREDICTION_SPECULATIVE_PREDICTOR_H_
+#define MOZC_PREDICTION_SPECULATIVE_PREDICTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/thread.h"
+#include "composer/composer.h"
+#include "prediction/predictor_interface.h"
+#include "prediction/result.h"
+#include "request/conversion_request.h"
+
+namespace mozc::prediction {
+
+// Wraps a predictor and answers the requests from the results computed in
+// background while the user is between keystrokes.
+//
+// After answering a key event, the caller passes the compositions expected
+// for the likely next key events to Speculate(). A background worker computes
+// their results one by one and stores them in a small cache keyed by the
+// fingerprint of the request. Predict() returns the cached results when the
+// fingerprint matches, and falls back to the wrapped predictor otherwise.
+//
+// Speculation doesn't delay the real requests much: Predict() cancels the
+// remaining speculative work, Speculate() does nothing while the previous
+// worker is still running, and every speculative request has a deadline. As
+// the wrapped predictor is not thread-safe, Predict() and Convert() wait for
+// the speculative request being computed before calling it. Any operation
+// that changes the history stops the worker and clears the cache.
+//
+// This is enabled by Request.enable_speculative_prediction. Otherwise all the
+// calls are delegated to the wrapped predictor.
+class SpeculativePredictor : public PredictorInterface {
+ public:
+  // The number of the results cached.
+  static constexpr size_t kMaxCacheSize = 8;
+
+  // The time given to compute all the speculative requests passed to a single
+  // Speculate() call.
+  static constexpr absl::Duration kSpeculationBudget = absl::Milliseconds(100);
+
+  explicit SpeculativePredictor(std::unique_ptr<PredictorInterface> predictor);
+
+  SpeculativePredictor(const SpeculativePredictor&) = delete;
+  SpeculativePredictor& operator=(const SpeculativePredictor&) = delete;
+
+  ~SpeculativePredictor() override;
+
+  std::vector<Result> Predict(const ConversionRequest& request) const override;
+
+  std::vector<Result> Convert(const ConversionRequest& request) const override;
+
+  void Finish(const ConversionRequest& request,
+              absl::Span<const Result> results, uint32_t revert_id) override;
+  void Revert(uint32_t revert_id) override;
+  void CommitContext(const ConversionRequest& request) const override;
+  bool ClearAllHistory() override;
+  bool ClearUnusedHistory() override;
+  bool ClearHistoryEntry(absl::string_view key,
+                         absl::string_view value) override;
+  bool AddHistoryEntry(absl::string_view key, absl::string_view value) override;
+  bool Sync() override { return predictor_->Sync(); }
+  bool Reload() override;
+  bool Wait() override { return predictor_->Wait(); }
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
+
+  absl::string_view GetPredictorName() const override {
+    return predictor_->GetPredictorName();
+  }
+
+  // Starts computing the results for `request` with its composition replaced
+  // by each of `composers` in background. `request` is copied, so it doesn't
+  // need to outlive this call.
+  void Speculate(const ConversionRequest& request,
+                 std::vector<composer::ComposerData> composers) const;
+
+  // Blocks until the background worker finishes. For testing.
+  void WaitForSpeculation() const;
+
+  // Cancels the remaining speculative requests and waits for the one being
+  // computed. The wrapped predictor is not used from another thread after this
+  // call until the next Speculate().
+  void StopSpeculation() const;
+
+  // Returns true if `request` can be answered from the speculative results.
+  static bool IsSpeculationEnabled(const ConversionRequest& request);
+
+  // Returns the fingerprint of all the inputs of the prediction, i.e. the
+  // composition, the history, the options except for the deadline, and the
+  // request, context and config protos.
+  static uint64_t GetFingerprint(const ConversionRequest& request);
+
+ private:
+  // Owned copy of the part of the request shared by the speculative requests.
+  struct SpeculationBase {
+    commands::Request request;
+    commands::Context context;
+    config::Config config;
+    Result history_result;
+    ConversionRequest::Options options;
+  };
+
+  void RunSpeculation(const SpeculationBase& base,
+                      std::vector<composer::ComposerData> composers) const;
+
+  std::optional<std::vector<Result>> LookupCache(uint64_t fingerprint) const;
+
+  // Stops the worker and clears the cache.
+  void Invalidate() const;
+
+  std::unique_ptr<PredictorInterface> predictor_;
+
+  mutable absl::Mutex mutex_;
+  mutable std::deque<std::pair<uint64_t, std::vector<Result>>> cache_
+      ABSL_GUARDED_BY(mutex_);
+
+  mutable std::atomic<bool> cancelled_ = false;
+  mutable absl::Mutex worker_mutex_;
+  mutable std::optional<BackgroundFuture<void>> worker_
+      ABSL_GUARDED_BY(worker_mutex_);
+};
+
+}  // namespace mozc::prediction
+
+#endif  // MOZC_PREDICTION_SPECULATIVE_PREDICTOR_H_
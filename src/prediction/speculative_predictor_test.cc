@@ -0,0 +1,227 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "prediction/speculative_predictor.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "composer/composer.h"
+#include "composer/table.h"
+#include "config/config_handler.h"
+#include "prediction/predictor_interface.h"
+#include "prediction/result.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+#include "request/conversion_request.h"
+#include "testing/gunit.h"
+
+namespace mozc::prediction {
+namespace {
+
+// Returns the key as the only result and counts the calls. Each call takes
+// `delay`, and the calls overlapping with another are detected.
+class CountingPredictor : public PredictorInterface {
+ public:
+  explicit CountingPredictor(std::atomic<int>* count,
+                             absl::Duration delay = absl::ZeroDuration())
+      : count_(count), delay_(delay) {}
+
+  std::vector<Result> Predict(const ConversionRequest& request) const override {
+    ++*count_;
+    if (in_flight_.fetch_add(1) > 0) {
+      overlapped_ = true;
+    }
+    absl::SleepFor(delay_);
+    in_flight_.fetch_sub(1);
+    Result result;
+    result.key = request.key();
+    result.value = request.key();
+    return {result};
+  }
+
+  absl::string_view GetPredictorName() const override {
+    return "CountingPredictor";
+  }
+
+  bool overlapped() const { return overlapped_; }
+
+ private:
+  std::atomic<int>* count_;
+  const absl::Duration delay_;
+  mutable std::atomic<int> in_flight_ = 0;
+  mutable std::atomic<bool> overlapped_ = false;
+};
+
+class SpeculativePredictorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    request_.set_enable_speculative_prediction(true);
+    config::ConfigHandler::GetDefaultConfig(&config_);
+    auto table = std::make_shared<composer::Table>();
+    table->AddRule("ka", "か", "");
+    table->AddRule("ki", "き", "");
+    table->AddRule("ku", "く", "");
+    composer_ = composer::Composer(table, request_, config_);
+    predictor_ = std::make_unique<SpeculativePredictor>(
+        std::make_unique<CountingPredictor>(&count_));
+  }
+
+  ConversionRequest CreateRequest(const composer::Composer& composer) const {
+    ConversionRequest::Options options;
+    options.request_type = ConversionRequest::SUGGESTION;
+    return ConversionRequestBuilder()
+        .SetComposer(composer)
+        .SetRequestView(request_)
+        .SetConfigView(config_)
+        .SetOptions(std::move(options))
+        .Build();
+  }
+
+  // Returns the compositions after each of the next inputs.
+  std::vector<composer::ComposerData> CreateNextComposers() const {
+    std::vector<composer::ComposerData> composers;
+    for (std::string input : composer_.GetNextInputsForPrediction()) {
+      composer::Composer next_composer = composer_;
+      next_composer.InsertCharacter(std::move(input));
+      composers.push_back(next_composer.CreateComposerData());
+    }
+    return composers;
+  }
+
+  commands::Request request_;
+  config::Config config_;
+  composer::Composer composer_;
+  std::atomic<int> count_ = 0;
+  std::unique_ptr<SpeculativePredictor> predictor_;
+};
+
+TEST_F(SpeculativePredictorTest, AnswerFromSpeculation) {
+  composer_.InsertCharacter("k");
+  predictor_->Speculate(CreateRequest(composer_), CreateNextComposers());
+  predictor_->WaitForSpeculation();
+  EXPECT_EQ(count_, 3);
+
+  composer_.InsertCharacter("i");
+  const std::vector<Result> results =
+      predictor_->Predict(CreateRequest(composer_));
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].value, "き");
+  EXPECT_EQ(count_, 3);
+}
+
+TEST_F(SpeculativePredictorTest, FallBackOnMismatch) {
+  composer_.InsertCharacter("k");
+  predictor_->Speculate(CreateRequest(composer_), CreateNextComposers());
+  predictor_->WaitForSpeculation();
+  EXPECT_EQ(count_, 3);
+
+  // The history is also a part of the fingerprint.
+  composer_.InsertCharacter("a");
+  Result history;
+  history.key = "あ";
+  history.value = "亜";
+  const ConversionRequest request =
+      ConversionRequestBuilder()
+          .SetConversionRequest(CreateRequest(composer_))
+          .SetHistoryResultView(history)
+          .Build();
+  EXPECT_EQ(predictor_->Predict(request).size(), 1);
+  EXPECT_EQ(count_, 4);
+}
+
+TEST_F(SpeculativePredictorTest, InvalidateOnFinish) {
+  composer_.InsertCharacter("k");
+  predictor_->Speculate(CreateRequest(composer_), CreateNextComposers());
+  predictor_->WaitForSpeculation();
+
+  composer_.InsertCharacter("a");
+  const ConversionRequest request = CreateRequest(composer_);
+  predictor_->Finish(request, {}, 0);
+  EXPECT_EQ(predictor_->Predict(request).size(), 1);
+  EXPECT_EQ(count_, 4);
+}
+
+TEST_F(SpeculativePredictorTest, Disabled) {
+  request_.set_enable_speculative_prediction(false);
+  composer_.InsertCharacter("k");
+  predictor_->Speculate(CreateRequest(composer_), CreateNextComposers());
+  predictor_->WaitForSpeculation();
+  EXPECT_EQ(count_, 0);
+
+  composer_.InsertCharacter("a");
+  EXPECT_EQ(predictor_->Predict(CreateRequest(composer_)).size(), 1);
+  EXPECT_EQ(count_, 1);
+}
+
+TEST_F(SpeculativePredictorTest, WaitForSpeculationOnMismatch) {
+  auto counting_predictor =
+      std::make_unique<CountingPredictor>(&count_, absl::Milliseconds(50));
+  const CountingPredictor* counting = counting_predictor.get();
+  SpeculativePredictor predictor(std::move(counting_predictor));
+
+  composer_.InsertCharacter("k");
+  predictor.Speculate(CreateRequest(composer_), CreateNextComposers());
+  // Waits until the speculative request is in the wrapped predictor.
+  while (count_ == 0) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+
+  // "ko" is not speculated. The wrapped predictor is called after the
+  // speculative request being computed.
+  composer_.InsertCharacter("o");
+  EXPECT_EQ(predictor.Predict(CreateRequest(composer_)).size(), 1);
+  EXPECT_FALSE(counting->overlapped());
+  EXPECT_LE(count_, 4);
+}
+
+TEST_F(SpeculativePredictorTest, FingerprintIgnoresDeadline) {
+  composer_.InsertCharacter("ka");
+  const ConversionRequest request = CreateRequest(composer_);
+  ConversionRequest::Options options = request.options();
+  options.deadline = absl::FromUnixSeconds(1000);
+  const ConversionRequest request_with_deadline =
+      ConversionRequestBuilder()
+          .SetConversionRequest(request)
+          .SetOptions(std::move(options))
+          .Build();
+  EXPECT_EQ(SpeculativePredictor::GetFingerprint(request),
+            SpeculativePredictor::GetFingerprint(request_with_deadline));
+}
+
+}  // namespace
+}  // namespace mozc::prediction
@@ -61,6 +61,8 @@
 #include "base/clock.h"
 #include "base/container/trie.h"
 #include "base/japanese_util.h"
+#include "base/memory_usage.h"
+#include "base/trace.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "composer/composer.h"
@@ -331,6 +333,12 @@ bool UserHistoryPredictor::Wait() {
   return true;
 }
 
+void UserHistoryPredictor::CollectMemoryUsage(
+    MemoryUsageCollector& collector) const {
+  collector.AddHeap("prediction.user_history.revert_cache",
+                    revert_cache_.GetMemoryUsage());
+}
+
 bool UserHistoryPredictor::Sync() {
   storage_.AsyncSave();
   return true;
@@ -1336,6 +1344,7 @@ bool UserHistoryPredictor::LookupEntry(
 
 std::vector<Result> UserHistoryPredictor::Predict(
     const ConversionRequest& request) const {
+  MOZC_TRACE_SPAN("UserHistoryPredictor::Predict");
   const bool is_empty_input = request.key().empty();
   // Workaround for b/499745591
   // Predict() may be triggered when BS key is pressed, which is not expected.
@@ -105,6 +105,10 @@ class UserHistoryPredictor : public PredictorInterface {
   // Waits for syncer task.
   bool Wait() override;
 
+  // Reports the revert cache. The history itself is owned and reported by
+  // Modules.
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
+
   absl::string_view GetPredictorName() const override {
     return "UserHistoryPredictor";
   }
@@ -77,7 +77,9 @@ constexpr absl::string_view kFileName = "user://.history.db";
 }  // namespace
 
 UserHistoryStorage::UserHistoryStorage(absl::string_view filename)
-    : dic_(std::make_unique<DicCache>(kLruCacheSize)), filename_(filename) {
+    : dic_(std::make_unique<DicCache>(kLruCacheSize)),
+      filename_(filename),
+      storage_(filename) {
   AsyncLoad();
 }
 
@@ -128,10 +130,8 @@ void UserHistoryStorage::Clear() {
 }
 
 bool UserHistoryStorage::Load() {
-  storage::EncryptedStringStorage storage(filename());
-
   std::string input;
-  if (!storage.Load(&input)) {
+  if (!storage_.Load(&input)) {
     LOG(ERROR) << "Can't load user history data.";
     return false;
   }
@@ -223,8 +223,7 @@ bool UserHistoryStorage::Save() {
     return true;
   }
 
-  storage::EncryptedStringStorage storage(filename());
-  if (!storage.Save(output)) {
+  if (!storage_.Save(output)) {
     LOG(ERROR) << "Can't save user history data.";
     return false;
   }
@@ -342,6 +341,15 @@ bool UserHistoryStorage::IsEmpty() const {
   return dic_->empty();
 }
 
+size_t UserHistoryStorage::GetMemoryUsage() const {
+  auto lock = AcquireUniqueLock();
+  size_t bytes = dic_->GetMemoryUsage();
+  for (const DicElement& elm : *dic_) {
+    bytes += elm.value.ByteSizeLong();
+  }
+  return bytes;
+}
+
 // static
 uint64_t UserHistoryStorage::Fingerprint(const absl::string_view key,
                                          const absl::string_view value) {
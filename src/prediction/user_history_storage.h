@@ -222,6 +222,10 @@ class UserHistoryStorage {
   // Returns true if the storage is empty.
   bool IsEmpty() const;
 
+  // Returns the approximate heap size of the entries. The size of each entry
+  // is estimated from its serialized size.
+  size_t GetMemoryUsage() const;
+
   // Returns fingerprints from various object.
   static uint64_t Fingerprint(absl::string_view key, absl::string_view value);
   static uint64_t Fingerprint(const Entry& entry);
@@ -255,6 +259,9 @@ class UserHistoryStorage {
   mutable std::unique_ptr<DicCache> dic_;
 
   const std::string filename_;
+
+  // Kept to reuse the key derived for |filename_|.
+  storage::EncryptedStringStorage storage_;
 };
 }  // namespace mozc::prediction
 
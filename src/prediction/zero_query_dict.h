@@ -37,9 +37,11 @@
 #include <utility>
 
 #include "absl/base/attributes.h"
+#include "absl/log/log.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/bits.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 
 namespace mozc {
@@ -80,7 +82,8 @@ enum ZeroQueryType : uint16_t {
 // String values of key and value are encoded separately in the string array,
 // which can be extracted by using |key_index| and |value_index|.  The string
 // array is also sorted in ascending order of strings.  For the serialization
-// format of string array, see base/serialized_string_array.h".
+// format of string array, see base/serialized_string_array.h".  Optionally, a
+// PerfectHashIndex over the token array replaces the binary search.
 struct ZeroQueryEntry {
   uint32_t key_index = 0;
   uint32_t value_index = 0;
@@ -96,10 +99,18 @@ ASSERT_ALIGNED(ZeroQueryEntry, type);
 
 class ZeroQueryDict {
  public:
+  // |index_data| is an optional PerfectHashIndex over the token array, which
+  // is used by equal_range() if valid.
   void Init(absl::string_view token_array_data,
-            absl::string_view string_array_data) {
+            absl::string_view string_array_data,
+            absl::string_view index_data = "") {
     token_array_ = token_array_data;
     string_array_.Set(string_array_data);
+    index_.clear();
+    if (!index_data.empty() &&
+        !index_.Init(index_data, GetZeroQueryEntreis().size())) {
+      LOG(WARNING) << "Invalid zero query index is ignored";
+    }
   }
 
   absl::string_view key(const ZeroQueryEntry& entry) const {
@@ -116,6 +127,11 @@ class ZeroQueryDict {
 
   absl::Span<const ZeroQueryEntry> equal_range(absl::string_view key) const {
     absl::Span<const ZeroQueryEntry> tokens = GetZeroQueryEntreis();
+    if (!index_.empty()) {
+      const auto [first, last] = index_.Find(
+          key, [&](uint32_t i) { return string_array_[tokens[i].key_index]; });
+      return tokens.subspan(first, last - first);
+    }
     const auto [it_begin, it_end] = std::equal_range(
         tokens.begin(), tokens.end(), key,
         // The `lhs/rhs` can be either ZeroQueryEntry or absl::string_view.
@@ -140,6 +156,7 @@ class ZeroQueryDict {
  private:
   absl::string_view token_array_;
   SerializedStringArray string_array_;
+  PerfectHashIndex index_;
 };
 }  // namespace mozc
 
@@ -29,12 +29,14 @@
 
 #include "prediction/zero_query_dict.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 #include "testing/gunit.h"
 
@@ -127,6 +129,37 @@ TEST(ZeroQueryDict, EqualRange) {
   EXPECT_TRUE(dict.equal_range("This key is not found").empty());
 }
 
+TEST(ZeroQueryDict, EqualRangeWithIndex) {
+  ZeroQueryDict dict;
+  const auto buf = InitTestZeroQueryDict(&dict);
+  std::vector<absl::string_view> keys;
+  for (const ZeroQueryEntry& entry : dict.GetZeroQueryEntreis()) {
+    keys.push_back(dict.key(entry));
+  }
+  std::unique_ptr<uint32_t[]> index_buf;
+  const absl::string_view index_data =
+      PerfectHashIndex::BuildToBuffer(keys, &index_buf);
+
+  ZeroQueryDict indexed_dict;
+  const absl::string_view token_array_data(kTestTokenArray,
+                                           std::size(kTestTokenArray) - 1);
+  std::unique_ptr<uint32_t[]> string_buf;
+  indexed_dict.Init(
+      token_array_data,
+      SerializedStringArray::SerializeToBuffer(kTestStrings, &string_buf),
+      index_data);
+
+  for (absl::string_view key : {"あ", "ああ", "", "This key is not found"}) {
+    const absl::Span<const ZeroQueryEntry> expected = dict.equal_range(key);
+    const absl::Span<const ZeroQueryEntry> actual =
+        indexed_dict.equal_range(key);
+    ASSERT_EQ(actual.size(), expected.size()) << key;
+    for (size_t i = 0; i < actual.size(); ++i) {
+      EXPECT_EQ(indexed_dict.value(actual[i]), dict.value(expected[i]));
+    }
+  }
+}
+
 TEST(ZeroQueryDict, UninitializedTest) {
   ZeroQueryDict dict;
   EXPECT_TRUE(dict.GetZeroQueryEntreis().empty());
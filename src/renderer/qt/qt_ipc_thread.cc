@@ -29,11 +29,14 @@
 
 #include "renderer/qt/qt_ipc_thread.h"
 
+#include <memory>
 #include <string>
 #include <utility>
 
 #include "absl/log/log.h"
+#include "base/thread.h"
 #include "renderer/qt/qt_ipc_server.h"
+#include "renderer/shared_snapshot_buffer.h"
 
 namespace mozc {
 namespace renderer {
@@ -46,7 +49,27 @@ void QtIpcThread::run() {
     LOG(ERROR) << "cannot start server";
     return;
   }
+
+  // The clients publish the updates through the shared memory once they have
+  // connected over IPC.
+  std::unique_ptr<SharedSnapshotBuffer> snapshot_buffer =
+      SharedSnapshotBuffer::Create(
+          SharedSnapshotBuffer::GetPath(ipc.GetServiceName()));
+  Thread snapshot_reader;
+  if (snapshot_buffer != nullptr) {
+    snapshot_reader = Thread([this, buffer = snapshot_buffer.get()] {
+      std::string snapshot;
+      while (buffer->Wait(&snapshot)) {
+        emit EmitUpdated(std::move(snapshot));
+      }
+    });
+  }
+
   ipc.Loop();
+
+  if (snapshot_buffer != nullptr) {
+    snapshot_buffer->Close();
+  }
 }
 
 }  // namespace renderer
@@ -55,6 +55,7 @@
 #include "ipc/ipc.h"
 #include "ipc/named_event.h"
 #include "protocol/renderer_command.pb.h"
+#include "renderer/shared_snapshot_buffer.h"
 
 #ifdef __APPLE__
 #include "base/mac/mac_util.h"
@@ -377,6 +378,7 @@ bool RendererClient::IsAvailable() const {
 }
 
 bool RendererClient::Shutdown(bool force) {
+  snapshot_buffer_.reset();
   std::unique_ptr<IPCClientInterface> client(CreateIPCClient());
 
   if (!client) {
@@ -429,6 +431,11 @@ bool RendererClient::ExecCommand(const commands::RendererCommand& command) {
 
   MOZC_VLOG(2) << "Sending: " << command;
 
+  if (PublishSnapshot(command)) {
+    is_window_visible_ = command.visible();
+    return true;
+  }
+
   std::unique_ptr<IPCClientInterface> client(CreateIPCClient());
 
   // In case IPCClient::Init fails with timeout error, the last error should be
@@ -489,6 +496,33 @@ bool RendererClient::ExecCommand(const commands::RendererCommand& command) {
 
   CallCommand(client.get(), command);
 
+  // The renderer is up and compatible. Send the following updates through the
+  // shared memory. The mock IPC clients for testing are always used instead.
+  if (command.type() == commands::RendererCommand::UPDATE &&
+      snapshot_buffer_ == nullptr &&
+      ipc_client_factory_for_testing_ == nullptr) {
+    snapshot_buffer_ =
+        SharedSnapshotBuffer::Open(SharedSnapshotBuffer::GetPath(name_));
+  }
+
+  return true;
+}
+
+bool RendererClient::PublishSnapshot(const commands::RendererCommand& command) {
+  if (snapshot_buffer_ == nullptr ||
+      command.type() != commands::RendererCommand::UPDATE) {
+    return false;
+  }
+  std::string buf;
+  if (!command.SerializeToString(&buf)) {
+    LOG(ERROR) << "SerializeToString failed";
+    return false;
+  }
+  if (!snapshot_buffer_->Publish(buf)) {
+    // Falls back to IPC, which restarts the renderer if it has gone.
+    snapshot_buffer_.reset();
+    return false;
+  }
   return true;
 }
 
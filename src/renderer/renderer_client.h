@@ -39,6 +39,7 @@
 #include "ipc/ipc.h"
 #include "protocol/renderer_command.pb.h"
 #include "renderer/renderer_interface.h"
+#include "renderer/shared_snapshot_buffer.h"
 
 namespace mozc {
 
@@ -124,10 +125,17 @@ class RendererClient final : public RendererInterface {
 
   std::unique_ptr<IPCClientInterface> CreateIPCClient() const;
 
+  // Publishes |command| through |snapshot_buffer_| if it's open. Returns false
+  // if the command needs to be sent over IPC.
+  bool PublishSnapshot(const commands::RendererCommand& command);
+
   bool is_window_visible_;
   int version_mismatch_nums_;
   const std::string name_;
   std::unique_ptr<RendererLauncherInterface> default_renderer_launcher_;
+  // Opened after an update is sent over IPC, and closed when the renderer
+  // stops consuming the snapshots.
+  std::unique_ptr<SharedSnapshotBuffer> snapshot_buffer_;
 
   // Behavior overrides for testing
   IPCClientFactoryInterface* const
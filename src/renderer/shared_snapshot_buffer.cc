@@ -0,0 +1,325 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "renderer/shared_snapshot_buffer.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/clock.h"
+#include "base/file_util.h"
+#include "base/mmap.h"
+#include "base/system_util.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+namespace mozc {
+namespace renderer {
+namespace {
+
+constexpr uint32_t kMagic = 0x4d5a5342;  // "MZSB"
+constexpr uint32_t kFormatVersion = 1;
+
+#ifdef __linux__
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected,
+          nullptr, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>* word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT32_MAX,
+          nullptr, nullptr, 0);
+}
+
+uint32_t GetProcessId() { return static_cast<uint32_t>(getpid()); }
+
+bool IsProcessAlive(uint32_t pid) {
+  return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+}
+#endif  // __linux__
+
+}  // namespace
+
+// The memory layout shared by the processes. All the fields are zero in a new
+// file. The atomics must be lock-free to work across the processes.
+struct alignas(64) SharedSnapshotBuffer::Header {
+  // Set after the other fields are initialized.
+  std::atomic<uint32_t> magic;
+  uint32_t format_version;
+  // The futex word the reader waits on. Incremented on every publish.
+  std::atomic<uint32_t> doorbell;
+  std::atomic<uint32_t> closed;
+  // The process ID of the writer publishing a snapshot, or 0.
+  std::atomic<uint32_t> writer;
+  std::atomic<uint64_t> published_version;
+  // The time of the oldest snapshot not consumed by the reader in
+  // microseconds, or 0.
+  std::atomic<int64_t> pending_since;
+};
+
+struct alignas(64) SharedSnapshotBuffer::Slot {
+  // Sequence lock. Odd while a writer is updating the slot.
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> version;
+  std::atomic<uint32_t> size;
+  char data[kMaxSnapshotSize];
+};
+
+namespace {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+}  // namespace
+
+std::string SharedSnapshotBuffer::GetPath(absl::string_view name) {
+  return FileUtil::JoinPath(SystemUtil::GetUserProfileDirectory(),
+                            absl::StrCat(".", name, ".snapshot"));
+}
+
+std::unique_ptr<SharedSnapshotBuffer> SharedSnapshotBuffer::Create(
+    const std::string& path) {
+#ifdef __linux__
+  constexpr size_t kFileSize = sizeof(Header) + 2 * sizeof(Slot);
+  // Unlink first so that the writers mapping the old file keep seeing it as
+  // it was, i.e. closed or stale.
+  unlink(path.c_str());
+  const int fd =
+      open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot create " << path << ": " << errno;
+    return nullptr;
+  }
+  const bool resized = ftruncate(fd, kFileSize) == 0;
+  close(fd);
+  if (!resized) {
+    LOG(ERROR) << "Cannot resize " << path << ": " << errno;
+    unlink(path.c_str());
+    return nullptr;
+  }
+
+  absl::StatusOr<Mmap> mmap = Mmap::Map(path, Mmap::READ_WRITE);
+  if (!mmap.ok()) {
+    LOG(ERROR) << "Cannot map " << path << ": " << mmap.status();
+    unlink(path.c_str());
+    return nullptr;
+  }
+  auto buffer = absl::WrapUnique(
+      new SharedSnapshotBuffer(*std::move(mmap), path, /*is_reader=*/true));
+  Header* header = buffer->header();
+  header->format_version = kFormatVersion;
+  header->magic.store(kMagic, std::memory_order_release);
+  return buffer;
+#else   // __linux__
+  return nullptr;
+#endif  // __linux__
+}
+
+std::unique_ptr<SharedSnapshotBuffer> SharedSnapshotBuffer::Open(
+    const std::string& path) {
+#ifdef __linux__
+  absl::StatusOr<Mmap> mmap = Mmap::Map(path, Mmap::READ_WRITE);
+  if (!mmap.ok()) {
+    return nullptr;
+  }
+  if (mmap->size() != sizeof(Header) + 2 * sizeof(Slot)) {
+    LOG(WARNING) << "Unexpected size of " << path << ": " << mmap->size();
+    return nullptr;
+  }
+  auto buffer = absl::WrapUnique(
+      new SharedSnapshotBuffer(*std::move(mmap), path, /*is_reader=*/false));
+  const Header* header = buffer->header();
+  if (header->magic.load(std::memory_order_acquire) != kMagic ||
+      header->format_version != kFormatVersion ||
+      header->closed.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return buffer;
+#else   // __linux__
+  return nullptr;
+#endif  // __linux__
+}
+
+SharedSnapshotBuffer::SharedSnapshotBuffer(Mmap mmap, std::string path,
+                                           bool is_reader)
+    : mmap_(std::move(mmap)), path_(std::move(path)), is_reader_(is_reader) {}
+
+SharedSnapshotBuffer::~SharedSnapshotBuffer() {
+  if (is_reader_) {
+    Close();
+    FileUtil::UnlinkOrLogError(path_);
+  }
+}
+
+SharedSnapshotBuffer::Header* SharedSnapshotBuffer::header() {
+  return std::launder(reinterpret_cast<Header*>(mmap_.data()));
+}
+
+SharedSnapshotBuffer::Slot* SharedSnapshotBuffer::slot(uint64_t version) {
+  return std::launder(reinterpret_cast<Slot*>(
+      mmap_.data() + sizeof(Header) + (version % 2) * sizeof(Slot)));
+}
+
+bool SharedSnapshotBuffer::Publish(absl::string_view snapshot) {
+#ifdef __linux__
+  if (is_reader_ || snapshot.size() > kMaxSnapshotSize) {
+    return false;
+  }
+  Header* header = this->header();
+  if (header->closed.load(std::memory_order_acquire)) {
+    return false;
+  }
+  const int64_t now = absl::ToUnixMicros(Clock::GetAbslTime());
+  const int64_t pending_since =
+      header->pending_since.load(std::memory_order_acquire);
+  if (pending_since != 0 &&
+      now - pending_since > absl::ToInt64Microseconds(kStaleTimeout)) {
+    LOG(WARNING) << "The renderer doesn't consume the snapshots";
+    return false;
+  }
+
+  // Another writer may have crashed while publishing.
+  const uint32_t pid = GetProcessId();
+  uint32_t holder = 0;
+  if (!header->writer.compare_exchange_strong(holder, pid,
+                                              std::memory_order_acquire) &&
+      (IsProcessAlive(holder) ||
+       !header->writer.compare_exchange_strong(holder, pid,
+                                               std::memory_order_acquire))) {
+    return false;
+  }
+
+  const uint64_t version =
+      header->published_version.load(std::memory_order_relaxed) + 1;
+  Slot* slot = this->slot(version);
+  // Clear the lowest bit in case a crashed writer left the slot locked.
+  const uint64_t sequence =
+      slot->sequence.load(std::memory_order_relaxed) & ~uint64_t{1};
+  slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->version.store(version, std::memory_order_relaxed);
+  slot->size.store(snapshot.size(), std::memory_order_relaxed);
+  std::memcpy(slot->data, snapshot.data(), snapshot.size());
+  slot->sequence.store(sequence + 2, std::memory_order_release);
+
+  header->published_version.store(version, std::memory_order_release);
+  int64_t no_pending = 0;
+  header->pending_since.compare_exchange_strong(no_pending, now,
+                                                std::memory_order_release);
+  header->writer.store(0, std::memory_order_release);
+
+  header->doorbell.fetch_add(1, std::memory_order_release);
+  FutexWakeAll(&header->doorbell);
+  return true;
+#else   // __linux__
+  return false;
+#endif  // __linux__
+}
+
+bool SharedSnapshotBuffer::Wait(std::string* snapshot) {
+#ifdef __linux__
+  Header* header = this->header();
+  while (true) {
+    const uint32_t doorbell = header->doorbell.load(std::memory_order_acquire);
+    if (header->closed.load(std::memory_order_acquire)) {
+      return false;
+    }
+    if (ReadLatest(snapshot)) {
+      return true;
+    }
+    FutexWait(&header->doorbell, doorbell);
+  }
+#else   // __linux__
+  return false;
+#endif  // __linux__
+}
+
+bool SharedSnapshotBuffer::ReadLatest(std::string* snapshot) {
+  Header* header = this->header();
+  while (true) {
+    const uint64_t version =
+        header->published_version.load(std::memory_order_acquire);
+    if (version == last_version_) {
+      return false;
+    }
+    const Slot* slot = this->slot(version);
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence % 2 != 0 ||
+        slot->version.load(std::memory_order_relaxed) != version) {
+      // A writer is overwriting the slot with a newer version.
+      continue;
+    }
+    const uint32_t size = slot->size.load(std::memory_order_relaxed);
+    if (size > kMaxSnapshotSize) {
+      LOG(ERROR) << "Broken snapshot: " << size;
+      last_version_ = version;
+      return false;
+    }
+    snapshot->assign(slot->data, size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+    last_version_ = version;
+    header->pending_since.store(0, std::memory_order_release);
+    return true;
+  }
+}
+
+void SharedSnapshotBuffer::Close() {
+#ifdef __linux__
+  Header* header = this->header();
+  header->closed.store(1, std::memory_order_release);
+  header->doorbell.fetch_add(1, std::memory_order_release);
+  FutexWakeAll(&header->doorbell);
+#endif  // __linux__
+}
+
+}  // namespace renderer
+}  // namespace mozc
@@ -0,0 +1,122 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Shared memory transport for the renderer commands.
+//
+// The renderer only needs the latest RendererCommand, so instead of a queue
+// the clients publish versioned snapshots into a double buffer in a file
+// mapped by both of the processes. Each slot is guarded by a sequence lock,
+// and the renderer sleeps on a futex in the mapped header (the doorbell)
+// until a newer version is published. Snapshots overwritten before the
+// renderer wakes up are never rendered.
+//
+// The buffer is created by the renderer and opened by the clients once they
+// have talked to the renderer over IPC. Publish() fails when the buffer
+// cannot carry the snapshot or the renderer seems to have gone, and the
+// client falls back to the IPC path in that case.
+//
+// Supported only on Linux. Create() and Open() return nullptr elsewhere.
+
+#ifndef MOZC_RENDERER_SHARED_SNAPSHOT_BUFFER_H_
+#define MOZC_RENDERER_SHARED_SNAPSHOT_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/mmap.h"
+
+namespace mozc {
+namespace renderer {
+
+class SharedSnapshotBuffer {
+ public:
+  // Snapshots larger than this are sent over IPC.
+  static constexpr size_t kMaxSnapshotSize = 256 * 1024;
+
+  // The writers treat the reader as gone if it doesn't consume a published
+  // snapshot within this duration.
+  static constexpr absl::Duration kStaleTimeout = absl::Seconds(1);
+
+  // Returns the path of the buffer for the renderer named |name|.
+  static std::string GetPath(absl::string_view name);
+
+  // Creates a new buffer at |path| for the reader. The existing file is
+  // replaced so that the writers of the old buffer notice the reader is gone.
+  static std::unique_ptr<SharedSnapshotBuffer> Create(const std::string& path);
+
+  // Opens the buffer at |path| for a writer. Returns nullptr if the buffer
+  // doesn't exist, is closed or is created by an incompatible renderer.
+  static std::unique_ptr<SharedSnapshotBuffer> Open(const std::string& path);
+
+  SharedSnapshotBuffer(const SharedSnapshotBuffer&) = delete;
+  SharedSnapshotBuffer& operator=(const SharedSnapshotBuffer&) = delete;
+  // The reader closes the buffer and removes the file.
+  ~SharedSnapshotBuffer();
+
+  // Writer: publishes |snapshot| as the latest version and rings the doorbell.
+  // Returns false if |snapshot| is too large, another writer is publishing,
+  // or the reader is closed or stale.
+  bool Publish(absl::string_view snapshot);
+
+  // Reader: blocks until a snapshot newer than the last one returned is
+  // published, and copies it to |snapshot|. Returns false after Close().
+  bool Wait(std::string* snapshot);
+
+  // Reader: marks the buffer closed and wakes up Wait(). Subsequent Publish()
+  // calls of all the writers fail.
+  void Close();
+
+ private:
+  struct Header;
+  struct Slot;
+
+  SharedSnapshotBuffer(Mmap mmap, std::string path, bool is_reader);
+
+  Header* header();
+  Slot* slot(uint64_t version);
+
+  // Copies the snapshot of the latest version to |snapshot|. Returns false if
+  // no newer snapshot than |last_version_| is published.
+  bool ReadLatest(std::string* snapshot);
+
+  Mmap mmap_;
+  const std::string path_;
+  const bool is_reader_;
+  uint64_t last_version_ = 0;
+};
+
+}  // namespace renderer
+}  // namespace mozc
+
+#endif  // MOZC_RENDERER_SHARED_SNAPSHOT_BUFFER_H_
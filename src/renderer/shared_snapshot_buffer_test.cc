@@ -0,0 +1,185 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "renderer/shared_snapshot_buffer.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "base/clock.h"
+#include "base/clock_mock.h"
+#include "base/file_util.h"
+#include "base/thread.h"
+#include "testing/gunit.h"
+#include "testing/mozctest.h"
+
+namespace mozc {
+namespace renderer {
+namespace {
+
+#ifdef __linux__
+
+class SharedSnapshotBufferTest : public testing::TestWithTempUserProfile {
+ protected:
+  SharedSnapshotBufferTest() : path_(SharedSnapshotBuffer::GetPath("test")) {}
+
+  const std::string path_;
+};
+
+TEST_F(SharedSnapshotBufferTest, PublishAndWait) {
+  std::unique_ptr<SharedSnapshotBuffer> reader =
+      SharedSnapshotBuffer::Create(path_);
+  ASSERT_NE(reader, nullptr);
+  std::unique_ptr<SharedSnapshotBuffer> writer =
+      SharedSnapshotBuffer::Open(path_);
+  ASSERT_NE(writer, nullptr);
+
+  std::string snapshot;
+  EXPECT_TRUE(writer->Publish("first"));
+  ASSERT_TRUE(reader->Wait(&snapshot));
+  EXPECT_EQ(snapshot, "first");
+
+  // Only the latest snapshot is delivered.
+  EXPECT_TRUE(writer->Publish("second"));
+  EXPECT_TRUE(writer->Publish("third"));
+  ASSERT_TRUE(reader->Wait(&snapshot));
+  EXPECT_EQ(snapshot, "third");
+
+  // Wakes up the waiting reader.
+  BackgroundFuture<std::string> received([&reader] {
+    std::string snapshot;
+    EXPECT_TRUE(reader->Wait(&snapshot));
+    return snapshot;
+  });
+  EXPECT_TRUE(writer->Publish("fourth"));
+  EXPECT_EQ(received.Get(), "fourth");
+}
+
+TEST_F(SharedSnapshotBufferTest, TooLarge) {
+  std::unique_ptr<SharedSnapshotBuffer> reader =
+      SharedSnapshotBuffer::Create(path_);
+  ASSERT_NE(reader, nullptr);
+  std::unique_ptr<SharedSnapshotBuffer> writer =
+      SharedSnapshotBuffer::Open(path_);
+  ASSERT_NE(writer, nullptr);
+
+  const std::string large(SharedSnapshotBuffer::kMaxSnapshotSize + 1, 'a');
+  EXPECT_FALSE(writer->Publish(large));
+  const std::string max(SharedSnapshotBuffer::kMaxSnapshotSize, 'a');
+  EXPECT_TRUE(writer->Publish(max));
+  std::string snapshot;
+  ASSERT_TRUE(reader->Wait(&snapshot));
+  EXPECT_EQ(snapshot, max);
+}
+
+TEST_F(SharedSnapshotBufferTest, Close) {
+  EXPECT_EQ(SharedSnapshotBuffer::Open(path_), nullptr);
+
+  std::unique_ptr<SharedSnapshotBuffer> reader =
+      SharedSnapshotBuffer::Create(path_);
+  ASSERT_NE(reader, nullptr);
+  std::unique_ptr<SharedSnapshotBuffer> writer =
+      SharedSnapshotBuffer::Open(path_);
+  ASSERT_NE(writer, nullptr);
+
+  BackgroundFuture<bool> waited([&reader] {
+    std::string snapshot;
+    return reader->Wait(&snapshot);
+  });
+  reader->Close();
+  EXPECT_FALSE(waited.Get());
+  EXPECT_FALSE(writer->Publish("snapshot"));
+  EXPECT_EQ(SharedSnapshotBuffer::Open(path_), nullptr);
+
+  reader.reset();
+  EXPECT_FALSE(FileUtil::FileExists(path_).ok());
+}
+
+TEST_F(SharedSnapshotBufferTest, Recreate) {
+  std::unique_ptr<SharedSnapshotBuffer> reader =
+      SharedSnapshotBuffer::Create(path_);
+  ASSERT_NE(reader, nullptr);
+  std::unique_ptr<SharedSnapshotBuffer> writer =
+      SharedSnapshotBuffer::Open(path_);
+  ASSERT_NE(writer, nullptr);
+
+  // A new renderer doesn't see the snapshots for the old one.
+  std::unique_ptr<SharedSnapshotBuffer> new_reader =
+      SharedSnapshotBuffer::Create(path_);
+  ASSERT_NE(new_reader, nullptr);
+  EXPECT_TRUE(writer->Publish("old"));
+  std::unique_ptr<SharedSnapshotBuffer> new_writer =
+      SharedSnapshotBuffer::Open(path_);
+  ASSERT_NE(new_writer, nullptr);
+  EXPECT_TRUE(new_writer->Publish("new"));
+  std::string snapshot;
+  ASSERT_TRUE(new_reader->Wait(&snapshot));
+  EXPECT_EQ(snapshot, "new");
+}
+
+TEST_F(SharedSnapshotBufferTest, StaleReader) {
+  ClockMock clock(absl::FromUnixSeconds(1000));
+  Clock::SetClockForUnitTest(&clock);
+
+  std::unique_ptr<SharedSnapshotBuffer> reader =
+      SharedSnapshotBuffer::Create(path_);
+  ASSERT_NE(reader, nullptr);
+  std::unique_ptr<SharedSnapshotBuffer> writer =
+      SharedSnapshotBuffer::Open(path_);
+  ASSERT_NE(writer, nullptr);
+
+  EXPECT_TRUE(writer->Publish("first"));
+  clock.Advance(SharedSnapshotBuffer::kStaleTimeout / 2);
+  EXPECT_TRUE(writer->Publish("second"));
+  clock.Advance(SharedSnapshotBuffer::kStaleTimeout);
+  // The first snapshot is not consumed for too long.
+  EXPECT_FALSE(writer->Publish("third"));
+
+  std::string snapshot;
+  ASSERT_TRUE(reader->Wait(&snapshot));
+  EXPECT_EQ(snapshot, "second");
+  EXPECT_TRUE(writer->Publish("third"));
+
+  Clock::SetClockForUnitTest(nullptr);
+}
+
+#else  // __linux__
+
+TEST(SharedSnapshotBufferTest, Unsupported) {
+  EXPECT_EQ(SharedSnapshotBuffer::Create("test"), nullptr);
+  EXPECT_EQ(SharedSnapshotBuffer::Open("test"), nullptr);
+}
+
+#endif  // __linux__
+
+}  // namespace
+}  // namespace renderer
+}  // namespace mozc
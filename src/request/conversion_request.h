@@ -189,6 +189,11 @@ class ConversionRequest {
 
   bool IsZeroQuerySuggestion() const { return key().empty(); }
 
+  // Returns true if the deadline of this request has passed.
+  bool IsDeadlineExceeded() const {
+    return ::mozc::IsDeadlineExceeded(options_);
+  }
+
   // Clients needs to check ConversionRequest::incognito_mode() instead
   // of Config::incognito_mode() or Request::is_incognito_mode(), as the
   // incognito mode can also set via Options.
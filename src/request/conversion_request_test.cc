@@ -36,6 +36,9 @@
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/clock.h"
+#include "base/clock_mock.h"
 #include "composer/composer.h"
 #include "composer/table.h"
 #include "converter/candidate.h"
@@ -156,6 +159,23 @@ TEST(ConversionRequestTest, IsZeroQuerySuggestionTest) {
       ConversionRequestBuilder().SetKey("key").Build().IsZeroQuerySuggestion());
 }
 
+TEST(ConversionRequestTest, IsDeadlineExceededTest) {
+  ClockMock clock(absl::FromUnixSeconds(1000));
+  Clock::SetClockForUnitTest(&clock);
+
+  EXPECT_FALSE(ConversionRequestBuilder().Build().IsDeadlineExceeded());
+
+  ConversionRequest::Options options;
+  options.deadline = absl::FromUnixSeconds(1000) + absl::Milliseconds(10);
+  const ConversionRequest convreq =
+      ConversionRequestBuilder().SetOptions(std::move(options)).Build();
+  EXPECT_FALSE(convreq.IsDeadlineExceeded());
+  clock.Advance(absl::Milliseconds(10));
+  EXPECT_TRUE(convreq.IsDeadlineExceeded());
+
+  Clock::SetClockForUnitTest(nullptr);
+}
+
 TEST(ConversionRequestTest, IncognitoModeTest) {
   {
     const ConversionRequest convreq = ConversionRequestBuilder().Build();
@@ -35,6 +35,9 @@
 #include <ostream>
 #include <type_traits>
 
+#include "absl/time/time.h"
+#include "base/clock.h"
+
 namespace mozc {
 
 inline constexpr size_t kMaxConversionCandidatesSize = 200;
@@ -69,7 +72,7 @@ enum ComposerKeySelection {
 };
 
 // Options must be trivially copyable to get hash value directly.
-// Since it is small (~40 bytes), passing and returning by value is preferred
+// Since it is small (~60 bytes), passing and returning by value is preferred
 // to avoid reference lifetime issues.
 struct ConversionOptions {
   RequestType request_type = RequestType::CONVERSION;
@@ -142,11 +145,22 @@ struct ConversionOptions {
 
   // This conversion request is called by predictor for realtime conversion.
   bool used_in_predictor_realtime_conversion = false;
+
+  // Expensive stages stop early and return the results found so far once
+  // this deadline has passed. See IsDeadlineExceeded() below.
+  absl::Time deadline = absl::InfiniteFuture();
 };
 
 static_assert(std::is_trivially_copyable<ConversionOptions>::value,
               "ConversionOptions must be trivially copyable");
 
+// Returns true if the deadline of `options` has passed. The clock is not read
+// when no deadline is set.
+inline bool IsDeadlineExceeded(const ConversionOptions& options) {
+  return options.deadline != absl::InfiniteFuture() &&
+         Clock::GetAbslTime() >= options.deadline;
+}
+
 }  // namespace mozc
 
 #endif  // MOZC_REQUEST_OPTIONS_H_
@@ -157,7 +157,8 @@ std::string A11yDescriptionRewriter::GetKanaCharacterLabel(
 }
 
 A11yDescriptionRewriter::A11yDescriptionRewriter(
-    absl::string_view token_array_data, absl::string_view string_array_data)
+    absl::string_view token_array_data, absl::string_view string_array_data,
+    absl::string_view index_data)
     : small_letter_set_(
           {// Small hiragana
            U'ぁ', U'ぃ', U'ぅ', U'ぇ', U'ぉ', U'ゃ', U'ゅ', U'ょ', U'っ', U'ゎ',
@@ -178,7 +179,7 @@ A11yDescriptionRewriter::A11yDescriptionRewriter(
       }) {
   if (!token_array_data.empty() && !string_array_data.empty()) {
     description_map_ = std::make_unique<SerializedDictionary>(
-        token_array_data, string_array_data);
+        token_array_data, string_array_data, index_data);
   }
 }
 
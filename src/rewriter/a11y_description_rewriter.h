@@ -45,8 +45,10 @@ namespace mozc {
 
 class A11yDescriptionRewriter : public RewriterInterface {
  public:
-  explicit A11yDescriptionRewriter(absl::string_view token_array_data,
-                                   absl::string_view string_array_data);
+  // |index_data| is an optional PerfectHashIndex over the token array.
+  A11yDescriptionRewriter(absl::string_view token_array_data,
+                          absl::string_view string_array_data,
+                          absl::string_view index_data = "");
 
   A11yDescriptionRewriter(const A11yDescriptionRewriter&) = delete;
   A11yDescriptionRewriter& operator=(const A11yDescriptionRewriter&) = delete;
@@ -39,6 +39,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
@@ -80,6 +81,22 @@ bool CollocationFilter::Exists(const absl::string_view left,
   return filter_.Exists({left, right});
 }
 
+int CollocationFilter::FindFirst(
+    const absl::string_view left,
+    const absl::Span<const absl::string_view> rights) const {
+  if (left.empty() || rights.empty()) {
+    return -1;
+  }
+  absl::InlinedVector<bool, 16> results(rights.size());
+  filter_.ExistsMany(left, rights, absl::MakeSpan(results));
+  for (size_t i = 0; i < rights.size(); ++i) {
+    if (results[i] && !rights[i].empty()) {
+      return i;
+    }
+  }
+  return -1;
+}
+
 absl::StatusOr<SuppressionFilter> SuppressionFilter::Create(
     absl::string_view data) {
   absl::StatusOr<ExistenceFilter> filter =
@@ -570,6 +587,7 @@ bool CollocationRewriter::RewriteFromPrevSegment(
 
   // Reuse |curs| in the loop as this method is performance critical.
   std::vector<std::string> curs;
+  std::vector<absl::string_view> cur_views;
   for (size_t i = 0; i < i_max; ++i) {
     if (seg->candidate(i).cost > seg->candidate(0).cost + kMaxCostDiff) {
       continue;
@@ -586,17 +604,17 @@ bool CollocationRewriter::RewriteFromPrevSegment(
       continue;
     }
 
-    for (absl::string_view cur : curs) {
-      if (collocation_filter_.Exists(prev, cur)) {
-        if (i != 0) {
-          MOZC_VLOG(3) << prev << cur << " " << seg->candidate(0).value << "->"
-                       << seg->candidate(i).value;
-        }
-        seg->move_candidate(i, 0);
-        seg->mutable_candidate(0)->attributes |=
-            converter::Attribute::CONTEXT_SENSITIVE;
-        return true;
+    cur_views.assign(curs.begin(), curs.end());
+    if (const int k = collocation_filter_.FindFirst(prev, cur_views);
+        k != -1) {
+      if (i != 0) {
+        MOZC_VLOG(3) << prev << cur_views[k] << " " << seg->candidate(0).value
+                     << "->" << seg->candidate(i).value;
       }
+      seg->move_candidate(i, 0);
+      seg->mutable_candidate(0)->attributes |=
+          converter::Attribute::CONTEXT_SENSITIVE;
+      return true;
     }
   }
   return false;
@@ -627,6 +645,24 @@ bool CollocationRewriter::RewriteUsingNextSegment(Segment* next_seg,
     next_seg_ok[j] = 1;
   }
 
+  // Flattens the lookup tokens of the next segment in the order of (j, next)
+  // so that each |cur| is checked against all of them in one batch.
+  std::vector<absl::string_view> flat_nexts;
+  std::vector<size_t> flat_next_indices;
+  for (size_t j = 0; j < j_max; ++j) {
+    if (next_seg->candidate(j).cost >
+        next_seg->candidate(0).cost + kMaxCostDiff) {
+      continue;
+    }
+    if (!next_seg_ok[j]) {
+      continue;
+    }
+    for (absl::string_view next : nexts[j]) {
+      flat_nexts.push_back(next);
+      flat_next_indices.push_back(j);
+    }
+  }
+
   // Reuse |curs| in the loop as this method is performance critical.
   std::vector<std::string> curs;
   for (size_t i = 0; i < i_max; ++i) {
@@ -646,30 +682,21 @@ bool CollocationRewriter::RewriteUsingNextSegment(Segment* next_seg,
     }
 
     for (absl::string_view cur : curs) {
-      for (size_t j = 0; j < j_max; ++j) {
-        if (next_seg->candidate(j).cost >
-            next_seg->candidate(0).cost + kMaxCostDiff) {
-          continue;
-        }
-        if (!next_seg_ok[j]) {
-          continue;
-        }
-
-        for (absl::string_view next : nexts[j]) {
-          if (collocation_filter_.Exists(cur, next)) {
-            DCHECK(VerifyNaturalContent(next_seg->candidate(j),
-                                        next_seg->candidate(0), RIGHT))
-                << "IsNaturalContent() should not fail here.";
-            seg->move_candidate(i, 0);
-            seg->mutable_candidate(0)->attributes |=
-                converter::Attribute::CONTEXT_SENSITIVE;
-            next_seg->move_candidate(j, 0);
-            next_seg->mutable_candidate(0)->attributes |=
-                converter::Attribute::CONTEXT_SENSITIVE;
-            return true;
-          }
-        }
+      const int k = collocation_filter_.FindFirst(cur, flat_nexts);
+      if (k == -1) {
+        continue;
       }
+      const size_t j = flat_next_indices[k];
+      DCHECK(VerifyNaturalContent(next_seg->candidate(j),
+                                  next_seg->candidate(0), RIGHT))
+          << "IsNaturalContent() should not fail here.";
+      seg->move_candidate(i, 0);
+      seg->mutable_candidate(0)->attributes |=
+          converter::Attribute::CONTEXT_SENSITIVE;
+      next_seg->move_candidate(j, 0);
+      next_seg->mutable_candidate(0)->attributes |=
+          converter::Attribute::CONTEXT_SENSITIVE;
+      return true;
     }
   }
   return false;
@@ -56,6 +56,11 @@ class CollocationFilter {
 
   bool Exists(absl::string_view left, absl::string_view right) const;
 
+  // Returns the index of the first element of `rights` such that
+  // Exists(left, right) holds, or -1 if none. The filter is probed in a batch.
+  int FindFirst(absl::string_view left,
+                absl::Span<const absl::string_view> rights) const;
+
  private:
   storage::ExistenceFilter filter_;
 };
@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -38,8 +39,10 @@
 #include <vector>
 
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 #include "base/japanese_util.h"
 #include "base/util.h"
@@ -171,8 +174,14 @@ bool CorrectionRewriter::LookupCorrection(
   results->clear();
 
   using Iter = SerializedStringArray::const_iterator;
-  std::pair<Iter, Iter> range =
-      std::equal_range(error_array_.begin(), error_array_.end(), key);
+  std::pair<Iter, Iter> range;
+  if (!error_index_.empty()) {
+    const auto [first, last] =
+        error_index_.Find(key, [this](uint32_t i) { return error_array_[i]; });
+    range = {error_array_.begin() + first, error_array_.begin() + last};
+  } else {
+    range = std::equal_range(error_array_.begin(), error_array_.end(), key);
+  }
   for (; range.first != range.second; ++range.first) {
     const absl::string_view v = value_array_[range.first.index()];
     if (value.empty() || value == v) {
@@ -186,7 +195,8 @@ bool CorrectionRewriter::LookupCorrection(
 CorrectionRewriter::CorrectionRewriter(const engine::Modules& modules,
                                        absl::string_view value_array_data,
                                        absl::string_view error_array_data,
-                                       absl::string_view correction_array_data)
+                                       absl::string_view correction_array_data,
+                                       absl::string_view index_data)
     : modules_(modules) {
   DCHECK(SerializedStringArray::VerifyData(value_array_data));
   DCHECK(SerializedStringArray::VerifyData(error_array_data));
@@ -196,6 +206,10 @@ CorrectionRewriter::CorrectionRewriter(const engine::Modules& modules,
   correction_array_.Set(correction_array_data);
   DCHECK_EQ(value_array_.size(), error_array_.size());
   DCHECK_EQ(value_array_.size(), correction_array_.size());
+  if (!index_data.empty() &&
+      !error_index_.Init(index_data, error_array_.size())) {
+    LOG(WARNING) << "Invalid reading correction index is ignored";
+  }
 }
 
 bool CorrectionRewriter::Rewrite(const ConversionRequest& request,
@@ -36,6 +36,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 #include "converter/candidate.h"
 #include "converter/segments.h"
@@ -48,10 +49,12 @@ namespace mozc {
 
 class CorrectionRewriter : public RewriterInterface {
  public:
+  // |index_data| is an optional PerfectHashIndex over the error array.
   CorrectionRewriter(const engine::Modules& modules,
                      absl::string_view value_array_data,
                      absl::string_view error_array_data,
-                     absl::string_view correction_array_data);
+                     absl::string_view correction_array_data,
+                     absl::string_view index_data = "");
 
   bool Rewrite(const ConversionRequest& request,
                Segments* segments) const override;
@@ -95,6 +98,7 @@ class CorrectionRewriter : public RewriterInterface {
   SerializedStringArray value_array_;
   SerializedStringArray error_array_;
   SerializedStringArray correction_array_;
+  PerfectHashIndex error_index_;
   const engine::Modules& modules_;
 };
 
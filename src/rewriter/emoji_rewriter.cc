@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <string>
@@ -40,6 +41,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -146,10 +148,15 @@ std::vector<std::unique_ptr<converter::Candidate>> CreateEmojiData(
 }  // namespace
 
 EmojiRewriter::EmojiRewriter(absl::string_view token_array_data,
-                             absl::string_view string_array_data)
+                             absl::string_view string_array_data,
+                             absl::string_view index_data)
     : token_array_data_(token_array_data) {
   DCHECK(SerializedStringArray::VerifyData(string_array_data));
   string_array_.Set(string_array_data);
+  if (!index_data.empty() &&
+      !index_.Init(index_data, GetEmojiTokens().size())) {
+    LOG(WARNING) << "Invalid emoji index is ignored";
+  }
 }
 
 int EmojiRewriter::capability(const ConversionRequest& request) const {
@@ -177,8 +184,14 @@ bool EmojiRewriter::IsEmojiCandidate(const converter::Candidate& candidate) {
 
 absl::Span<const EmojiData> EmojiRewriter::LookUpToken(
     absl::string_view key) const {
-  // Search string array for key.
   const absl::Span<const EmojiData> tokens = GetEmojiTokens();
+  if (!index_.empty()) {
+    const auto [first, last] = index_.Find(
+        key, [&](uint32_t i) { return string_array_[tokens[i].key_index]; });
+    return tokens.subspan(first, last - first);
+  }
+
+  // Search string array for key.
   const auto [it_begin, it_end] = std::equal_range(
       // The `lhs/rhs` can be either EmojiData or absl::string_view.
       tokens.begin(), tokens.end(), key, [&](const auto& lhs, const auto& rhs) {
@@ -35,6 +35,7 @@
 
 #include "absl/strings/string_view.h"
 #include "base/bits.h"
+#include "base/container/perfect_hash_index.h"
 #include "base/container/serialized_string_array.h"
 #include "converter/candidate.h"
 #include "converter/segments.h"
@@ -69,8 +70,10 @@ namespace mozc {
 //   }
 class EmojiRewriter : public RewriterInterface {
  public:
+  // |index_data| is an optional PerfectHashIndex over the token array.
   EmojiRewriter(absl::string_view token_array_data,
-                absl::string_view string_array_data);
+                absl::string_view string_array_data,
+                absl::string_view index_data = "");
   EmojiRewriter(const EmojiRewriter&) = delete;
   EmojiRewriter& operator=(const EmojiRewriter&) = delete;
 
@@ -106,6 +109,7 @@ class EmojiRewriter : public RewriterInterface {
 
   absl::string_view token_array_data_;
   SerializedStringArray string_array_;
+  PerfectHashIndex index_;
 };
 
 }  // namespace mozc
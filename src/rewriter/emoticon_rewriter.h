@@ -42,8 +42,10 @@ namespace mozc {
 
 class EmoticonRewriter : public RewriterInterface {
  public:
+  // |index_data| is an optional PerfectHashIndex over the token array.
   EmoticonRewriter(absl::string_view token_array_data,
-                   absl::string_view string_array_data);
+                   absl::string_view string_array_data,
+                   absl::string_view index_data = "");
 
   int capability(const ConversionRequest& request) const override;
 
@@ -35,14 +35,16 @@ gen_a11y_description_rewriter_data.py
   --input=japanese_phonetic_reading.tsv
   --output_token_array=output_token_array
   --output_string_array=output_token_array
+  --output_index=output_index
 """
 
 import argparse
 import codecs
 import struct
-from typing import List
+from typing import List, Optional
 
 from build_tools import code_generator_util
+from build_tools import perfect_hash_index_builder
 from build_tools import serialized_string_array_builder
 
 KeyValuePair = List[str]
@@ -61,6 +63,7 @@ def WriteOutput(
     key_value_pairs: List[KeyValuePair],
     token_array_file: str,
     string_array_file: str,
+    index_file: Optional[str] = None,
 ):
   """Output token and string arrays to files.
 
@@ -68,6 +71,7 @@ def WriteOutput(
     key_value_pairs: Pairs of character and the phonetic reading.
     token_array_file: Token array file to consist SerializedDictionary.
     string_array_file: String array file to consist SerializedDictionary.
+    index_file: Optional perfect hash index file over the token array.
   """
   strings = []
   with open(token_array_file, 'wb') as f:
@@ -83,6 +87,10 @@ def WriteOutput(
       strings.append(key)
       strings.append(value)
   serialized_string_array_builder.SerializeToFile(strings, string_array_file)
+  if index_file:
+    perfect_hash_index_builder.BuildToFile(
+        [key for (key, _) in key_value_pairs], index_file
+    )
 
 
 def ParseArgs() -> argparse.Namespace:
@@ -106,6 +114,11 @@ def ParseArgs() -> argparse.Namespace:
       dest='output_string_array',
       help='Output string array file.',
   )
+  parser.add_argument(
+      '--output_index',
+      dest='output_index',
+      help='Output perfect hash index file (optional).',
+  )
   return parser.parse_args()
 
 
@@ -113,7 +126,10 @@ def main() -> None:
   args = ParseArgs()
   key_value_pairs = ReadJapanesePhoneticReading(args.input)
   WriteOutput(
-      key_value_pairs, args.output_token_array, args.output_string_array
+      key_value_pairs,
+      args.output_token_array,
+      args.output_string_array,
+      args.output_index,
   )
 
 
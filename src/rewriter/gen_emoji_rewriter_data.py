@@ -58,6 +58,7 @@ import struct
 import sys
 
 from build_tools import code_generator_util
+from build_tools import perfect_hash_index_builder
 from build_tools import serialized_string_array_builder
 
 
@@ -144,7 +145,11 @@ def ReadEmojiTsv(stream):
 
 
 def OutputData(
-    emoji_data_list, token_dict, token_array_file, string_array_file
+    emoji_data_list,
+    token_dict,
+    token_array_file,
+    string_array_file,
+    index_file=None,
 ):
   """Output token and string arrays to files."""
   sorted_token_dict = sorted(token_dict.items())
@@ -182,6 +187,13 @@ def OutputData(
       sorted_strings, string_array_file
   )
 
+  if index_file:
+    # Keys of the token array, one per token, for PerfectHashIndex.
+    keys = []
+    for reading, value_list in sorted_token_dict:
+      keys.extend([reading] * len(value_list))
+    perfect_hash_index_builder.BuildToFile(keys, index_file)
+
 
 def ParseOptions() -> argparse.Namespace:
   """Parse given options.
@@ -201,6 +213,11 @@ def ParseOptions() -> argparse.Namespace:
       dest='output_string_array',
       help='output string array file',
   )
+  parser.add_argument(
+      '--output_index',
+      dest='output_index',
+      help='output perfect hash index file (optional)',
+  )
   return parser.parse_args()
 
 
@@ -214,6 +231,7 @@ def main():
       token_dict,
       options.output_token_array,
       options.output_string_array,
+      options.output_index,
   )
 
 
@@ -50,6 +50,8 @@
 ABSL_FLAG(std::string, input, "", "Emoticon dictionary file");
 ABSL_FLAG(std::string, output_token_array, "", "Output token array");
 ABSL_FLAG(std::string, output_string_array, "", "Output string array");
+ABSL_FLAG(std::string, output_index, "",
+          "Output perfect hash index over the token array (optional)");
 
 namespace mozc {
 namespace {
@@ -135,6 +137,7 @@ int main(int argc, char** argv) {
   const auto& input_data = mozc::ReadEmoticonTsv(absl::GetFlag(FLAGS_input));
   mozc::SerializedDictionary::CompileToFiles(
       input_data, absl::GetFlag(FLAGS_output_token_array),
-      absl::GetFlag(FLAGS_output_string_array));
+      absl::GetFlag(FLAGS_output_string_array),
+      absl::GetFlag(FLAGS_output_index));
   return 0;
 }
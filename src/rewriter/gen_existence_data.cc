@@ -46,15 +46,20 @@ namespace mozc {
 namespace {
 
 using ::mozc::storage::ExistenceFilterBuilder;
+using ::mozc::storage::ExistenceFilterParams;
 
 std::string GenExistenceData(const absl::Span<const std::string> entries,
                              double error_rate) {
   const int n = entries.size();
-  const int m =
-      ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(error_rate, n);
+  const int m = ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
+      error_rate, n, ExistenceFilterParams::BLOCKED);
   LOG(INFO) << "entry: " << n << " err: " << error_rate << " bytes: " << m;
 
-  ExistenceFilterBuilder builder(ExistenceFilterBuilder::CreateOptimal(m, n));
+  // The filters are probed for every pair of candidates, so the blocked
+  // layout is used to make each probe touch only one cache line.
+  ExistenceFilterBuilder builder(ExistenceFilterBuilder::CreateOptimal(
+      m, n, ExistenceFilterParams::kDefaultFpType,
+      ExistenceFilterParams::BLOCKED));
 
   for (absl::string_view entry : entries) {
     builder.Insert(entry);
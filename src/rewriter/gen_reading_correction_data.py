@@ -36,6 +36,7 @@ Usage:
     --output_value_array=value_array.data
     --output_error_array=error_array.data
     --output_correction_array=correction_array.data
+    --output_index=index.data
 """
 
 
@@ -43,6 +44,7 @@ import codecs
 import optparse
 
 from build_tools import code_generator_util
+from build_tools import perfect_hash_index_builder
 from build_tools import serialized_string_array_builder
 
 
@@ -65,6 +67,11 @@ def ParseOptions():
       dest='output_correction_array',
       help='Output serialized string array for corrections.',
   )
+  parser.add_option(
+      '--output_index',
+      dest='output_index',
+      help='Output perfect hash index for errors (optional).',
+  )
   return parser.parse_args()[0]
 
 
@@ -73,6 +80,7 @@ def WriteData(
     output_value_array_path,
     output_error_array_path,
     output_correction_array_path,
+    output_index_path=None,
 ):
   outputs = []
   with codecs.open(input_path, 'r', encoding='utf-8') as input_stream:
@@ -98,6 +106,10 @@ def WriteData(
       [correction for (_, _, correction) in outputs],
       output_correction_array_path,
   )
+  if output_index_path:
+    perfect_hash_index_builder.BuildToFile(
+        [error for (_, error, _) in outputs], output_index_path
+    )
 
 
 def main():
@@ -107,6 +119,7 @@ def main():
       options.output_value_array,
       options.output_error_array,
       options.output_correction_array,
+      options.output_index,
   )
 
 
@@ -41,6 +41,8 @@ ABSL_FLAG(std::string, output_token_array, "",
           "Output token array of noun prefix dictionary");
 ABSL_FLAG(std::string, output_string_array, "",
           "Output string array of noun prefix dictionary");
+ABSL_FLAG(std::string, output_index, "",
+          "Output perfect hash index of noun prefix dictionary (optional)");
 
 namespace {
 
@@ -102,6 +104,7 @@ int main(int argc, char** argv) {
   }
   mozc::SerializedDictionary::CompileToFiles(
       tokens, absl::GetFlag(FLAGS_output_token_array),
-      absl::GetFlag(FLAGS_output_string_array));
+      absl::GetFlag(FLAGS_output_string_array),
+      absl::GetFlag(FLAGS_output_index));
   return 0;
 }
@@ -0,0 +1,207 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "rewriter/merger_rewriter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "base/trace.h"
+#include "converter/segments.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+#include "request/conversion_request.h"
+#include "rewriter/rewriter_interface.h"
+
+namespace mozc {
+namespace {
+
+// An entry is evicted when the cache exceeds this size. Practically, the
+// number of distinct keys is small.
+constexpr size_t kMaxPlanCacheSize = 32;
+
+RewriterInterface::CapabilityType GetCapabilityType(
+    const ConversionRequest& request) {
+  switch (request.request_type()) {
+    case ConversionRequest::CONVERSION:
+      return RewriterInterface::CONVERSION;
+    case ConversionRequest::PREDICTION:
+    case ConversionRequest::PARTIAL_PREDICTION:
+      return RewriterInterface::PREDICTION;
+    case ConversionRequest::SUGGESTION:
+    case ConversionRequest::PARTIAL_SUGGESTION:
+      return RewriterInterface::SUGGESTION;
+    case ConversionRequest::REVERSE_CONVERSION:
+    default:
+      return RewriterInterface::NOT_AVAILABLE;
+  }
+}
+
+}  // namespace
+
+void MergerRewriter::AddRewriter(std::unique_ptr<RewriterInterface> rewriter,
+                                 absl::string_view name) {
+  DCHECK(rewriter);
+  rewriters_.push_back(std::move(rewriter));
+  rewriter_names_.push_back(name);
+
+  absl::MutexLock lock(mutex_);
+  stats_.push_back(RewriterStats{.name = name});
+  // Existing plans don't contain the new rewriter.
+  plans_.clear();
+}
+
+std::shared_ptr<const MergerRewriter::RewritePlan> MergerRewriter::GetPlan(
+    const ConversionRequest& request, CapabilityType capability_type) const {
+  const commands::Request& request_proto = request.request();
+  const config::Config& config = request.config();
+  const PlanKey key = {
+      .capability_type = capability_type,
+      .mixed_conversion = request_proto.mixed_conversion(),
+      .emoji_rewriter_capability = request_proto.emoji_rewriter_capability(),
+      .is_a11y_talkback_enabled = request_proto.is_a11y_talkback_enabled(),
+      .enable_a11y_description = request_proto.enable_a11y_description(),
+      .language_aware_input = request_proto.language_aware_input(),
+      .special_romanji_table = request_proto.special_romanji_table(),
+      .preedit_method = config.preedit_method(),
+      .use_spelling_correction = config.use_spelling_correction(),
+  };
+  {
+    absl::ReaderMutexLock lock(mutex_);
+    if (const auto it = plans_.find(key); it != plans_.end()) {
+      num_plan_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+      return it->second;
+    }
+  }
+
+  auto plan = std::make_shared<RewritePlan>();
+  for (size_t i = 0; i < rewriters_.size(); ++i) {
+    if (rewriters_[i]->capability(request) & capability_type) {
+      plan->push_back(i);
+    }
+  }
+
+  absl::MutexLock lock(mutex_);
+  ++num_plan_cache_misses_;
+  if (plans_.size() >= kMaxPlanCacheSize) {
+    plans_.erase(plans_.begin());
+  }
+  plans_.emplace(key, plan);
+  return plan;
+}
+
+void MergerRewriter::ClearPlans() {
+  absl::MutexLock lock(mutex_);
+  plans_.clear();
+}
+
+bool MergerRewriter::Rewrite(const ConversionRequest& request,
+                             Segments* segments) const {
+  if (segments == nullptr) {
+    return false;
+  }
+
+  MOZC_TRACE_SPAN("MergerRewriter::Rewrite");
+  const CapabilityType capability_type = GetCapabilityType(request);
+  bool is_updated = false;
+  if (capability_type != NOT_AVAILABLE) {
+    const std::shared_ptr<const RewritePlan> plan =
+        GetPlan(request, capability_type);
+    if (collect_stats_.load(std::memory_order_relaxed)) {
+      // Measures locally and merges them at once to lock the mutex only once.
+      std::vector<std::pair<bool, absl::Duration>> costs;
+      costs.reserve(plan->size());
+      for (const size_t i : *plan) {
+        MOZC_TRACE_SPAN(rewriter_names_[i]);
+        const absl::Time start = absl::Now();
+        const bool updated = rewriters_[i]->Rewrite(request, segments);
+        costs.emplace_back(updated, absl::Now() - start);
+        is_updated |= updated;
+      }
+      absl::MutexLock lock(mutex_);
+      for (size_t j = 0; j < plan->size(); ++j) {
+        RewriterStats& stats = stats_[(*plan)[j]];
+        ++stats.num_calls;
+        stats.num_updates += costs[j].first ? 1 : 0;
+        stats.total_time += costs[j].second;
+      }
+    } else {
+      for (const size_t i : *plan) {
+        MOZC_TRACE_SPAN(rewriter_names_[i]);
+        is_updated |= rewriters_[i]->Rewrite(request, segments);
+      }
+    }
+  }
+
+  if (request.request_type() == ConversionRequest::SUGGESTION &&
+      segments->conversion_segments_size() == 1 &&
+      !request.request().mixed_conversion()) {
+    const size_t max_suggestions = request.config().suggestions_size();
+    Segment* segment = segments->mutable_conversion_segment(0);
+    const size_t candidate_size = segment->candidates_size();
+    if (candidate_size > max_suggestions) {
+      segment->erase_candidates(max_suggestions,
+                                candidate_size - max_suggestions);
+    }
+  }
+  return is_updated;
+}
+
+std::vector<MergerRewriter::RewriterStats> MergerRewriter::GetRewriterStats()
+    const {
+  absl::MutexLock lock(mutex_);
+  return stats_;
+}
+
+MergerRewriter::PlanCacheStats MergerRewriter::GetPlanCacheStats() const {
+  absl::MutexLock lock(mutex_);
+  return PlanCacheStats{
+      .num_hits = num_plan_cache_hits_.load(std::memory_order_relaxed),
+      .num_misses = num_plan_cache_misses_,
+  };
+}
+
+void MergerRewriter::ResetStats() {
+  absl::MutexLock lock(mutex_);
+  for (RewriterStats& stats : stats_) {
+    stats = RewriterStats{.name = stats.name};
+  }
+  num_plan_cache_hits_.store(0, std::memory_order_relaxed);
+  num_plan_cache_misses_ = 0;
+}
+
+}  // namespace mozc
@@ -30,13 +30,21 @@
 #ifndef MOZC_REWRITER_MERGER_REWRITER_H_
 #define MOZC_REWRITER_MERGER_REWRITER_H_
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "base/memory_usage.h"
 #include "converter/segments.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
@@ -47,16 +55,31 @@ namespace mozc {
 
 class MergerRewriter : public RewriterInterface {
  public:
+  // Cumulative cost of a rewriter. Collected only when collect_stats is set.
+  struct RewriterStats {
+    absl::string_view name;
+    // Number of Rewrite() calls.
+    uint64_t num_calls = 0;
+    // Number of Rewrite() calls which updated the segments.
+    uint64_t num_updates = 0;
+    absl::Duration total_time = absl::ZeroDuration();
+  };
+
+  struct PlanCacheStats {
+    uint64_t num_hits = 0;
+    uint64_t num_misses = 0;
+  };
+
   MergerRewriter() = default;
   ~MergerRewriter() override = default;
 
   MergerRewriter(const MergerRewriter&) = delete;
   MergerRewriter& operator=(const MergerRewriter&) = delete;
 
-  void AddRewriter(std::unique_ptr<RewriterInterface> rewriter) {
-    DCHECK(rewriter);
-    rewriters_.push_back(std::move(rewriter));
-  }
+  // `name` is used to identify the rewriter in traces and stats. It must
+  // outlive this object, e.g. a string literal.
+  void AddRewriter(std::unique_ptr<RewriterInterface> rewriter,
+                   absl::string_view name = "Rewriter");
 
   std::optional<ResizeSegmentsRequest> CheckResizeSegmentsRequest(
       const ConversionRequest& request, const Segments& segments) const {
@@ -74,48 +97,11 @@ class MergerRewriter : public RewriterInterface {
     return std::nullopt;
   }
 
+  // Calls the rewriters whose capability matches the request type. The list
+  // of the applicable rewriters (rewrite plan) is compiled once for each
+  // PlanKey and cached.
   bool Rewrite(const ConversionRequest& request,
-               Segments* segments) const override {
-    if (segments == nullptr) {
-      return false;
-    }
-
-    const CapabilityType capability_type = [&request]() {
-      switch (request.request_type()) {
-        case ConversionRequest::CONVERSION:
-          return RewriterInterface::CONVERSION;
-        case ConversionRequest::PREDICTION:
-        case ConversionRequest::PARTIAL_PREDICTION:
-          return RewriterInterface::PREDICTION;
-        case ConversionRequest::SUGGESTION:
-        case ConversionRequest::PARTIAL_SUGGESTION:
-          return RewriterInterface::SUGGESTION;
-        case ConversionRequest::REVERSE_CONVERSION:
-        default:
-          return RewriterInterface::NOT_AVAILABLE;
-      }
-    }();
-
-    bool is_updated = false;
-    for (const std::unique_ptr<RewriterInterface>& rewriter : rewriters_) {
-      if (rewriter->capability(request) & capability_type) {
-        is_updated |= rewriter->Rewrite(request, segments);
-      }
-    }
-
-    if (request.request_type() == ConversionRequest::SUGGESTION &&
-        segments->conversion_segments_size() == 1 &&
-        !request.request().mixed_conversion()) {
-      const size_t max_suggestions = request.config().suggestions_size();
-      Segment* segment = segments->mutable_conversion_segment(0);
-      const size_t candidate_size = segment->candidates_size();
-      if (candidate_size > max_suggestions) {
-        segment->erase_candidates(max_suggestions,
-                                  candidate_size - max_suggestions);
-      }
-    }
-    return is_updated;
-  }
+               Segments* segments) const override;
 
   // This method is mainly called when user puts SPACE key
   // and changes the focused candidate.
@@ -166,6 +152,7 @@ class MergerRewriter : public RewriterInterface {
 
   // Reloads internal data from local file system.
   bool Reload() override {
+    ClearPlans();
     bool result = false;
     for (const std::unique_ptr<RewriterInterface>& rewriter : rewriters_) {
       result |= rewriter->Reload();
@@ -175,13 +162,75 @@ class MergerRewriter : public RewriterInterface {
 
   // Clears internal data
   void Clear() override {
+    ClearPlans();
     for (const std::unique_ptr<RewriterInterface>& rewriter : rewriters_) {
       rewriter->Clear();
     }
   }
 
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override {
+    for (const std::unique_ptr<RewriterInterface>& rewriter : rewriters_) {
+      rewriter->CollectMemoryUsage(collector);
+    }
+  }
+
+  // Enables the per-rewriter cost accounting. It is disabled by default as it
+  // reads the clock twice per rewriter.
+  void set_collect_stats(bool collect_stats) {
+    collect_stats_.store(collect_stats, std::memory_order_relaxed);
+  }
+
+  // Returns the stats in the order of AddRewriter() calls.
+  std::vector<RewriterStats> GetRewriterStats() const;
+  PlanCacheStats GetPlanCacheStats() const;
+  void ResetStats();
+
  private:
+  // Indices of rewriters_ to be called.
+  using RewritePlan = std::vector<size_t>;
+
+  // The fields of the request which capability() of the rewriters reads.
+  struct PlanKey {
+    CapabilityType capability_type;
+    bool mixed_conversion;
+    int emoji_rewriter_capability;
+    bool is_a11y_talkback_enabled;
+    bool enable_a11y_description;
+    int language_aware_input;
+    int special_romanji_table;
+    int preedit_method;
+    bool use_spelling_correction;
+
+    friend bool operator==(const PlanKey&, const PlanKey&) = default;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const PlanKey& key) {
+      return H::combine(std::move(h), key.capability_type,
+                        key.mixed_conversion, key.emoji_rewriter_capability,
+                        key.is_a11y_talkback_enabled,
+                        key.enable_a11y_description, key.language_aware_input,
+                        key.special_romanji_table, key.preedit_method,
+                        key.use_spelling_correction);
+    }
+  };
+
+  // Returns the cached plan or compiles a new one.
+  std::shared_ptr<const RewritePlan> GetPlan(
+      const ConversionRequest& request, CapabilityType capability_type) const;
+  void ClearPlans();
+
   std::vector<std::unique_ptr<RewriterInterface>> rewriters_;
+  // Parallel to rewriters_.
+  std::vector<absl::string_view> rewriter_names_;
+  std::atomic<bool> collect_stats_ = false;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<PlanKey, std::shared_ptr<const RewritePlan>>
+      plans_ ABSL_GUARDED_BY(mutex_);
+  mutable std::vector<RewriterStats> stats_ ABSL_GUARDED_BY(mutex_);
+  // Hits are counted under the reader lock.
+  mutable std::atomic<uint64_t> num_plan_cache_hits_ = 0;
+  mutable uint64_t num_plan_cache_misses_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace mozc
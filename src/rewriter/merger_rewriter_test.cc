@@ -32,6 +32,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "converter/segments.h"
@@ -109,6 +110,28 @@ class TestRewriter : public RewriterInterface {
   int capability_;
 };
 
+// Counts capability() calls. Available for all types only in mixed conversion.
+class CapabilityCountingRewriter : public RewriterInterface {
+ public:
+  CapabilityCountingRewriter(int* capability_count, bool return_value)
+      : capability_count_(capability_count), return_value_(return_value) {}
+
+  int capability(const ConversionRequest& request) const override {
+    ++*capability_count_;
+    return request.request().mixed_conversion() ? RewriterInterface::ALL
+                                                : RewriterInterface::CONVERSION;
+  }
+
+  bool Rewrite(const ConversionRequest& request,
+               Segments* segments) const override {
+    return return_value_;
+  }
+
+ private:
+  int* capability_count_;
+  bool return_value_;
+};
+
 class MergerRewriterTest : public testing::TestWithTempUserProfile {};
 
 ConversionRequest ConvReq(ConversionRequest::RequestType request_type) {
@@ -379,5 +402,105 @@ TEST_F(MergerRewriterTest, Clear) {
             "d.Clear();");
 }
 
+TEST_F(MergerRewriterTest, RewritePlanIsCached) {
+  int capability_count = 0;
+  MergerRewriter merger;
+  merger.AddRewriter(
+      std::make_unique<CapabilityCountingRewriter>(&capability_count, true),
+      "a");
+  merger.AddRewriter(
+      std::make_unique<CapabilityCountingRewriter>(&capability_count, false),
+      "b");
+  Segments segments;
+
+  const ConversionRequest conversion = ConvReq(ConversionRequest::CONVERSION);
+  EXPECT_TRUE(merger.Rewrite(conversion, &segments));
+  EXPECT_EQ(capability_count, 2);
+  EXPECT_TRUE(merger.Rewrite(conversion, &segments));
+  EXPECT_EQ(capability_count, 2);
+
+  // Another request type compiles another plan.
+  const ConversionRequest prediction = ConvReq(ConversionRequest::PREDICTION);
+  EXPECT_FALSE(merger.Rewrite(prediction, &segments));
+  EXPECT_EQ(capability_count, 4);
+  EXPECT_FALSE(merger.Rewrite(prediction, &segments));
+  EXPECT_EQ(capability_count, 4);
+
+  // A different request also compiles another plan.
+  commands::Request mixed_conversion;
+  mixed_conversion.set_mixed_conversion(true);
+  const ConversionRequest mixed_prediction =
+      ConversionRequestBuilder()
+          .SetRequestView(mixed_conversion)
+          .SetRequestType(ConversionRequest::PREDICTION)
+          .Build();
+  EXPECT_TRUE(merger.Rewrite(mixed_prediction, &segments));
+  EXPECT_EQ(capability_count, 6);
+
+  // Requests with the same fields share the plan even if they are different
+  // objects.
+  const commands::Request mixed_conversion_copy = mixed_conversion;
+  const ConversionRequest mixed_prediction2 =
+      ConversionRequestBuilder()
+          .SetRequestView(mixed_conversion_copy)
+          .SetRequestType(ConversionRequest::PREDICTION)
+          .Build();
+  EXPECT_TRUE(merger.Rewrite(mixed_prediction2, &segments));
+  EXPECT_EQ(capability_count, 6);
+
+  const MergerRewriter::PlanCacheStats plan_cache_stats =
+      merger.GetPlanCacheStats();
+  EXPECT_EQ(plan_cache_stats.num_hits, 3);
+  EXPECT_EQ(plan_cache_stats.num_misses, 3);
+
+  // Modifying the request in place selects another plan.
+  mixed_conversion.set_mixed_conversion(false);
+  EXPECT_FALSE(merger.Rewrite(mixed_prediction, &segments));
+  mixed_conversion.set_mixed_conversion(true);
+  EXPECT_TRUE(merger.Rewrite(mixed_prediction, &segments));
+  EXPECT_EQ(capability_count, 6);
+
+  // Reload invalidates the plans.
+  merger.Reload();
+  EXPECT_TRUE(merger.Rewrite(conversion, &segments));
+  EXPECT_EQ(capability_count, 8);
+}
+
+TEST_F(MergerRewriterTest, RewriterStats) {
+  int capability_count = 0;
+  MergerRewriter merger;
+  merger.set_collect_stats(true);
+  merger.AddRewriter(
+      std::make_unique<CapabilityCountingRewriter>(&capability_count, true),
+      "a");
+  merger.AddRewriter(
+      std::make_unique<CapabilityCountingRewriter>(&capability_count, false),
+      "b");
+  Segments segments;
+
+  const ConversionRequest conversion = ConvReq(ConversionRequest::CONVERSION);
+  EXPECT_TRUE(merger.Rewrite(conversion, &segments));
+  EXPECT_TRUE(merger.Rewrite(conversion, &segments));
+  // Not applicable.
+  EXPECT_FALSE(
+      merger.Rewrite(ConvReq(ConversionRequest::SUGGESTION), &segments));
+
+  std::vector<MergerRewriter::RewriterStats> stats = merger.GetRewriterStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].name, "a");
+  EXPECT_EQ(stats[0].num_calls, 2);
+  EXPECT_EQ(stats[0].num_updates, 2);
+  EXPECT_EQ(stats[1].name, "b");
+  EXPECT_EQ(stats[1].num_calls, 2);
+  EXPECT_EQ(stats[1].num_updates, 0);
+
+  merger.ResetStats();
+  stats = merger.GetRewriterStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].name, "a");
+  EXPECT_EQ(stats[0].num_calls, 0);
+  EXPECT_EQ(merger.GetPlanCacheStats().num_hits, 0);
+}
+
 }  // namespace
 }  // namespace mozc
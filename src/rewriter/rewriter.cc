@@ -32,6 +32,7 @@
 #include <memory>
 
 #include "absl/flags/flag.h"
+#include "absl/log/log.h"
 #include "base/container/tuple.h"
 #include "data_manager/data_manager.h"
 #include "dictionary/dictionary_interface.h"
@@ -126,9 +127,15 @@ ABSL_FLAG(bool, use_history_rewriter, true, "Use history rewriter or not.");
 ABSL_FLAG(bool, use_history_rewriter, false, "Use history rewriter or not.");
 #endif  // MOZC_USER_HISTORY_REWRITER
 
+ABSL_FLAG(bool, rewriter_stats, false,
+          "Collect the cumulative cost of each rewriter and log it when the "
+          "rewriter is destroyed.");
+
 namespace mozc {
 
 Rewriter::Rewriter(const engine::Modules& modules) {
+  set_collect_stats(absl::GetFlag(FLAGS_rewriter_stats));
+
   const DataManager& data_manager = modules.GetDataManager();
   const dictionary::DictionaryInterface& dictionary = modules.GetDictionary();
   const dictionary::PosMatcher& pos_matcher = modules.GetPosMatcher();
@@ -137,66 +144,106 @@ Rewriter::Rewriter(const engine::Modules& modules) {
       modules.GetSingleKanjiDictionary();
 
 #ifdef MOZC_USER_DICTIONARY_REWRITER
-  AddRewriter(std::make_unique<UserDictionaryRewriter>());
+  AddRewriter(std::make_unique<UserDictionaryRewriter>(),
+              "UserDictionaryRewriter");
 #endif  // MOZC_USER_DICTIONARY_REWRITER
 
   AddRewriter(make_unique_from_tuples<FocusCandidateRewriter>(
-      data_manager.GetCounterSuffixSortedArray(), pos_matcher));
-  AddRewriter(std::make_unique<LanguageAwareRewriter>(pos_matcher, dictionary));
-  AddRewriter(std::make_unique<TransliterationRewriter>(pos_matcher));
-  AddRewriter(std::make_unique<EnglishVariantsRewriter>(pos_matcher));
+                  data_manager.GetCounterSuffixSortedArray(), pos_matcher),
+              "FocusCandidateRewriter");
+  AddRewriter(std::make_unique<LanguageAwareRewriter>(pos_matcher, dictionary),
+              "LanguageAwareRewriter");
+  AddRewriter(std::make_unique<TransliterationRewriter>(pos_matcher),
+              "TransliterationRewriter");
+  AddRewriter(std::make_unique<EnglishVariantsRewriter>(pos_matcher),
+              "EnglishVariantsRewriter");
   AddRewriter(make_unique_from_tuples<NumberRewriter>(
-      data_manager.GetCounterSuffixSortedArray(), pos_matcher));
+                  data_manager.GetCounterSuffixSortedArray(), pos_matcher),
+              "NumberRewriter");
   AddRewriter(apply_from_tuples(CollocationRewriter::Create, pos_matcher,
-                                data_manager.GetCollocationData()));
+                                data_manager.GetCollocationData()),
+              "CollocationRewriter");
   AddRewriter(std::make_unique<SingleKanjiRewriter>(pos_matcher,
-                                                    single_kanji_dictionary));
-  AddRewriter(std::make_unique<IvsVariantsRewriter>());
+                                                    single_kanji_dictionary),
+              "SingleKanjiRewriter");
+  AddRewriter(std::make_unique<IvsVariantsRewriter>(), "IvsVariantsRewriter");
   AddRewriter(make_unique_from_tuples<EmoticonRewriter>(
-      data_manager.GetEmoticonRewriterData()));
+                  data_manager.GetEmoticonRewriterData(),
+                  data_manager.GetLookupIndexData("emoticon")),
+              "EmoticonRewriter");
   AddRewriter(make_unique_from_tuples<EmojiRewriter>(
-      data_manager.GetEmojiRewriterData()));
-  AddRewriter(std::make_unique<CalculatorRewriter>());
+                  data_manager.GetEmojiRewriterData(),
+                  data_manager.GetLookupIndexData("emoji")),
+              "EmojiRewriter");
+  AddRewriter(std::make_unique<CalculatorRewriter>(), "CalculatorRewriter");
   AddRewriter(make_unique_from_tuples<SymbolRewriter>(
-      data_manager.GetSymbolRewriterData()));
-  AddRewriter(std::make_unique<UnicodeRewriter>());
-  AddRewriter(std::make_unique<VariantsRewriter>(pos_matcher));
-  AddRewriter(std::make_unique<ZipcodeRewriter>(pos_matcher));
-  AddRewriter(std::make_unique<DiceRewriter>());
-  AddRewriter(std::make_unique<SmallLetterRewriter>());
+                  data_manager.GetSymbolRewriterData()),
+              "SymbolRewriter");
+  AddRewriter(std::make_unique<UnicodeRewriter>(), "UnicodeRewriter");
+  AddRewriter(std::make_unique<VariantsRewriter>(pos_matcher),
+              "VariantsRewriter");
+  AddRewriter(std::make_unique<ZipcodeRewriter>(pos_matcher),
+              "ZipcodeRewriter");
+  AddRewriter(std::make_unique<DiceRewriter>(), "DiceRewriter");
+  AddRewriter(std::make_unique<SmallLetterRewriter>(), "SmallLetterRewriter");
 
   if (absl::GetFlag(FLAGS_use_history_rewriter)) {
-    AddRewriter(std::make_unique<UserBoundaryHistoryRewriter>());
+    AddRewriter(std::make_unique<UserBoundaryHistoryRewriter>(),
+                "UserBoundaryHistoryRewriter");
     AddRewriter(
-        std::make_unique<UserSegmentHistoryRewriter>(pos_matcher, pos_group));
+        std::make_unique<UserSegmentHistoryRewriter>(pos_matcher, pos_group),
+        "UserSegmentHistoryRewriter");
   }
 
 #ifdef MOZC_DATE_REWRITER
-  AddRewriter(std::make_unique<DateRewriter>(dictionary));
+  AddRewriter(std::make_unique<DateRewriter>(dictionary), "DateRewriter");
 #endif  // MOZC_DATE_REWRITER
 
 #ifdef MOZC_FORTUNE_REWRITER
-  AddRewriter(std::make_unique<FortuneRewriter>());
+  AddRewriter(std::make_unique<FortuneRewriter>(), "FortuneRewriter");
 #endif  // MOZC_FORTUNE_REWRITER
 
 #ifdef MOZC_COMMAND_REWRITER
-  AddRewriter(std::make_unique<CommandRewriter>());
+  AddRewriter(std::make_unique<CommandRewriter>(), "CommandRewriter");
 #endif  // MOZC_COMMAND_REWRITER
 
 #ifdef MOZC_USAGE_REWRITER
   AddRewriter(make_unique_from_tuples<UsageRewriter>(
-      data_manager.GetUsageRewriterData(), dictionary, pos_matcher));
+                  data_manager.GetUsageRewriterData(), dictionary, pos_matcher),
+              "UsageRewriter");
 #endif  // MOZC_USAGE_REWRITER
 
-  AddRewriter(std::make_unique<VersionRewriter>(data_manager.GetDataVersion()));
+  AddRewriter(std::make_unique<VersionRewriter>(data_manager.GetDataVersion()),
+              "VersionRewriter");
   AddRewriter(make_unique_from_tuples<CorrectionRewriter>(
-      modules, data_manager.GetReadingCorrectionData()));
-  AddRewriter(std::make_unique<T13nPromotionRewriter>());
+                  modules, data_manager.GetReadingCorrectionData(),
+                  data_manager.GetLookupIndexData("reading_correction")),
+              "CorrectionRewriter");
+  AddRewriter(std::make_unique<T13nPromotionRewriter>(),
+              "T13nPromotionRewriter");
   AddRewriter(make_unique_from_tuples<EnvironmentalFilterRewriter>(
-      data_manager.GetEmojiRewriterData()));
-  AddRewriter(std::make_unique<RemoveRedundantCandidateRewriter>());
+                  data_manager.GetEmojiRewriterData()),
+              "EnvironmentalFilterRewriter");
+  AddRewriter(std::make_unique<RemoveRedundantCandidateRewriter>(),
+              "RemoveRedundantCandidateRewriter");
   AddRewriter(make_unique_from_tuples<A11yDescriptionRewriter>(
-      data_manager.GetA11yDescriptionRewriterData()));
+                  data_manager.GetA11yDescriptionRewriterData(),
+                  data_manager.GetLookupIndexData("a11y_description")),
+              "A11yDescriptionRewriter");
+}
+
+Rewriter::~Rewriter() {
+  if (!absl::GetFlag(FLAGS_rewriter_stats)) {
+    return;
+  }
+  const PlanCacheStats plan_cache_stats = GetPlanCacheStats();
+  LOG(INFO) << "Rewrite plan cache: hits=" << plan_cache_stats.num_hits
+            << " misses=" << plan_cache_stats.num_misses;
+  for (const RewriterStats& stats : GetRewriterStats()) {
+    LOG(INFO) << stats.name << ": calls=" << stats.num_calls
+              << " updates=" << stats.num_updates
+              << " total_time=" << stats.total_time;
+  }
 }
 
 }  // namespace mozc
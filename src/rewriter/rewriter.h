@@ -40,6 +40,7 @@ class Rewriter : public MergerRewriter {
   explicit Rewriter(const engine::Modules& modules);
   Rewriter(const Rewriter&) = delete;
   Rewriter& operator=(const Rewriter&) = delete;
+  ~Rewriter() override;
 };
 
 }  // namespace mozc
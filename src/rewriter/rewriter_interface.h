@@ -35,6 +35,7 @@
 #include <cstdint>
 #include <optional>
 
+#include "base/memory_usage.h"
 #include "converter/segments.h"
 #include "request/conversion_request.h"
 
@@ -55,6 +56,9 @@ class RewriterInterface {
   // Returns capability of this rewriter.
   // If (capability() & CONVERSION), this rewriter
   // is called after StartConversion().
+  // MergerRewriter caches the result for the fields in
+  // MergerRewriter::PlanKey. Add the field to PlanKey when the result depends
+  // on another field of request.request() or request.config().
   virtual int capability(const ConversionRequest& request) const {
     return CONVERSION;
   }
@@ -121,6 +125,9 @@ class RewriterInterface {
   // on settings UI.
   virtual void Clear() {}
 
+  // Reports the memory used by the learning data of this rewriter.
+  virtual void CollectMemoryUsage(MemoryUsageCollector& collector) const {}
+
   // We plan to deprecate the following rewriters in the future, as equivalent
   // functionalities have already been implemented. To experimentally disable
   // them, we will use the disable_legacy_rewriter_mode mendel flag to suppress
@@ -215,7 +215,7 @@ UserBoundaryHistoryRewriter::CheckResizeSegmentsRequest(
     return std::nullopt;
   }
 
-  if (request.options().skip_slow_rewriters) {
+  if (request.options().skip_slow_rewriters || request.IsDeadlineExceeded()) {
     return std::nullopt;
   }
 
@@ -345,4 +345,12 @@ void UserBoundaryHistoryRewriter::Clear() {
   storage_.Clear();
 }
 
+void UserBoundaryHistoryRewriter::CollectMemoryUsage(
+    MemoryUsageCollector& collector) const {
+  collector.AddMapped("rewriter.user_boundary_history",
+                      storage_.mapped_region());
+  collector.AddHeap("rewriter.user_boundary_history.index",
+                    storage_.GetIndexMemoryUsage());
+}
+
 }  // namespace mozc
@@ -32,6 +32,7 @@
 
 #include <optional>
 
+#include "base/memory_usage.h"
 #include "converter/segments.h"
 #include "request/conversion_request.h"
 #include "rewriter/rewriter_interface.h"
@@ -56,6 +57,7 @@ class UserBoundaryHistoryRewriter : public RewriterInterface {
   bool Sync() override;
   bool Reload() override;
   void Clear() override;
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
 
  private:
   bool Insert(const ConversionRequest& request, const Segments& segments);
@@ -1018,6 +1018,18 @@ void UserSegmentHistoryRewriter::Clear() {
   }
 }
 
+void UserSegmentHistoryRewriter::CollectMemoryUsage(
+    MemoryUsageCollector& collector) const {
+  if (storage_ != nullptr) {
+    collector.AddMapped("rewriter.user_segment_history",
+                        storage_->mapped_region());
+    collector.AddHeap("rewriter.user_segment_history.index",
+                      storage_->GetIndexMemoryUsage());
+  }
+  collector.AddHeap("rewriter.user_segment_history.revert_cache",
+                    revert_cache_.GetMemoryUsage());
+}
+
 void UserSegmentHistoryRewriter::Revert(const Segments& segments) {
   const std::vector<std::string>* revert_entries =
       revert_cache_.LookupWithoutInsert(segments.revert_id());
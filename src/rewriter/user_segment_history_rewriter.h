@@ -39,6 +39,7 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/memory_usage.h"
 #include "converter/candidate.h"
 #include "converter/segments.h"
 #include "dictionary/pos_group.h"
@@ -64,6 +65,7 @@ class UserSegmentHistoryRewriter : public RewriterInterface {
   bool Reload() override;
   void Clear() override;
   void Revert(const Segments& segments) override;
+  void CollectMemoryUsage(MemoryUsageCollector& collector) const override;
   bool ClearHistoryEntry(const Segments& segments, size_t segment_index,
                          int candidate_index) override;
 
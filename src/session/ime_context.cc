@@ -32,12 +32,12 @@
 
 #include "session/ime_context.h"
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 
 #include "absl/base/no_destructor.h"
 #include "absl/log/check.h"
-#include "absl/memory/memory.h"
 #include "absl/time/time.h"
 #include "composer/composer.h"
 #include "composer/table.h"
@@ -64,8 +64,10 @@ ImeContext::CopyableData::CopyableData()
       request(composer::GetSharedDefaultRequest()),
       config(config::ConfigHandler::GetSharedDefaultConfig()),
       key_map_manager(GetSharedDefaultKeyMapManager()),
-      composer(composer::Table::GetSharedDefaultTable(), request, config),
-      state(NONE) {
+      composer(std::make_shared<composer::Composer>(
+          composer::Table::GetSharedDefaultTable(), request, config)),
+      state(NONE),
+      output(std::make_shared<commands::Output>()) {
   DCHECK(request);
   DCHECK(config);
   DCHECK(key_map_manager);
@@ -76,9 +78,22 @@ ImeContext::ImeContext(
     std::unique_ptr<engine::EngineConverterInterface> converter)
     : converter_(std::move(converter)) {}
 
-ImeContext::ImeContext(const ImeContext& src) : data_(src.data_) {
-  if (src.converter_) {
-    converter_ = absl::WrapUnique(src.converter().Clone());
+ImeContext::ImeContext(const ImeContext& src)
+    : data_(src.data_), converter_(src.converter_) {}
+
+engine::EngineConverterInterface* ImeContext::mutable_converter() {
+  if (converter_.use_count() > 1) {
+    converter_.reset(converter_->Clone());
+  }
+  return converter_.get();
+}
+
+void ImeContext::ResetComposer() {
+  if (data_.composer.use_count() > 1) {
+    data_.composer = std::make_shared<composer::Composer>(
+        data_.composer->CreateResetComposer());
+  } else {
+    data_.composer->Reset();
   }
 }
 
@@ -86,9 +101,9 @@ void ImeContext::SetRequest(std::shared_ptr<const commands::Request> request) {
   DCHECK(request);
   data_.request = std::move(request);
   if (converter_) {
-    converter_->SetRequest(data_.request);
+    mutable_converter()->SetRequest(data_.request);
   }
-  data_.composer.SetRequest(data_.request);
+  mutable_composer()->SetRequest(data_.request);
 }
 
 const commands::Request& ImeContext::GetRequest() const {
@@ -100,10 +115,10 @@ void ImeContext::SetConfig(std::shared_ptr<const config::Config> config) {
   data_.config = std::move(config);
 
   if (converter_) {
-    converter_->SetConfig(data_.config);
+    mutable_converter()->SetConfig(data_.config);
   }
 
-  data_.composer.SetConfig(data_.config);
+  mutable_composer()->SetConfig(data_.config);
   data_.key_event_transformer.ReloadConfig(*data_.config);
 }
 
@@ -118,5 +133,20 @@ void ImeContext::SetKeyMapManager(
 const keymap::KeyMapManager& ImeContext::GetKeyMapManager() const {
   return *data_.key_map_manager;
 }
+
+size_t ImeContext::GetMemoryUsage() const {
+  size_t bytes = sizeof(*this);
+  if (data_.composer) {
+    bytes += sizeof(composer::Composer) / data_.composer.use_count();
+  }
+  if (data_.output) {
+    bytes += (sizeof(commands::Output) + data_.output->ByteSizeLong()) /
+             data_.output.use_count();
+  }
+  if (converter_) {
+    bytes += converter_->GetMemoryUsage() / converter_.use_count();
+  }
+  return bytes;
+}
 }  // namespace session
 }  // namespace mozc
@@ -33,7 +33,9 @@
 #ifndef MOZC_SESSION_IME_CONTEXT_H_
 #define MOZC_SESSION_IME_CONTEXT_H_
 
+#include <cstddef>
 #include <memory>
+#include <utility>
 
 #include "absl/time/time.h"
 #include "composer/composer.h"
@@ -65,15 +67,19 @@ class ImeContext final {
     data_.last_command_time = last_command_time;
   }
 
-  const composer::Composer& composer() const { return data_.composer; }
-  composer::Composer* mutable_composer() { return &data_.composer; }
+  // The composer, the converter and the last output are shared between
+  // copies of the context (e.g. undo snapshots) until one of the copies asks
+  // for a mutable instance. Prefer the const accessors for read-only access.
+  const composer::Composer& composer() const { return *data_.composer; }
+  composer::Composer* mutable_composer() { return Unshare(&data_.composer); }
+  // Same as mutable_composer()->Reset(), but a shared composer is replaced
+  // without copying its composition.
+  void ResetComposer();
 
   const engine::EngineConverterInterface& converter() const {
     return *converter_;
   }
-  engine::EngineConverterInterface* mutable_converter() {
-    return converter_.get();
-  }
+  engine::EngineConverterInterface* mutable_converter();
 
   const KeyEventTransformer& key_event_transformer() const {
     return data_.key_event_transformer;
@@ -121,8 +127,16 @@ class ImeContext final {
   }
   commands::Context* mutable_client_context() { return &data_.client_context; }
 
-  const commands::Output& output() const { return data_.output; }
-  commands::Output* mutable_output() { return &data_.output; }
+  const commands::Output& output() const { return *data_.output; }
+  commands::Output* mutable_output() { return Unshare(&data_.output); }
+  // Replaces the output without copying the current one.
+  void set_output(commands::Output output) {
+    data_.output = std::make_shared<commands::Output>(std::move(output));
+  }
+
+  // Returns the approximate heap size of this context. The composer, the
+  // converter and the output shared with other copies are divided among them.
+  size_t GetMemoryUsage() const;
 
  private:
   // Separate copyable data and non-copyable data to
@@ -141,7 +155,7 @@ class ImeContext final {
     std::shared_ptr<const config::Config> config;
     std::shared_ptr<const keymap::KeyMapManager> key_map_manager;
 
-    composer::Composer composer;
+    std::shared_ptr<composer::Composer> composer;
     KeyEventTransformer key_event_transformer;
 
     State state;
@@ -151,13 +165,24 @@ class ImeContext final {
 
     // Storing the last output consisting of the last result and the
     // last performed command.
-    commands::Output output;
+    std::shared_ptr<commands::Output> output;
   };
 
+  // Returns a mutable instance of |*ptr|, copying it first if it is shared
+  // with another context.
+  template <typename T>
+  static T* Unshare(std::shared_ptr<T>* ptr) {
+    if (ptr->use_count() > 1) {
+      *ptr = std::make_shared<T>(std::as_const(**ptr));
+    }
+    return ptr->get();
+  }
+
   CopyableData data_;
 
-  // converter_ should explicitly be copied via Clone() method.
-  std::unique_ptr<engine::EngineConverterInterface> converter_;
+  // converter_ should explicitly be copied via Clone() method when it is
+  // shared and a mutable instance is requested.
+  std::shared_ptr<engine::EngineConverterInterface> converter_;
 };
 
 }  // namespace session
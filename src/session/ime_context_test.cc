@@ -31,6 +31,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
@@ -58,6 +59,21 @@ using ::testing::DoAll;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 
+class CloneCountingEngineConverter : public EngineConverter {
+ public:
+  CloneCountingEngineConverter(
+      std::shared_ptr<const ConverterInterface> converter, int* num_clones)
+      : EngineConverter(std::move(converter)), num_clones_(num_clones) {}
+
+  EngineConverter* Clone() const override {
+    ++*num_clones_;
+    return EngineConverter::Clone();
+  }
+
+ private:
+  int* num_clones_;
+};
+
 TEST(ImeContextTest, DefaultValues) {
   ImeContext context;
   EXPECT_EQ(context.create_time(), absl::InfinitePast());
@@ -193,5 +209,81 @@ TEST(ImeContextTest, CopyContext) {
   }
 }
 
+TEST(ImeContextTest, CopyOnWrite) {
+  auto table = std::make_shared<composer::Table>();
+  table->AddRule("a", "あ", "");
+  auto converter = std::make_shared<MockConverter>();
+
+  ImeContext source(std::make_unique<EngineConverter>(converter));
+  source.mutable_composer()->SetTable(table);
+  source.mutable_composer()->InsertCharacter("a");
+  source.mutable_output()->set_id(1);
+
+  const ImeContext snapshot(source);
+  // The copy shares the heavy members until they are modified.
+  EXPECT_EQ(&snapshot.composer(), &source.composer());
+  EXPECT_EQ(&snapshot.converter(), &source.converter());
+  EXPECT_EQ(&snapshot.output(), &source.output());
+
+  source.mutable_composer()->InsertCharacter("a");
+  EXPECT_NE(&snapshot.composer(), &source.composer());
+  EXPECT_EQ(snapshot.composer().GetStringForPreedit(), "あ");
+  EXPECT_EQ(source.composer().GetStringForPreedit(), "ああ");
+  EXPECT_EQ(&snapshot.converter(), &source.converter());
+
+  source.mutable_converter()->set_use_cascading_window(false);
+  EXPECT_NE(&snapshot.converter(), &source.converter());
+
+  commands::Output output;
+  output.set_id(2);
+  source.set_output(output);
+  EXPECT_EQ(snapshot.output().id(), 1);
+  EXPECT_EQ(source.output().id(), 2);
+
+  // An unshared member is modified in place.
+  const composer::Composer* composer = &source.composer();
+  source.mutable_composer()->Reset();
+  EXPECT_EQ(&source.composer(), composer);
+}
+
+
+TEST(ImeContextTest, CommitAfterUndoSnapshot) {
+  auto table = std::make_shared<composer::Table>();
+  table->AddRule("a", "あ", "");
+  auto converter = std::make_shared<MockConverter>();
+
+  int num_clones = 0;
+  ImeContext context(
+      std::make_unique<CloneCountingEngineConverter>(converter, &num_clones));
+  context.mutable_composer()->SetTable(table);
+  context.mutable_composer()->InsertCharacter("a");
+
+  // Session::PushUndoContext() followed by a commit.
+  const ImeContext snapshot(context);
+  EXPECT_EQ(num_clones, 0);
+  context.mutable_converter()->CommitPreedit(context.composer(),
+                                             commands::Context());
+  context.ResetComposer();
+
+  // The converter is cloned once, as the snapshot keeps the state before the
+  // commit. The composer is replaced without copying the composition.
+  EXPECT_EQ(num_clones, 1);
+  EXPECT_NE(&snapshot.converter(), &context.converter());
+  EXPECT_NE(&snapshot.composer(), &context.composer());
+  EXPECT_EQ(snapshot.composer().GetStringForPreedit(), "あ");
+  EXPECT_TRUE(context.composer().Empty());
+  EXPECT_EQ(context.composer().GetInputMode(),
+            snapshot.composer().GetInputMode());
+
+  // Without a snapshot, the converter and the composer are modified in place.
+  const composer::Composer* composer = &context.composer();
+  context.mutable_composer()->InsertCharacter("a");
+  context.mutable_converter()->CommitPreedit(context.composer(),
+                                             commands::Context());
+  context.ResetComposer();
+  EXPECT_EQ(num_clones, 1);
+  EXPECT_EQ(&context.composer(), composer);
+}
+
 }  // namespace session
 }  // namespace mozc
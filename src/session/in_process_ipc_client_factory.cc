@@ -0,0 +1,281 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "session/in_process_ipc_client_factory.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "base/clock.h"
+#include "base/version.h"
+#include "base/vlog.h"
+#include "engine/engine_factory.h"
+#include "engine/engine_interface.h"
+#include "ipc/ipc.h"
+#include "protocol/commands.pb.h"
+#include "session/session_handler.h"
+
+namespace mozc {
+namespace {
+
+// Same as the name of SessionServer.
+constexpr absl::string_view kSessionName = "session";
+
+// Taken while the handler is alive. This must differ from the name of the
+// mutex taken by mozc_server ("server") so as not to block it.
+constexpr absl::string_view kProcessMutexName = "in_process_session";
+
+// While the handler is alive, NewClient() checks at this interval whether
+// mozc_server has been started, to hand the user data over to it.
+constexpr absl::Duration kServerCheckInterval = absl::Seconds(1);
+
+constexpr absl::Duration kReloadServerTimeout = absl::Seconds(1);
+
+class InProcessIPCClient : public IPCClientInterface {
+ public:
+  explicit InProcessIPCClient(InProcessIPCClientFactory* factory)
+      : factory_(factory),
+        product_version_(Version::GetMozcVersion()),
+        last_ipc_error_(IPC_NO_ERROR) {}
+
+  bool Connected() const override { return true; }
+
+  // |timeout| is ignored as the request is evaluated synchronously.
+  bool Call(absl::string_view request, std::string* response,
+            absl::Duration timeout) override {
+    if (!factory_->Call(request, response)) {
+      last_ipc_error_ = IPC_NO_CONNECTION;
+      return false;
+    }
+    last_ipc_error_ = IPC_NO_ERROR;
+    return true;
+  }
+
+  uint32_t GetServerProtocolVersion() const override {
+    return IPC_PROTOCOL_VERSION;
+  }
+  absl::string_view GetServerProductVersion() const override {
+    return product_version_;
+  }
+  // There is no server process to wait for.
+  uint32_t GetServerProcessId() const override { return 0; }
+  IPCErrorType GetLastIPCError() const override { return last_ipc_error_; }
+
+ private:
+  InProcessIPCClientFactory* factory_;
+  const std::string product_version_;
+  IPCErrorType last_ipc_error_;
+};
+
+}  // namespace
+
+InProcessIPCClientFactory::InProcessIPCClientFactory()
+    : InProcessIPCClientFactory(EngineFactory::Create) {}
+
+InProcessIPCClientFactory::InProcessIPCClientFactory(
+    EngineCreator engine_creator)
+    : InProcessIPCClientFactory(std::move(engine_creator),
+                                IPCClientFactory::GetIPCClientFactory()) {}
+
+InProcessIPCClientFactory::InProcessIPCClientFactory(
+    EngineCreator engine_creator, IPCClientFactoryInterface* ipc_client_factory)
+    : ipc_client_factory_(ipc_client_factory),
+      engine_creator_(std::move(engine_creator)),
+      process_mutex_(kProcessMutexName) {}
+
+InProcessIPCClientFactory::~InProcessIPCClientFactory() { Shutdown(); }
+
+std::unique_ptr<IPCClientInterface> InProcessIPCClientFactory::NewClient(
+    absl::string_view name, absl::string_view path_name) {
+  if (name != kSessionName) {
+    return ipc_client_factory_->NewClient(name, path_name);
+  }
+
+  absl::MutexLock l(mutex_);
+  if (!session_handler_ || IsServerCheckDue()) {
+    // Prefers mozc_server if it's running.
+    std::unique_ptr<IPCClientInterface> client =
+        ipc_client_factory_->NewClient(name, path_name);
+    if (client->Connected()) {
+      MOZC_VLOG(1) << "mozc_server is running. Use IPC.";
+      if (session_handler_) {
+        HandOverToServer();
+      }
+      return client;
+    }
+  }
+  if (EnsureSessionHandler()) {
+    return std::make_unique<InProcessIPCClient>(this);
+  }
+  MOZC_VLOG(1) << "Another process owns the session. Fall back to IPC.";
+  return ipc_client_factory_->NewClient(name, path_name);
+}
+
+std::unique_ptr<IPCClientInterface> InProcessIPCClientFactory::NewClient(
+    absl::string_view name) {
+  return NewClient(name, "");
+}
+
+bool InProcessIPCClientFactory::Call(absl::string_view request,
+                                     std::string* response) {
+  commands::Command command;
+  if (!command.mutable_input()->ParseFromString(request)) {
+    LOG(WARNING) << "Invalid request";
+    response->clear();
+    return true;
+  }
+
+  absl::MutexLock l(mutex_);
+  if (!session_handler_ && IsServerRunning()) {
+    // The sessions have been handed over to mozc_server. The client should
+    // reconnect through NewClient().
+    response->clear();
+    return false;
+  }
+  if (!EnsureSessionHandler()) {
+    response->clear();
+    return false;
+  }
+  if (!session_handler_->EvalCommand(&command)) {
+    // The handler is no longer available, e.g. by the SHUTDOWN command. Unlock
+    // the user profile so that other processes can take it over.
+    ReleaseSessionHandler();
+    response->clear();
+    return false;
+  }
+  if (!command.output().SerializeToString(response)) {
+    LOG(WARNING) << "SerializeToString() failed";
+    response->clear();
+  }
+  return true;
+}
+
+void InProcessIPCClientFactory::Shutdown() {
+  absl::MutexLock l(mutex_);
+  if (!session_handler_) {
+    return;
+  }
+  SyncAndReleaseSessionHandler();
+  // mozc_server may have been started since the last check. Let it load the
+  // user data synced above, as its next sync would overwrite them otherwise.
+  if (IsServerRunning()) {
+    ReloadServer();
+  }
+}
+
+bool InProcessIPCClientFactory::EnsureSessionHandler() {
+  if (session_handler_) {
+    return true;
+  }
+  if (!process_mutex_.Lock()) {
+    return false;
+  }
+  absl::StatusOr<std::unique_ptr<EngineInterface>> engine = engine_creator_();
+  if (!engine.ok()) {
+    LOG(ERROR) << "Failed to create an engine: " << engine.status();
+    process_mutex_.UnLock();
+    return false;
+  }
+  session_handler_ = std::make_unique<SessionHandler>(*std::move(engine));
+  if (!session_handler_->IsAvailable()) {
+    LOG(ERROR) << "SessionHandler is not available";
+    ReleaseSessionHandler();
+    return false;
+  }
+  next_server_check_time_ = Clock::GetAbslTime() + kServerCheckInterval;
+  // The watch dog is not started as it sends CLEANUP through a regular IPC
+  // client, which would launch mozc_server. The user data is synced by
+  // Shutdown() instead.
+  return true;
+}
+
+void InProcessIPCClientFactory::ReleaseSessionHandler() {
+  session_handler_.reset();
+  process_mutex_.UnLock();
+}
+
+void InProcessIPCClientFactory::SyncAndReleaseSessionHandler() {
+  // Syncs the user data as the watch dog doesn't run in-process.
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::SHUTDOWN);
+  session_handler_->EvalCommand(&command);
+  ReleaseSessionHandler();
+}
+
+void InProcessIPCClientFactory::HandOverToServer() {
+  MOZC_VLOG(1) << "mozc_server has been started. Hand the sessions over.";
+  // mozc_server loaded the user data when it started, so it has to reload them
+  // after they are synced here. Otherwise the two processes would overwrite
+  // each other's user data.
+  SyncAndReleaseSessionHandler();
+  ReloadServer();
+}
+
+void InProcessIPCClientFactory::ReloadServer() {
+  commands::Input input;
+  input.set_type(commands::Input::RELOAD);
+  std::unique_ptr<IPCClientInterface> client =
+      ipc_client_factory_->NewClient(kSessionName);
+  std::string response;
+  if (!client->Connected() ||
+      !client->Call(input.SerializeAsString(), &response,
+                    kReloadServerTimeout)) {
+    LOG(WARNING) << "Failed to reload mozc_server";
+  }
+}
+
+bool InProcessIPCClientFactory::IsServerRunning() {
+  return ipc_client_factory_->NewClient(kSessionName)->Connected();
+}
+
+bool InProcessIPCClientFactory::IsServerCheckDue() {
+  const absl::Time now = Clock::GetAbslTime();
+  if (now < next_server_check_time_) {
+    return false;
+  }
+  next_server_check_time_ = now + kServerCheckInterval;
+  return true;
+}
+
+InProcessIPCClientFactory*
+InProcessIPCClientFactory::GetInProcessIPCClientFactory() {
+  static absl::NoDestructor<InProcessIPCClientFactory> factory;
+  return factory.get();
+}
+
+}  // namespace mozc
@@ -0,0 +1,142 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// IPCClientFactoryInterface which evaluates the requests for the session
+// server with a SessionHandler embedded in the calling process, instead of
+// sending them to mozc_server. The data set is the same read-only image the
+// server maps, so its pages are shared with the other processes through the
+// page cache and only the touched pages are resident.
+//
+// Usage:
+//   client::Client client;
+//   client.SetIPCClientFactory(
+//       InProcessIPCClientFactory::GetInProcessIPCClientFactory());
+//
+// If mozc_server is already running, NewClient() returns the regular IPC
+// client connecting to it, so that the sessions and the user data are owned by
+// the server. Otherwise the factory creates the handler and holds the
+// "in_process_session" ProcessMutex while it is alive, so at most one helper
+// process evaluates the sessions in-process. This lock is separate from the
+// one mozc_server takes, so mozc_server can still start later for the other
+// clients (e.g. ibus).
+//
+// Only one process should own the user data. While the handler is alive,
+// NewClient() checks periodically whether mozc_server has been started. If
+// so, the handler syncs the user data and is deleted, mozc_server is asked to
+// reload the user data, and the clients are connected to mozc_server from
+// then on.
+//
+// The session watch dog is not started in-process, so the user data is synced
+// only by SYNC_DATA, SHUTDOWN, Shutdown() and the hand-over above. Call
+// Shutdown() before the process exits as the singleton is never destroyed.
+
+#ifndef MOZC_SESSION_IN_PROCESS_IPC_CLIENT_FACTORY_H_
+#define MOZC_SESSION_IN_PROCESS_IPC_CLIENT_FACTORY_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "base/process_mutex.h"
+#include "engine/engine_interface.h"
+#include "ipc/ipc.h"
+#include "session/session_handler.h"
+
+namespace mozc {
+
+class InProcessIPCClientFactory : public IPCClientFactoryInterface {
+ public:
+  using EngineCreator = absl::AnyInvocable<
+      absl::StatusOr<std::unique_ptr<EngineInterface>>()>;
+
+  // Creates the engine with EngineFactory.
+  InProcessIPCClientFactory();
+  explicit InProcessIPCClientFactory(EngineCreator engine_creator);
+  // |ipc_client_factory| connects to mozc_server and the other servers.
+  InProcessIPCClientFactory(EngineCreator engine_creator,
+                            IPCClientFactoryInterface* ipc_client_factory);
+  InProcessIPCClientFactory(const InProcessIPCClientFactory&) = delete;
+  InProcessIPCClientFactory& operator=(const InProcessIPCClientFactory&) =
+      delete;
+  ~InProcessIPCClientFactory() override;
+
+  // Returns an in-process client for the session server. The requests for
+  // the other servers (e.g. renderer) are delegated to IPCClientFactory.
+  std::unique_ptr<IPCClientInterface> NewClient(
+      absl::string_view name, absl::string_view path_name) override;
+  std::unique_ptr<IPCClientInterface> NewClient(
+      absl::string_view name) override;
+
+  // Evaluates a serialized commands::Input and stores the serialized
+  // commands::Output to |response|. Returns false when the handler is not
+  // available, e.g. after the SHUTDOWN command. The handler is created again
+  // on the next call in that case.
+  bool Call(absl::string_view request, std::string* response);
+
+  // Syncs the user data and deletes the handler if it exists. The handler is
+  // created again on the next request. If mozc_server is running, it is asked
+  // to reload the synced user data.
+  void Shutdown();
+
+  // Returns a singleton instance.
+  static InProcessIPCClientFactory* GetInProcessIPCClientFactory();
+
+ private:
+  // Takes the process mutex and creates the handler if it does not exist.
+  // Returns false if another process holds the mutex.
+  bool EnsureSessionHandler() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ReleaseSessionHandler() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void SyncAndReleaseSessionHandler() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Syncs the user data, deletes the handler and lets mozc_server reload the
+  // user data.
+  void HandOverToServer() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ReloadServer();
+  bool IsServerRunning();
+  // Returns true at most once per check interval.
+  bool IsServerCheckDue() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  IPCClientFactoryInterface* const ipc_client_factory_;
+  absl::Mutex mutex_;
+  EngineCreator engine_creator_ ABSL_GUARDED_BY(mutex_);
+  ProcessMutex process_mutex_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<SessionHandler> session_handler_ ABSL_GUARDED_BY(mutex_);
+  absl::Time next_server_check_time_ ABSL_GUARDED_BY(mutex_) =
+      absl::InfinitePast();
+};
+
+}  // namespace mozc
+
+#endif  // MOZC_SESSION_IN_PROCESS_IPC_CLIENT_FACTORY_H_
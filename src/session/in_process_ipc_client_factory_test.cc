@@ -0,0 +1,217 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "session/in_process_ipc_client_factory.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "base/clock_mock.h"
+#include "base/process_mutex.h"
+#include "base/version.h"
+#include "engine/mock_data_engine_factory.h"
+#include "ipc/ipc.h"
+#include "ipc/ipc_mock.h"
+#include "protocol/commands.pb.h"
+#include "testing/gunit.h"
+#include "testing/mozctest.h"
+
+namespace mozc {
+namespace {
+
+bool Call(IPCClientInterface* client, const commands::Input& input,
+          commands::Output* output) {
+  std::string response;
+  if (!client->Call(input.SerializeAsString(), &response,
+                    absl::Milliseconds(1000))) {
+    return false;
+  }
+  return output->ParseFromString(response);
+}
+
+class InProcessIPCClientFactoryTest : public testing::TestWithTempUserProfile {
+ protected:
+  InProcessIPCClientFactoryTest()
+      : factory_(MockDataEngineFactory::Create) {}
+
+  InProcessIPCClientFactory factory_;
+};
+
+TEST_F(InProcessIPCClientFactoryTest, SendKey) {
+  std::unique_ptr<IPCClientInterface> client = factory_.NewClient("session");
+  ASSERT_NE(client, nullptr);
+  EXPECT_TRUE(client->Connected());
+  EXPECT_EQ(client->GetServerProtocolVersion(), IPC_PROTOCOL_VERSION);
+  EXPECT_EQ(client->GetServerProductVersion(), Version::GetMozcVersion());
+  EXPECT_EQ(client->GetServerProcessId(), 0);
+
+  commands::Input input;
+  commands::Output output;
+  input.set_type(commands::Input::CREATE_SESSION);
+  ASSERT_TRUE(Call(client.get(), input, &output));
+  const uint64_t id = output.id();
+  EXPECT_NE(id, 0);
+
+  input.Clear();
+  output.Clear();
+  input.set_type(commands::Input::SEND_KEY);
+  input.set_id(id);
+  input.mutable_key()->set_key_code('a');
+  ASSERT_TRUE(Call(client.get(), input, &output));
+  EXPECT_TRUE(output.consumed());
+  EXPECT_EQ(client->GetLastIPCError(), IPC_NO_ERROR);
+
+  // Another client shares the same handler and thus the same sessions.
+  std::unique_ptr<IPCClientInterface> client2 = factory_.NewClient("session");
+  input.Clear();
+  output.Clear();
+  input.set_type(commands::Input::DELETE_SESSION);
+  input.set_id(id);
+  ASSERT_TRUE(Call(client2.get(), input, &output));
+  EXPECT_EQ(output.id(), id);
+}
+
+TEST_F(InProcessIPCClientFactoryTest, DoesNotBlockServer) {
+  std::unique_ptr<IPCClientInterface> client = factory_.NewClient("session");
+  ASSERT_NE(client, nullptr);
+
+  // mozc_server can start while the handler is alive.
+  {
+    ProcessMutex server_mutex("server");
+    EXPECT_TRUE(server_mutex.Lock());
+  }
+
+  // Another helper process cannot evaluate the sessions in-process.
+  ProcessMutex process_mutex("in_process_session");
+  EXPECT_FALSE(process_mutex.Lock());
+
+  commands::Input input;
+  commands::Output output;
+  input.set_type(commands::Input::SHUTDOWN);
+  EXPECT_FALSE(Call(client.get(), input, &output));
+  EXPECT_EQ(client->GetLastIPCError(), IPC_NO_CONNECTION);
+
+  // The mutex is released by SHUTDOWN.
+  EXPECT_TRUE(process_mutex.Lock());
+
+  // The handler is not created while another process owns the mutex.
+  input.set_type(commands::Input::NO_OPERATION);
+  EXPECT_FALSE(Call(client.get(), input, &output));
+
+  // It's created again once the mutex is released.
+  process_mutex.UnLock();
+  EXPECT_TRUE(Call(client.get(), input, &output));
+}
+
+TEST_F(InProcessIPCClientFactoryTest, Shutdown) {
+  std::unique_ptr<IPCClientInterface> client = factory_.NewClient("session");
+  ASSERT_NE(client, nullptr);
+
+  commands::Input input;
+  commands::Output output;
+  input.set_type(commands::Input::CREATE_SESSION);
+  ASSERT_TRUE(Call(client.get(), input, &output));
+
+  factory_.Shutdown();
+  ProcessMutex process_mutex("in_process_session");
+  EXPECT_TRUE(process_mutex.Lock());
+  process_mutex.UnLock();
+
+  // Shutdown() is a no-op without the handler.
+  factory_.Shutdown();
+
+  // The handler is created again on the next request.
+  input.set_type(commands::Input::NO_OPERATION);
+  EXPECT_TRUE(Call(client.get(), input, &output));
+}
+
+TEST_F(InProcessIPCClientFactoryTest, HandOverToServer) {
+  ScopedClockMock clock(absl::FromUnixSeconds(1000));
+  // Stands for mozc_server, which is not running at first.
+  IPCClientFactoryMock server;
+  server.SetServerProductVersion("mozc_server");
+  server.SetResult(true);
+  InProcessIPCClientFactory factory(MockDataEngineFactory::Create, &server);
+
+  std::unique_ptr<IPCClientInterface> client = factory.NewClient("session");
+  EXPECT_EQ(client->GetServerProductVersion(), Version::GetMozcVersion());
+  commands::Input input;
+  commands::Output output;
+  input.set_type(commands::Input::CREATE_SESSION);
+  ASSERT_TRUE(Call(client.get(), input, &output));
+
+  // Another client starts mozc_server. It's not checked until the interval
+  // passes.
+  server.SetConnection(true);
+  client = factory.NewClient("session");
+  EXPECT_EQ(client->GetServerProductVersion(), Version::GetMozcVersion());
+  EXPECT_TRUE(server.GetGeneratedRequest().empty());
+
+  // The sessions are handed over to mozc_server, which reloads the user data
+  // synced in-process.
+  clock->Advance(absl::Seconds(1));
+  client = factory.NewClient("session");
+  EXPECT_EQ(client->GetServerProductVersion(), "mozc_server");
+  commands::Input request;
+  ASSERT_TRUE(request.ParseFromString(server.GetGeneratedRequest()));
+  EXPECT_EQ(request.type(), commands::Input::RELOAD);
+
+  // The handler is deleted and not created again while mozc_server runs.
+  ProcessMutex process_mutex("in_process_session");
+  EXPECT_TRUE(process_mutex.Lock());
+  process_mutex.UnLock();
+  EXPECT_EQ(factory.NewClient("session")->GetServerProductVersion(),
+            "mozc_server");
+}
+
+TEST_F(InProcessIPCClientFactoryTest, ShutdownReloadsServer) {
+  IPCClientFactoryMock server;
+  server.SetResult(true);
+  InProcessIPCClientFactory factory(MockDataEngineFactory::Create, &server);
+
+  std::unique_ptr<IPCClientInterface> client = factory.NewClient("session");
+  commands::Input input;
+  commands::Output output;
+  input.set_type(commands::Input::CREATE_SESSION);
+  ASSERT_TRUE(Call(client.get(), input, &output));
+
+  // mozc_server has been started since the last check. It reloads the user
+  // data synced by Shutdown().
+  server.SetConnection(true);
+  factory.Shutdown();
+  commands::Input request;
+  ASSERT_TRUE(request.ParseFromString(server.GetGeneratedRequest()));
+  EXPECT_EQ(request.type(), commands::Input::RELOAD);
+}
+
+}  // namespace
+}  // namespace mozc
@@ -52,6 +52,7 @@
 #include "engine/engine_interface.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "session/ime_context.h"
 #include "session/key_event_transformer.h"
 #include "session/keymap.h"
@@ -142,7 +143,7 @@ void SetSessionState(const ImeContext::State state, ImeContext* context) {
   switch (state) {
     case ImeContext::DIRECT:
     case ImeContext::PRECOMPOSITION:
-      context->mutable_composer()->Reset();
+      context->ResetComposer();
       break;
     case ImeContext::CONVERSION:
       context->mutable_composer()->ResetInputMode();
@@ -168,7 +169,7 @@ void SetStateToPredompositionAndCancel(ImeContext* context) {
   // Internal state contains:
   // - candidate list
   // - result text to commit
-  if (!context->mutable_converter()->CheckState(
+  if (!context->converter().CheckState(
           EngineConverterInterface::COMPOSITION)) {
     context->mutable_converter()->Cancel();
   }
@@ -545,7 +546,7 @@ bool Session::SendKey(commands::Command* command) {
 bool Session::UpdateCompositionInternal(commands::Command* command) {
   command->mutable_output()->set_consumed(true);
 
-  context_->mutable_composer()->Reset();
+  context_->ResetComposer();
   // Use the top entry for now.
   context_->mutable_composer()->SetCompositionsForHandwriting(
       command->input().command().composition_events());
@@ -1397,7 +1398,7 @@ bool Session::CommitCandidate(commands::Command* command) {
         // Don't clear the undo context, which we've just updated.
         MoveCursorToEndInternal(command, false);
         // Copy the previous output for Undo.
-        *context_->mutable_output() = command->output();
+        context_->set_output(command->output());
         return true;
       }
     }
@@ -1417,7 +1418,7 @@ bool Session::CommitCandidate(commands::Command* command) {
   }
   Output(command);
   // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  context_->set_output(command->output());
   return true;
 }
 
@@ -1475,6 +1476,61 @@ absl::Time Session::last_command_time() const {
   return context_->last_command_time();
 }
 
+void Session::Hibernate(protocol::HibernatedSession* hibernated) const {
+  hibernated->set_create_time(absl::ToUnixMicros(context_->create_time()));
+  if (context_->last_command_time() != absl::InfinitePast()) {
+    hibernated->set_last_command_time(
+        absl::ToUnixMicros(context_->last_command_time()));
+  }
+
+  ImeContext::State state = context_->state();
+  if (state == ImeContext::CONVERSION) {
+    // Candidates are not kept, so the conversion is resumed as a composition.
+    state = ImeContext::COMPOSITION;
+  }
+  hibernated->set_state(state);
+
+  context_->composer().SaveState(hibernated->mutable_composer());
+
+  *hibernated->mutable_client_capability() = context_->client_capability();
+  *hibernated->mutable_application_info() = context_->application_info();
+  *hibernated->mutable_client_context() = context_->client_context();
+  if (context_->output().has_result()) {
+    *hibernated->mutable_last_result() = context_->output().result();
+  }
+}
+
+void Session::Resume(const protocol::HibernatedSession& hibernated) {
+  context_->set_create_time(absl::FromUnixMicros(hibernated.create_time()));
+  if (hibernated.has_last_command_time()) {
+    context_->set_last_command_time(
+        absl::FromUnixMicros(hibernated.last_command_time()));
+  }
+
+  *context_->mutable_client_capability() = hibernated.client_capability();
+  *context_->mutable_application_info() = hibernated.application_info();
+  *context_->mutable_client_context() = hibernated.client_context();
+  if (hibernated.has_last_result()) {
+    *context_->mutable_output()->mutable_result() = hibernated.last_result();
+  }
+
+  composer::Composer* composer = context_->mutable_composer();
+  composer->RestoreState(hibernated.composer());
+
+  switch (hibernated.state()) {
+    case ImeContext::DIRECT:
+      context_->set_state(ImeContext::DIRECT);
+      return;
+    case ImeContext::COMPOSITION:
+      context_->set_state(composer->Empty() ? ImeContext::PRECOMPOSITION
+                                            : ImeContext::COMPOSITION);
+      return;
+    default:
+      context_->set_state(ImeContext::PRECOMPOSITION);
+      return;
+  }
+}
+
 bool Session::InsertCharacter(commands::Command* command) {
   if (!command->input().has_key()) {
     LOG(ERROR) << "No key event: " << command->input();
@@ -1796,7 +1852,7 @@ bool Session::CommitInternal(commands::Command* command,
 
   Output(command);
   // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  context_->set_output(command->output());
   return true;
 }
 
@@ -1855,7 +1911,7 @@ bool Session::CommitFirstSuggestion(commands::Command* command) {
 
   Output(command);
   // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  context_->set_output(command->output());
   return true;
 }
 
@@ -1890,7 +1946,7 @@ bool Session::CommitSegment(commands::Command* command) {
   }
   Output(command);
   // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  context_->set_output(command->output());
   return true;
 }
 
@@ -2547,7 +2603,7 @@ bool Session::Delete(commands::Command* command) {
   command->mutable_output()->set_consumed(true);
   context_->mutable_composer()->Delete();
   ClearUndoContext();
-  if (context_->mutable_composer()->Empty()) {
+  if (context_->composer().Empty()) {
     SetStateToPredompositionAndCancel(context_.get());
     Output(command);
   } else if (Suggest(command->input())) {
@@ -2562,7 +2618,7 @@ bool Session::Backspace(commands::Command* command) {
   command->mutable_output()->set_consumed(true);
   context_->mutable_composer()->Backspace();
   ClearUndoContext();
-  if (context_->mutable_composer()->Empty()) {
+  if (context_->composer().Empty()) {
     SetStateToPredompositionAndCancel(context_.get());
     Output(command);
   } else if (Suggest(command->input())) {
@@ -2927,5 +2983,13 @@ composer::Composer* Session::get_internal_composer_only_for_unittest() {
 
 const ImeContext& Session::context() const { return *context_; }
 
+size_t Session::GetMemoryUsage() const {
+  size_t bytes = sizeof(*this) + context_->GetMemoryUsage();
+  for (const std::unique_ptr<ImeContext>& undo_context : undo_contexts_) {
+    bytes += sizeof(ImeContext*) + undo_context->GetMemoryUsage();
+  }
+  return bytes;
+}
+
 }  // namespace session
 }  // namespace mozc
@@ -44,6 +44,7 @@
 #include "engine/engine_interface.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "session/ime_context.h"
 #include "session/keymap.h"
 #include "transliteration/transliteration.h"
@@ -266,12 +267,24 @@ class Session {
   // return 0 (default value) if no command is executed in this session.
   absl::Time last_command_time() const;
 
+  // Saves the state needed to resume this session into |hibernated|.
+  // Candidate lists and the undo history are not saved, and a session in
+  // conversion is saved as a composition.
+  void Hibernate(mozc::protocol::HibernatedSession* hibernated) const;
+
+  // Restores the state saved by Hibernate(). The config, request and table
+  // should be set before calling this method.
+  void Resume(const mozc::protocol::HibernatedSession& hibernated);
+
   // TODO(komatsu): delete this function.
   // For unittest only
   mozc::composer::Composer* get_internal_composer_only_for_unittest();
 
   const ImeContext& context() const;
 
+  // Returns the approximate heap size of the context and the undo stack.
+  size_t GetMemoryUsage() const;
+
  private:
   friend class SessionTestPeer;
 
@@ -37,6 +37,8 @@
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -45,7 +47,10 @@
 #include "absl/random/random.h"
 #include "absl/time/time.h"
 #include "base/clock.h"
+#include "base/file_stream.h"
+#include "base/memory_usage.h"
 #include "base/stopwatch.h"
+#include "base/trace.h"
 #include "base/version.h"
 #include "base/vlog.h"
 #include "composer/table.h"
@@ -55,6 +60,7 @@
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
 #include "protocol/engine_builder.pb.h"
+#include "protocol/state.pb.h"
 #include "protocol/user_dictionary_storage.pb.h"
 #include "session/common.h"
 #include "session/keymap.h"
@@ -77,6 +83,15 @@ ABSL_FLAG(int32_t, max_session_size, 64,
           "if size of sessions reaches to \"max_session_size\", "
           "oldest session is removed");
 
+ABSL_FLAG(int32_t, max_active_session_size, 64,
+          "maximum number of sessions kept in memory. "
+          "if \"max_session_size\" is larger, least recently used sessions "
+          "beyond this size are hibernated");
+
+ABSL_FLAG(absl::Duration, hibernate_session_timeout, absl::Seconds(600),
+          "hibernate session if it is not accessed for "
+          "\"hibernate_session_timeout\". 0 disables it");
+
 // TODO(b/275437228): Convert this to `absl::Duration`.
 ABSL_FLAG(int32_t, create_session_min_interval, 0,
           "minimum interval (sec) for create session");
@@ -97,12 +112,16 @@ ABSL_FLAG(int32_t, last_create_session_timeout, 300,
 
 ABSL_FLAG(bool, restricted, false, "Launch server with restricted setting");
 
+ABSL_FLAG(std::string, trace_file, "",
+          "If specified, the spans recorded for each command are appended to "
+          "this file in the Chrome trace event format. Spans inside the "
+          "engine are recorded only with --//:enable_tracing.");
+
 namespace mozc {
 namespace {
 
-bool IsApplicationAlive(const session::Session* session) {
+bool IsApplicationAlive(const commands::ApplicationInfo& info) {
 #ifndef MOZC_DISABLE_SESSION_WATCHDOG
-  const commands::ApplicationInfo& info = session->application_info();
   // When the thread/process's current status is unknown, i.e.,
   // if IsThreadAlive/IsProcessAlive functions failed to know the
   // status of the thread/process, return true just in case.
@@ -150,9 +169,30 @@ SessionHandler::SessionHandler(std::unique_ptr<EngineInterface> engine)
     absl::SetFlag(&FLAGS_last_command_timeout, 60);
   }
 
-  // Allow [2..128] sessions.
-  max_session_size_ = std::clamp(absl::GetFlag(FLAGS_max_session_size), 2, 128);
-  session_map_ = std::make_unique<SessionMap>(max_session_size_);
+  // Allow [2..8192] sessions, and keep up to 128 of them in memory. The rest
+  // are hibernated.
+  max_session_size_ =
+      std::clamp(absl::GetFlag(FLAGS_max_session_size), 2, 8192);
+  max_active_session_size_ = std::min<uint32_t>(
+      max_session_size_,
+      std::clamp(absl::GetFlag(FLAGS_max_active_session_size), 2, 128));
+  session_map_ = std::make_unique<SessionMap>(max_active_session_size_);
+  if (max_session_size_ > max_active_session_size_) {
+    hibernated_session_map_ = std::make_unique<HibernatedSessionMap>(
+        max_session_size_ - max_active_session_size_);
+  }
+
+  if (const std::string trace_file = absl::GetFlag(FLAGS_trace_file);
+      !trace_file.empty()) {
+    trace_stream_ = std::make_unique<OutputFileStream>(trace_file);
+    if (trace_stream_->good()) {
+      // The closing bracket is optional in the Chrome trace event format.
+      *trace_stream_ << "[\n";
+    } else {
+      LOG(ERROR) << "Cannot open the trace file: " << trace_file;
+      trace_stream_.reset();
+    }
+  }
 
   if (!engine_) {
     return;
@@ -316,6 +356,17 @@ bool SessionHandler::EvalCommand(commands::Command* command) {
   Stopwatch stopwatch;
   stopwatch.Start();
 
+  trace_recorder_.Clear();
+  std::optional<TraceRecorder::ScopedActivation> trace_activation;
+  if (command->input().request_trace() || trace_stream_ != nullptr) {
+    trace_activation.emplace(&trace_recorder_);
+  }
+  std::optional<ScopedTraceSpan> trace_span;
+  if (trace_activation.has_value()) {
+    trace_span.emplace(commands::Input::CommandType_Name(
+        command->input().type()));
+  }
+
   switch (command->input().type()) {
     case commands::Input::CREATE_SESSION:
       eval_succeeded = CreateSession(command);
@@ -383,6 +434,9 @@ bool SessionHandler::EvalCommand(commands::Command* command) {
     case commands::Input::GET_SERVER_VERSION:
       eval_succeeded = GetServerVersion(command);
       break;
+    case commands::Input::GET_MEMORY_USAGE:
+      eval_succeeded = GetMemoryUsage(command);
+      break;
     default:
       eval_succeeded = false;
   }
@@ -401,9 +455,44 @@ bool SessionHandler::EvalCommand(commands::Command* command) {
 
   stopwatch.Stop();
 
+  if (trace_activation.has_value()) {
+    trace_span.reset();
+    trace_activation.reset();
+    OutputTrace(command);
+  }
+
   return is_available_;
 }
 
+void SessionHandler::OutputTrace(commands::Command* command) {
+  if (trace_recorder_.empty()) {
+    return;
+  }
+
+  if (command->input().request_trace()) {
+    const absl::Time origin = trace_recorder_.spans().front().begin;
+    for (const TraceRecorder::Span& span : trace_recorder_.spans()) {
+      commands::Output::TraceSpan* trace_span =
+          command->mutable_output()->add_trace_spans();
+      trace_span->set_name(span.name);
+      trace_span->set_begin_usec(
+          absl::ToInt64Microseconds(span.begin - origin));
+      trace_span->set_duration_usec(absl::ToInt64Microseconds(span.duration));
+      trace_span->set_depth(span.depth);
+    }
+  }
+
+  if (trace_stream_ != nullptr) {
+    // Uses the session ID as the thread ID so that each session is rendered
+    // in its own track.
+    std::string events;
+    trace_recorder_.AppendChromeTraceEvents(
+        /*pid=*/1, static_cast<int>(command->input().id() & 0x7fffffff),
+        &events);
+    *trace_stream_ << events << std::flush;
+  }
+}
+
 std::unique_ptr<session::Session> SessionHandler::NewSession() {
   // Session doesn't take the ownership of engine.
   return std::make_unique<session::Session>(*engine_);
@@ -420,35 +509,35 @@ void SessionHandler::MaybeUpdateConfig(commands::Command* command) {
 
 bool SessionHandler::SendKey(commands::Command* command) {
   const SessionID id = command->input().id();
-  std::unique_ptr<session::Session>* session = session_map_->MutableLookup(id);
-  if (session == nullptr || !*session) {
+  session::Session* session = GetSession(id);
+  if (session == nullptr) {
     LOG(WARNING) << "SessionID " << id << " is not available";
     return false;
   }
-  (*session)->SendKey(command);
+  session->SendKey(command);
   MaybeUpdateConfig(command);
   return true;
 }
 
 bool SessionHandler::TestSendKey(commands::Command* command) {
   const SessionID id = command->input().id();
-  std::unique_ptr<session::Session>* session = session_map_->MutableLookup(id);
-  if (session == nullptr || !*session) {
+  session::Session* session = GetSession(id);
+  if (session == nullptr) {
     LOG(WARNING) << "SessionID " << id << " is not available";
     return false;
   }
-  (*session)->TestSendKey(command);
+  session->TestSendKey(command);
   return true;
 }
 
 bool SessionHandler::SendCommand(commands::Command* command) {
   const SessionID id = command->input().id();
-  std::unique_ptr<session::Session>* session = session_map_->MutableLookup(id);
-  if (session == nullptr || !*session) {
+  session::Session* session = GetSession(id);
+  if (session == nullptr) {
     LOG(WARNING) << "SessionID " << id << " is not available";
     return false;
   }
-  (*session)->SendCommand(command);
+  session->SendCommand(command);
   MaybeUpdateConfig(command);
   return true;
 }
@@ -479,6 +568,37 @@ bool SessionHandler::GetServerVersion(mozc::commands::Command* command) const {
   return true;
 }
 
+bool SessionHandler::GetMemoryUsage(commands::Command* command) const {
+  MemoryUsageCollector collector;
+  engine_->CollectMemoryUsage(collector);
+  table_manager_->CollectMemoryUsage(collector);
+  size_t active_bytes = session_map_->GetMemoryUsage();
+  for (const SessionElement& element : *session_map_) {
+    active_bytes += element.value->GetMemoryUsage();
+  }
+  collector.AddHeap("session.active", active_bytes);
+  if (hibernated_session_map_) {
+    size_t bytes = hibernated_session_map_->GetMemoryUsage();
+    for (const HibernatedSessionMap::Element& element :
+         *hibernated_session_map_) {
+      bytes += GetHeapBytes(element.value);
+    }
+    collector.AddHeap("session.hibernated", bytes);
+  }
+
+  for (const MemoryUsage& usage : collector.usages()) {
+    commands::Output::MemoryUsage* output =
+        command->mutable_output()->add_memory_usage();
+    output->set_name(usage.name);
+    output->set_heap_bytes(usage.heap_bytes);
+    output->set_mapped_bytes(usage.mapped_bytes);
+    if (usage.resident_bytes.has_value()) {
+      output->set_resident_bytes(*usage.resident_bytes);
+    }
+  }
+  return true;
+}
+
 bool SessionHandler::CreateSession(commands::Command* command) {
   // prevent DOS attack
   // don't allow CreateSession in very short period.
@@ -499,8 +619,15 @@ bool SessionHandler::CreateSession(commands::Command* command) {
 
   last_create_session_time_ = current_time;
 
-  // if session map is FULL, remove the oldest item from the LRU
-  if (session_map_->Size() >= max_session_size_) {
+  // if session map is FULL, remove the oldest item from the LRU. Hibernated
+  // sessions are older than the active ones.
+  if (GetSessionSize() >= max_session_size_ && hibernated_session_map_ &&
+      !hibernated_session_map_->empty()) {
+    const SessionID oldest_id = hibernated_session_map_->Tail()->key;
+    hibernated_session_map_->Erase(oldest_id);
+    MOZC_VLOG(1) << "Session is FULL, oldest SessionID " << oldest_id
+                 << " is removed";
+  } else if (GetSessionSize() >= max_session_size_) {
     SessionElement* oldest_element = session_map_->MutableTail();
     if (oldest_element == nullptr) {
       LOG(ERROR) << "oldest SessionElement is NULL";
@@ -531,8 +658,7 @@ bool SessionHandler::CreateSession(commands::Command* command) {
   }
 
   const SessionID new_id = CreateNewSessionID();
-  SessionElement* element = session_map_->Insert(new_id);
-  element->value = std::move(session);
+  AddActiveSession(new_id, std::move(session));
   command->mutable_output()->set_id(new_id);
 
   // The created session has not been fully initialized yet.
@@ -591,21 +717,59 @@ bool SessionHandler::Cleanup(commands::Command* command) {
           std::min(absl::Seconds(absl::GetFlag(FLAGS_last_command_timeout)),
                    absl::Seconds(7200)));
 
+  // allow [0..7200] sec. default 600
+  const absl::Duration hibernate_session_timeout =
+      suspend_time +
+      std::clamp(absl::GetFlag(FLAGS_hibernate_session_timeout),
+                 absl::ZeroDuration(), absl::Seconds(7200));
+
+  auto should_remove = [&](SessionID id,
+                           const commands::ApplicationInfo& application_info,
+                           absl::Time create_session_time,
+                           absl::Time last_command_time) {
+    if (!IsApplicationAlive(application_info)) {
+      MOZC_VLOG(2) << "Application is not alive. Removing: " << id;
+      return true;
+    }
+    if (last_command_time == absl::InfinitePast()) {
+      // no command is executed
+      return (current_time - create_session_time) >= create_session_timeout;
+    }
+    // some commands are executed already
+    return (current_time - last_command_time) >= last_command_timeout;
+  };
+
   std::vector<SessionID> remove_ids;
+  std::vector<SessionID> hibernate_ids;
   for (const SessionElement& element : *session_map_) {
     const session::Session* session = element.value.get();
-    if (!IsApplicationAlive(session)) {
-      MOZC_VLOG(2) << "Application is not alive. Removing: " << element.key;
+    if (should_remove(element.key, session->application_info(),
+                      session->create_session_time(),
+                      session->last_command_time())) {
       remove_ids.push_back(element.key);
-    } else if (session->last_command_time() == absl::InfinitePast()) {
-      // no command is executed
-      if ((current_time - session->create_session_time()) >=
-          create_session_timeout) {
+    } else if (hibernated_session_map_ &&
+               hibernate_session_timeout > absl::ZeroDuration() &&
+               (current_time - std::max(session->create_session_time(),
+                                        session->last_command_time())) >=
+                   hibernate_session_timeout) {
+      hibernate_ids.push_back(element.key);
+    }
+  }
+  if (hibernated_session_map_) {
+    for (const HibernatedSessionMap::Element& element :
+         *hibernated_session_map_) {
+      protocol::HibernatedSession hibernated;
+      if (!hibernated.ParseFromString(element.value)) {
         remove_ids.push_back(element.key);
+        continue;
       }
-    } else {  // some commands are executed already
-      if ((current_time - session->last_command_time()) >=
-          last_command_timeout) {
+      const absl::Time last_command_time =
+          hibernated.has_last_command_time()
+              ? absl::FromUnixMicros(hibernated.last_command_time())
+              : absl::InfinitePast();
+      if (should_remove(element.key, hibernated.application_info(),
+                        absl::FromUnixMicros(hibernated.create_time()),
+                        last_command_time)) {
         remove_ids.push_back(element.key);
       }
     }
@@ -615,6 +779,10 @@ bool SessionHandler::Cleanup(commands::Command* command) {
     DeleteSessionID(remove_ids[i]);
     MOZC_VLOG(1) << "Session ID " << remove_ids[i] << " is removed by server";
   }
+  for (const SessionID id : hibernate_ids) {
+    HibernateSession(id);
+    MOZC_VLOG(1) << "Session ID " << id << " is hibernated by server";
+  }
 
   // Sync all data. This is a regression bug fix http://b/3033708
   engine_->Sync();
@@ -691,7 +859,8 @@ SessionID SessionHandler::CreateNewSessionID() {
     const SessionID id =
         absl::Uniform<SessionID>(absl::IntervalClosed, bitgen_, 1,
                                  std::numeric_limits<SessionID>::max());
-    if (!session_map_->HasKey(id)) {
+    if (!session_map_->HasKey(id) &&
+        !(hibernated_session_map_ && hibernated_session_map_->HasKey(id))) {
       return id;
     }
 
@@ -701,20 +870,81 @@ SessionID SessionHandler::CreateNewSessionID() {
 
 bool SessionHandler::DeleteSessionID(SessionID id) {
   std::unique_ptr<session::Session>* session = session_map_->MutableLookup(id);
-  if (session == nullptr || !*session) {
+  if (session != nullptr && *session) {
+    session->reset();
+    session_map_->Erase(id);  // remove from LRU
+  } else if (!hibernated_session_map_ || !hibernated_session_map_->Erase(id)) {
     LOG_IF(WARNING, id != 0) << "cannot find SessionID " << id;
     return false;
   }
-  session->reset();
-
-  session_map_->Erase(id);  // remove from LRU
 
   // if session gets empty, save the timestamp
   if (last_session_empty_time_ == absl::InfinitePast() &&
-      session_map_->Size() == 0) {
+      GetSessionSize() == 0) {
     last_session_empty_time_ = Clock::GetAbslTime();
   }
 
   return true;
 }
+
+session::Session* SessionHandler::GetSession(SessionID id) {
+  if (std::unique_ptr<session::Session>* session =
+          session_map_->MutableLookup(id);
+      session != nullptr) {
+    return session->get();
+  }
+  if (!hibernated_session_map_) {
+    return nullptr;
+  }
+  const std::string* data = hibernated_session_map_->LookupWithoutInsert(id);
+  if (data == nullptr) {
+    return nullptr;
+  }
+  protocol::HibernatedSession hibernated;
+  const bool parsed = hibernated.ParseFromString(*data);
+  hibernated_session_map_->Erase(id);
+  if (!parsed) {
+    LOG(ERROR) << "Broken hibernated session: " << id;
+    return nullptr;
+  }
+
+  std::unique_ptr<session::Session> session = NewSession();
+  session->SetConfig(config_);
+  session->SetKeyMapManager(key_map_manager_);
+  session->SetRequest(request_);
+  session->SetTable(table_manager_->GetTable(*request_, *config_));
+  session->Resume(hibernated);
+  MOZC_VLOG(1) << "Session ID " << id << " is resumed";
+
+  session::Session* result = session.get();
+  AddActiveSession(id, std::move(session));
+  return result;
+}
+
+void SessionHandler::AddActiveSession(
+    SessionID id, std::unique_ptr<session::Session> session) {
+  if (hibernated_session_map_ &&
+      session_map_->Size() >= max_active_session_size_) {
+    HibernateSession(session_map_->Tail()->key);
+  }
+  // If the map is still full, Insert() drops the least recently used session.
+  session_map_->Insert(id)->value = std::move(session);
+}
+
+void SessionHandler::HibernateSession(SessionID id) {
+  std::unique_ptr<session::Session>* session =
+      session_map_->MutableLookupWithoutInsert(id);
+  if (!hibernated_session_map_ || session == nullptr || !*session) {
+    return;
+  }
+  protocol::HibernatedSession hibernated;
+  (*session)->Hibernate(&hibernated);
+  session_map_->Erase(id);
+  hibernated_session_map_->Insert(id, hibernated.SerializeAsString());
+}
+
+size_t SessionHandler::GetSessionSize() const {
+  return session_map_->Size() +
+         (hibernated_session_map_ ? hibernated_session_map_->Size() : 0);
+}
 }  // namespace mozc
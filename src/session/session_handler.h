@@ -32,13 +32,17 @@
 #ifndef MOZC_SESSION_SESSION_HANDLER_H_
 #define MOZC_SESSION_SESSION_HANDLER_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 
 #include "absl/random/random.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "base/file_stream.h"
+#include "base/trace.h"
 #include "composer/table.h"
 #include "engine/engine_interface.h"
 #include "protocol/commands.pb.h"
@@ -82,6 +86,8 @@ class SessionHandler {
   using SessionMap =
       mozc::storage::LruCache<SessionID, std::unique_ptr<session::Session>>;
   using SessionElement = SessionMap::Element;
+  // Idle sessions serialized as protocol::HibernatedSession.
+  using HibernatedSessionMap = mozc::storage::LruCache<SessionID, std::string>;
 
   // Updates the config, if the |command| contains the config.
   void MaybeUpdateConfig(commands::Command* command);
@@ -118,6 +124,7 @@ class SessionHandler {
   bool NoOperation(commands::Command* command);
   bool ReloadSupplementalModel(commands::Command* command);
   bool GetServerVersion(commands::Command* command) const;
+  bool GetMemoryUsage(commands::Command* command) const;
 
   // Replaces engine_ with a new instance if it is ready.
   void MaybeReloadEngine(commands::Command* command);
@@ -125,12 +132,31 @@ class SessionHandler {
   SessionID CreateNewSessionID();
   bool DeleteSessionID(SessionID id);
 
+  // Returns the session for |id|, resuming it if it is hibernated. Returns
+  // nullptr if there is no such session.
+  session::Session* GetSession(SessionID id);
+  // Adds |session| to the active sessions. If the active sessions are full,
+  // the least recently used one is hibernated.
+  void AddActiveSession(SessionID id,
+                        std::unique_ptr<session::Session> session);
+  // Moves the active session of |id| to the hibernated sessions.
+  void HibernateSession(SessionID id);
+  // Returns the number of the active and hibernated sessions.
+  size_t GetSessionSize() const;
+
+  // Copies the spans recorded by trace_recorder_ to the output and/or the
+  // trace file.
+  void OutputTrace(commands::Command* command);
+
   std::unique_ptr<SessionMap> session_map_;
+  // Null if hibernation is disabled, i.e. all the sessions are active.
+  std::unique_ptr<HibernatedSessionMap> hibernated_session_map_;
 #ifndef MOZC_DISABLE_SESSION_WATCHDOG
   std::optional<SessionWatchDog> session_watch_dog_;
 #endif  // MOZC_DISABLE_SESSION_WATCHDOG
   bool is_available_ = false;
   uint32_t max_session_size_ = 0;
+  uint32_t max_active_session_size_ = 0;
   absl::Time last_session_empty_time_ = absl::InfinitePast();
   absl::Time last_cleanup_time_ = absl::InfinitePast();
   absl::Time last_create_session_time_ = absl::InfinitePast();
@@ -154,6 +180,11 @@ class SessionHandler {
   std::shared_ptr<keymap::KeyMapManager> key_map_manager_;
 
   absl::BitGen bitgen_;
+
+  // Reused for every command to avoid reallocation.
+  TraceRecorder trace_recorder_;
+  // Opened when --trace_file is specified.
+  std::unique_ptr<OutputFileStream> trace_stream_;
 };
 
 }  // namespace mozc
@@ -52,6 +52,8 @@ SEND_KEY        Enter
 SHOW
 SHOW_LOG_BY_VALUE       ございます
 SHOW_LOG_BY_VALUE       ございました
+GET_MEMORY_USAGE
+SHOW_MEMORY_USAGE
 */
 
 #include <cstdint>
@@ -116,6 +118,23 @@ void ShowLog(const commands::Output& output, const int cand_id) {
   }
 }
 
+void ShowMemoryUsage(const commands::Output& output) {
+  uint64_t total_heap_bytes = 0;
+  uint64_t total_resident_bytes = 0;
+  for (const commands::Output::MemoryUsage& usage : output.memory_usage()) {
+    std::cout << usage.name() << "\theap=" << usage.heap_bytes()
+              << "\tmapped=" << usage.mapped_bytes();
+    if (usage.has_resident_bytes()) {
+      std::cout << "\tresident=" << usage.resident_bytes();
+    }
+    std::cout << std::endl;
+    total_heap_bytes += usage.heap_bytes();
+    total_resident_bytes += usage.resident_bytes();
+  }
+  std::cout << "total\theap=" << total_heap_bytes
+            << "\tresident=" << total_resident_bytes << std::endl;
+}
+
 bool ParseLine(session::SessionHandlerInterpreter& handler, std::string line,
                int line_number) {
   std::vector<std::string> args = handler.Parse(line);
@@ -154,6 +173,11 @@ bool ParseLine(session::SessionHandlerInterpreter& handler, std::string line,
     Show(handler.LastOutput());
     return true;
   }
+  if (command == "SHOW_MEMORY_USAGE") {
+    // Run GET_MEMORY_USAGE beforehand.
+    ShowMemoryUsage(handler.LastOutput());
+    return true;
+  }
   if (command == "SHOW_LOG") {
     uint32_t id;
     if (args.size() == 2 && absl::SimpleAtoi(args[1], &id)) {
@@ -38,6 +38,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/declare.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
@@ -47,6 +48,7 @@
 #include "absl/time/time.h"
 #include "base/clock.h"
 #include "base/clock_mock.h"
+#include "base/memory_usage.h"
 #include "config/config_handler.h"
 #include "data_manager/data_manager.h"
 #include "data_manager/testing/mock_data_manager.h"
@@ -65,6 +67,8 @@
 #include "testing/test_peer.h"
 
 ABSL_DECLARE_FLAG(int32_t, max_session_size);
+ABSL_DECLARE_FLAG(int32_t, max_active_session_size);
+ABSL_DECLARE_FLAG(absl::Duration, hibernate_session_timeout);
 ABSL_DECLARE_FLAG(int32_t, create_session_min_interval);
 ABSL_DECLARE_FLAG(int32_t, last_command_timeout);
 ABSL_DECLARE_FLAG(int32_t, last_create_session_timeout);
@@ -82,6 +86,7 @@ class KeyMapManagerAccessorTestPeer : public testing::TestPeer<SessionHandler> {
 namespace {
 
 using ::mozc::session::testing::SessionHandlerTestBase;
+using ::testing::_;
 using ::testing::Return;
 
 EngineReloadResponse::Status SendMockEngineReloadRequest(
@@ -269,6 +274,95 @@ TEST_F(SessionHandlerTest, MaxSessionSizeTest) {
   Clock::SetClockForUnitTest(nullptr);
 }
 
+TEST_F(SessionHandlerTest, HibernateSessionTest) {
+  absl::SetFlag(&FLAGS_create_session_min_interval, 0);
+  absl::SetFlag(&FLAGS_max_session_size, 4);
+  absl::SetFlag(&FLAGS_max_active_session_size, 2);
+  SessionHandler handler(CreateMockDataEngine());
+
+  uint64_t composing_id = 0;
+  ASSERT_TRUE(CreateSession(handler, &composing_id));
+  {
+    commands::Command command;
+    commands::Input* input = command.mutable_input();
+    input->set_id(composing_id);
+    input->set_type(commands::Input::SEND_KEY);
+    input->mutable_key()->set_special_key(commands::KeyEvent::ON);
+    ASSERT_TRUE(handler.EvalCommand(&command));
+  }
+  {
+    commands::Command command;
+    commands::Input* input = command.mutable_input();
+    input->set_id(composing_id);
+    input->set_type(commands::Input::SEND_KEY);
+    input->mutable_key()->set_key_code('a');
+    ASSERT_TRUE(handler.EvalCommand(&command));
+    EXPECT_EQ(command.output().preedit().segment(0).value(), "あ");
+  }
+
+  // The first session is hibernated by the newer ones.
+  std::vector<uint64_t> ids;
+  for (int i = 0; i < 3; ++i) {
+    uint64_t id = 0;
+    EXPECT_TRUE(CreateSession(handler, &id));
+    ids.push_back(id);
+  }
+
+  // The composition is restored on the next access.
+  {
+    commands::Command command;
+    commands::Input* input = command.mutable_input();
+    input->set_id(composing_id);
+    input->set_type(commands::Input::SEND_KEY);
+    input->mutable_key()->set_key_code('i');
+    ASSERT_TRUE(handler.EvalCommand(&command));
+    EXPECT_EQ(command.output().error_code(),
+              commands::Output::SESSION_SUCCESS);
+    EXPECT_EQ(command.output().preedit().segment(0).value(), "あい");
+  }
+  for (const uint64_t id : ids) {
+    EXPECT_TRUE(IsGoodSession(handler, id));
+  }
+
+  // The oldest session is removed once the total size is exceeded.
+  EXPECT_TRUE(CreateSession(handler, nullptr));
+  EXPECT_FALSE(IsGoodSession(handler, composing_id));
+  for (const uint64_t id : ids) {
+    EXPECT_TRUE(IsGoodSession(handler, id));
+  }
+}
+
+TEST_F(SessionHandlerTest, HibernateIdleSessionTest) {
+  const absl::Duration timeout = absl::Seconds(10);
+  absl::SetFlag(&FLAGS_max_session_size, 4);
+  absl::SetFlag(&FLAGS_max_active_session_size, 2);
+  absl::SetFlag(&FLAGS_hibernate_session_timeout, timeout);
+  absl::SetFlag(&FLAGS_last_command_timeout,
+                static_cast<int32_t>(absl::ToInt64Seconds(3 * timeout)));
+  ClockMock clock(absl::FromUnixSeconds(1000));
+  Clock::SetClockForUnitTest(&clock);
+
+  SessionHandler handler(CreateMockDataEngine());
+
+  uint64_t id = 0;
+  EXPECT_TRUE(CreateSession(handler, &id));
+  EXPECT_TRUE(IsGoodSession(handler, id));
+
+  // Hibernated by the cleanup and resumed by the next command.
+  clock.Advance(timeout);
+  EXPECT_TRUE(CleanUp(handler, id));
+  EXPECT_TRUE(IsGoodSession(handler, id));
+
+  // Hibernated sessions are removed by the last command timeout as well.
+  clock.Advance(timeout);
+  EXPECT_TRUE(CleanUp(handler, id));
+  clock.Advance(3 * timeout);
+  EXPECT_TRUE(CleanUp(handler, id));
+  EXPECT_FALSE(IsGoodSession(handler, id));
+
+  Clock::SetClockForUnitTest(nullptr);
+}
+
 TEST_F(SessionHandlerTest, CreateSession_ConfigTest) {
   // Setting ATOK to ConfigHandler before all other initializations.
   //  Not using SET_CONFIG command
@@ -781,6 +875,51 @@ TEST_F(SessionHandlerTest, GetServerVersionTest) {
   EXPECT_EQ(command.output().server_version().data_version(), "24.20240101.01");
 }
 
+TEST_F(SessionHandlerTest, GetMemoryUsageTest) {
+  auto engine = std::make_unique<MockEngine>();
+  EXPECT_CALL(*engine, CollectMemoryUsage(_))
+      .WillOnce([](MemoryUsageCollector& collector) {
+        collector.AddHeap("engine.test", 1234);
+      });
+  SessionHandler handler(std::move(engine));
+
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::GET_MEMORY_USAGE);
+  ASSERT_TRUE(handler.EvalCommand(&command));
+  absl::flat_hash_map<std::string, commands::Output::MemoryUsage> usages;
+  for (const commands::Output::MemoryUsage& usage :
+       command.output().memory_usage()) {
+    usages.emplace(usage.name(), usage);
+  }
+  ASSERT_TRUE(usages.contains("engine.test"));
+  EXPECT_EQ(usages["engine.test"].heap_bytes(), 1234);
+  EXPECT_TRUE(usages.contains("composer.tables"));
+  EXPECT_TRUE(usages.contains("session.active"));
+}
+
+TEST_F(SessionHandlerTest, RequestTraceTest) {
+  auto engine = std::make_unique<MockEngine>();
+  EXPECT_CALL(*engine, GetDataVersion())
+      .WillRepeatedly(Return("24.20240101.01"));
+  SessionHandler handler(std::move(engine));
+
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::GET_SERVER_VERSION);
+  handler.EvalCommand(&command);
+  EXPECT_EQ(command.output().trace_spans_size(), 0);
+
+  command.Clear();
+  command.mutable_input()->set_type(commands::Input::GET_SERVER_VERSION);
+  command.mutable_input()->set_request_trace(true);
+  handler.EvalCommand(&command);
+  ASSERT_GE(command.output().trace_spans_size(), 1);
+  const commands::Output::TraceSpan& root = command.output().trace_spans(0);
+  EXPECT_EQ(root.name(), "GET_SERVER_VERSION");
+  EXPECT_EQ(root.depth(), 0);
+  EXPECT_EQ(root.begin_usec(), 0);
+  EXPECT_GE(root.duration_usec(), 0);
+}
+
 TEST_F(SessionHandlerTest, ReloadFromMinimalEngine) {
   std::unique_ptr<Engine> engine = Engine::CreateEngine();
 
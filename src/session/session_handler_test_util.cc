@@ -33,6 +33,7 @@
 
 #include "absl/flags/declare.h"
 #include "absl/flags/flag.h"
+#include "absl/time/time.h"
 #include "base/config_file_stream.h"
 #include "base/file_util.h"
 #include "config/character_form_manager.h"
@@ -42,6 +43,8 @@
 #include "session/session_handler.h"
 
 ABSL_DECLARE_FLAG(int32_t, max_session_size);
+ABSL_DECLARE_FLAG(int32_t, max_active_session_size);
+ABSL_DECLARE_FLAG(absl::Duration, hibernate_session_timeout);
 ABSL_DECLARE_FLAG(int32_t, create_session_min_interval);
 ABSL_DECLARE_FLAG(int32_t, watch_dog_interval);
 ABSL_DECLARE_FLAG(int32_t, last_command_timeout);
@@ -101,6 +104,10 @@ bool IsGoodSession(SessionHandler* handler, uint64_t id) {
 
 void SessionHandlerTestBase::SetUp() {
   flags_max_session_size_backup_ = absl::GetFlag(FLAGS_max_session_size);
+  flags_max_active_session_size_backup_ =
+      absl::GetFlag(FLAGS_max_active_session_size);
+  flags_hibernate_session_timeout_backup_ =
+      absl::GetFlag(FLAGS_hibernate_session_timeout);
   flags_create_session_min_interval_backup_ =
       absl::GetFlag(FLAGS_create_session_min_interval);
   flags_watch_dog_interval_backup_ = absl::GetFlag(FLAGS_watch_dog_interval);
@@ -119,6 +126,10 @@ void SessionHandlerTestBase::TearDown() {
   ConfigHandler::SetConfig(config_backup_);
 
   absl::SetFlag(&FLAGS_max_session_size, flags_max_session_size_backup_);
+  absl::SetFlag(&FLAGS_max_active_session_size,
+                flags_max_active_session_size_backup_);
+  absl::SetFlag(&FLAGS_hibernate_session_timeout,
+                flags_hibernate_session_timeout_backup_);
   absl::SetFlag(&FLAGS_create_session_min_interval,
                 flags_create_session_min_interval_backup_);
   absl::SetFlag(&FLAGS_watch_dog_interval, flags_watch_dog_interval_backup_);
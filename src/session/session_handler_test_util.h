@@ -34,6 +34,7 @@
 
 #include <cstdint>
 
+#include "absl/time/time.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
 #include "session/session_handler.h"
@@ -70,6 +71,8 @@ class SessionHandlerTestBase : public ::mozc::testing::TestWithTempUserProfile {
  private:
   config::Config config_backup_;
   int32_t flags_max_session_size_backup_;
+  int32_t flags_max_active_session_size_backup_;
+  absl::Duration flags_hibernate_session_timeout_backup_;
   int32_t flags_create_session_min_interval_backup_;
   int32_t flags_watch_dog_interval_backup_;
   int32_t flags_last_command_timeout_backup_;
@@ -255,6 +255,12 @@ bool SessionHandlerTool::SyncData() {
   return true;
 }
 
+bool SessionHandlerTool::GetMemoryUsage(commands::Output* output) {
+  commands::Input input;
+  input.set_type(commands::Input::GET_MEMORY_USAGE);
+  return EvalCommand(&input, output);
+}
+
 void SessionHandlerTool::SetCallbackText(const absl::string_view text) {
   strings::Assign(callback_text_, text);
 }
@@ -736,6 +742,9 @@ absl::Status SessionHandlerInterpreter::Eval(
   } else if (command == "CLEAR_USER_PREDICTION") {
     MOZC_ASSERT_EQ(1, args.size());
     ClearUserPrediction();
+  } else if (command == "GET_MEMORY_USAGE") {
+    MOZC_ASSERT_EQ(1, args.size());
+    MOZC_ASSERT_TRUE(client_->GetMemoryUsage(last_output_.get()));
   } else if (command == "EXPECT_CONSUMED") {
     MOZC_ASSERT_EQ(args.size(), 2);
     MOZC_ASSERT_TRUE(last_output_->has_consumed());
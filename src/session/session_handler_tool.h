@@ -90,6 +90,7 @@ class SessionHandlerTool {
   bool SetRequest(const commands::Request& request, commands::Output* output);
   bool SetConfig(const config::Config& config, commands::Output* output);
   bool SyncData();
+  bool GetMemoryUsage(commands::Output* output);
   void SetCallbackText(absl::string_view text);
   bool ReloadSupplementalModel(absl::string_view model_path);
 
@@ -33,12 +33,15 @@
 
 #include "session/session_server.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/log/log.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "base/protobuf/arena.h"
 #include "base/vlog.h"
 #include "engine/engine_factory.h"
 #include "ipc/ipc.h"
@@ -58,6 +61,9 @@ constexpr int kNumConnections = 10;
 #endif  // _WIN32
 
 constexpr absl::Duration kTimeOut = absl::Milliseconds(5000);
+
+// Large enough for the messages of a request with a full candidate window.
+constexpr size_t kArenaBlockSize = 256 * 1024;
 constexpr char kSessionName[] = "session";
 constexpr char kEventName[] = "session";
 
@@ -68,7 +74,9 @@ namespace mozc {
 SessionServer::SessionServer()
     : IPCServer(kSessionName, kNumConnections, kTimeOut),
       session_handler_(
-          std::make_unique<SessionHandler>(EngineFactory::Create().value())) {
+          std::make_unique<SessionHandler>(EngineFactory::Create().value())),
+      arena_block_(std::make_unique_for_overwrite<char[]>(kArenaBlockSize)),
+      arena_(arena_block_.get(), kArenaBlockSize) {
   // start session watch dog timer
   session_handler_->StartWatchDog();
 
@@ -90,27 +98,29 @@ bool SessionServer::Process(absl::string_view request, std::string* response) {
     return false;  // shutdown the server if handler doesn't exist
   }
 
-  commands::Command command;
-  if (!command.mutable_input()->ParseFromString(request)) {
+  absl::Cleanup reset_arena = [this] { arena_.Reset(); };
+  commands::Command* command =
+      protobuf::Arena::Create<commands::Command>(&arena_);
+  if (!command->mutable_input()->ParseFromString(request)) {
     LOG(WARNING) << "Invalid request";
     response->clear();
     return true;
   }
 
-  if (!session_handler_->EvalCommand(&command)) {
+  if (!session_handler_->EvalCommand(command)) {
     LOG(WARNING) << "EvalCommand() returned false. Exiting the loop.";
     response->clear();
     return false;
   }
 
-  if (!command.output().SerializeToString(response)) {
+  if (!command->output().SerializeToString(response)) {
     LOG(WARNING) << "SerializeToString() failed";
     response->clear();
     return true;
   }
 
   // debug message
-  MOZC_VLOG(2) << command;
+  MOZC_VLOG(2) << *command;
 
   return true;
 }
@@ -36,6 +36,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "base/protobuf/arena.h"
 #include "ipc/ipc.h"
 #include "session/session_handler.h"
 
@@ -63,6 +64,14 @@ class SessionServer : public IPCServer {
 
  private:
   std::unique_ptr<SessionHandler> session_handler_;
+
+  // The messages of a request are allocated on `arena_` and released at once
+  // after the response is serialized. Process() is called only from the
+  // server thread, so one arena is reused by all the requests. The initial
+  // block is kept by Reset(), so the usual requests allocate no memory for the
+  // messages.
+  std::unique_ptr<char[]> arena_block_;
+  protobuf::Arena arena_;
 };
 
 }  // namespace mozc
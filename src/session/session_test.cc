@@ -62,6 +62,7 @@
 #include "protocol/candidate_window.pb.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "request/conversion_request.h"
 #include "request/request_test_util.h"
 #include "rewriter/transliteration_rewriter.h"
@@ -3427,6 +3428,65 @@ TEST_F(SessionTest, ClearUndoContextAfterDirectInputAfterConversion) {
   EXPECT_FALSE(command.output().has_preedit());
 }
 
+TEST_F(SessionTest, ResumeKeepsTemporaryAsciiSegment) {
+  MockEngine engine;
+  std::shared_ptr<MockConverter> converter = CreateEngineConverterMock(&engine);
+
+  Session session(engine);
+  InitSessionToPrecomposition(&session);
+  commands::Command command;
+
+  // Shifted "GOOGLE" is typed in the temporary ASCII mode, and the following
+  // lower case input comes back to Hiragana.
+  InsertCharacterChars("GOOGLEkensaku", &session, &command);
+  EXPECT_PREEDIT("GOOGLEけんさく", command);
+
+  protocol::HibernatedSession hibernated;
+  session.Hibernate(&hibernated);
+
+  Session resumed(engine);
+  InitSessionToPrecomposition(&resumed);
+  resumed.Resume(hibernated);
+  EXPECT_EQ(resumed.context().state(), ImeContext::COMPOSITION);
+  EXPECT_EQ(resumed.context().composer().GetStringForPreedit(),
+            "GOOGLEけんさく");
+  EXPECT_EQ(resumed.context().composer().GetInputMode(),
+            transliteration::HIRAGANA);
+
+  InsertCharacterChars("a", &resumed, &command);
+  EXPECT_PREEDIT("GOOGLEけんさくあ", command);
+}
+
+TEST_F(SessionTest, ResumeKeepsTemporaryInputMode) {
+  MockEngine engine;
+  std::shared_ptr<MockConverter> converter = CreateEngineConverterMock(&engine);
+
+  Session session(engine);
+  InitSessionToPrecomposition(&session);
+  commands::Command command;
+
+  InsertCharacterChars("aGo", &session, &command);
+  EXPECT_PREEDIT("あGo", command);
+  EXPECT_EQ(command.output().mode(), commands::HALF_ASCII);
+
+  protocol::HibernatedSession hibernated;
+  session.Hibernate(&hibernated);
+
+  Session resumed(engine);
+  InitSessionToPrecomposition(&resumed);
+  resumed.Resume(hibernated);
+  EXPECT_EQ(resumed.context().composer().GetStringForPreedit(), "あGo");
+
+  // The temporary ASCII mode continues, and the input mode comes back to
+  // Hiragana when the composition is committed.
+  InsertCharacterChars("ogle", &resumed, &command);
+  EXPECT_PREEDIT("あGoogle", command);
+  EXPECT_EQ(command.output().mode(), commands::HALF_ASCII);
+  SendKey("Enter", &resumed, &command);
+  EXPECT_RESULT("あGoogle", command);
+  EXPECT_EQ(command.output().mode(), commands::HIRAGANA);
+}
+
 TEST_F(SessionTest, TemporaryCompositionModeAfterUndo) {
   MockEngine engine;
   std::shared_ptr<MockConverter> converter = CreateEngineConverterMock(&engine);
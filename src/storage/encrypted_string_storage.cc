@@ -38,6 +38,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "base/encryptor.h"
 #include "base/file_stream.h"
 #include "base/file_util.h"
@@ -59,65 +60,48 @@ constexpr size_t kSaltSize = 32;
 
 // Maximum file size (64Mbyte)
 constexpr size_t kMaxFileSize = 64 * 1024 * 1024;
+
+// Size of the data encrypted or decrypted at once.
+constexpr size_t kChunkSize = 64 * 1024;
 }  // namespace
 
 bool EncryptedStringStorage::Load(std::string* output) const {
   DCHECK(output);
 
-  std::string salt;
-
   // Reads encrypted message and salt from local file
-  {
-    const absl::StatusOr<Mmap> mmap = Mmap::Map(filename_, Mmap::READ_ONLY);
-    if (!mmap.ok()) {
-      LOG(ERROR) << "cannot open user history file: " << mmap.status();
-      return false;
-    }
-
-    if (mmap->size() < kSaltSize) {
-      LOG(ERROR) << "file size is too small";
-      return false;
-    }
-
-    if (mmap->size() > kMaxFileSize) {
-      LOG(ERROR) << "file size is too big.";
-      return false;
-    }
-
-    // copy salt
-    salt.assign(mmap->begin(), kSaltSize);
-
-    // copy body
-    output->assign(mmap->begin() + kSaltSize, mmap->size() - kSaltSize);
+  const absl::StatusOr<Mmap> mmap = Mmap::Map(filename_, Mmap::READ_ONLY);
+  if (!mmap.ok()) {
+    LOG(ERROR) << "cannot open user history file: " << mmap.status();
+    return false;
   }
 
-  return Decrypt(salt, output);
-}
-
-bool EncryptedStringStorage::Decrypt(absl::string_view salt,
-                                     std::string* data) const {
-  DCHECK(data);
-
-  std::string password;
-  if (!PasswordManager::GetPassword(&password)) {
-    LOG(ERROR) << "PasswordManager::GetPassword() failed";
+  if (mmap->size() < kSaltSize) {
+    LOG(ERROR) << "file size is too small";
     return false;
   }
 
-  if (password.empty()) {
-    LOG(ERROR) << "password is empty";
+  if (mmap->size() > kMaxFileSize) {
+    LOG(ERROR) << "file size is too big.";
     return false;
   }
 
-  // Decrypt message
+  const absl::string_view salt = mmap->string_view().substr(0, kSaltSize);
   Encryptor::Key key;
-  if (!key.DeriveFromPassword(password, salt)) {
-    LOG(ERROR) << "Encryptor::Key::DeriveFromPassword failed";
+  if (!DeriveKey(salt, &key)) {
     return false;
   }
 
-  if (!Encryptor::DecryptString(key, data)) {
-    LOG(ERROR) << "Encryptor::DecryptString() failed";
+  // Decrypts the body directly from the mapped file.
+  const absl::string_view body = mmap->string_view().substr(kSaltSize);
+  Encryptor::DecryptionStream stream(key);
+  output->clear();
+  output->reserve(body.size());
+  for (size_t i = 0; i < body.size(); i += kChunkSize) {
+    stream.Update(body.substr(i, kChunkSize), output);
+  }
+  if (!stream.Finish(output)) {
+    LOG(ERROR) << "Encryptor::DecryptionStream::Finish() failed";
+    output->clear();
     return false;
   }
 
@@ -125,16 +109,19 @@ bool EncryptedStringStorage::Decrypt(absl::string_view salt,
 }
 
 bool EncryptedStringStorage::Save(absl::string_view input) const {
-  // Generate salt.
-  const std::string salt = mozc::Random().ByteString(kSaltSize);
+  if (input.empty()) {
+    LOG(ERROR) << "input is empty";
+    return false;
+  }
 
-  std::string output(input);
-  if (!Encrypt(salt, &output)) {
+  // A fresh salt gives a fresh key and IV, so the same data is never encrypted
+  // into the same ciphertext twice.
+  const std::string salt = mozc::Random().ByteString(kSaltSize);
+  Encryptor::Key key;
+  if (!DeriveKey(salt, &key)) {
     return false;
   }
 
-  // Even if histoy is empty, save to them into a file to
-  // make the file empty
   const std::string tmp_filename = filename_ + ".tmp";
   {
     OutputFileStream ofs(tmp_filename, std::ios::out | std::ios::binary);
@@ -145,7 +132,18 @@ bool EncryptedStringStorage::Save(absl::string_view input) const {
 
     MOZC_VLOG(1) << "Syncing user history to: " << filename_;
     ofs.write(salt.data(), salt.size());
-    ofs.write(output.data(), output.size());
+
+    Encryptor::EncryptionStream stream(key);
+    std::string buf;
+    buf.reserve(kChunkSize + Encryptor::kBlockSize);
+    for (size_t i = 0; i < input.size(); i += kChunkSize) {
+      buf.clear();
+      stream.Update(input.substr(i, kChunkSize), &buf);
+      ofs.write(buf.data(), buf.size());
+    }
+    buf.clear();
+    stream.Finish(&buf);
+    ofs.write(buf.data(), buf.size());
   }
 
   if (absl::Status s = FileUtil::AtomicRename(tmp_filename, filename_);
@@ -165,29 +163,36 @@ bool EncryptedStringStorage::Save(absl::string_view input) const {
   return true;
 }
 
-bool EncryptedStringStorage::Encrypt(absl::string_view salt,
-                                     std::string* data) const {
-  DCHECK(data);
+bool EncryptedStringStorage::GetPassword(std::string* password) const {
+  DCHECK(password);
 
-  std::string password;
-  if (!PasswordManager::GetPassword(&password)) {
-    LOG(ERROR) << "PasswordManager::GetPassword() failed";
-    return false;
+  absl::MutexLock lock(mutex_);
+  if (password_.empty()) {
+    if (!PasswordManager::GetPassword(&password_)) {
+      LOG(ERROR) << "PasswordManager::GetPassword() failed";
+      password_.clear();
+      return false;
+    }
+    if (password_.empty()) {
+      LOG(ERROR) << "password is empty";
+      return false;
+    }
   }
+  *password = password_;
+  return true;
+}
 
-  if (password.empty()) {
-    LOG(ERROR) << "password is empty";
-    return false;
-  }
+bool EncryptedStringStorage::DeriveKey(absl::string_view salt,
+                                       Encryptor::Key* key) const {
+  DCHECK(key);
 
-  Encryptor::Key key;
-  if (!key.DeriveFromPassword(password, salt)) {
-    LOG(ERROR) << "Encryptor::Key::DeriveFromPassword() failed";
+  std::string password;
+  if (!GetPassword(&password)) {
     return false;
   }
 
-  if (!Encryptor::EncryptString(key, data)) {
-    LOG(ERROR) << "Encryptor::EncryptString() failed";
+  if (!key->DeriveFromPassword(password, salt)) {
+    LOG(ERROR) << "Encryptor::Key::DeriveFromPassword() failed";
     return false;
   }
 
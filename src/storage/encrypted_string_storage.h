@@ -32,7 +32,10 @@
 
 #include <string>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "base/encryptor.h"
 
 namespace mozc {
 namespace storage {
@@ -45,6 +48,11 @@ class StringStorageInterface {
   virtual bool Save(absl::string_view input) const = 0;
 };
 
+// Stores a string in a file encrypted with a key derived from the password
+// of PasswordManager and the random salt at the head of the file. Every save
+// uses a fresh salt. The data is encrypted and decrypted in chunks, and the
+// password is obtained only once per instance, so keep the instance to save and
+// load the same file repeatedly.
 class EncryptedStringStorage : public StringStorageInterface {
  public:
   explicit EncryptedStringStorage(absl::string_view filename)
@@ -58,11 +66,18 @@ class EncryptedStringStorage : public StringStorageInterface {
   absl::string_view filename() const { return filename_; }
 
  protected:
-  virtual bool Encrypt(absl::string_view salt, std::string* data) const;
-  virtual bool Decrypt(absl::string_view salt, std::string* data) const;
+  // Derives the key for the data saved with |salt|.
+  virtual bool DeriveKey(absl::string_view salt, Encryptor::Key* key) const;
 
  private:
+  // Returns the password of PasswordManager, which is costly to get.
+  bool GetPassword(std::string* password) const;
+
   std::string filename_;
+
+  // The password cached by GetPassword().
+  mutable absl::Mutex mutex_;
+  mutable std::string password_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace storage
@@ -35,6 +35,9 @@
 #include <memory>
 #include <string>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "base/encryptor.h"
 #include "base/file_stream.h"
 #include "base/file_util.h"
 #include "base/system_util.h"
@@ -55,24 +58,9 @@ class TestEncryptedStringStorage : public EncryptedStringStorage {
       : EncryptedStringStorage(filename) {}
 
  protected:
-  virtual bool Encrypt(absl::string_view salt, std::string* data) const {
-    salt_ = salt;
-    original_data_ = *data;
-    *data = "123456789012345678901234567890";
-    return true;
+  bool DeriveKey(absl::string_view salt, Encryptor::Key* key) const override {
+    return key->DeriveFromPassword("password", salt);
   }
-
-  virtual bool Decrypt(absl::string_view salt, std::string* data) const {
-    if (salt_ != salt) {
-      return false;
-    }
-    CHECK_EQ(*data, "123456789012345678901234567890");
-    *data = original_data_;
-    return true;
-  }
-
-  mutable std::string salt_;
-  mutable std::string original_data_;
 };
 #else   // __ANDROID__
 typedef EncryptedStringStorage TestEncryptedStringStorage;
@@ -102,6 +90,58 @@ TEST_F(EncryptedStringStorageTest, SaveAndLoad) {
   EXPECT_EQ(output, kData);
 }
 
+TEST_F(EncryptedStringStorageTest, SaveAndLoadLargeData) {
+  // Longer than the chunk size and not aligned to the block size.
+  std::string data;
+  for (int i = 0; data.size() < 200 * 1024; ++i) {
+    data.append(std::to_string(i));
+  }
+  ASSERT_TRUE(storage_->Save(data));
+
+  std::string output;
+  ASSERT_TRUE(storage_->Load(&output));
+  EXPECT_EQ(output, data);
+
+  // Overwrites the file with the cached password.
+  data.resize(data.size() / 2);
+  ASSERT_TRUE(storage_->Save(data));
+
+  // Another instance derives the key from the salt in the file.
+  TestEncryptedStringStorage storage(filename_);
+  ASSERT_TRUE(storage.Load(&output));
+  EXPECT_EQ(output, data);
+}
+
+TEST_F(EncryptedStringStorageTest, SaveWithFreshSalt) {
+  // Saving the same data twice must not give the same file, or unchanged
+  // leading parts of the data would be recognizable across saves.
+  const std::string data(1024, 'a');
+  ASSERT_TRUE(storage_->Save(data));
+  const absl::StatusOr<std::string> first = FileUtil::GetContents(filename_);
+  ASSERT_TRUE(first.ok()) << first.status();
+
+  ASSERT_TRUE(storage_->Save(data));
+  const absl::StatusOr<std::string> second = FileUtil::GetContents(filename_);
+  ASSERT_TRUE(second.ok()) << second.status();
+
+  ASSERT_EQ(first->size(), second->size());
+  EXPECT_NE(*first, *second);
+  // No ciphertext block is shared either.
+  for (size_t i = 0; i < first->size(); i += Encryptor::kBlockSize) {
+    EXPECT_NE(first->substr(i, Encryptor::kBlockSize),
+              second->substr(i, Encryptor::kBlockSize))
+        << i;
+  }
+
+  std::string output;
+  ASSERT_TRUE(storage_->Load(&output));
+  EXPECT_EQ(output, data);
+}
+
+TEST_F(EncryptedStringStorageTest, SaveEmptyData) {
+  EXPECT_FALSE(storage_->Save(""));
+}
+
 #ifndef __ANDROID__
 // Note: On Android, we cannot check the behavior of Encryption because
 // it depends on the JVM's behavior, which cannot be launched from native test.
@@ -40,11 +40,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/prefetch.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/bits.h"
 #include "base/vlog.h"
@@ -114,11 +117,33 @@ BlockBitmap BlockBitmapBuilder::Build() const {
   return BlockBitmap(std::move(blocks));
 }
 
+uint64_t Fingerprint(absl::Span<const absl::string_view> strs,
+                     uint8_t fp_type) {
+  char buf[256];
+  size_t len = 0;
+  for (const absl::string_view str : strs) {
+    if (str.size() > sizeof(buf) - len) {
+      return Fingerprint(absl::StrJoin(strs, ""), fp_type);
+    }
+    memcpy(buf + len, str.data(), str.size());
+    len += str.size();
+  }
+  return Fingerprint(absl::string_view(buf, len), fp_type);
+}
+
 }  // namespace existence_filter_internal
 
 namespace {
 
 constexpr uint32_t kHeaderSize = 3;
+// The BLOCKED layout pads the header to 64 bytes to align the Bloom blocks.
+constexpr uint32_t kBlockedHeaderSize =
+    existence_filter_internal::kBloomBlockWords;
+
+constexpr uint32_t GetHeaderSize(const ExistenceFilterParams& params) {
+  return params.layout == ExistenceFilterParams::BLOCKED ? kBlockedHeaderSize
+                                                         : kHeaderSize;
+}
 
 absl::StatusOr<ExistenceFilterParams> ReadHeader(
     absl::Span<const uint32_t> buf) {
@@ -137,7 +162,8 @@ absl::StatusOr<ExistenceFilterParams> ReadHeader(
   // binary stores the value in lower bits.
   const uint32_t v = *it++;
   params.num_hashes = v & 0xFFFF;
-  params.fp_type = v >> 16;
+  params.fp_type = (v >> 16) & 0xFF;
+  params.layout = v >> 24;
 
   if (params.num_hashes >= 8 || params.num_hashes <= 0) {
     return absl::InvalidArgumentError("Bad number of hashes (header.k)");
@@ -147,6 +173,16 @@ absl::StatusOr<ExistenceFilterParams> ReadHeader(
     return absl::InvalidArgumentError("unsupported fp type");
   }
 
+  if (params.layout >= ExistenceFilterParams::LAYOUT_SIZE) {
+    return absl::InvalidArgumentError("unsupported layout");
+  }
+
+  if (params.layout == ExistenceFilterParams::BLOCKED &&
+      (params.size == 0 ||
+       params.size % existence_filter_internal::kBloomBlockBits != 0)) {
+    return absl::InvalidArgumentError("Bad size for the blocked layout");
+  }
+
   return params;
 }
 
@@ -167,6 +203,9 @@ std::ostream& operator<<(std::ostream& os,
 }
 
 bool ExistenceFilter::Exists(uint64_t hash) const {
+  if (params_.layout == ExistenceFilterParams::BLOCKED) {
+    return ExistsBlocked(hash);
+  }
   for (int i = 0; i < params_.num_hashes; ++i) {
     hash = std::rotl(hash, 8);
     const uint32_t index = hash % params_.size;
@@ -177,6 +216,52 @@ bool ExistenceFilter::Exists(uint64_t hash) const {
   return true;
 }
 
+bool ExistenceFilter::ExistsBlocked(uint64_t hash) const {
+  using ::mozc::storage::existence_filter_internal::kBloomBlockWords;
+  const uint32_t* block = rep_.GetWords(
+      existence_filter_internal::GetBloomBlockOffset(hash, params_.size));
+  uint32_t mask[kBloomBlockWords];
+  existence_filter_internal::MakeBloomBlockMask(hash, params_.num_hashes,
+                                                mask);
+  // Tests all the words without branches so that the loop is vectorized.
+  uint32_t missing = 0;
+  for (int i = 0; i < kBloomBlockWords; ++i) {
+    missing |= mask[i] & ~block[i];
+  }
+  return missing == 0;
+}
+
+void ExistenceFilter::Prefetch(uint64_t hash) const {
+  if (params_.layout == ExistenceFilterParams::BLOCKED) {
+    absl::PrefetchToLocalCache(rep_.GetWords(
+        existence_filter_internal::GetBloomBlockOffset(hash, params_.size)));
+    return;
+  }
+  for (int i = 0; i < params_.num_hashes; ++i) {
+    hash = std::rotl(hash, 8);
+    absl::PrefetchToLocalCache(rep_.GetWords(hash % params_.size));
+  }
+}
+
+void ExistenceFilter::ExistsMany(absl::string_view prefix,
+                                 absl::Span<const absl::string_view> keys,
+                                 absl::Span<bool> results) const {
+  DCHECK_EQ(keys.size(), results.size());
+  constexpr size_t kBatchSize = 16;
+  uint64_t hashes[kBatchSize];
+  for (size_t begin = 0; begin < keys.size(); begin += kBatchSize) {
+    const size_t size = std::min(kBatchSize, keys.size() - begin);
+    for (size_t i = 0; i < size; ++i) {
+      hashes[i] = existence_filter_internal::Fingerprint(
+          {prefix, keys[begin + i]}, params_.fp_type);
+      Prefetch(hashes[i]);
+    }
+    for (size_t i = 0; i < size; ++i) {
+      results[begin + i] = Exists(hashes[i]);
+    }
+  }
+}
+
 absl::StatusOr<ExistenceFilter> ExistenceFilter::Read(
     absl::Span<const uint32_t> buf) {
   ExistenceFilterParams params;
@@ -186,23 +271,42 @@ absl::StatusOr<ExistenceFilter> ExistenceFilter::Read(
   } else {
     return absl::InvalidArgumentError("Invalid format: could not read header");
   }
-  buf.remove_prefix(kHeaderSize);
+  if (buf.size() < GetHeaderSize(params)) {
+    return absl::InvalidArgumentError(
+        "Not enough bufsize: could not read header");
+  }
+  buf.remove_prefix(GetHeaderSize(params));
 
   MOZC_VLOG(1) << "Reading bloom filter with params: " << params;
 
   if (buf.size() < BitsToWords(params.size)) {
     return absl::InvalidArgumentError("Not enough bufsize: could not read");
   }
+  // Each Bloom block of the BLOCKED layout has to fit in one cache line. The
+  // data set packs the filters with 512-bit alignment.
+  if (params.layout == ExistenceFilterParams::BLOCKED &&
+      reinterpret_cast<uintptr_t>(buf.data()) %
+              existence_filter_internal::kBloomBlockBytes !=
+          0) {
+    return absl::InvalidArgumentError(
+        "Bitmap of the blocked layout is not aligned to the cache line");
+  }
 
   return ExistenceFilter(std::move(params), buf);
 }
 
 ExistenceFilterBuilder ExistenceFilterBuilder::CreateOptimal(
-    size_t size_in_bytes, uint32_t estimated_insertions, uint16_t fp_type) {
+    size_t size_in_bytes, uint32_t estimated_insertions, uint8_t fp_type,
+    uint8_t layout) {
   CHECK_LT(size_in_bytes, (1 << 29)) << "Requested size is too big";
   CHECK_GT(estimated_insertions, 0);
   CHECK_LT(fp_type, ExistenceFilterParams::FP_TYPE_SIZE);
-  const uint32_t m = std::max<uint32_t>(1, size_in_bytes * 8);
+  CHECK_LT(layout, ExistenceFilterParams::LAYOUT_SIZE);
+  uint32_t m = std::max<uint32_t>(1, size_in_bytes * 8);
+  if (layout == ExistenceFilterParams::BLOCKED) {
+    using ::mozc::storage::existence_filter_internal::kBloomBlockBits;
+    m = (m + kBloomBlockBits - 1) / kBloomBlockBits * kBloomBlockBits;
+  }
   const uint32_t n = estimated_insertions;
 
   uint16_t optimal_k =
@@ -211,10 +315,22 @@ ExistenceFilterBuilder ExistenceFilterBuilder::CreateOptimal(
 
   MOZC_VLOG(1) << "optimal_k: " << optimal_k;
 
-  return ExistenceFilterBuilder({m, n, optimal_k, fp_type});
+  return ExistenceFilterBuilder({m, n, optimal_k, fp_type, layout});
 }
 
 void ExistenceFilterBuilder::Insert(uint64_t hash) {
+  if (params_.layout == ExistenceFilterParams::BLOCKED) {
+    using ::mozc::storage::existence_filter_internal::kBloomBlockWords;
+    uint32_t* block = rep_.GetMutableWords(
+        existence_filter_internal::GetBloomBlockOffset(hash, params_.size));
+    uint32_t mask[kBloomBlockWords];
+    existence_filter_internal::MakeBloomBlockMask(hash, params_.num_hashes,
+                                                  mask);
+    for (int i = 0; i < kBloomBlockWords; ++i) {
+      block[i] |= mask[i];
+    }
+    return;
+  }
   for (int i = 0; i < params_.num_hashes; ++i) {
     hash = std::rotl(hash, 8);
     const uint32_t index = hash % params_.size;
@@ -223,7 +339,7 @@ void ExistenceFilterBuilder::Insert(uint64_t hash) {
 }
 
 size_t ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
-    float error_rate, size_t num_elements) {
+    float error_rate, size_t num_elements, uint8_t layout) {
   // (-num_hashes * num_elements) / log(1 - error_rate^(1/num_hashes))
 
   double min_bits = 0;
@@ -233,12 +349,17 @@ size_t ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
         log(1.0 - pow(static_cast<double>(error_rate), (1.0 / num_hashes)));
     if (min_bits == 0 || num_bits < min_bits) min_bits = num_bits;
   }
+  if (layout == ExistenceFilterParams::BLOCKED) {
+    // Keys are not evenly distributed over the blocks. Empirically, 25% more
+    // bits compensate the higher false positive rate.
+    min_bits *= 1.25;
+  }
   return static_cast<size_t>(ceil(min_bits / 8));
 }
 
 std::string ExistenceFilterBuilder::SerializeAsString() {
   const size_t required_bytes =
-      (kHeaderSize + BitsToWords(params_.size)) * sizeof(uint32_t);
+      (GetHeaderSize(params_) + BitsToWords(params_.size)) * sizeof(uint32_t);
   std::string buf;
   buf.resize(required_bytes);
 
@@ -249,7 +370,10 @@ std::string ExistenceFilterBuilder::SerializeAsString() {
   // Original num_hashes was 32 bit integer. Pushes the num_hases first so
   // it can evaluated properly even when loading them as single 32 bit integer.
   it = StoreUnaligned<uint16_t>(params_.num_hashes, it);
-  it = StoreUnaligned<uint16_t>(params_.fp_type, it);
+  it = StoreUnaligned<uint8_t>(params_.fp_type, it);
+  it = StoreUnaligned<uint8_t>(params_.layout, it);
+  // Padding is already zero-filled by resize().
+  it += (GetHeaderSize(params_) - kHeaderSize) * sizeof(uint32_t);
   // This method is called on data generation and we can call LOG(INFO) here.
   LOG(INFO) << "Header written: " << params_;
 
@@ -41,7 +41,6 @@
 #include "absl/base/attributes.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/hash.h"
@@ -56,6 +55,14 @@ inline constexpr int kBlockMask = kBlockBits - 1;
 inline constexpr int kBlockBytes = kBlockBits >> 3;
 inline constexpr int kBlockWords = kBlockBits >> 5;
 
+// Bloom block of the BLOCKED layout. 512 bits == 64 bytes == one cache line.
+// kBlockBits is a multiple of kBloomBlockBits, so a Bloom block never
+// straddles two bitmap blocks.
+inline constexpr int kBloomBlockShift = 9;
+inline constexpr int kBloomBlockBits = 1 << kBloomBlockShift;
+inline constexpr int kBloomBlockBytes = kBloomBlockBits >> 3;
+inline constexpr int kBloomBlockWords = kBloomBlockBits >> 5;
+
 // BlockBitmap is an immutable view, directly referencing data given to the
 // constructors.
 class BlockBitmap {
@@ -74,6 +81,13 @@ class BlockBitmap {
     return (blocks_[bindex][windex] >> bitpos) & 1;
   }
 
+  // Returns the pointer to the word containing the bit at `index`.
+  inline const uint32_t* GetWords(uint32_t index) const {
+    const uint32_t bindex = index >> kBlockShift;
+    const uint32_t windex = (index & kBlockMask) >> 5;
+    return blocks_[bindex].data() + windex;
+  }
+
  protected:
   // Array of blocks. Each block has kBlockBits region except for last block.
   std::vector<absl::Span<const uint32_t>> blocks_;
@@ -93,6 +107,12 @@ class BlockBitmapBuilder {
     blocks_[bindex][windex] |= (static_cast<uint32_t>(1) << bitpos);
   }
 
+  inline uint32_t* GetMutableWords(uint32_t index) {
+    const uint32_t bindex = index >> kBlockShift;
+    const uint32_t windex = (index & kBlockMask) >> 5;
+    return blocks_[bindex].data() + windex;
+  }
+
   // Serializes the bitmap to the area indicated by `it`.
   std::string::iterator SerializeTo(std::string::iterator it);
   // Builds a BlockBitmap from the underlying data. It doesn't copy the data, so
@@ -103,20 +123,51 @@ class BlockBitmapBuilder {
   std::vector<std::vector<uint32_t>> blocks_;
 };
 
-inline uint64_t Fingerprint(absl::string_view str, uint16_t fp_type) {
+inline uint64_t Fingerprint(absl::string_view str, uint8_t fp_type) {
   return fp_type == 0 ? LegacyFingerprint(str) : CityFingerprint(str);
 }
 
+// Returns the fingerprint of the concatenation of `strs`. Short keys are
+// concatenated on the stack to avoid allocations.
+uint64_t Fingerprint(absl::Span<const absl::string_view> strs,
+                     uint8_t fp_type);
+
+// Returns the bit index of the first bit of the Bloom block for `hash`.
+inline uint32_t GetBloomBlockOffset(uint64_t hash, uint32_t size) {
+  // Maps the upper 32 bits to [0, num_blocks) without division.
+  const uint64_t num_blocks = size >> kBloomBlockShift;
+  return static_cast<uint32_t>(((hash >> 32) * num_blocks) >> 32)
+         << kBloomBlockShift;
+}
+
+// Sets the `num_hashes` bits for `hash` to `mask`. The bit positions are
+// derived from the lower 32 bits, which are independent of the block offset.
+inline void MakeBloomBlockMask(uint64_t hash, int num_hashes,
+                               uint32_t mask[kBloomBlockWords]) {
+  static constexpr uint32_t kSalts[] = {0x47b6137b, 0x44974d91, 0x8824ad5b,
+                                        0xa2b7289d, 0x705495c7, 0x2df1424b,
+                                        0x9efc4947, 0x5c6bfb31};
+  for (int i = 0; i < kBloomBlockWords; ++i) {
+    mask[i] = 0;
+  }
+  const uint32_t h = static_cast<uint32_t>(hash);
+  for (int i = 0; i < num_hashes; ++i) {
+    const uint32_t bit = (h * kSalts[i]) >> (32 - kBloomBlockShift);
+    mask[bit >> 5] |= static_cast<uint32_t>(1) << (bit & 31);
+  }
+}
+
 }  // namespace existence_filter_internal
 
 // ExistenceFilter parameters.
 struct ExistenceFilterParams {
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const ExistenceFilterParams& params) {
-    absl::Format(
-        &sink,
-        "size: %d bits, estimated insertions: %d, num_hashes: %d, fp_type: %d",
-        params.size, params.expected_nelts, params.num_hashes, params.fp_type);
+    absl::Format(&sink,
+                 "size: %d bits, estimated insertions: %d, num_hashes: %d, "
+                 "fp_type: %d, layout: %d",
+                 params.size, params.expected_nelts, params.num_hashes,
+                 params.fp_type, params.layout);
   }
 
   enum FpType {
@@ -125,7 +176,19 @@ struct ExistenceFilterParams {
     FP_TYPE_SIZE = 2,
   };
 
-  static constexpr uint16_t kDefaultFpType = CITY_FP;
+  // Bit layout of the filter.
+  enum Layout {
+    // Each of the num_hashes bits is anywhere in the bitmap.
+    STANDARD = 0,
+    // All the bits of a key are in one 64-byte block, so that a query touches
+    // only one cache line. `size` is a multiple of 512, and the bitmap starts
+    // at the 64th byte of the serialized data. The false positive rate is
+    // slightly higher than STANDARD for the same size.
+    BLOCKED = 1,
+    LAYOUT_SIZE = 2,
+  };
+
+  static constexpr uint8_t kDefaultFpType = CITY_FP;
 
   uint32_t size = 0;            // the number of bits in the bit vector
   uint32_t expected_nelts = 0;  // the number of values that will be stored
@@ -135,9 +198,11 @@ struct ExistenceFilterParams {
   uint16_t num_hashes = 0;
 
   // Fingerprint algorithm type.
-  // The old code defines `num_hashes` as 32 bits int. To store the fp_type,
-  // splits the `num_hashes` into two 16 bits int.
-  uint16_t fp_type = kDefaultFpType;
+  // The old code defines `num_hashes` as 32 bits int. To store the fp_type
+  // and the layout, splits the `num_hashes` into a 16 bits int and two 8 bits
+  // ints. Old readers reject the BLOCKED layout as an unsupported fp_type.
+  uint8_t fp_type = kDefaultFpType;
+  uint8_t layout = STANDARD;
 
   static_assert(std::endian::native == std::endian::little);
 };
@@ -166,10 +231,10 @@ class ExistenceFilter {
   static absl::StatusOr<ExistenceFilter> Read(
       absl::Span<const uint32_t> buf ABSL_ATTRIBUTE_LIFETIME_BOUND);
 
-  // Checks if the given `args` was in the filter.
+  // Checks if the concatenation of `keys` was in the filter.
   bool Exists(absl::Span<const absl::string_view> keys) const {
-    return Exists(existence_filter_internal::Fingerprint(
-        absl::StrJoin(keys, ""), params_.fp_type));
+    return Exists(
+        existence_filter_internal::Fingerprint(keys, params_.fp_type));
   }
 
   // Checks if the given `key` was in the filter.
@@ -177,6 +242,20 @@ class ExistenceFilter {
     return Exists(existence_filter_internal::Fingerprint(key, params_.fp_type));
   }
 
+  // Checks each of `keys` and stores the result to `results`, which must have
+  // the same size as `keys`. The fingerprints of a batch are computed and
+  // their memory is prefetched before probing, so that the cache misses
+  // overlap.
+  void ExistsMany(absl::Span<const absl::string_view> keys,
+                  absl::Span<bool> results) const {
+    ExistsMany("", keys, results);
+  }
+
+  // Same as above, but checks the concatenation of `prefix` and each key.
+  void ExistsMany(absl::string_view prefix,
+                  absl::Span<const absl::string_view> keys,
+                  absl::Span<bool> results) const;
+
   // Returns params.
   const ExistenceFilterParams& params() const { return params_; }
 
@@ -184,6 +263,10 @@ class ExistenceFilter {
   // Checks if the given 'hash' was previously inserted int the filter
   // It may return some false positives
   bool Exists(uint64_t hash) const;
+  bool ExistsBlocked(uint64_t hash) const;
+
+  // Prefetches the memory to be probed by Exists(hash).
+  void Prefetch(uint64_t hash) const;
 
   ExistenceFilterParams params_;
   existence_filter_internal::BlockBitmap rep_;  // points to bitmap
@@ -197,14 +280,16 @@ class ExistenceFilterBuilder {
   explicit ExistenceFilterBuilder(ExistenceFilterParams params)
       : params_(std::move(params)), rep_(params_.size) {}
 
+  // For the BLOCKED layout, the size is rounded up to a multiple of 64 bytes.
   static ExistenceFilterBuilder CreateOptimal(
       size_t size_in_bytes, uint32_t estimated_insertions,
-      uint16_t fp_type = ExistenceFilterParams::kDefaultFpType);
+      uint8_t fp_type = ExistenceFilterParams::kDefaultFpType,
+      uint8_t layout = ExistenceFilterParams::STANDARD);
 
-  // Inserts a list of string into the filter.
+  // Inserts the concatenation of `keys` into the filter.
   void Insert(absl::Span<const absl::string_view> keys) {
-    return Insert(existence_filter_internal::Fingerprint(
-        absl::StrJoin(keys, ""), params_.fp_type));
+    return Insert(
+        existence_filter_internal::Fingerprint(keys, params_.fp_type));
   }
 
   // Inserts one string into the filter.
@@ -219,9 +304,11 @@ class ExistenceFilterBuilder {
   ExistenceFilter Build() const ABSL_ATTRIBUTE_LIFETIME_BOUND;
 
   // Returns the minimum required size of the filter in bytes
-  // under the given error rate and number of elements
-  static size_t MinFilterSizeInBytesForErrorRate(float error_rate,
-                                                 size_t num_elements);
+  // under the given error rate and number of elements. The BLOCKED layout
+  // needs 25% more space to achieve the same error rate.
+  static size_t MinFilterSizeInBytesForErrorRate(
+      float error_rate, size_t num_elements,
+      uint8_t layout = ExistenceFilterParams::STANDARD);
 
  private:
   // Inserts a hash value into the filter
@@ -32,6 +32,7 @@
 #include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/hash.h"
 #include "testing/gmock.h"
 #include "testing/gunit.h"
@@ -48,7 +50,7 @@ namespace mozc {
 namespace storage {
 namespace {
 
-void CheckValues(const ExistenceFilter& filter, int m, int n) {
+int CheckValues(const ExistenceFilter& filter, int m, int n) {
   int false_positives = 0;
   for (int i = 0; i < 2 * n; ++i) {
     const bool should_exist = ((i % 2) == 0);
@@ -63,17 +65,41 @@ void CheckValues(const ExistenceFilter& filter, int m, int n) {
   }
 
   LOG(INFO) << "false_positives: " << false_positives;
+  return false_positives;
 }
 
-std::vector<uint32_t> StringToAlignedBuffer(const absl::string_view str) {
-  std::vector<uint32_t> aligned_buf(str.size() / sizeof(uint32_t));
-  memcpy(aligned_buf.data(), str.data(), str.size());
-  return aligned_buf;
-}
+// Copy of a serialized filter starting at a cache line boundary, as the data
+// set places it.
+class AlignedBuffer {
+ public:
+  explicit AlignedBuffer(const absl::string_view str)
+      : blocks_((str.size() + sizeof(Block) - 1) / sizeof(Block)),
+        size_(str.size() / sizeof(uint32_t)) {
+    memcpy(blocks_.data(), str.data(), str.size());
+  }
+
+  uint32_t& operator[](size_t i) { return data()[i]; }
+  operator absl::Span<const uint32_t>() const {  // NOLINT
+    return absl::MakeConstSpan(
+        reinterpret_cast<const uint32_t*>(blocks_.data()), size_);
+  }
+
+ private:
+  struct alignas(existence_filter_internal::kBloomBlockBytes) Block {
+    uint32_t words[existence_filter_internal::kBloomBlockWords];
+  };
+
+  uint32_t* data() { return reinterpret_cast<uint32_t*>(blocks_.data()); }
 
-void RunTest(int m, int n) {
+  std::vector<Block> blocks_;
+  size_t size_;
+};
+
+void RunTest(int m, int n,
+             uint8_t layout = ExistenceFilterParams::STANDARD) {
   LOG(INFO) << "Test " << m << " " << n;
-  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(m, n);
+  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(
+      m, n, ExistenceFilterParams::kDefaultFpType, layout);
 
   for (int i = 0; i < n; ++i) {
     const int val = i * 2;
@@ -85,9 +111,10 @@ void RunTest(int m, int n) {
 
   const std::string buf = builder.SerializeAsString();
   LOG(INFO) << "write size: " << buf.size();
-  const std::vector<uint32_t> aligned_buf = StringToAlignedBuffer(buf);
+  const AlignedBuffer aligned_buf(buf);
   absl::StatusOr<ExistenceFilter> filter2 = ExistenceFilter::Read(aligned_buf);
   EXPECT_OK(filter2);
+  EXPECT_EQ(filter2->params().layout, layout);
   CheckValues(*filter2, m, n);
 }
 
@@ -95,6 +122,82 @@ TEST(ExistenceFilterTest, RunTest) {
   int n = 50000;
   int m = ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(0.01, 50000);
   RunTest(m, n);
+  RunTest(m, n, ExistenceFilterParams::BLOCKED);
+}
+
+TEST(ExistenceFilterTest, BlockedLayoutTest) {
+  constexpr int kNumElements = 50000;
+  const int m = ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
+      0.01, kNumElements);
+  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(
+      m, kNumElements, ExistenceFilterParams::kDefaultFpType,
+      ExistenceFilterParams::BLOCKED);
+  EXPECT_EQ(builder.Build().params().size % 512, 0);
+  for (int i = 0; i < kNumElements; ++i) {
+    builder.Insert(absl::StrCat(i * 2));
+  }
+
+  // The bitmap starts at the 64th byte.
+  const std::string buf = builder.SerializeAsString();
+  EXPECT_EQ(buf.size(), 64 + builder.Build().params().size / 8);
+  const AlignedBuffer aligned_buf(buf);
+  absl::StatusOr<ExistenceFilter> filter = ExistenceFilter::Read(aligned_buf);
+  ASSERT_OK(filter);
+
+  // The false positive rate stays in the same order as the standard layout.
+  const int false_positives = CheckValues(*filter, m, kNumElements);
+  EXPECT_LT(false_positives, kNumElements * 0.02);
+
+  // Old readers see the layout as a part of fp_type. Broken sizes are
+  // rejected.
+  AlignedBuffer broken_buf = aligned_buf;
+  broken_buf[0] += 1;
+  EXPECT_FALSE(ExistenceFilter::Read(broken_buf).ok());
+  broken_buf = aligned_buf;
+  broken_buf[2] |= 0xFF000000;
+  EXPECT_FALSE(ExistenceFilter::Read(broken_buf).ok());
+
+  // The blocks must be on cache line boundaries.
+  const AlignedBuffer shifted_buf(absl::StrCat("abcd", buf));
+  EXPECT_FALSE(ExistenceFilter::Read(
+                   absl::Span<const uint32_t>(shifted_buf).subspan(1))
+                   .ok());
+}
+
+TEST(ExistenceFilterTest, ExistsManyTest) {
+  constexpr int kNumElements = 1000;
+  for (const uint8_t layout :
+       {ExistenceFilterParams::STANDARD, ExistenceFilterParams::BLOCKED}) {
+    ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(
+        ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(0.001,
+                                                                 kNumElements),
+        kNumElements, ExistenceFilterParams::kDefaultFpType, layout);
+    for (int i = 0; i < kNumElements; i += 2) {
+      builder.Insert({"prefix", absl::StrCat(i)});
+    }
+    const ExistenceFilter filter = builder.Build();
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < kNumElements; ++i) {
+      keys.push_back(absl::StrCat(i));
+    }
+    const std::vector<absl::string_view> key_views(keys.begin(), keys.end());
+    const std::unique_ptr<bool[]> results =
+        std::make_unique<bool[]>(kNumElements);
+    filter.ExistsMany("prefix", key_views,
+                      absl::MakeSpan(results.get(), kNumElements));
+    for (int i = 0; i < kNumElements; ++i) {
+      EXPECT_EQ(results[i], filter.Exists({"prefix", keys[i]}));
+      if (i % 2 == 0) {
+        EXPECT_TRUE(results[i]);
+      }
+    }
+
+    // Keys longer than the stack buffer are concatenated on the heap.
+    const std::string long_key(1000, 'a');
+    builder.Insert({long_key, long_key});
+    EXPECT_TRUE(builder.Build().Exists(long_key + long_key));
+  }
 }
 
 TEST(ExistenceFilterTest, MinFilterSizeEstimateTest) {
@@ -131,7 +234,7 @@ TEST(ExistenceFilterTest, ReadWriteTest) {
   // If we change the default FpType, we also need to update the data FP.
   EXPECT_EQ(CityFingerprint(buf), 0x877b326008d5246a);
 
-  const std::vector<uint32_t> aligned_buf = StringToAlignedBuffer(buf);
+  const AlignedBuffer aligned_buf(buf);
   absl::StatusOr<ExistenceFilter> filter_read(
       ExistenceFilter::Read(aligned_buf));
   EXPECT_OK(filter_read);
@@ -209,7 +312,7 @@ TEST(ExistenceFilterTest, FpTypeTest) {
     }
 
     const std::string buf = builder.SerializeAsString();
-    const std::vector<uint32_t> aligned_buf = StringToAlignedBuffer(buf);
+    const AlignedBuffer aligned_buf(buf);
     absl::StatusOr<ExistenceFilter> filter_read(
         ExistenceFilter::Read(aligned_buf));
 
@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <iterator>
 #include <string>
 #include <utility>
@@ -38,6 +39,7 @@
 
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
+#include "base/parallel.h"
 #include "storage/louds/bit_stream.h"
 
 namespace mozc {
@@ -73,7 +75,8 @@ void LoudsTrieBuilder::Build() {
   CHECK(!built_);
 
   // Initialize for the build. Sort and de-dup the words.
-  std::sort(word_list_.begin(), word_list_.end());
+  ParallelStableSort(word_list_.begin(), word_list_.end(),
+                     std::less<std::string>(), num_threads_);
   word_list_.erase(std::unique(word_list_.begin(), word_list_.end()),
                    word_list_.end());
   std::vector<Entry> entry_list;
@@ -58,6 +58,11 @@ class LoudsTrieBuilder {
   // Builds the trie image.
   void Build();
 
+  // Sets the number of threads used to sort the words in Build(). Non-positive
+  // value means the number of hardware threads. The image is the same
+  // regardless of this value. The default is 1.
+  void set_num_threads(int num_threads) { num_threads_ = num_threads; }
+
   // Returns the binary image of the trie.
   absl::string_view image() const;
 
@@ -68,6 +73,7 @@ class LoudsTrieBuilder {
 
  private:
   bool built_ = false;
+  int num_threads_ = 1;
 
   std::vector<std::string> word_list_;
   std::vector<int> id_list_;
@@ -156,6 +156,13 @@ class LruCache {
   const Element* absl_nullable Tail() const { return lru_tail_; }
   Element* absl_nullable MutableTail() { return lru_tail_; }
 
+  // Returns the approximate heap size of the element blocks and the index.
+  size_t GetMemoryUsage() const {
+    using Slot = typename absl::flat_hash_map<Key, Element*>::value_type;
+    return block_capacity_ * sizeof(Element) +
+           table_.capacity() * (sizeof(Slot) + 1);
+  }
+
   // Expose the free list only for testing purposes.
   const Element* absl_nullable FreeListForTesting() const { return free_list_; }
 
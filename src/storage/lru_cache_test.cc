@@ -144,6 +144,16 @@ TEST(LruCacheTest, Clear) {
   EXPECT_EQ(SizeOfFreeList(cache), 5);
 }
 
+TEST(LruCacheTest, GetMemoryUsage) {
+  LruCache<int, int> cache(5);
+  const size_t empty_usage = cache.GetMemoryUsage();
+  for (int i = 0; i < 3; ++i) {
+    cache.Insert(i, i);
+  }
+  // At least the elements themselves are counted.
+  EXPECT_GE(cache.GetMemoryUsage(), empty_usage + 3 * 2 * sizeof(int));
+}
+
 TEST(LruCacheTest, LargeCapacity) {
   constexpr int kCapacity = 1000000;
   LruCache<int, int> cache(kCapacity);
@@ -126,6 +126,17 @@ class LruStorage {
 
   absl::string_view filename() const { return filename_; }
 
+  // Returns the memory-mapped storage file.
+  absl::string_view mapped_region() const { return mmap_.string_view(); }
+
+  // Returns the approximate heap size of the LRU index over the mapped file.
+  size_t GetIndexMemoryUsage() const {
+    using Slot = decltype(lru_map_)::value_type;
+    // A node of std::list holds two links besides the value.
+    return lru_list_.size() * 3 * sizeof(char*) +
+           lru_map_.capacity() * (sizeof(Slot) + 1);
+  }
+
   // Writes one entry at |i| th index.
   // i must be 0 <= i < size.
   // This data will not update the index of the storage.
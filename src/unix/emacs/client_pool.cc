@@ -33,6 +33,8 @@
 
 #include <memory>
 
+#include "ipc/ipc.h"
+
 namespace mozc {
 namespace emacs {
 namespace {
@@ -41,7 +43,10 @@ constexpr int kMaxClients = 64;  // max number of parallel clients
 
 }  // namespace
 
-ClientPool::ClientPool() : lru_cache_(kMaxClients), next_id_(1) {}
+ClientPool::ClientPool() : ClientPool(nullptr) {}
+
+ClientPool::ClientPool(IPCClientFactoryInterface* client_factory)
+    : client_factory_(client_factory), lru_cache_(kMaxClients), next_id_(1) {}
 
 int ClientPool::CreateClient() {
   // Emacs supports at-least 28-bit integer.
@@ -51,7 +56,7 @@ int ClientPool::CreateClient() {
       next_id_ = 1;  // Keep next_id_ to be a positive 28-bit integer.
     }
   }
-  lru_cache_.Insert(next_id_, std::make_shared<Client>());
+  lru_cache_.Insert(next_id_, NewClient());
   return next_id_++;
 }
 
@@ -63,11 +68,19 @@ std::shared_ptr<ClientPool::Client> ClientPool::GetClient(int id) {
     lru_cache_.Insert(id, *value);  // Put id at the head of LRU.
     return *value;
   } else {
-    auto client_ptr = std::make_shared<Client>();
+    std::shared_ptr<Client> client_ptr = NewClient();
     lru_cache_.Insert(id, client_ptr);
     return client_ptr;
   }
 }
 
+std::shared_ptr<ClientPool::Client> ClientPool::NewClient() const {
+  auto client = std::make_shared<Client>();
+  if (client_factory_ != nullptr) {
+    client->SetIPCClientFactory(client_factory_);
+  }
+  return client;
+}
+
 }  // namespace emacs
 }  // namespace mozc
@@ -35,6 +35,7 @@
 #include <memory>
 
 #include "client/client.h"
+#include "ipc/ipc.h"
 #include "storage/lru_cache.h"
 
 namespace mozc {
@@ -45,6 +46,9 @@ class ClientPool final {
   using Client = ::mozc::client::Client;
 
   ClientPool();
+  // Creates the clients with |client_factory| instead of the default IPC
+  // client factory. |client_factory| must outlive this pool.
+  explicit ClientPool(IPCClientFactoryInterface* client_factory);
   ClientPool(const ClientPool&) = delete;
   ClientPool& operator=(const ClientPool&) = delete;
 
@@ -60,6 +64,9 @@ class ClientPool final {
   std::shared_ptr<Client> GetClient(int id);
 
  private:
+  std::shared_ptr<Client> NewClient() const;
+
+  IPCClientFactoryInterface* client_factory_;
   storage::LruCache<int, std::shared_ptr<Client>> lru_cache_;
   int next_id_;
 };
@@ -1557,7 +1557,9 @@ The helper program helps Emacs communicate with Mozc server,
 which doesn't understand S-expression.")
 
 (defvar mozc-helper-program-args '("--suppress_stderr")
-  "A list of arguments passed to the helper program.")
+  "A list of arguments passed to the helper program.
+Add \"--in_process\" to convert inside the helper process instead of
+Mozc server.")
 
 (defvar mozc-helper-process-timeout-sec 1
   "Time-out in second to wait a response from Mozc server.")
@@ -31,23 +31,38 @@
 #include <cstdio>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/base/const_init.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "base/init_mozc.h"
 #include "base/version.h"
 #include "client/client.h"
 #include "config/config_handler.h"
 #include "protocol/commands.pb.h"
+#include "session/in_process_ipc_client_factory.h"
 #include "unix/emacs/client_pool.h"
 #include "unix/emacs/mozc_emacs_helper_lib.h"
+#include "unix/emacs/session_task_queue.h"
 
 ABSL_FLAG(bool, suppress_stderr, false, "Discards all the output to stderr.");
+ABSL_FLAG(bool, in_process, false,
+          "Evaluates the requests in this process instead of mozc_server. "
+          "Falls back to mozc_server if it is already running.");
+ABSL_FLAG(int32_t, concurrent_sessions, 0,
+          "Number of threads processing the requests of different sessions "
+          "concurrently. The requests are processed one by one if 0.");
+ABSL_FLAG(int32_t, max_pending_requests, 64,
+          "Maximum number of requests queued or being processed in the "
+          "concurrent mode.");
 
 namespace mozc::emacs {
 namespace {
@@ -73,10 +88,51 @@ void PrintGreetingMessage() {
   fflush(stdout);
 }
 
+// Serializes the output lines of the workers.
+ABSL_CONST_INIT absl::Mutex g_output_mutex(absl::kConstInit);
+
+// Prints a result returned by Mozc server in S-expression.
+void PrintResponse(uint32_t event_id, uint32_t session_id,
+                   commands::Output* output) {
+  RemoveUsageData(output);
+
+  std::vector<std::string> buffer;
+  PrintMessage(*output, &buffer);
+  const std::string result = absl::StrJoin(buffer, "");
+  absl::MutexLock l(g_output_mutex);
+  absl::FPrintF(
+      stdout, "((emacs-event-id . %u)(emacs-session-id . %u)(output . %s))\n",
+      event_id, session_id, result);
+  fflush(stdout);
+}
+
+void SendKey(client::Client* client, uint32_t event_id, uint32_t session_id,
+             const commands::KeyEvent& key) {
+  commands::Output output;
+  if (!client->SendKey(key, &output)) {
+    absl::MutexLock l(g_output_mutex);
+    ErrorExit(kErrSessionError, "Session failed");
+  }
+  PrintResponse(event_id, session_id, &output);
+}
+
 // Main loop, which takes an input line as a command and print a corresponding
 // result returned by Mozc server in S-expression.
+//
+// In the concurrent mode, the requests are queued per session and the
+// responses are printed as they complete. The requests of a session are still
+// processed in order.
 void ProcessLoop() {
-  ClientPool client_pool;
+  InProcessIPCClientFactory* in_process_factory =
+      absl::GetFlag(FLAGS_in_process)
+          ? InProcessIPCClientFactory::GetInProcessIPCClientFactory()
+          : nullptr;
+  ClientPool client_pool(in_process_factory);
+  std::optional<SessionTaskQueue> task_queue;
+  if (const int num_threads = absl::GetFlag(FLAGS_concurrent_sessions);
+      num_threads > 0) {
+    task_queue.emplace(num_threads, absl::GetFlag(FLAGS_max_pending_requests));
+  }
   commands::Command command;
   std::string line;
 
@@ -94,31 +150,44 @@ void ProcessLoop() {
         session_id = client_pool.CreateClient();
         break;
       case commands::Input::DELETE_SESSION:
+        // The queued requests keep the client alive.
         client_pool.DeleteClient(session_id);
         break;
       case commands::Input::SEND_KEY: {
         std::shared_ptr<client::Client> client =
             client_pool.GetClient(session_id);
         CHECK(client.get());
-        if (!client->SendKey(command.input().key(), command.mutable_output())) {
-          ErrorExit(kErrSessionError, "Session failed");
+        if (task_queue.has_value()) {
+          task_queue->Post(session_id, [client = std::move(client), event_id,
+                                        session_id,
+                                        key = command.input().key()] {
+            SendKey(client.get(), event_id, session_id, key);
+          });
+        } else {
+          SendKey(client.get(), event_id, session_id, command.input().key());
         }
-        break;
+        continue;
       }
       default:
         ErrorExit(kErrVoidFunction, "Unknown function");
     }
 
-    RemoveUsageData(command.mutable_output());
+    if (task_queue.has_value()) {
+      // Responds after the queued requests of the session.
+      task_queue->Post(session_id, [event_id, session_id,
+                                    output = command.output()]() mutable {
+        PrintResponse(event_id, session_id, &output);
+      });
+    } else {
+      PrintResponse(event_id, session_id, command.mutable_output());
+    }
+  }
 
-    // Output results.
-    std::vector<std::string> buffer;
-    PrintMessage(command.output(), &buffer);
-    const std::string output = absl::StrJoin(buffer, "");
-    absl::FPrintF(
-        stdout, "((emacs-event-id . %u)(emacs-session-id . %u)(output . %s))\n",
-        event_id, session_id, output);
-    fflush(stdout);
+  if (in_process_factory != nullptr) {
+    // Finishes the queued requests, then syncs the user data, which
+    // mozc_server would do on its shutdown.
+    task_queue.reset();
+    in_process_factory->Shutdown();
   }
 }
 
@@ -0,0 +1,105 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "unix/emacs/session_task_queue.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "base/thread.h"
+
+namespace mozc {
+namespace emacs {
+
+SessionTaskQueue::SessionTaskQueue(int num_threads, int max_pending_tasks)
+    : max_pending_tasks_(std::max(max_pending_tasks, 1)) {
+  num_threads = std::max(num_threads, 1);
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this] { WorkerMain(); });
+  }
+}
+
+SessionTaskQueue::~SessionTaskQueue() {
+  Wait();
+  {
+    absl::MutexLock l(mutex_);
+    stopped_ = true;
+  }
+  workers_.clear();  // Joins the workers.
+}
+
+void SessionTaskQueue::Post(int session_id, Task task) {
+  absl::MutexLock l(mutex_);
+  mutex_.Await(absl::Condition(this, &SessionTaskQueue::CanPost));
+  ++pending_tasks_;
+  auto [it, inserted] = queues_.try_emplace(session_id);
+  it->second.push_back(std::move(task));
+  if (inserted) {
+    // Otherwise, the session is already ready or running.
+    ready_sessions_.push_back(session_id);
+  }
+}
+
+void SessionTaskQueue::Wait() {
+  absl::MutexLock l(mutex_);
+  mutex_.Await(absl::Condition(this, &SessionTaskQueue::IsIdle));
+}
+
+void SessionTaskQueue::WorkerMain() {
+  absl::MutexLock l(mutex_);
+  while (true) {
+    mutex_.Await(absl::Condition(this, &SessionTaskQueue::HasReadySession));
+    if (ready_sessions_.empty()) {
+      return;  // Stopped.
+    }
+    const int session_id = ready_sessions_.front();
+    ready_sessions_.pop_front();
+    // The reference to the queue is not stable while the mutex is released.
+    Task task = std::move(queues_[session_id].front());
+    queues_[session_id].pop_front();
+
+    mutex_.unlock();
+    std::move(task)();
+    mutex_.lock();
+
+    --pending_tasks_;
+    if (queues_[session_id].empty()) {
+      queues_.erase(session_id);
+    } else {
+      // Let the other sessions run before the next task of this session.
+      ready_sessions_.push_back(session_id);
+    }
+  }
+}
+
+}  // namespace emacs
+}  // namespace mozc
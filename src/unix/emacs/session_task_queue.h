@@ -0,0 +1,97 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Task queue running the requests of the sessions concurrently.
+
+#ifndef MOZC_UNIX_EMACS_SESSION_TASK_QUEUE_H_
+#define MOZC_UNIX_EMACS_SESSION_TASK_QUEUE_H_
+
+#include <deque>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "base/thread.h"
+
+namespace mozc {
+namespace emacs {
+
+// Runs the posted tasks on worker threads. The tasks of a session run one by
+// one in the posted order, while the tasks of different sessions run
+// concurrently.
+class SessionTaskQueue final {
+ public:
+  using Task = absl::AnyInvocable<void() &&>;
+
+  // Starts |num_threads| workers. Post() blocks while |max_pending_tasks|
+  // tasks are queued or running.
+  SessionTaskQueue(int num_threads, int max_pending_tasks);
+  SessionTaskQueue(const SessionTaskQueue&) = delete;
+  SessionTaskQueue& operator=(const SessionTaskQueue&) = delete;
+
+  // Waits for all the posted tasks and stops the workers.
+  ~SessionTaskQueue();
+
+  // Appends |task| to the queue of |session_id|.
+  void Post(int session_id, Task task) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Blocks until all the posted tasks complete.
+  void Wait() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void WorkerMain() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  bool CanPost() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return pending_tasks_ < max_pending_tasks_;
+  }
+  bool IsIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return pending_tasks_ == 0;
+  }
+  bool HasReadySession() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return stopped_ || !ready_sessions_.empty();
+  }
+
+  const int max_pending_tasks_;
+  absl::Mutex mutex_;
+  int pending_tasks_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+  // A session has an entry while it has a queued or running task.
+  absl::flat_hash_map<int, std::deque<Task>> queues_ ABSL_GUARDED_BY(mutex_);
+  // The sessions having a queued task but no running task.
+  std::deque<int> ready_sessions_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Thread> workers_;
+};
+
+}  // namespace emacs
+}  // namespace mozc
+
+#endif  // MOZC_UNIX_EMACS_SESSION_TASK_QUEUE_H_
@@ -0,0 +1,102 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "unix/emacs/session_task_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "base/thread.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace emacs {
+namespace {
+
+TEST(SessionTaskQueueTest, KeepsOrderInSession) {
+  std::vector<int> results[2];
+  {
+    SessionTaskQueue queue(4, 8);
+    for (int i = 0; i < 100; ++i) {
+      for (int session = 0; session < 2; ++session) {
+        queue.Post(session, [&results, session, i] {
+          results[session].push_back(i);
+        });
+      }
+    }
+    queue.Wait();
+  }
+  for (const std::vector<int>& result : results) {
+    ASSERT_EQ(result.size(), 100);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(result[i], i);
+    }
+  }
+}
+
+TEST(SessionTaskQueueTest, RunsSessionsConcurrently) {
+  SessionTaskQueue queue(2, 8);
+  absl::Notification second_done;
+  std::atomic<bool> first_waited = false;
+  // The first session is blocked until the second one runs.
+  queue.Post(1, [&] {
+    first_waited = second_done.WaitForNotificationWithTimeout(
+        absl::Seconds(10));
+  });
+  queue.Post(2, [&] { second_done.Notify(); });
+  queue.Wait();
+  EXPECT_TRUE(first_waited);
+}
+
+TEST(SessionTaskQueueTest, BoundsPendingTasks) {
+  SessionTaskQueue queue(1, 2);
+  absl::Notification release;
+  queue.Post(1, [&] { release.WaitForNotification(); });
+  queue.Post(2, [] {});
+
+  std::atomic<bool> posted = false;
+  BackgroundFuture<void> poster([&] {
+    queue.Post(3, [] {});
+    posted = true;
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  EXPECT_FALSE(posted);
+
+  release.Notify();
+  poster.Wait();
+  EXPECT_TRUE(posted);
+  queue.Wait();
+}
+
+}  // namespace
+}  // namespace emacs
+}  // namespace mozc